@@ -7,6 +7,12 @@
 QT += core gui
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets svg printsupport
 
+# The render server's --serve-socket needs QtNetwork; qmake CONFIG+=fin_no_render_socket builds without it.
+!fin_no_render_socket {
+    QT += network
+    DEFINES += FIN_RENDER_SOCKET
+}
+
 system ("git status") {
     GIT_BRANCH = $$system(git rev-parse --abbrev-ref HEAD)
     GIT_TIME = $$system(git show --oneline --format=\"%ci\" -s HEAD)
@@ -21,6 +27,11 @@ DEFINES += GIT_BRANCH=\"\\\"$$GIT_BRANCH\\\"\"
 DEFINES += GIT_TIME=\"\\\"$$GIT_TIME\\\"\"
 DEFINES += APP_VERSION=\"\\\"$$APP_VERSION\\\"\"
 
+# Highest trace level compiled in (0 off, 1 error, 2 warn, 3 info, 4 debug), e.g. qmake FIN_TRACE_MAX_LEVEL=2
+!isEmpty(FIN_TRACE_MAX_LEVEL) {
+    DEFINES += FIN_TRACE_MAX_LEVEL=$$FIN_TRACE_MAX_LEVEL
+}
+
 TARGET = FigureItNow7
 TEMPLATE = app
 
@@ -34,6 +45,7 @@ SOURCES += main.cpp\
     finFigureObject.cpp \
     finLexNode.cpp \
     finLexReader.cpp \
+    finSymbolTable.cpp \
     finSyntaxErrorDump.cpp \
     finSyntaxErrorList.cpp \
     finSyntaxNode.cpp \
@@ -77,11 +89,17 @@ SOURCES += main.cpp\
     finPlotPolar.cpp \
     finPlotEquation2D.cpp \
     finPlotParametric.cpp \
+    finPlotParallel.cpp \
     finUiSyntaxHighlighter.cpp \
     finUiScriptEditor.cpp \
     finUiAboutDlg.cpp \
     finUiCommandLine.cpp \
+    finUiRenderServer.cpp \
     finExecAlg.cpp \
+    finExecAlgSimd.cpp \
+    finExecBytecode.cpp \
+    finExecPool.cpp \
+    finExecCompileCache.cpp \
     finExecVariableSysvar.cpp \
     finUiSysFuncList.cpp \
     finVersion.cpp
@@ -91,6 +109,7 @@ HEADERS  += MainWindow.h \
     finFigureObject.h \
     finLexNode.h \
     finLexReader.h \
+    finSymbolTable.h \
     finSyntaxErrorDump.h \
     finSyntaxErrorList.h \
     finSyntaxNode.h \
@@ -127,11 +146,17 @@ HEADERS  += MainWindow.h \
     finPlotPolar.h \
     finPlotEquation2D.h \
     finPlotParametric.h \
+    finPlotParallel.h \
     finUiSyntaxHighlighter.h \
     finUiScriptEditor.h \
     finUiAboutDlg.h \
     finUiCommandLine.h \
+    finUiRenderServer.h \
     finExecAlg.h \
+    finExecAlgSimd.h \
+    finExecBytecode.h \
+    finExecPool.h \
+    finExecCompileCache.h \
     finUiSysFuncList.h \
     finVersion.h
 
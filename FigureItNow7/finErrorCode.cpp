@@ -10,7 +10,8 @@
  *  \brief Implementations of the error-code helpers and finException.
  *
  *  Provides the lookup table backing finErrorKits::errcodeToString(), the finException constructor /
- *  accessor / logging routines, and the QDebug stream operator used to render a finExceptionObject.
+ *  accessor / logging routines, the QDebug stream operator used to render a finExceptionObject, and the
+ *  runtime level table of finTraceKits.
  */
 
 #include "finErrorCode.h"
@@ -18,6 +19,7 @@
 #include <QtGlobal>
 #include <QObject>
 #include <QDebug>
+#include <QStringList>
 
 static const struct {
     finErrorCode _errCode;
@@ -188,6 +190,16 @@ QString finException::dumpInfo() const
 
 void finException::dump() const
 {
+    static const finTraceKits::Level tracelevel[EL_MAX] = {
+        finTraceKits::TL_OFF, finTraceKits::TL_DEBUG, finTraceKits::TL_INFO,
+        finTraceKits::TL_WARNING, finTraceKits::TL_ERROR, finTraceKits::TL_ERROR,
+    };
+
+    // Exceptions caught and recovered from are common; skip formatting unless the line is written.
+    if ( this->_level > EL_DUMMY && this->_level < EL_FATAL &&
+         !finTraceKits::isTraced(finTraceKits::TC_EXCEPTION, tracelevel[this->_level]) )
+        return;
+
     switch (this->_level) {
     case EL_DEBUG:
         qDebug() << this->dumpInfo();
@@ -209,3 +221,111 @@ void finException::dump() const
     }
 }
 
+QAtomicInt finTraceKits::_catLevel[TC_MAX] = {
+    TL_DEBUG, TL_DEBUG, TL_DEBUG, TL_DEBUG, TL_DEBUG, TL_DEBUG
+};
+
+finTraceKits::finTraceKits()
+{
+    /* Do Nothing because you should not call this constructor. */
+}
+
+finTraceKits::Level finTraceKits::getLevel(Category cat)
+{
+    Q_ASSERT_X(cat >= TC_GENERAL && cat < TC_MAX, "cast", "invalid category");
+    return static_cast<Level>(_catLevel[cat].loadRelaxed());
+}
+
+void finTraceKits::setLevel(Category cat, Level level)
+{
+    Q_ASSERT_X(cat >= TC_GENERAL && cat < TC_MAX, "cast", "invalid category");
+    _catLevel[cat].storeRelaxed(level);
+}
+
+void finTraceKits::setAllLevels(Level level)
+{
+    for ( int i = 0; i < TC_MAX; i++ )
+        _catLevel[i].storeRelaxed(level);
+}
+
+finErrorCode finTraceKits::setupFromString(const QString &spec)
+{
+    finErrorCode errcode = finErrorKits::EC_SUCCESS;
+    const QStringList itemlist = spec.split(QChar(','), Qt::SkipEmptyParts);
+
+    foreach ( const QString &item, itemlist ) {
+        QString catname, lvname = item.trimmed();
+        int eqidx = lvname.indexOf(QChar('='));
+        if ( eqidx >= 0 ) {
+            catname = lvname.left(eqidx).trimmed();
+            lvname = lvname.mid(eqidx + 1).trimmed();
+        }
+
+        int level = TL_MAX;
+        for ( int i = TL_OFF; i < TL_MAX; i++ ) {
+            QLatin1String name(levelName(static_cast<Level>(i)));
+            if ( QString::compare(lvname, name, Qt::CaseInsensitive) == 0 ) {
+                level = i;
+                break;
+            }
+        }
+        if ( level == TL_MAX ) {
+            errcode = finErrorKits::EC_INVALID_PARAM;
+            continue;
+        }
+
+        if ( catname.isEmpty() ) {
+            setAllLevels(static_cast<Level>(level));
+            continue;
+        }
+
+        int cat = TC_MAX;
+        for ( int i = TC_GENERAL; i < TC_MAX; i++ ) {
+            QLatin1String name(categoryName(static_cast<Category>(i)));
+            if ( QString::compare(catname, name, Qt::CaseInsensitive) == 0 ) {
+                cat = i;
+                break;
+            }
+        }
+        if ( cat == TC_MAX ) {
+            errcode = finErrorKits::EC_INVALID_PARAM;
+            continue;
+        }
+        setLevel(static_cast<Category>(cat), static_cast<Level>(level));
+    }
+    return errcode;
+}
+
+QDebug finTraceKits::traceStream(Level level)
+{
+    switch ( level ) {
+      case TL_ERROR:
+        return QMessageLogger().critical();
+      case TL_WARNING:
+        return QMessageLogger().warning();
+      case TL_INFO:
+        return QMessageLogger().info();
+      default:
+        return QMessageLogger().debug();
+    }
+}
+
+const char *finTraceKits::levelName(Level level)
+{
+    static const char *levelname[TL_MAX] = {
+        "off", "error", "warn", "info", "debug"
+    };
+
+    Q_ASSERT_X(level >= TL_OFF && level < TL_MAX, "cast", "invalid level");
+    return levelname[level];
+}
+
+const char *finTraceKits::categoryName(Category cat)
+{
+    static const char *catname[TC_MAX] = {
+        "general", "lex", "syntax", "exec", "plot", "exception"
+    };
+
+    Q_ASSERT_X(cat >= TC_GENERAL && cat < TC_MAX, "cast", "invalid category");
+    return catname[cat];
+}
@@ -9,14 +9,15 @@
  *  \brief Declarations of error codes, exceptions, and diagnostic utilities.
  *
  *  This header defines the error-code enumeration shared by every FIN-7 module, the finException
- *  type used to propagate errors across module boundaries, and the convenience macros used for
- *  throwing and logging.
+ *  type used to propagate errors across module boundaries, the finTraceKits switches behind the
+ *  leveled trace macros, and the convenience macros used for throwing and logging.
  */
 
 #ifndef FINERRORCODE_H
 #define FINERRORCODE_H
 
 #include <QObject>
+#include <QAtomicInt>
 #include <QDebug>
 #include <QException>
 #include <QString>
@@ -282,6 +283,90 @@ public:
     void dump() const;
 };
 
+/*! \def FIN_TRACE_MAX_LEVEL
+ *  \brief Highest finTraceKits::Level whose trace lines are compiled in.
+ *
+ *  Trace lines above this level compile to nothing, arguments included. Defaults to TL_DEBUG, or to
+ *  TL_INFO when QT_NO_DEBUG is defined; override it with the FIN_TRACE_MAX_LEVEL build option.
+ */
+#ifndef FIN_TRACE_MAX_LEVEL
+#  ifdef QT_NO_DEBUG
+#    define FIN_TRACE_MAX_LEVEL  3
+#  else
+#    define FIN_TRACE_MAX_LEVEL  4
+#  endif
+#endif
+
+/*! \class finTraceKits
+ *  \brief Leveled, category-based switches for the finTrace* logging macros.
+ *
+ *  finTraceKits is used as a namespace. Every trace line has a Category and a Level, and is written only
+ *  if its level is within both the build-time ceiling FIN_TRACE_MAX_LEVEL and the runtime level of its
+ *  category. A line disabled at run time costs one comparison and formats nothing.
+ */
+class finTraceKits
+{
+public:
+    /*! \enum finTraceKits::Category
+     *  \brief Subsystems whose tracing can be switched independently.
+     */
+    enum Category {
+        TC_GENERAL = 0,  //!< Everything else; the category of finDebug and finInfo.
+        TC_LEX,          //!< The lexer (finLexReader).
+        TC_SYNTAX,       //!< The parser and syntax trees.
+        TC_EXEC,         //!< The execution machine and its runtime.
+        TC_PLOT,         //!< Plotters and figure objects.
+        TC_EXCEPTION,    //!< The log line every finException writes when constructed.
+        TC_MAX           //!< Sentinel marking the end of the enum.
+    };
+
+    /*! \enum finTraceKits::Level
+     *  \brief Trace levels; a category at a given level also writes every lower level.
+     */
+    enum Level {
+        TL_OFF = 0,      //!< Nothing is written.
+        TL_ERROR,        //!< Errors; written to qCritical().
+        TL_WARNING,      //!< Warnings; written to qWarning().
+        TL_INFO,         //!< Informational messages; written to qInfo().
+        TL_DEBUG,        //!< Debug diagnostics; written to qDebug().
+        TL_MAX           //!< Sentinel marking the end of the enum.
+    };
+
+private:
+    static QAtomicInt _catLevel[TC_MAX];
+
+    finTraceKits();
+
+public:
+    /*!
+     *  \brief Returns whether a trace line of \a level in \a cat is written.
+     */
+    static inline bool isTraced(Category cat, Level level)
+    {
+        return level <= FIN_TRACE_MAX_LEVEL && level <= _catLevel[cat].loadRelaxed();
+    }
+
+    static Level getLevel(Category cat);
+    static void setLevel(Category cat, Level level);
+    static void setAllLevels(Level level);
+
+    /*!
+     *  \brief Sets runtime levels from a specification such as "warn,lex=debug,exception=off".
+     *
+     *  A bare level applies to every category; "category=level" applies to one. Items are applied in
+     *  order, and unknown items are skipped with EC_INVALID_PARAM returned at the end.
+     */
+    static finErrorCode setupFromString(const QString &spec);
+
+    /*!
+     *  \brief Returns the Qt message stream a trace line of \a level is written to.
+     */
+    static QDebug traceStream(Level level);
+
+    static const char *levelName(Level level);
+    static const char *categoryName(Category cat);
+};
+
 /*! \def _FIN_DEBUGHEAD(func,file,line,level)
  *  \brief Builds the "[func (file:line) level]" prefix used in log lines.
  *
@@ -336,15 +421,30 @@ public:
  */
 #define finDebugHead(level)  _FIN_DEBUGHEAD(__PRETTY_FUNCTION__, __FILE__, __LINE__, level)
 
+/*! \def finTrace(cat, level)
+ *  \brief Stream-style trace line of category \a cat at \a level, prefixed with the current source location.
+ *
+ *  Use it as a statement: `finTrace(finTraceKits::TC_LEX, finTraceKits::TL_DEBUG) << ...;`. The streamed
+ *  operands are evaluated only if the line is written.
+ */
+#define finTrace(cat, level) \
+    if ( !finTraceKits::isTraced((cat), (level)) ) {} else \
+        finTraceKits::traceStream(level).noquote() << finDebugHead(finTraceKits::levelName(level))
+
+#define finTraceError(cat)    finTrace((cat), finTraceKits::TL_ERROR)
+#define finTraceWarning(cat)  finTrace((cat), finTraceKits::TL_WARNING)
+#define finTraceInfo(cat)     finTrace((cat), finTraceKits::TL_INFO)
+#define finTraceDebug(cat)    finTrace((cat), finTraceKits::TL_DEBUG)
+
 /*! \def finDebug
- *  \brief Stream-style qDebug() prefixed with the current source location.
+ *  \brief Debug trace line of the general category; see finTrace().
  */
-#define finDebug    (qDebug().noquote() << finDebugHead("debug"))
+#define finDebug    finTraceDebug(finTraceKits::TC_GENERAL)
 
 /*! \def finInfo
- *  \brief Stream-style qInfo() prefixed with the current source location.
+ *  \brief Informational trace line of the general category; see finTrace().
  */
-#define finInfo     (qInfo().noquote() << finDebugHead("info"))
+#define finInfo     finTraceInfo(finTraceKits::TC_GENERAL)
 
 /*! \def finWarning
  *  \brief Stream-style qWarning() prefixed with the current source location.
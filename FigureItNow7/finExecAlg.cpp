@@ -17,6 +17,7 @@
 #include <qmath.h>
 
 #include "finExecAlg.h"
+#include "finExecAlgSimd.h"
 
 finExecAlg::finExecAlg()
 {
@@ -181,6 +182,24 @@ void finExecAlg::csStringToArrayVar(const QString &csstr, finExecVariable *outva
     stringListToArrayVar(trimstr.split(','), outvar);
 }
 
+void finExecAlg::csStringToNumList(const QString &csstr, QList<double> *list)
+{
+    list->clear();
+    QString trimstr = csstr.trimmed();
+    if ( trimstr.isEmpty() )
+        return;
+
+    QStringList strlist = trimstr.split(',');
+    list->reserve(strlist.length());
+    foreach ( const QString &stritem, strlist ) {
+        bool numok = false;
+        double valitem = stritem.toDouble(&numok);
+        if ( !numok )
+            valitem = 0.0;
+        list->append(valitem);
+    }
+}
+
 QString finExecAlg::numArrayVarToCsString(finExecVariable *invar)
 {
     QStringList strlist;
@@ -213,6 +232,10 @@ void finExecAlg::numArrayVarToList(finExecVariable *invar, QList<double> *list)
         _appendVarToNumList(invar, list);
         return;
     }
+    if ( invar->isPackedArray() && invar->getPackedColumnCount() == 0 ) {
+        *list = invar->getPackedData();
+        return;
+    }
 
     int itemcnt = invar->getArrayLength();
     for ( int i = 0; i < itemcnt; i++ ) {
@@ -230,6 +253,13 @@ void finExecAlg::numMatVarToList(finExecVariable *invar, QList<QList<double>> *l
         list->append(tmplist);
         return;
     }
+    if ( invar->isPackedArray() && invar->getPackedColumnCount() > 0 ) {
+        const QList<double> &data = invar->getPackedData();
+        int colcnt = invar->getPackedColumnCount();
+        for ( int i = 0; i < data.length(); i += colcnt )
+            list->append(data.mid(i, colcnt));
+        return;
+    }
 
     int itemcnt = invar->getArrayLength();
     for ( int i = 0; i < itemcnt; i++ ) {
@@ -243,20 +273,30 @@ void finExecAlg::numMatVarToList(finExecVariable *invar, QList<QList<double>> *l
 void finExecAlg::listToNumArrayVar(const QList<double> &list, finExecVariable *outvar)
 {
     outvar->setType(finExecVariable::TP_ARRAY);
-    outvar->preallocArrayLength(list.length());
-
-    int idx = 0;
-    foreach ( double val, list ) {
-        finExecVariable *itemvar = outvar->getVariableItemAt(idx);
-        itemvar->setType(finExecVariable::TP_NUMERIC);
-        itemvar->setNumericValue(val);
-        idx++;
-    }
+    outvar->setupPackedArray(list);
 }
 
 void finExecAlg::listToNumMatVar(const QList<QList<double>> &list, finExecVariable *outvar)
 {
     outvar->setType(finExecVariable::TP_ARRAY);
+
+    int colcnt = (list.empty() ? 0 : list.first().length());
+    bool isrect = (colcnt > 0);
+    foreach ( const QList<double> &sublist, list ) {
+        if ( sublist.length() != colcnt ) {
+            isrect = false;
+            break;
+        }
+    }
+    if ( isrect ) {
+        QList<double> flatlist;
+        flatlist.reserve(list.length() * colcnt);
+        foreach ( const QList<double> &sublist, list )
+            flatlist.append(sublist);
+        outvar->setupPackedArray(flatlist, colcnt);
+        return;
+    }
+
     outvar->preallocArrayLength(list.length());
 
     int idx = 0;
@@ -267,6 +307,33 @@ void finExecAlg::listToNumMatVar(const QList<QList<double>> &list, finExecVariab
     }
 }
 
+void finExecAlg::numMatVarToFlatList(finExecVariable *invar, QList<double> *list, int *rowcnt, int *colcnt)
+{
+    if ( invar == nullptr || list == nullptr || rowcnt == nullptr || colcnt == nullptr )
+        finThrow(finErrorKits::EC_NULL_POINTER, "Input or output pointer is null.");
+    if ( !invar->isNumericMatrix(rowcnt, colcnt) )
+        finThrow(finErrorKits::EC_INVALID_PARAM, "Input variable is not a numeric matrix.");
+
+    if ( invar->isPackedArray() ) {
+        *list = invar->getPackedData();
+        return;
+    }
+
+    list->clear();
+    list->reserve((*rowcnt) * (*colcnt));
+    for ( int i = 0; i < *rowcnt; i++ ) {
+        QList<double> rowlist;
+        numArrayVarToList(invar->getVariableItemAt(i), &rowlist);
+        list->append(rowlist);
+    }
+}
+
+void finExecAlg::flatListToNumMatVar(const QList<double> &list, int colcnt, finExecVariable *outvar)
+{
+    outvar->setType(finExecVariable::TP_ARRAY);
+    outvar->setupPackedArray(list, colcnt);
+}
+
 void finExecAlg::listMatrixToArray(const QList< QList<double> > &inlist, QList<double> *outlist)
 {
     if ( outlist == nullptr ) {
@@ -382,10 +449,8 @@ void finExecAlg::listArrayNeg(const QList<double> &inlist, QList<double> *outlis
     if ( outlist == nullptr ) {
         finThrow(finErrorCode::EC_NULL_POINTER, "The output variable is null.");
     }
-    outlist->clear();
-    foreach ( double val, inlist) {
-        outlist->append(-val);
-    }
+    outlist->resize(inlist.length());
+    finExecAlgSimd::arrayNeg(inlist.constData(), outlist->data(), inlist.length());
 }
 
 void finExecAlg::listArrayAdd(const QList<double> &inlist1, const QList<double> &inlist2,
@@ -399,12 +464,8 @@ void finExecAlg::listArrayAdd(const QList<double> &inlist1, const QList<double>
     }
 
     int len = inlist1.length();
-    outlist->clear();
-    for ( int i = 0; i < len; i++ ) {
-        double val1 = inlist1.at(i);
-        double val2 = inlist2.at(i);
-        outlist->append(val1 + val2);
-    }
+    outlist->resize(len);
+    finExecAlgSimd::arrayAdd(inlist1.constData(), inlist2.constData(), outlist->data(), len);
 }
 
 void finExecAlg::listArraySub(const QList<double> &inlist1, const QList<double> &inlist2,
@@ -418,12 +479,8 @@ void finExecAlg::listArraySub(const QList<double> &inlist1, const QList<double>
     }
 
     int len = inlist1.length();
-    outlist->clear();
-    for ( int i = 0; i < len; i++ ) {
-        double val1 = inlist1.at(i);
-        double val2 = inlist2.at(i);
-        outlist->append(val1 - val2);
-    }
+    outlist->resize(len);
+    finExecAlgSimd::arraySub(inlist1.constData(), inlist2.constData(), outlist->data(), len);
 }
 
 void finExecAlg::listArraySum(const QList<double> &inlist, double *outval)
@@ -432,11 +489,7 @@ void finExecAlg::listArraySum(const QList<double> &inlist, double *outval)
         finThrow(finErrorKits::EC_NULL_POINTER, "The output variable is null.");
     }
 
-    double sumval = 0.0;
-    foreach ( double val, inlist ) {
-        sumval += val;
-    }
-    *outval = sumval;
+    *outval = finExecAlgSimd::arraySum(inlist.constData(), inlist.length());
 }
 
 void finExecAlg::listArrayAvg(const QList<double> &inlist, double *outval)
@@ -462,10 +515,7 @@ void finExecAlg::listVectorNorm(const QList<double> &inlist, double *outval)
         finThrow(finErrorKits::EC_NULL_POINTER, "The output variable is null.");
     }
 
-    double norm2 = 0.0;
-    foreach ( double val, inlist ) {
-        norm2 += val * val;
-    }
+    double norm2 = finExecAlgSimd::arraySumSquare(inlist.constData(), inlist.length());
     *outval = sqrt(norm2);
 }
 
@@ -475,11 +525,7 @@ void finExecAlg::listVectorNorm1(const QList<double> &inlist, double *outval)
         finThrow(finErrorKits::EC_NULL_POINTER, "The output variable is null.");
     }
 
-    double norm = 0.0;
-    foreach ( double val, inlist ) {
-        norm += fabs(val);
-    }
-    *outval = norm;
+    *outval = finExecAlgSimd::arraySumAbs(inlist.constData(), inlist.length());
 }
 
 void finExecAlg::listVectorNormP(const QList<double> &inlist, double p, double *outval)
@@ -501,12 +547,7 @@ void finExecAlg::listVectorNormInf(const QList<double> &inlist, double *outval)
         finThrow(finErrorKits::EC_NULL_POINTER, "The output variable is null.");
     }
 
-    double normmax = 0.0;
-    foreach ( double val, inlist ) {
-        if ( fabs(val) > normmax )
-            normmax = fabs(val);
-    }
-    *outval = normmax;
+    *outval = finExecAlgSimd::arrayMaxAbs(inlist.constData(), inlist.length());
 }
 
 void finExecAlg::listVectorNormalize(const QList<double> &inlist, QList<double> *outlist)
@@ -518,10 +559,8 @@ void finExecAlg::listVectorNormalize(const QList<double> &inlist, QList<double>
     double norm = 1.0;
     listVectorNorm(inlist, &norm);
 
-    outlist->clear();
-    foreach ( double val, inlist ) {
-        outlist->append(val/norm);
-    }
+    outlist->resize(inlist.length());
+    finExecAlgSimd::arrayDiv(inlist.constData(), norm, outlist->data(), inlist.length());
 }
 
 void finExecAlg::listVectorDot(const QList<double> &inlist1, const QList<double> &inlist2, double *outval)
@@ -534,13 +573,7 @@ void finExecAlg::listVectorDot(const QList<double> &inlist1, const QList<double>
     if ( len > inlist2.length() )
         len = inlist2.length();
 
-    double retval = 0.0;
-    for ( int i = 0; i < len; i++ ) {
-        double val1 = inlist1.at(i);
-        double val2 = inlist2.at(i);
-        retval += val1 * val2;
-    }
-    *outval = retval;
+    *outval = finExecAlgSimd::arrayDot(inlist1.constData(), inlist2.constData(), len);
 }
 
 void finExecAlg::varArrayNeg(finExecVariable *invar, finExecVariable *outvar)
@@ -822,27 +855,48 @@ void finExecAlg::listMatDot(const QList<QList<double>> &inlist1, const QList<QLi
     if ( outlist == nullptr )
         finThrow(finErrorKits::EC_NULL_POINTER, "The output list is null.");
 
-    QList<QList<double>> inlist2t;
-    listMatTranspose(inlist2, &inlist2t);
-
-    outlist->clear();
-    foreach ( const QList<double> &in1row, inlist1 ) {
-        QList<double> outrow;
-        foreach ( const QList<double> &in2col, inlist2t ) {
-            int len = in1row.length();
-            if ( len != in2col.length() )
+    // Shorter rows of the right operand are zero-padded, as listMatTranspose() does.
+    int row1 = inlist1.length(), col1 = inlist2.length(), col2 = 0;
+    foreach ( const QList<double> &in2row, inlist2 ) {
+        if ( in2row.length() > col2 )
+            col2 = in2row.length();
+    }
+    if ( col2 > 0 ) {
+        foreach ( const QList<double> &in1row, inlist1 ) {
+            if ( in1row.length() != col1 )
                 finThrow(finErrorKits::EC_INVALID_PARAM, "Matrix inner dimensions mismatch.");
-
-            double itemval = 0.0;
-            for ( int i = 0; i < len; i++ ) {
-                double in1item = in1row.at(i);
-                double in2item = in2col.at(i);
-                itemval += in1item * in2item;
-            }
-            outrow.append(itemval);
         }
-        outlist->append(outrow);
     }
+
+    QList<double> in1flat, in2flat, outflat;
+    listMatrixToArray(inlist1, &in1flat);
+    in2flat.reserve(col1 * col2);
+    foreach ( const QList<double> &in2row, inlist2 ) {
+        in2flat.append(in2row);
+        for ( int j = in2row.length(); j < col2; j++ )
+            in2flat.append(0.0);
+    }
+
+    outflat.resize(row1 * col2);
+    if ( col2 > 0 )
+        finExecAlgSimd::matDot(in1flat.constData(), in2flat.constData(), row1, col1, col2, outflat.data());
+
+    outlist->clear();
+    for ( int i = 0; i < row1; i++ )
+        outlist->append(outflat.mid(i * col2, col2));
+}
+
+void finExecAlg::flatMatDot(const QList<double> &inlist1, const QList<double> &inlist2,
+                            int row1, int col1, int col2, QList<double> *outlist)
+{
+    if ( outlist == nullptr )
+        finThrow(finErrorKits::EC_NULL_POINTER, "The output list is null.");
+    if ( inlist1.length() != row1 * col1 || inlist2.length() != col1 * col2 )
+        finThrow(finErrorKits::EC_INVALID_PARAM, "Matrix inner dimensions mismatch.");
+
+    outlist->clear();
+    outlist->resize(row1 * col2);
+    finExecAlgSimd::matDot(inlist1.constData(), inlist2.constData(), row1, col1, col2, outlist->data());
 }
 
 void finExecAlg::varMatTranspose(finExecVariable *invar, finExecVariable *outvar)
@@ -852,10 +906,17 @@ void finExecAlg::varMatTranspose(finExecVariable *invar, finExecVariable *outvar
     if ( !invar->isNumericMatrix() )
         finThrow(finErrorKits::EC_INVALID_PARAM, "Input variable is not a numeric matrix.");
 
-    QList<QList<double>> inlist, outlist;
-    numMatVarToList(invar, &inlist);
-    listMatTranspose(inlist, &outlist);
-    listToNumMatVar(outlist, outvar);
+    int row = 0, col = 0;
+    QList<double> inlist, outlist;
+    numMatVarToFlatList(invar, &inlist, &row, &col);
+    if ( row == 0 || col == 0 ) {
+        listToNumMatVar(QList<QList<double>>(), outvar);
+        return;
+    }
+
+    outlist.resize(row * col);
+    finExecAlgSimd::matTranspose(inlist.constData(), row, col, outlist.data());
+    flatListToNumMatVar(outlist, row, outvar);
 }
 
 void finExecAlg::varMatAdd(finExecVariable *invar1, finExecVariable *invar2, finExecVariable *outvar)
@@ -915,11 +976,18 @@ void finExecAlg::varMatDot(finExecVariable *invar1, finExecVariable *invar2, fin
     if ( varcol1 != varrow2 )
         finThrow(finErrorKits::EC_INVALID_PARAM, "Matrix inner dimensions mismatch.");
 
-    QList< QList<double> > inlist1, inlist2, outlist;
-    numMatVarToList(invar1, &inlist1);
-    numMatVarToList(invar2, &inlist2);
+    QList<double> inlist1, inlist2, outlist;
+    numMatVarToFlatList(invar1, &inlist1, &varrow1, &varcol1);
+    numMatVarToFlatList(invar2, &inlist2, &varrow2, &varcol2);
 
-    listMatDot(inlist1, inlist2, &outlist);
+    flatMatDot(inlist1, inlist2, varrow1, varcol1, varcol2, &outlist);
 
-    listToNumMatVar(outlist, outvar);
+    if ( varcol2 > 0 ) {
+        flatListToNumMatVar(outlist, varcol2, outvar);
+    } else {
+        QList< QList<double> > emptyrows;
+        for ( int i = 0; i < varrow1; i++ )
+            emptyrows.append(QList<double>());
+        listToNumMatVar(emptyrows, outvar);
+    }
 }
@@ -114,6 +114,15 @@ public:
      */
     static void csStringToArrayVar(const QString &csstr, finExecVariable *outvar);
 
+    /*! \brief Parses a comma-separated string into a list of numbers.
+     *
+     *  Items that cannot be parsed become 0.0, as in csStringToNumArrayVar().
+     *
+     *  \param csstr  Source comma-separated text.
+     *  \param list   Output numeric list.
+     */
+    static void csStringToNumList(const QString &csstr, QList<double> *list);
+
     /*! \brief Serializes a numeric array variable as comma-separated text.
      *
      *  \param invar  Input variable to serialize.
@@ -149,6 +158,8 @@ public:
     static void numMatVarToList(finExecVariable *invar, QList<QList<double>> *list);
 
     /*! \brief Converts a flat numeric list to an array variable.
+     *
+     *  The output is stored packed, so the list buffer is shared rather than copied item by item.
      *
      *  \param list    Source numeric list.
      *  \param outvar  Output variable that receives a numeric array.
@@ -156,11 +167,30 @@ public:
     static void listToNumArrayVar(const QList<double> &list, finExecVariable *outvar);
 
     /*! \brief Converts a nested numeric list to a matrix variable.
+     *
+     *  Rectangular input is stored as one packed matrix; ragged input becomes an array of packed rows.
      *
      *  \param list    Source matrix list.
      *  \param outvar  Output variable that receives a numeric matrix.
      */
     static void listToNumMatVar(const QList<QList<double>> &list, finExecVariable *outvar);
+
+    /*! \brief Reads a numeric matrix variable into one row-major list.
+     *
+     *  \param invar   Input numeric matrix variable.
+     *  \param list    Output row-major numeric list.
+     *  \param rowcnt  Output number of rows.
+     *  \param colcnt  Output number of columns.
+     */
+    static void numMatVarToFlatList(finExecVariable *invar, QList<double> *list, int *rowcnt, int *colcnt);
+
+    /*! \brief Stores a row-major numeric list as a packed matrix variable.
+     *
+     *  \param list    Source row-major numeric list holding \a rowcnt * \a colcnt items.
+     *  \param colcnt  Number of columns.
+     *  \param outvar  Output variable that receives the packed matrix.
+     */
+    static void flatListToNumMatVar(const QList<double> &list, int colcnt, finExecVariable *outvar);
     ///@}
 
     /*! \name Array Reshaping Helpers
@@ -307,6 +337,10 @@ public:
     static void listMatDot(const QList<QList<double>> &inlist1, const QList<QList<double>> &inlist2,
                            QList<QList<double>> *outlist);
 
+    /*! \brief Multiplies a \a row1 x \a col1 and a \a col1 x \a col2 row-major matrix. */
+    static void flatMatDot(const QList<double> &inlist1, const QList<double> &inlist2,
+                           int row1, int col1, int col2, QList<double> *outlist);
+
     /*! \brief Transposes a numeric matrix variable. */
     static void varMatTranspose(finExecVariable *invar, finExecVariable *outvar);
 
@@ -0,0 +1,759 @@
+/*-
+ * GNU GENERAL PUBLIC LICENSE, version 3
+ * See LICENSE file for detail.
+ *
+ * Author: Yulong Yu
+ * Copyright(c) 2015-2026 Yulong Yu. All rights reserved.
+ */
+
+/*! \file finExecAlgSimd.cpp
+ *  \brief Implementations of the vectorized numeric kernels behind finExecAlg.
+ *
+ *  The SSE2 / AVX2 variants are compiled with per-function target attributes (GCC, Clang) or directly
+ *  (MSVC), so the rest of the program keeps its baseline instruction set and the CPU is probed at runtime.
+ */
+
+#include "finExecAlgSimd.h"
+
+#include <QAtomicInt>
+
+#include <math.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define FIN_SIMD_X86
+#  define FIN_TARGET_SSE2  __attribute__((target("sse2")))
+#  define FIN_TARGET_AVX2  __attribute__((target("avx2")))
+#  include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#  define FIN_SIMD_X86
+#  define FIN_TARGET_SSE2
+#  define FIN_TARGET_AVX2
+#  include <intrin.h>
+#  include <immintrin.h>
+#endif
+
+
+/* Tile sizes of the blocked matrix kernels, in elements. A 64 x 256 tile of the right operand (128 KiB)
+ * stays in L2 while a row band of the left operand streams over it.
+ */
+static const int _glMatDotBlockI = 64;
+static const int _glMatDotBlockK = 64;
+static const int _glMatDotBlockJ = 256;
+static const int _glTransBlock = 32;
+
+static QAtomicInt _glSimdLevel(-1);
+
+finExecAlgSimd::finExecAlgSimd()
+{
+    /* Do Nothing because you should not call this constructor. */
+    return;
+}
+
+finExecAlgSimdLevel finExecAlgSimd::getSupportedLevel()
+{
+#if defined(FIN_SIMD_X86) && defined(__GNUC__)
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports("avx2") )
+        return finExecAlgSimd::LV_AVX2;
+    if ( __builtin_cpu_supports("sse2") )
+        return finExecAlgSimd::LV_SSE2;
+    return finExecAlgSimd::LV_SCALAR;
+#elif defined(FIN_SIMD_X86)
+    int cpuinfo[4];
+    __cpuid(cpuinfo, 0);
+    int maxleaf = cpuinfo[0];
+
+    __cpuid(cpuinfo, 1);
+    bool hassse2 = ((cpuinfo[3] & (1 << 26)) != 0);
+    bool hasosxsave = ((cpuinfo[2] & (1 << 27)) != 0);
+    bool hasavx2 = false;
+    if ( maxleaf >= 7 && hasosxsave && (_xgetbv(0) & 0x6) == 0x6 ) {
+        __cpuidex(cpuinfo, 7, 0);
+        hasavx2 = ((cpuinfo[1] & (1 << 5)) != 0);
+    }
+
+    if ( hasavx2 )
+        return finExecAlgSimd::LV_AVX2;
+    if ( hassse2 )
+        return finExecAlgSimd::LV_SSE2;
+    return finExecAlgSimd::LV_SCALAR;
+#else
+    return finExecAlgSimd::LV_SCALAR;
+#endif
+}
+
+finExecAlgSimdLevel finExecAlgSimd::getLevel()
+{
+    int level = _glSimdLevel.loadRelaxed();
+    if ( level < 0 ) {
+        level = (int)finExecAlgSimd::getSupportedLevel();
+        _glSimdLevel.storeRelaxed(level);
+    }
+    return (finExecAlgSimdLevel)level;
+}
+
+void finExecAlgSimd::setLevel(finExecAlgSimdLevel level)
+{
+    finExecAlgSimdLevel suplevel = finExecAlgSimd::getSupportedLevel();
+    if ( level > suplevel )
+        level = suplevel;
+    _glSimdLevel.storeRelaxed((int)level);
+}
+
+QString finExecAlgSimd::getLevelName(finExecAlgSimdLevel level)
+{
+    switch ( level ) {
+      case finExecAlgSimd::LV_SSE2:
+        return QString("SSE2");
+
+      case finExecAlgSimd::LV_AVX2:
+        return QString("AVX2");
+
+      default:
+        return QString("Scalar");
+    }
+}
+
+/*
+ * Scalar kernels. They define the reference results and also process the tails the vector kernels leave.
+ */
+
+static void _scalarAdd(const double *in1, const double *in2, double *out, int len)
+{
+    for ( int i = 0; i < len; i++ )
+        out[i] = in1[i] + in2[i];
+}
+
+static void _scalarSub(const double *in1, const double *in2, double *out, int len)
+{
+    for ( int i = 0; i < len; i++ )
+        out[i] = in1[i] - in2[i];
+}
+
+static void _scalarNeg(const double *in, double *out, int len)
+{
+    for ( int i = 0; i < len; i++ )
+        out[i] = -in[i];
+}
+
+static void _scalarDiv(const double *in, double divisor, double *out, int len)
+{
+    for ( int i = 0; i < len; i++ )
+        out[i] = in[i] / divisor;
+}
+
+static void _scalarPointScale(const double *in, double *out, int cnt, double sx, double sy, double dx, double dy)
+{
+    for ( int i = 0; i < cnt * 2; i += 2 ) {
+        out[i] = in[i] * sx + dx;
+        out[i + 1] = in[i + 1] * sy + dy;
+    }
+}
+
+static void _scalarPointAffine(const double *in, double *out, int cnt,
+                               double m11, double m12, double m21, double m22, double dx, double dy)
+{
+    for ( int i = 0; i < cnt * 2; i += 2 ) {
+        double x = in[i], y = in[i + 1];
+        out[i] = m11 * x + m21 * y + dx;
+        out[i + 1] = m12 * x + m22 * y + dy;
+    }
+}
+
+static double _scalarSum(const double *in, int len)
+{
+    double sumval = 0.0;
+    for ( int i = 0; i < len; i++ )
+        sumval += in[i];
+    return sumval;
+}
+
+static double _scalarSumAbs(const double *in, int len)
+{
+    double sumval = 0.0;
+    for ( int i = 0; i < len; i++ )
+        sumval += fabs(in[i]);
+    return sumval;
+}
+
+static double _scalarSumSquare(const double *in, int len)
+{
+    double sumval = 0.0;
+    for ( int i = 0; i < len; i++ )
+        sumval += in[i] * in[i];
+    return sumval;
+}
+
+static double _scalarMaxAbs(const double *in, int len, double maxval)
+{
+    for ( int i = 0; i < len; i++ ) {
+        if ( fabs(in[i]) > maxval )
+            maxval = fabs(in[i]);
+    }
+    return maxval;
+}
+
+static double _scalarDot(const double *in1, const double *in2, int len)
+{
+    double sumval = 0.0;
+    for ( int i = 0; i < len; i++ )
+        sumval += in1[i] * in2[i];
+    return sumval;
+}
+
+static void _scalarAxpy(double scale, const double *in, double *out, int len)
+{
+    for ( int i = 0; i < len; i++ )
+        out[i] += scale * in[i];
+}
+
+#ifdef FIN_SIMD_X86
+
+/*
+ * SSE2 kernels, two doubles per register.
+ */
+
+FIN_TARGET_SSE2 static void _sse2Add(const double *in1, const double *in2, double *out, int len)
+{
+    int i = 0;
+    for ( ; i + 2 <= len; i += 2 )
+        _mm_storeu_pd(out + i, _mm_add_pd(_mm_loadu_pd(in1 + i), _mm_loadu_pd(in2 + i)));
+    _scalarAdd(in1 + i, in2 + i, out + i, len - i);
+}
+
+FIN_TARGET_SSE2 static void _sse2Sub(const double *in1, const double *in2, double *out, int len)
+{
+    int i = 0;
+    for ( ; i + 2 <= len; i += 2 )
+        _mm_storeu_pd(out + i, _mm_sub_pd(_mm_loadu_pd(in1 + i), _mm_loadu_pd(in2 + i)));
+    _scalarSub(in1 + i, in2 + i, out + i, len - i);
+}
+
+FIN_TARGET_SSE2 static void _sse2Neg(const double *in, double *out, int len)
+{
+    const __m128d signmask = _mm_set1_pd(-0.0);
+    int i = 0;
+    for ( ; i + 2 <= len; i += 2 )
+        _mm_storeu_pd(out + i, _mm_xor_pd(_mm_loadu_pd(in + i), signmask));
+    _scalarNeg(in + i, out + i, len - i);
+}
+
+FIN_TARGET_SSE2 static void _sse2Div(const double *in, double divisor, double *out, int len)
+{
+    const __m128d divvec = _mm_set1_pd(divisor);
+    int i = 0;
+    for ( ; i + 2 <= len; i += 2 )
+        _mm_storeu_pd(out + i, _mm_div_pd(_mm_loadu_pd(in + i), divvec));
+    _scalarDiv(in + i, divisor, out + i, len - i);
+}
+
+FIN_TARGET_SSE2 static void _sse2PointScale(const double *in, double *out, int cnt,
+                                            double sx, double sy, double dx, double dy)
+{
+    const __m128d scalevec = _mm_set_pd(sy, sx);
+    const __m128d shiftvec = _mm_set_pd(dy, dx);
+    for ( int i = 0; i < cnt * 2; i += 2 )
+        _mm_storeu_pd(out + i, _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(in + i), scalevec), shiftvec));
+}
+
+FIN_TARGET_SSE2 static void _sse2PointAffine(const double *in, double *out, int cnt,
+                                             double m11, double m12, double m21, double m22, double dx, double dy)
+{
+    const __m128d diagvec = _mm_set_pd(m22, m11);
+    const __m128d crossvec = _mm_set_pd(m12, m21);
+    const __m128d shiftvec = _mm_set_pd(dy, dx);
+    for ( int i = 0; i < cnt * 2; i += 2 ) {
+        __m128d ptvec = _mm_loadu_pd(in + i);
+        __m128d swapvec = _mm_shuffle_pd(ptvec, ptvec, 1);
+        __m128d sumvec = _mm_add_pd(_mm_mul_pd(ptvec, diagvec), _mm_mul_pd(swapvec, crossvec));
+        _mm_storeu_pd(out + i, _mm_add_pd(sumvec, shiftvec));
+    }
+}
+
+FIN_TARGET_SSE2 static double _sse2HorizontalSum(__m128d acc)
+{
+    double lanes[2];
+    _mm_storeu_pd(lanes, acc);
+    return lanes[0] + lanes[1];
+}
+
+FIN_TARGET_SSE2 static double _sse2Sum(const double *in, int len)
+{
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    int i = 0;
+    for ( ; i + 4 <= len; i += 4 ) {
+        acc0 = _mm_add_pd(acc0, _mm_loadu_pd(in + i));
+        acc1 = _mm_add_pd(acc1, _mm_loadu_pd(in + i + 2));
+    }
+    return _sse2HorizontalSum(_mm_add_pd(acc0, acc1)) + _scalarSum(in + i, len - i);
+}
+
+FIN_TARGET_SSE2 static double _sse2SumAbs(const double *in, int len)
+{
+    const __m128d absmask = _mm_castsi128_pd(_mm_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    int i = 0;
+    for ( ; i + 4 <= len; i += 4 ) {
+        acc0 = _mm_add_pd(acc0, _mm_and_pd(_mm_loadu_pd(in + i), absmask));
+        acc1 = _mm_add_pd(acc1, _mm_and_pd(_mm_loadu_pd(in + i + 2), absmask));
+    }
+    return _sse2HorizontalSum(_mm_add_pd(acc0, acc1)) + _scalarSumAbs(in + i, len - i);
+}
+
+FIN_TARGET_SSE2 static double _sse2SumSquare(const double *in, int len)
+{
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    int i = 0;
+    for ( ; i + 4 <= len; i += 4 ) {
+        __m128d val0 = _mm_loadu_pd(in + i);
+        __m128d val1 = _mm_loadu_pd(in + i + 2);
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(val0, val0));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(val1, val1));
+    }
+    return _sse2HorizontalSum(_mm_add_pd(acc0, acc1)) + _scalarSumSquare(in + i, len - i);
+}
+
+FIN_TARGET_SSE2 static double _sse2MaxAbs(const double *in, int len)
+{
+    // maxpd returns its second operand when either one is NaN, so NaN items are skipped like in the
+    // scalar comparison.
+    const __m128d absmask = _mm_castsi128_pd(_mm_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+    __m128d acc = _mm_setzero_pd();
+    int i = 0;
+    for ( ; i + 2 <= len; i += 2 )
+        acc = _mm_max_pd(_mm_and_pd(_mm_loadu_pd(in + i), absmask), acc);
+
+    double lanes[2];
+    _mm_storeu_pd(lanes, acc);
+    double maxval = (lanes[1] > lanes[0] ? lanes[1] : lanes[0]);
+    return _scalarMaxAbs(in + i, len - i, maxval);
+}
+
+FIN_TARGET_SSE2 static double _sse2Dot(const double *in1, const double *in2, int len)
+{
+    __m128d acc0 = _mm_setzero_pd(), acc1 = _mm_setzero_pd();
+    int i = 0;
+    for ( ; i + 4 <= len; i += 4 ) {
+        acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(in1 + i), _mm_loadu_pd(in2 + i)));
+        acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(in1 + i + 2), _mm_loadu_pd(in2 + i + 2)));
+    }
+    return _sse2HorizontalSum(_mm_add_pd(acc0, acc1)) + _scalarDot(in1 + i, in2 + i, len - i);
+}
+
+FIN_TARGET_SSE2 static void _sse2Axpy(double scale, const double *in, double *out, int len)
+{
+    const __m128d scalevec = _mm_set1_pd(scale);
+    int i = 0;
+    for ( ; i + 2 <= len; i += 2 ) {
+        __m128d prod = _mm_mul_pd(scalevec, _mm_loadu_pd(in + i));
+        _mm_storeu_pd(out + i, _mm_add_pd(_mm_loadu_pd(out + i), prod));
+    }
+    _scalarAxpy(scale, in + i, out + i, len - i);
+}
+
+/*
+ * AVX2 kernels, four doubles per register. Multiplications and additions stay separate instructions (no
+ * FMA), which keeps the element-wise results identical to the scalar kernels.
+ */
+
+FIN_TARGET_AVX2 static void _avx2Add(const double *in1, const double *in2, double *out, int len)
+{
+    int i = 0;
+    for ( ; i + 4 <= len; i += 4 )
+        _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(in1 + i), _mm256_loadu_pd(in2 + i)));
+    _scalarAdd(in1 + i, in2 + i, out + i, len - i);
+}
+
+FIN_TARGET_AVX2 static void _avx2Sub(const double *in1, const double *in2, double *out, int len)
+{
+    int i = 0;
+    for ( ; i + 4 <= len; i += 4 )
+        _mm256_storeu_pd(out + i, _mm256_sub_pd(_mm256_loadu_pd(in1 + i), _mm256_loadu_pd(in2 + i)));
+    _scalarSub(in1 + i, in2 + i, out + i, len - i);
+}
+
+FIN_TARGET_AVX2 static void _avx2Neg(const double *in, double *out, int len)
+{
+    const __m256d signmask = _mm256_set1_pd(-0.0);
+    int i = 0;
+    for ( ; i + 4 <= len; i += 4 )
+        _mm256_storeu_pd(out + i, _mm256_xor_pd(_mm256_loadu_pd(in + i), signmask));
+    _scalarNeg(in + i, out + i, len - i);
+}
+
+FIN_TARGET_AVX2 static void _avx2Div(const double *in, double divisor, double *out, int len)
+{
+    const __m256d divvec = _mm256_set1_pd(divisor);
+    int i = 0;
+    for ( ; i + 4 <= len; i += 4 )
+        _mm256_storeu_pd(out + i, _mm256_div_pd(_mm256_loadu_pd(in + i), divvec));
+    _scalarDiv(in + i, divisor, out + i, len - i);
+}
+
+FIN_TARGET_AVX2 static double _avx2HorizontalSum(__m256d acc)
+{
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc);
+    return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+
+FIN_TARGET_AVX2 static double _avx2Sum(const double *in, int len)
+{
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    int i = 0;
+    for ( ; i + 8 <= len; i += 8 ) {
+        acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(in + i));
+        acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(in + i + 4));
+    }
+    return _avx2HorizontalSum(_mm256_add_pd(acc0, acc1)) + _scalarSum(in + i, len - i);
+}
+
+FIN_TARGET_AVX2 static double _avx2SumAbs(const double *in, int len)
+{
+    const __m256d absmask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    int i = 0;
+    for ( ; i + 8 <= len; i += 8 ) {
+        acc0 = _mm256_add_pd(acc0, _mm256_and_pd(_mm256_loadu_pd(in + i), absmask));
+        acc1 = _mm256_add_pd(acc1, _mm256_and_pd(_mm256_loadu_pd(in + i + 4), absmask));
+    }
+    return _avx2HorizontalSum(_mm256_add_pd(acc0, acc1)) + _scalarSumAbs(in + i, len - i);
+}
+
+FIN_TARGET_AVX2 static double _avx2SumSquare(const double *in, int len)
+{
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    int i = 0;
+    for ( ; i + 8 <= len; i += 8 ) {
+        __m256d val0 = _mm256_loadu_pd(in + i);
+        __m256d val1 = _mm256_loadu_pd(in + i + 4);
+        acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(val0, val0));
+        acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(val1, val1));
+    }
+    return _avx2HorizontalSum(_mm256_add_pd(acc0, acc1)) + _scalarSumSquare(in + i, len - i);
+}
+
+FIN_TARGET_AVX2 static double _avx2MaxAbs(const double *in, int len)
+{
+    const __m256d absmask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x7FFFFFFFFFFFFFFFLL));
+    __m256d acc = _mm256_setzero_pd();
+    int i = 0;
+    for ( ; i + 4 <= len; i += 4 )
+        acc = _mm256_max_pd(_mm256_and_pd(_mm256_loadu_pd(in + i), absmask), acc);
+
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc);
+    return _scalarMaxAbs(in + i, len - i, _scalarMaxAbs(lanes, 4, 0.0));
+}
+
+FIN_TARGET_AVX2 static double _avx2Dot(const double *in1, const double *in2, int len)
+{
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    int i = 0;
+    for ( ; i + 8 <= len; i += 8 ) {
+        acc0 = _mm256_add_pd(acc0, _mm256_mul_pd(_mm256_loadu_pd(in1 + i), _mm256_loadu_pd(in2 + i)));
+        acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(in1 + i + 4), _mm256_loadu_pd(in2 + i + 4)));
+    }
+    return _avx2HorizontalSum(_mm256_add_pd(acc0, acc1)) + _scalarDot(in1 + i, in2 + i, len - i);
+}
+
+FIN_TARGET_AVX2 static void _avx2Axpy(double scale, const double *in, double *out, int len)
+{
+    const __m256d scalevec = _mm256_set1_pd(scale);
+    int i = 0;
+    for ( ; i + 4 <= len; i += 4 ) {
+        __m256d prod = _mm256_mul_pd(scalevec, _mm256_loadu_pd(in + i));
+        _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(out + i), prod));
+    }
+    _scalarAxpy(scale, in + i, out + i, len - i);
+}
+
+/*
+ * The point kernels hold two (x, y) pairs per register; the swap for the affine cross terms stays within each
+ * 128-bit lane.
+ */
+
+FIN_TARGET_AVX2 static void _avx2PointScale(const double *in, double *out, int cnt,
+                                            double sx, double sy, double dx, double dy)
+{
+    const __m256d scalevec = _mm256_set_pd(sy, sx, sy, sx);
+    const __m256d shiftvec = _mm256_set_pd(dy, dx, dy, dx);
+    int i = 0;
+    for ( ; i + 2 <= cnt; i += 2 ) {
+        __m256d ptvec = _mm256_loadu_pd(in + i * 2);
+        _mm256_storeu_pd(out + i * 2, _mm256_add_pd(_mm256_mul_pd(ptvec, scalevec), shiftvec));
+    }
+    _scalarPointScale(in + i * 2, out + i * 2, cnt - i, sx, sy, dx, dy);
+}
+
+FIN_TARGET_AVX2 static void _avx2PointAffine(const double *in, double *out, int cnt,
+                                             double m11, double m12, double m21, double m22, double dx, double dy)
+{
+    const __m256d diagvec = _mm256_set_pd(m22, m11, m22, m11);
+    const __m256d crossvec = _mm256_set_pd(m12, m21, m12, m21);
+    const __m256d shiftvec = _mm256_set_pd(dy, dx, dy, dx);
+    int i = 0;
+    for ( ; i + 2 <= cnt; i += 2 ) {
+        __m256d ptvec = _mm256_loadu_pd(in + i * 2);
+        __m256d swapvec = _mm256_permute_pd(ptvec, 0x5);
+        __m256d sumvec = _mm256_add_pd(_mm256_mul_pd(ptvec, diagvec), _mm256_mul_pd(swapvec, crossvec));
+        _mm256_storeu_pd(out + i * 2, _mm256_add_pd(sumvec, shiftvec));
+    }
+    _scalarPointAffine(in + i * 2, out + i * 2, cnt - i, m11, m12, m21, m22, dx, dy);
+}
+
+#endif // FIN_SIMD_X86
+
+void finExecAlgSimd::pointScale(const double *in, double *out, int cnt, double sx, double sy, double dx, double dy)
+{
+#ifdef FIN_SIMD_X86
+    switch ( finExecAlgSimd::getLevel() ) {
+      case finExecAlgSimd::LV_AVX2:
+        _avx2PointScale(in, out, cnt, sx, sy, dx, dy);
+        return;
+
+      case finExecAlgSimd::LV_SSE2:
+        _sse2PointScale(in, out, cnt, sx, sy, dx, dy);
+        return;
+
+      default:
+        break;
+    }
+#endif
+    _scalarPointScale(in, out, cnt, sx, sy, dx, dy);
+}
+
+void finExecAlgSimd::pointAffine(const double *in, double *out, int cnt,
+                                 double m11, double m12, double m21, double m22, double dx, double dy)
+{
+#ifdef FIN_SIMD_X86
+    switch ( finExecAlgSimd::getLevel() ) {
+      case finExecAlgSimd::LV_AVX2:
+        _avx2PointAffine(in, out, cnt, m11, m12, m21, m22, dx, dy);
+        return;
+
+      case finExecAlgSimd::LV_SSE2:
+        _sse2PointAffine(in, out, cnt, m11, m12, m21, m22, dx, dy);
+        return;
+
+      default:
+        break;
+    }
+#endif
+    _scalarPointAffine(in, out, cnt, m11, m12, m21, m22, dx, dy);
+}
+
+void finExecAlgSimd::arrayAdd(const double *in1, const double *in2, double *out, int len)
+{
+#ifdef FIN_SIMD_X86
+    switch ( finExecAlgSimd::getLevel() ) {
+      case finExecAlgSimd::LV_AVX2:
+        _avx2Add(in1, in2, out, len);
+        return;
+
+      case finExecAlgSimd::LV_SSE2:
+        _sse2Add(in1, in2, out, len);
+        return;
+
+      default:
+        break;
+    }
+#endif
+    _scalarAdd(in1, in2, out, len);
+}
+
+void finExecAlgSimd::arraySub(const double *in1, const double *in2, double *out, int len)
+{
+#ifdef FIN_SIMD_X86
+    switch ( finExecAlgSimd::getLevel() ) {
+      case finExecAlgSimd::LV_AVX2:
+        _avx2Sub(in1, in2, out, len);
+        return;
+
+      case finExecAlgSimd::LV_SSE2:
+        _sse2Sub(in1, in2, out, len);
+        return;
+
+      default:
+        break;
+    }
+#endif
+    _scalarSub(in1, in2, out, len);
+}
+
+void finExecAlgSimd::arrayNeg(const double *in, double *out, int len)
+{
+#ifdef FIN_SIMD_X86
+    switch ( finExecAlgSimd::getLevel() ) {
+      case finExecAlgSimd::LV_AVX2:
+        _avx2Neg(in, out, len);
+        return;
+
+      case finExecAlgSimd::LV_SSE2:
+        _sse2Neg(in, out, len);
+        return;
+
+      default:
+        break;
+    }
+#endif
+    _scalarNeg(in, out, len);
+}
+
+void finExecAlgSimd::arrayDiv(const double *in, double divisor, double *out, int len)
+{
+#ifdef FIN_SIMD_X86
+    switch ( finExecAlgSimd::getLevel() ) {
+      case finExecAlgSimd::LV_AVX2:
+        _avx2Div(in, divisor, out, len);
+        return;
+
+      case finExecAlgSimd::LV_SSE2:
+        _sse2Div(in, divisor, out, len);
+        return;
+
+      default:
+        break;
+    }
+#endif
+    _scalarDiv(in, divisor, out, len);
+}
+
+double finExecAlgSimd::arraySum(const double *in, int len)
+{
+#ifdef FIN_SIMD_X86
+    switch ( finExecAlgSimd::getLevel() ) {
+      case finExecAlgSimd::LV_AVX2:
+        return _avx2Sum(in, len);
+
+      case finExecAlgSimd::LV_SSE2:
+        return _sse2Sum(in, len);
+
+      default:
+        break;
+    }
+#endif
+    return _scalarSum(in, len);
+}
+
+double finExecAlgSimd::arraySumAbs(const double *in, int len)
+{
+#ifdef FIN_SIMD_X86
+    switch ( finExecAlgSimd::getLevel() ) {
+      case finExecAlgSimd::LV_AVX2:
+        return _avx2SumAbs(in, len);
+
+      case finExecAlgSimd::LV_SSE2:
+        return _sse2SumAbs(in, len);
+
+      default:
+        break;
+    }
+#endif
+    return _scalarSumAbs(in, len);
+}
+
+double finExecAlgSimd::arraySumSquare(const double *in, int len)
+{
+#ifdef FIN_SIMD_X86
+    switch ( finExecAlgSimd::getLevel() ) {
+      case finExecAlgSimd::LV_AVX2:
+        return _avx2SumSquare(in, len);
+
+      case finExecAlgSimd::LV_SSE2:
+        return _sse2SumSquare(in, len);
+
+      default:
+        break;
+    }
+#endif
+    return _scalarSumSquare(in, len);
+}
+
+double finExecAlgSimd::arrayMaxAbs(const double *in, int len)
+{
+#ifdef FIN_SIMD_X86
+    switch ( finExecAlgSimd::getLevel() ) {
+      case finExecAlgSimd::LV_AVX2:
+        return _avx2MaxAbs(in, len);
+
+      case finExecAlgSimd::LV_SSE2:
+        return _sse2MaxAbs(in, len);
+
+      default:
+        break;
+    }
+#endif
+    return _scalarMaxAbs(in, len, 0.0);
+}
+
+double finExecAlgSimd::arrayDot(const double *in1, const double *in2, int len)
+{
+#ifdef FIN_SIMD_X86
+    switch ( finExecAlgSimd::getLevel() ) {
+      case finExecAlgSimd::LV_AVX2:
+        return _avx2Dot(in1, in2, len);
+
+      case finExecAlgSimd::LV_SSE2:
+        return _sse2Dot(in1, in2, len);
+
+      default:
+        break;
+    }
+#endif
+    return _scalarDot(in1, in2, len);
+}
+
+void finExecAlgSimd::matTranspose(const double *in, int row, int col, double *out)
+{
+    // Square tiles keep both the rows read and the rows written inside L1.
+    for ( int ib = 0; ib < row; ib += _glTransBlock ) {
+        int iend = (ib + _glTransBlock < row ? ib + _glTransBlock : row);
+        for ( int jb = 0; jb < col; jb += _glTransBlock ) {
+            int jend = (jb + _glTransBlock < col ? jb + _glTransBlock : col);
+            for ( int i = ib; i < iend; i++ ) {
+                for ( int j = jb; j < jend; j++ )
+                    out[j * row + i] = in[i * col + j];
+            }
+        }
+    }
+}
+
+void finExecAlgSimd::matDot(const double *in1, const double *in2, int row1, int col1, int col2, double *out)
+{
+    void (*axpy)(double scale, const double *in, double *out, int len) = _scalarAxpy;
+#ifdef FIN_SIMD_X86
+    switch ( finExecAlgSimd::getLevel() ) {
+      case finExecAlgSimd::LV_AVX2:
+        axpy = _avx2Axpy;
+        break;
+
+      case finExecAlgSimd::LV_SSE2:
+        axpy = _sse2Axpy;
+        break;
+
+      default:
+        break;
+    }
+#endif
+
+    for ( int i = 0; i < row1 * col2; i++ )
+        out[i] = 0.0;
+
+    // The k blocks are visited in ascending order for every output tile, so each output element is still
+    // summed over k from 0 upwards exactly like the naive triple loop.
+    for ( int jb = 0; jb < col2; jb += _glMatDotBlockJ ) {
+        int jlen = (jb + _glMatDotBlockJ < col2 ? _glMatDotBlockJ : col2 - jb);
+        for ( int kb = 0; kb < col1; kb += _glMatDotBlockK ) {
+            int kend = (kb + _glMatDotBlockK < col1 ? kb + _glMatDotBlockK : col1);
+            for ( int ib = 0; ib < row1; ib += _glMatDotBlockI ) {
+                int iend = (ib + _glMatDotBlockI < row1 ? ib + _glMatDotBlockI : row1);
+                for ( int i = ib; i < iend; i++ ) {
+                    double *outrow = out + i * col2 + jb;
+                    for ( int k = kb; k < kend; k++ )
+                        axpy(in1[i * col1 + k], in2 + k * col2 + jb, outrow, jlen);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,125 @@
+/*-
+ * GNU GENERAL PUBLIC LICENSE, version 3
+ * See LICENSE file for detail.
+ *
+ * Author: Yulong Yu
+ * Copyright(c) 2015-2026 Yulong Yu. All rights reserved.
+ */
+
+/*! \file finExecAlgSimd.h
+ *  \brief Declarations of the vectorized numeric kernels behind finExecAlg.
+ *
+ *  This header defines finExecAlgSimd, the set of contiguous-buffer kernels that the array, vector and
+ *  matrix algorithms of finExecAlg are built on. Each kernel has an SSE2 and an AVX2 implementation on x86
+ *  and a portable scalar one; the widest instruction set supported by the running CPU is chosen once at
+ *  runtime.
+ */
+
+#ifndef FINEXECALGSIMD_H
+#define FINEXECALGSIMD_H
+
+#include <QString>
+
+/*! \class finExecAlgSimd
+ *  \brief Runtime-dispatched SIMD kernels over contiguous double buffers.
+ *
+ *  finExecAlgSimd is used as a namespace. All kernels take raw row-major buffers; matrices are never stored
+ *  as nested lists here.
+ *
+ *  Numerical contract: element-wise kernels, point kernels, arrayMaxAbs(), matTranspose() and matDot() give results that
+ *  are bit-identical to the plain scalar loops (matDot() keeps the ascending summation order of every
+ *  output element and never fuses multiply-add). The reductions arraySum(), arraySumAbs(),
+ *  arraySumSquare() and arrayDot() add in several lanes and therefore reassociate the sum; their result
+ *  differs from a strict left-to-right sum by at most about \c len * DBL_EPSILON * (sum of |terms|).
+ */
+class finExecAlgSimd
+{
+public:
+    /*! \enum finExecAlgSimd::Level
+     *  \brief Instruction-set levels the kernels can run at.
+     */
+    enum Level {
+        LV_SCALAR = 0,  //!< Portable scalar loops.
+        LV_SSE2,        //!< 128-bit SSE2 kernels.
+        LV_AVX2         //!< 256-bit AVX2 kernels.
+    };
+
+    /*!
+     *  \brief Default constructor (unused).
+     */
+    finExecAlgSimd();
+
+    /*! \name Dispatch Control
+     *  \brief Inspect or restrict the instruction-set level used by the kernels.
+     */
+    ///@{
+
+    /*! \brief Returns the widest level supported by the running CPU. */
+    static Level getSupportedLevel();
+
+    /*! \brief Returns the level the kernels currently run at. */
+    static Level getLevel();
+
+    /*! \brief Restricts the kernels to \a level, clamped to the supported level; e.g. LV_SCALAR for
+     *         reference runs. */
+    static void setLevel(Level level);
+
+    /*! \brief Returns a human-readable name of \a level. */
+    static QString getLevelName(Level level);
+    ///@}
+
+    /*! \name Element-Wise Kernels
+     *  \brief Kernels producing one output per input element; bit-identical at every level.
+     */
+    ///@{
+    static void arrayAdd(const double *in1, const double *in2, double *out, int len);
+    static void arraySub(const double *in1, const double *in2, double *out, int len);
+    static void arrayNeg(const double *in, double *out, int len);
+    static void arrayDiv(const double *in, double divisor, double *out, int len);
+    ///@}
+
+    /*! \name Point Kernels
+     *  \brief Kernels mapping \a cnt 2D points stored as interleaved (x, y) pairs; \a in may equal \a out.
+     */
+    ///@{
+
+    /*! \brief Maps each point to (x * \a sx + \a dx, y * \a sy + \a dy). */
+    static void pointScale(const double *in, double *out, int cnt, double sx, double sy, double dx, double dy);
+
+    /*! \brief Maps each point to (\a m11 * x + \a m21 * y + \a dx, \a m12 * x + \a m22 * y + \a dy), the
+     *         same arithmetic as QTransform::map() of an affine matrix. */
+    static void pointAffine(const double *in, double *out, int cnt,
+                            double m11, double m12, double m21, double m22, double dx, double dy);
+    ///@}
+
+    /*! \name Reduction Kernels
+     *  \brief Kernels folding a buffer into one number; see the class notes for the tolerance.
+     */
+    ///@{
+    static double arraySum(const double *in, int len);
+    static double arraySumAbs(const double *in, int len);
+    static double arraySumSquare(const double *in, int len);
+    static double arrayMaxAbs(const double *in, int len);
+    static double arrayDot(const double *in1, const double *in2, int len);
+    ///@}
+
+    /*! \name Matrix Kernels
+     *  \brief Cache-blocked kernels over row-major matrices.
+     */
+    ///@{
+
+    /*! \brief Writes the \a col x \a row transpose of the \a row x \a col matrix \a in to \a out. */
+    static void matTranspose(const double *in, int row, int col, double *out);
+
+    /*! \brief Writes the \a row1 x \a col2 product of \a in1 (\a row1 x \a col1) and \a in2 (\a col1 x
+     *         \a col2) to \a out. */
+    static void matDot(const double *in1, const double *in2, int row1, int col1, int col2, double *out);
+    ///@}
+};
+
+/*! \typedef finExecAlgSimdLevel
+ *  \brief Shorthand alias for finExecAlgSimd::Level.
+ */
+typedef finExecAlgSimd::Level finExecAlgSimdLevel;
+
+#endif // FINEXECALGSIMD_H
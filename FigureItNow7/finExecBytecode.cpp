@@ -0,0 +1,190 @@
+/*-
+ * GNU GENERAL PUBLIC LICENSE, version 3
+ * See LICENSE file for detail.
+ *
+ * Author: Yulong Yu
+ * Copyright(c) 2015-2026 Yulong Yu. All rights reserved.
+ */
+
+/*! \file finExecBytecode.cpp
+ *  \brief Implementations of the FIN-7 VM code unit.
+ *
+ *  Provides instruction-stream building and patching, the literal / identifier / node pools, the
+ *  ownership of lowered function bodies, and a disassembler that writes to the debug log.
+ */
+
+#include "finExecBytecode.h"
+
+#include <QDebug>
+
+#include "finSymbolTable.h"
+
+
+finExecBytecode::finExecBytecode()
+    : _instList(), _numPool(), _strPool(), _namePool(), _nameIdPool(), _nameIdxMap(), _nodePool(), _subCodeMap()
+{
+    return;
+}
+
+finExecBytecode::~finExecBytecode()
+{
+    this->clear();
+}
+
+int finExecBytecode::getInstructionCount() const
+{
+    return this->_instList.count();
+}
+
+const finExecInstruction &finExecBytecode::getInstructionAt(int idx) const
+{
+    return this->_instList.at(idx);
+}
+
+const finExecInstruction *finExecBytecode::getInstructionData() const
+{
+    return this->_instList.constData();
+}
+
+int finExecBytecode::appendInstruction(finExecOpCode opcode, int arg1, int arg2, finLexNode *lexnode)
+{
+    return this->appendInstruction(opcode, arg1, arg2, 0, lexnode);
+}
+
+int finExecBytecode::appendInstruction(finExecOpCode opcode, int arg1, int arg2, int arg3, finLexNode *lexnode)
+{
+    finExecInstruction inst;
+    inst._opCode = opcode;
+    inst._arg1 = arg1;
+    inst._arg2 = arg2;
+    inst._arg3 = arg3;
+    inst._lexNode = lexnode;
+
+    this->_instList.append(inst);
+    return this->_instList.count() - 1;
+}
+
+void finExecBytecode::setInstructionArg(int idx, int arg1)
+{
+    if ( idx < 0 || idx >= this->_instList.count() )
+        finThrow(finErrorKits::EC_INVALID_PARAM, QString("Patch instruction %1 out of range.").arg(idx));
+
+    this->_instList[idx]._arg1 = arg1;
+}
+
+int finExecBytecode::appendNumericConst(double numval)
+{
+    this->_numPool.append(numval);
+    return this->_numPool.count() - 1;
+}
+
+int finExecBytecode::appendStringConst(const QString &strval)
+{
+    this->_strPool.append(strval);
+    return this->_strPool.count() - 1;
+}
+
+int finExecBytecode::appendName(const QString &name)
+{
+    QHash<QString, int>::const_iterator it = this->_nameIdxMap.constFind(name);
+    if ( it != this->_nameIdxMap.constEnd() )
+        return it.value();
+
+    this->_namePool.append(name);
+    this->_nameIdPool.append(finSymbolTable::getSymbolId(name));
+    int idx = this->_namePool.count() - 1;
+    this->_nameIdxMap.insert(name, idx);
+    return idx;
+}
+
+int finExecBytecode::appendSyntaxNode(finSyntaxNode *synnode)
+{
+    this->_nodePool.append(synnode);
+    return this->_nodePool.count() - 1;
+}
+
+double finExecBytecode::getNumericConstAt(int idx) const
+{
+    return this->_numPool.at(idx);
+}
+
+const QString &finExecBytecode::getStringConstAt(int idx) const
+{
+    return this->_strPool.at(idx);
+}
+
+const QString &finExecBytecode::getNameAt(int idx) const
+{
+    return this->_namePool.at(idx);
+}
+
+int finExecBytecode::getNameIdAt(int idx) const
+{
+    return this->_nameIdPool.at(idx);
+}
+
+finSyntaxNode *finExecBytecode::getSyntaxNodeAt(int idx) const
+{
+    return this->_nodePool.at(idx);
+}
+
+finErrorCode finExecBytecode::appendSubCode(finSyntaxNode *bodynode, finExecBytecode *subcode)
+{
+    if ( bodynode == nullptr || subcode == nullptr )
+        return finErrorKits::EC_NULL_POINTER;
+    if ( this->_subCodeMap.contains(bodynode) )
+        return finErrorKits::EC_CONTENTION;
+
+    this->_subCodeMap.insert(bodynode, subcode);
+    return finErrorKits::EC_SUCCESS;
+}
+
+finExecBytecode *finExecBytecode::findSubCode(finSyntaxNode *bodynode) const
+{
+    return this->_subCodeMap.value(bodynode, nullptr);
+}
+
+void finExecBytecode::clear()
+{
+    this->_instList.clear();
+    this->_numPool.clear();
+    this->_strPool.clear();
+    this->_namePool.clear();
+    this->_nameIdPool.clear();
+    this->_nameIdxMap.clear();
+    this->_nodePool.clear();
+
+    qDeleteAll(this->_subCodeMap);
+    this->_subCodeMap.clear();
+}
+
+QString finExecBytecode::getOpCodeName(finExecOpCode opcode)
+{
+    static const char *_opCodeNames[] = {
+        "NOP", "PUSH_NULL", "PUSH_NUM", "PUSH_STR", "LOAD_VAR", "LOAD_SLOT", "CALC", "LOAD_ITEM", "STORE_ITEM", "CALL",
+        "TREE_EVAL", "TREE_EXEC", "SET_RESULT", "CLEAR_RESULT",
+        "DECLARE", "DECLARE_CHECK", "DECLARE_INIT", "DEF_FUNC",
+        "ENTER_ENV", "LEAVE_ENV", "JUMP", "JUMP_FALSE", "LOOP_EXIT",
+        "RETURN", "EXIT", "FLOW_ERROR"
+    };
+    static const int _opCodeNameCnt = sizeof (_opCodeNames) / sizeof (const char *);
+
+    if ( opcode < 0 || opcode >= _opCodeNameCnt )
+        return QString("???");
+    return QString(_opCodeNames[opcode]);
+}
+
+void finExecBytecode::dump() const
+{
+    for ( int i = 0; i < this->_instList.count(); i++ ) {
+        const finExecInstruction &inst = this->_instList.at(i);
+        QString line = QString("%1: %2 %3 %4 %5").arg(i, 5).arg(getOpCodeName(inst._opCode), -14)
+                       .arg(inst._arg1, 6).arg(inst._arg2, 6).arg(inst._arg3, 6);
+        if ( inst._lexNode != nullptr )
+            line += QString("    ; ") + inst._lexNode->getString();
+        qDebug().noquote() << line;
+    }
+    qDebug().noquote() << QString("  numbers=%1, strings=%2, names=%3, nodes=%4, functions=%5")
+                          .arg(this->_numPool.count()).arg(this->_strPool.count()).arg(this->_namePool.count())
+                          .arg(this->_nodePool.count()).arg(this->_subCodeMap.count());
+}
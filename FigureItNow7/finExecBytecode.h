@@ -0,0 +1,183 @@
+/*-
+ * GNU GENERAL PUBLIC LICENSE, version 3
+ * See LICENSE file for detail.
+ *
+ * Author: Yulong Yu
+ * Copyright(c) 2015-2026 Yulong Yu. All rights reserved.
+ */
+/*! \file finExecBytecode.h
+ *  \brief Declarations of the compact bytecode executed by the FIN-7 virtual machine.
+ *
+ *  This header defines finExecBytecode, the flat instruction stream that finExecCompiler lowers a
+ *  finSyntaxTree into, together with the constant pools and name tables the instructions refer to.
+ *  finExecMachine runs the bytecode in its VM execution mode instead of re-walking the syntax tree.
+ */
+
+#ifndef FINEXECBYTECODE_H
+#define FINEXECBYTECODE_H
+
+#include <QList>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+#include "finErrorCode.h"
+#include "finLexNode.h"
+#include "finSyntaxNode.h"
+
+
+/*! \class finExecBytecode
+ *  \brief One lowered code unit (a program or a user-function body) for the FIN-7 VM.
+ *
+ *  The instruction stream works on an operand stack of finExecVariable pointers. Operators are
+ *  resolved to finExecOperartorCalc table indices, jumps carry absolute instruction indices, and
+ *  literals, identifiers and syntax nodes are referenced through per-unit pools so that no string
+ *  comparison is needed while the code runs. Variables declared inside the code unit are addressed
+ *  by (scope depth, slot) coordinates; scope depth 0 is the environment the unit runs in, and depth
+ *  \a n is the \a n-th environment opened by the unit itself. Every instruction keeps the lex node it was lowered
+ *  from so execution diagnostics point at the same source location as the tree walker.
+ *
+ *  The code unit of a whole program additionally owns the code units of all user-function bodies
+ *  defined in it, keyed by the body syntax node that finExecFunction stores.
+ *
+ *  \see finExecCompiler
+ *  \see finExecMachine
+ */
+class finExecBytecode
+{
+public:
+    /*! \enum finExecBytecode::OpCode
+     *  \brief Operation codes understood by the FIN-7 VM.
+     */
+    enum OpCode {
+        BC_NOP,            //!< Does nothing.
+        BC_PUSH_NULL,      //!< Pushes a null operand.
+        BC_PUSH_NUM,       //!< Pushes a numeric literal from the numeric pool at _arg1.
+        BC_PUSH_STR,       //!< Pushes a string literal from the string pool at _arg1.
+        BC_LOAD_VAR,       //!< Pushes the variable named by the name table at _arg1.
+        BC_LOAD_SLOT,      //!< Pushes slot _arg3 of scope _arg2, or looks up the name at _arg1 if empty.
+        BC_CALC,           //!< Pops _arg2 operands and applies the operator at table index _arg1 (type _arg3).
+        BC_LOAD_ITEM,      //!< Pops an array and _arg2 - 1 indices, and pushes the item read from it.
+        BC_STORE_ITEM,     //!< Pops an array, an index and a value, and stores the value into that item.
+        BC_CALL,           //!< Pops _arg2 arguments and calls the function named at _arg1.
+        BC_TREE_EVAL,      //!< Evaluates the pooled expression node _arg1 with the tree walker.
+        BC_TREE_EXEC,      //!< Executes the pooled statement node _arg1 with the tree walker.
+        BC_SET_RESULT,     //!< Pops an operand and makes it the statement result.
+        BC_CLEAR_RESULT,   //!< Releases the current statement result.
+        BC_DECLARE,        //!< Declares the pooled variable node _arg1 into slot _arg2 (if >= 0).
+        BC_DECLARE_CHECK,  //!< Fails if the variable named at _arg1 already exists in this scope.
+        BC_DECLARE_INIT,   //!< Pops an initial value and declares the name at _arg1 into slot _arg3.
+        BC_DEF_FUNC,       //!< Defines the user function of the pooled function node _arg1.
+        BC_ENTER_ENV,      //!< Opens a child environment.
+        BC_LEAVE_ENV,      //!< Closes the innermost environment opened by this code unit.
+        BC_JUMP,           //!< Continues at instruction _arg1.
+        BC_JUMP_FALSE,     //!< Pops a condition and continues at _arg1 if it is false.
+        BC_LOOP_EXIT,      //!< Pops a loop condition; if false keeps it as result and jumps to _arg1.
+        BC_RETURN,         //!< Returns from the code unit, with a popped value if _arg1 is set.
+        BC_EXIT,           //!< Exits the script, with a popped value if _arg1 is set.
+        BC_FLOW_ERROR,     //!< Reports a control transfer that has no target.
+        BC_MAX             //!< Sentinel marking the end of the enum.
+    };
+
+    /*! \struct finExecBytecode::Instruction
+     *  \brief One VM instruction.
+     */
+    struct Instruction {
+        OpCode _opCode;        //!< Operation code.
+        int _arg1;             //!< First operand; meaning depends on _opCode.
+        int _arg2;             //!< Second operand; meaning depends on _opCode.
+        int _arg3;             //!< Third operand; meaning depends on _opCode.
+        finLexNode *_lexNode;  //!< Source lex node used for diagnostics; owned by the syntax tree.
+    };
+
+protected:
+    QList<Instruction> _instList;               //!< Instruction stream.
+    QList<double> _numPool;                     //!< Numeric literal pool.
+    QStringList _strPool;                       //!< String literal pool.
+    QStringList _namePool;                      //!< Identifier table.
+    QList<int> _nameIdPool;                     //!< finSymbolTable ID of each entry of _namePool.
+    QHash<QString, int> _nameIdxMap;            //!< Reverse lookup used to de-duplicate identifiers.
+    QList<finSyntaxNode *> _nodePool;           //!< Syntax nodes referenced by the instructions.
+
+    QHash<finSyntaxNode *, finExecBytecode *> _subCodeMap;  //!< Owned function-body code units.
+
+public:
+    /*! \brief Constructs an empty code unit. */
+    finExecBytecode();
+
+    /*! \brief Destroys the code unit and every function-body code unit it owns. */
+    ~finExecBytecode();
+
+    /*! \name Instruction Stream
+     *  \brief Build and read the instruction stream.
+     */
+    ///@{
+
+    /*! \brief Returns the number of instructions. */
+    int getInstructionCount() const;
+
+    /*! \brief Returns the instruction at \a idx. */
+    const Instruction &getInstructionAt(int idx) const;
+
+    /*! \brief Returns the raw instruction array for the VM dispatch loop. */
+    const Instruction *getInstructionData() const;
+
+    /*! \brief Appends one instruction and returns its index. */
+    int appendInstruction(OpCode opcode, int arg1, int arg2, finLexNode *lexnode);
+
+    /*! \brief Appends one three-operand instruction and returns its index. */
+    int appendInstruction(OpCode opcode, int arg1, int arg2, int arg3, finLexNode *lexnode);
+
+    /*! \brief Rewrites the first operand of the instruction at \a idx; used to patch jump targets. */
+    void setInstructionArg(int idx, int arg1);
+    ///@}
+
+    /*! \name Pools
+     *  \brief Register and read constants, identifiers and syntax nodes.
+     */
+    ///@{
+    int appendNumericConst(double numval);
+    int appendStringConst(const QString &strval);
+    int appendName(const QString &name);
+    int appendSyntaxNode(finSyntaxNode *synnode);
+
+    double getNumericConstAt(int idx) const;
+    const QString &getStringConstAt(int idx) const;
+    const QString &getNameAt(int idx) const;
+    int getNameIdAt(int idx) const;
+    finSyntaxNode *getSyntaxNodeAt(int idx) const;
+    ///@}
+
+    /*! \name Function-Body Code Units
+     *  \brief Attach and look up the lowered bodies of user functions.
+     */
+    ///@{
+
+    /*! \brief Takes ownership of \a subcode as the lowered form of the function body \a bodynode. */
+    finErrorCode appendSubCode(finSyntaxNode *bodynode, finExecBytecode *subcode);
+
+    /*! \brief Returns the lowered form of the function body \a bodynode, or \c nullptr. */
+    finExecBytecode *findSubCode(finSyntaxNode *bodynode) const;
+    ///@}
+
+    /*! \brief Removes all instructions, pools and owned function-body code units. */
+    void clear();
+
+    /*! \brief Writes a disassembly of the instruction stream to the debug log. */
+    void dump() const;
+
+    /*! \brief Returns the mnemonic of \a opcode. */
+    static QString getOpCodeName(OpCode opcode);
+};
+
+/*! \typedef finExecOpCode
+ *  \brief Shorthand alias for finExecBytecode::OpCode.
+ */
+typedef finExecBytecode::OpCode finExecOpCode;
+
+/*! \typedef finExecInstruction
+ *  \brief Shorthand alias for finExecBytecode::Instruction.
+ */
+typedef finExecBytecode::Instruction finExecInstruction;
+
+#endif // FINEXECBYTECODE_H
@@ -0,0 +1,421 @@
+/*-
+ * GNU GENERAL PUBLIC LICENSE, version 3
+ * See LICENSE file for detail.
+ *
+ * Author: Yulong Yu
+ * Copyright(c) 2015-2026 Yulong Yu. All rights reserved.
+ */
+
+/*! \file finExecCompileCache.cpp
+ *  \brief Implementations of the on-disk cache of compiled script syntax trees.
+ *
+ *  Entry layout (QDataStream, Qt 6.0 encoding): the magic number, the format version, the version key,
+ *  the SHA-256 digest the entry is named by, the UTF-16 length of the script, and then the syntax tree in
+ *  pre-order. Each syntax node is written as its type, its
+ *  head lex node and its child count, followed by the children. Each lex node is written as its type and,
+ *  unless it is a dummy, its text, its type-specific payload, its source position, and its source span.
+ */
+
+#include "finExecCompileCache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileInfoList>
+#include <QMutexLocker>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include "finSymbolTable.h"
+#include "finVersion.h"
+
+
+static const quint32 _finCompileCacheMagic = 0x46494e43;  // "FINC"
+static const quint32 _finCompileCacheFormat = 3;
+static const int _finCompileCacheMaxLevel = 4096;
+static const QString _finCompileCacheSuffix = QString(".fnc");
+
+QAtomicInt finExecCompileCache::_enabled(0);
+QString finExecCompileCache::_cacheDir = QString();
+qint64 finExecCompileCache::_maxCacheSize = 64 * 1024 * 1024;
+qint64 finExecCompileCache::_cacheSize = -1;
+QMutex finExecCompileCache::_mutex;
+
+finExecCompileCache::finExecCompileCache()
+{
+    /* Do Nothing because you should not call this constructor. */
+}
+
+bool finExecCompileCache::isEnabled()
+{
+    return (_enabled.loadAcquire() != 0);
+}
+
+void finExecCompileCache::setEnabled(bool enabled)
+{
+    _enabled.storeRelease(enabled ? 1 : 0);
+}
+
+QString finExecCompileCache::getCacheDirectory()
+{
+    QMutexLocker locker(&_mutex);
+    return getCacheDirectoryLocked();
+}
+
+QString finExecCompileCache::getCacheDirectoryLocked()
+{
+    if ( !_cacheDir.isEmpty() )
+        return _cacheDir;
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QString("/compiled-scripts");
+}
+
+void finExecCompileCache::setCacheDirectory(const QString &dirpath)
+{
+    QMutexLocker locker(&_mutex);
+    _cacheDir = dirpath;
+    _cacheSize = -1;
+}
+
+qint64 finExecCompileCache::getMaxCacheSize()
+{
+    QMutexLocker locker(&_mutex);
+    return _maxCacheSize;
+}
+
+void finExecCompileCache::setMaxCacheSize(qint64 size)
+{
+    QMutexLocker locker(&_mutex);
+    _maxCacheSize = (size < 0 ? 0 : size);
+}
+
+QString finExecCompileCache::getVersionKey()
+{
+    return QString("%1;%2;%3;%4").arg(_finCompileCacheFormat)
+                                 .arg(finVersionTools::currentVersionString(),
+                                      finVersionTools::currentGitVersion(),
+                                      finVersionTools::currentGitDate());
+}
+
+QByteArray finExecCompileCache::getScriptHash(const QString &script)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(getVersionKey().toUtf8());
+    hash.addData(QByteArray(1, '\0'));
+    hash.addData(script.toUtf8());
+    return hash.result();
+}
+
+QString finExecCompileCache::getEntryPath(const QByteArray &scripthash)
+{
+    return getCacheDirectoryLocked() + QString("/") +
+           QString::fromLatin1(scripthash.toHex()) + _finCompileCacheSuffix;
+}
+
+void finExecCompileCache::writeLexNode(QDataStream &stream, const finLexNode *lexnode)
+{
+    if ( lexnode == nullptr ) {
+        stream << (qint32)finLexNode::TP_DUMMY;
+        return;
+    }
+
+    finLexNodeType type = lexnode->getType();
+    stream << (qint32)type;
+    stream << lexnode->getString();
+    switch ( type ) {
+      case finLexNode::TP_DECIMAL:
+        stream << lexnode->getFloatValue();
+        break;
+
+      case finLexNode::TP_STRING:
+        stream << lexnode->getStringValue();
+        break;
+
+      case finLexNode::TP_OPERATOR:
+        stream << (qint32)lexnode->getOperator();
+        break;
+
+      default:
+        break;
+    }
+    stream << (quint32)lexnode->getRow() << (quint32)lexnode->getColumn();
+    stream << (quint64)lexnode->getSpanPosition() << (quint64)lexnode->getSpanLength();
+}
+
+bool finExecCompileCache::readLexNode(QDataStream &stream, finLexNode *lexnode)
+{
+    qint32 type;
+    stream >> type;
+    if ( stream.status() != QDataStream::Ok || type < finLexNode::TP_DUMMY || type >= finLexNode::TP_MAX )
+        return false;
+    if ( type == finLexNode::TP_DUMMY )
+        return true;
+
+    QString str;
+    stream >> str;
+    lexnode->setType((finLexNodeType)type);
+    if ( type == finLexNode::TP_VARIABLE || type == finLexNode::TP_KEYWORD || type == finLexNode::TP_OPERATOR ) {
+        // A full symbol table fails the read like the lexer would fail the compile.
+        int symid = finSymbolTable::tryGetSymbolId(str);
+        if ( symid == finSymbolTable::SYM_NONE )
+            return false;
+        lexnode->setSymbol(symid);
+    } else {
+        lexnode->setString(str);
+    }
+
+    switch ( type ) {
+      case finLexNode::TP_DECIMAL: {
+        double val;
+        stream >> val;
+        lexnode->setFloatValue(val);
+      } break;
+
+      case finLexNode::TP_STRING: {
+        QString strval;
+        stream >> strval;
+        lexnode->setStringValue(strval);
+      } break;
+
+      case finLexNode::TP_OPERATOR: {
+        qint32 optype;
+        stream >> optype;
+        if ( optype < finLexNode::OP_DUMMY || optype >= finLexNode::OP_MAX )
+            return false;
+        lexnode->setOperator((finLexOperatorType)optype);
+      } break;
+
+      default:
+        break;
+    }
+
+    quint32 row, column;
+    stream >> row >> column;
+    lexnode->setRow(row);
+    lexnode->setColumn(column);
+
+    quint64 spanpos, spanlen;
+    stream >> spanpos >> spanlen;
+    lexnode->setSpan(spanpos, spanlen);
+    return (stream.status() == QDataStream::Ok);
+}
+
+void finExecCompileCache::writeSyntaxNode(QDataStream &stream, const finSyntaxNode *synnode)
+{
+    stream << (qint32)synnode->getType();
+    writeLexNode(stream, synnode->getCommandLexNode());
+
+    int subcnt = synnode->getSubListCount();
+    stream << (qint32)subcnt;
+    for ( int i = 0; i < subcnt; i++ )
+        writeSyntaxNode(stream, synnode->getSubSyntaxNode(i));
+}
+
+bool finExecCompileCache::readSyntaxNode(QDataStream &stream, finSyntaxNode *synnode, int level)
+{
+    // A corrupted child count must not be able to drive the recursion arbitrarily deep.
+    if ( level > _finCompileCacheMaxLevel )
+        return false;
+
+    qint32 type;
+    stream >> type;
+    if ( stream.status() != QDataStream::Ok ||
+         type < finSyntaxNode::TP_DUMMY || type >= finSyntaxNode::TP_MAX )
+        return false;
+    synnode->setType((finSyntaxNodeType)type);
+
+    finLexNode lexnode;
+    if ( !readLexNode(stream, &lexnode) )
+        return false;
+    if ( lexnode.getType() != finLexNode::TP_DUMMY )
+        synnode->setCommandLexNode(&lexnode);
+
+    qint32 subcnt;
+    stream >> subcnt;
+    if ( stream.status() != QDataStream::Ok || subcnt < 0 )
+        return false;
+
+    for ( qint32 i = 0; i < subcnt; i++ ) {
+        finSyntaxNode *subnode = new finSyntaxNode();
+        if ( subnode == nullptr )
+            return false;
+
+        // The parent owns the child from here on, so a failed read below is cleaned up with the tree.
+        synnode->appendSubSyntaxNode(subnode);
+        if ( !readSyntaxNode(stream, subnode, level + 1) )
+            return false;
+    }
+    return true;
+}
+
+finSyntaxTree *finExecCompileCache::loadSyntaxTree(const QString &script)
+{
+    // Checked before hashing and locking, so that a disabled cache costs the caller nothing.
+    if ( !isEnabled() )
+        return nullptr;
+
+    QByteArray scripthash = getScriptHash(script);
+    QMutexLocker locker(&_mutex);
+    QString filepath = getEntryPath(scripthash);
+
+    QFile file(filepath);
+    if ( !file.open(QIODevice::ReadOnly) )
+        return nullptr;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic, format;
+    QString verkey;
+    QByteArray cachedhash;
+    qint64 cachedlen;
+    stream >> magic >> format >> verkey >> cachedhash >> cachedlen;
+
+    bool valid = (stream.status() == QDataStream::Ok && magic == _finCompileCacheMagic &&
+                  format == _finCompileCacheFormat && verkey == getVersionKey() &&
+                  cachedhash == scripthash && cachedlen == (qint64)script.length());
+    finSyntaxTree *syntree = nullptr;
+    if ( valid ) {
+        syntree = new finSyntaxTree();
+        if ( syntree == nullptr ) {
+            file.close();
+            return nullptr;
+        }
+
+        try {
+            finExecObjectArena::Scope arenascope(syntree->getNodeArena());
+            valid = readSyntaxNode(stream, syntree->getRootNode(), 0) && stream.atEnd();
+        } catch ( const finException & ) {
+            valid = false;
+        }
+    }
+
+    if ( !valid ) {
+        if ( syntree != nullptr )
+            delete syntree;
+        qint64 filesize = file.size();
+        file.close();
+        finWarning << "Drop the unreadable compile cache entry " << filepath;
+        if ( QFile::remove(filepath) && _cacheSize >= 0 )
+            _cacheSize = qMax((qint64)0, _cacheSize - filesize);
+        return nullptr;
+    }
+
+    syntree->setScriptCode(script);
+
+    // Hits refresh the timestamp that trimCache() evicts by.
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    file.close();
+    return syntree;
+}
+
+finErrorCode finExecCompileCache::storeSyntaxTree(const QString &script, const finSyntaxTree *syntree)
+{
+    if ( syntree == nullptr )
+        return finErrorKits::EC_NULL_POINTER;
+    if ( syntree->getErrorCount() > 0 )
+        return finErrorKits::EC_INVALID_PARAM;
+
+    if ( !isEnabled() )
+        return finErrorKits::EC_DUPLICATE_OP;
+
+    QByteArray scripthash = getScriptHash(script);
+    QMutexLocker locker(&_mutex);
+    QString filepath = getEntryPath(scripthash);
+
+    QFileInfo fileinfo(filepath);
+    if ( !QDir().mkpath(fileinfo.absolutePath()) )
+        return finErrorKits::EC_FILE_NOT_OPEN;
+    qint64 oldsize = (fileinfo.exists() ? fileinfo.size() : 0);
+
+    QSaveFile file(filepath);
+    if ( !file.open(QIODevice::WriteOnly) )
+        return finErrorKits::EC_FILE_NOT_OPEN;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream << _finCompileCacheMagic << _finCompileCacheFormat << getVersionKey()
+           << scripthash << (qint64)script.length();
+    writeSyntaxNode(stream, syntree->getRootNode());
+
+    if ( stream.status() != QDataStream::Ok ) {
+        file.cancelWriting();
+        return finErrorKits::EC_FILE_NOT_OPEN;
+    }
+    qint64 newsize = file.size();
+    if ( !file.commit() )
+        return finErrorKits::EC_FILE_NOT_OPEN;
+
+    if ( _cacheSize >= 0 )
+        _cacheSize += newsize - oldsize;
+    return trimCacheLocked(false);
+}
+
+finErrorCode finExecCompileCache::clearCache()
+{
+    QMutexLocker locker(&_mutex);
+
+    QDir dir(getCacheDirectoryLocked());
+    if ( !dir.exists() )
+        return finErrorKits::EC_NORMAL_WARN;
+
+    QFileInfoList entrylist = dir.entryInfoList(QStringList(QString("*") + _finCompileCacheSuffix), QDir::Files);
+    bool failed = false;
+    foreach ( const QFileInfo &entry, entrylist ) {
+        if ( !QFile::remove(entry.absoluteFilePath()) )
+            failed = true;
+    }
+    _cacheSize = (failed ? -1 : 0);
+    return (failed ? finErrorKits::EC_NORMAL_WARN : finErrorKits::EC_SUCCESS);
+}
+
+finErrorCode finExecCompileCache::trimCache()
+{
+    QMutexLocker locker(&_mutex);
+    return trimCacheLocked(true);
+}
+
+qint64 finExecCompileCache::scanCacheSizeLocked()
+{
+    QDir dir(getCacheDirectoryLocked());
+    if ( !dir.exists() )
+        return 0;
+
+    QFileInfoList entrylist = dir.entryInfoList(QStringList(QString("*") + _finCompileCacheSuffix), QDir::Files);
+    qint64 totalsize = 0;
+    foreach ( const QFileInfo &entry, entrylist )
+        totalsize += entry.size();
+    return totalsize;
+}
+
+finErrorCode finExecCompileCache::trimCacheLocked(bool rescan)
+{
+    // The directory is only listed once per process, or when the running total says it is over the cap.
+    if ( rescan || _cacheSize < 0 )
+        _cacheSize = scanCacheSizeLocked();
+    if ( _cacheSize <= _maxCacheSize )
+        return finErrorKits::EC_SUCCESS;
+
+    QDir dir(getCacheDirectoryLocked());
+    if ( !dir.exists() ) {
+        _cacheSize = 0;
+        return finErrorKits::EC_SUCCESS;
+    }
+
+    // Oldest first, so eviction walks from the least recently used entry. The listing also resynchronizes
+    // the running total with entries other processes may have added or removed.
+    QFileInfoList entrylist = dir.entryInfoList(QStringList(QString("*") + _finCompileCacheSuffix), QDir::Files,
+                                                QDir::Time | QDir::Reversed);
+    qint64 totalsize = 0;
+    foreach ( const QFileInfo &entry, entrylist )
+        totalsize += entry.size();
+
+    for ( int i = 0; i < entrylist.count() && totalsize > _maxCacheSize; i++ ) {
+        const QFileInfo &entry = entrylist.at(i);
+        if ( QFile::remove(entry.absoluteFilePath()) )
+            totalsize -= entry.size();
+    }
+    _cacheSize = totalsize;
+    return finErrorKits::EC_SUCCESS;
+}
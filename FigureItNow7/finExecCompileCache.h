@@ -0,0 +1,113 @@
+/*-
+ * GNU GENERAL PUBLIC LICENSE, version 3
+ * See LICENSE file for detail.
+ *
+ * Author: Yulong Yu
+ * Copyright(c) 2015-2026 Yulong Yu. All rights reserved.
+ */
+
+/*! \file finExecCompileCache.h
+ *  \brief Declarations of the on-disk cache of compiled script syntax trees.
+ *
+ *  This header defines finExecCompileCache, which stores the syntax tree of every successfully compiled
+ *  script in a binary file named after a hash of the script text and the program version, so that
+ *  finExecMachine::compile() can skip lexing and parsing for scripts it has seen before. The cache is off
+ *  until a caller enables it, which the command line does.
+ */
+
+#ifndef FINEXECCOMPILECACHE_H
+#define FINEXECCOMPILECACHE_H
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QDataStream>
+#include <QMutex>
+#include <QString>
+#include <QtGlobal>
+
+#include "finErrorCode.h"
+#include "finLexNode.h"
+#include "finSyntaxNode.h"
+#include "finSyntaxTree.h"
+
+
+/*! \class finExecCompileCache
+ *  \brief Persistent cache of compiled syntax trees keyed by script content and program version.
+ *
+ *  finExecCompileCache is used as a namespace. Entries are written atomically, one file per script, and
+ *  are keyed by the SHA-256 digest of the version key and the script; an entry repeats the digest and the
+ *  script length, which a lookup checks before it trusts the tree. Trees with syntax errors are never
+ *  cached. The total size of the cache directory is capped: a running total, taken from one directory
+ *  scan and then kept up to date by every store, decides when the least recently used entries are
+ *  removed. Every entry is implicitly invalidated when the program version changes, and clearCache()
+ *  drops all entries explicitly.
+ *
+ *  \see finExecMachine::compile()
+ */
+class finExecCompileCache
+{
+private:
+    static QAtomicInt _enabled;   //!< Whether lookups and stores are performed at all; off by default.
+    static QString _cacheDir;     //!< Directory holding the cache entries; empty selects the default.
+    static qint64 _maxCacheSize;  //!< Upper bound of the total size of all entries, in bytes.
+    static qint64 _cacheSize;     //!< Running total size of the entries; -1 until the directory is scanned.
+    static QMutex _mutex;         //!< Serializes directory access from concurrent machines.
+
+    finExecCompileCache();
+
+public:
+    /*! \name Configuration
+     *  \brief Enable, relocate, or cap the cache.
+     */
+    ///@{
+    static bool isEnabled();
+    static void setEnabled(bool enabled);
+
+    /*! \brief Returns the cache directory; by default a folder under the user cache location. */
+    static QString getCacheDirectory();
+    static void setCacheDirectory(const QString &dirpath);
+
+    static qint64 getMaxCacheSize();
+    static void setMaxCacheSize(qint64 size);
+    ///@}
+
+    /*! \name Cache Access
+     *  \brief Look up, store, and invalidate compiled trees.
+     */
+    ///@{
+
+    /*!
+     *  \brief Returns a heap-allocated copy of the cached tree of \a script, or \c nullptr on a miss.
+     *
+     *  Unreadable or stale entries are deleted and reported as misses.
+     */
+    static finSyntaxTree *loadSyntaxTree(const QString &script);
+
+    /*!
+     *  \brief Stores the error-free tree \a syntree compiled from \a script, then enforces the size cap.
+     */
+    static finErrorCode storeSyntaxTree(const QString &script, const finSyntaxTree *syntree);
+
+    /*! \brief Removes every entry from the cache directory. */
+    static finErrorCode clearCache();
+
+    /*! \brief Rescans the cache directory and removes the least recently used entries until it fits in the cap. */
+    static finErrorCode trimCache();
+    ///@}
+
+private:
+    // Helpers below expect _mutex to be held by the caller.
+    static QString getCacheDirectoryLocked();
+    static QString getVersionKey();
+    static QByteArray getScriptHash(const QString &script);
+    static QString getEntryPath(const QByteArray &scripthash);
+    static qint64 scanCacheSizeLocked();
+    static finErrorCode trimCacheLocked(bool rescan);
+
+    static void writeLexNode(QDataStream &stream, const finLexNode *lexnode);
+    static bool readLexNode(QDataStream &stream, finLexNode *lexnode);
+    static void writeSyntaxNode(QDataStream &stream, const finSyntaxNode *synnode);
+    static bool readSyntaxNode(QDataStream &stream, finSyntaxNode *synnode, int level);
+};
+
+#endif // FINEXECCOMPILECACHE_H
@@ -11,12 +11,17 @@
  *
  *  Provides the small adapter that stores script text, drives finSyntaxReader through a full parse,
  *  and converts parse failures into heap-allocated finSyntaxTree instances that carry syntax errors.
+ *  It also lowers a finished syntax tree into finExecBytecode for the VM execution mode.
  */
 
 #include "finExecCompiler.h"
 
+#include "finExecOperartorCalc.h"
+
 finExecCompiler::finExecCompiler()
-    : _scriptCode(), _synReader()
+    : _scriptCode(), _nodeArena(QString("compiler"), sizeof (finSyntaxNode)), _synReader(), _incScript(),
+      _incNodes(), _incPoints(), _lowerCode(nullptr),
+      _lowerEnvDepth(0), _lowerScopes(), _lowerBlocks(), _lowerLoops(), _lowerFuncNodes()
 {
     return;
 }
@@ -25,6 +30,8 @@ finExecCompiler::~finExecCompiler()
 {
     if ( this->_synReader.isReading() )
         this->_synReader.stopRead();
+
+    this->clearIncrementalState();
 }
 
 QString finExecCompiler::getScriptCode() const
@@ -41,29 +48,182 @@ finSyntaxTree *finExecCompiler::compile()
 {
     finSyntaxTree *rettree = nullptr;
 
-    if ( this->_scriptCode.length() == 0 )
+    if ( this->_scriptCode.length() == 0 ) {
+        this->clearIncrementalState();
         return this->buildErrorTree(QString());
+    }
 
     if ( this->_synReader.isReading() )
         this->_synReader.stopRead();
 
+    QList<finSyntaxError> errlist;
     try {
+        finExecObjectArena::Scope arenascope(&this->_nodeArena);
         this->_synReader.setScriptCode(this->_scriptCode);
-        this->_synReader.startRead();
-
-        while ( this->_synReader.readNextToken() ) { }
+        errlist = this->readIncremental();
     } catch (finException &e) {
+        this->clearIncrementalState();
         return this->buildErrorTree(e.getErrorDescription());
     }
 
-    rettree = this->_synReader.getSyntaxTree();
-    if ( rettree == nullptr )
-        rettree = this->buildErrorTree(QString("Cannot build syntax tree."));
+    rettree = new finSyntaxTree();
+    if ( rettree == nullptr ) {
+        this->clearIncrementalState();
+        return this->buildErrorTree(QString("Cannot build syntax tree."));
+    }
 
-    this->_synReader.stopRead();
+    // The tree shares the statements with the next incremental pass instead of copying them.
+    rettree->shareSyntaxNodeList(&this->_incNodes);
+    rettree->setScriptCode(this->_scriptCode);
+    rettree->appendSyntaxErrorList(&errlist);
+
+    // A lex error stops reading midway, which leaves nothing that a later pass could resume from.
+    if ( !errlist.isEmpty() )
+        this->clearIncrementalState();
     return rettree;
 }
 
+void finExecCompiler::clearIncrementalState()
+{
+    foreach ( finSyntaxNode *synnode, this->_incNodes )
+        finSyntaxNode::releaseNode(synnode);
+    this->_incNodes.clear();
+    this->_incPoints.clear();
+    this->_incScript = QString();
+}
+
+static void
+_shiftSyntaxNode(finSyntaxNode *synnode, qsizetype posdelta, unsigned int fromrow, int rowdelta, int coldelta)
+{
+    // Lex nodes made up by the parser (function calls, commas, ...) have no span and no source position.
+    finLexNode *lexnode = synnode->getCommandLexNode();
+    if ( lexnode != nullptr && lexnode->getSpanLength() > 0 ) {
+        unsigned int row = lexnode->getRow();
+        if ( row == fromrow )
+            lexnode->setColumn(static_cast<unsigned int>(static_cast<int>(lexnode->getColumn()) + coldelta));
+        lexnode->setRow(static_cast<unsigned int>(static_cast<int>(row) + rowdelta));
+        lexnode->setSpan(static_cast<unsigned long>(static_cast<qsizetype>(lexnode->getSpanPosition()) + posdelta),
+                         lexnode->getSpanLength());
+    }
+
+    for ( int i = 0; i < synnode->getSubListCount(); i++ )
+        _shiftSyntaxNode(synnode->getSubSyntaxNode(i), posdelta, fromrow, rowdelta, coldelta);
+}
+
+QList<finSyntaxError> finExecCompiler::readIncremental()
+{
+    const QString &script = this->_scriptCode;
+    const QString &oldscript = this->_incScript;
+    qsizetype newlen = script.length(), oldlen = oldscript.length();
+    qsizetype minlen = qMin(newlen, oldlen);
+    qsizetype prelen = 0, suflen = 0;
+
+    // The unchanged head and tail of the script.
+    if ( !oldscript.isEmpty() ) {
+        const QChar *newdata = script.constData(), *olddata = oldscript.constData();
+        while ( prelen < minlen && newdata[prelen] == olddata[prelen] )
+            prelen++;
+        while ( suflen < minlen - prelen && newdata[newlen - 1 - suflen] == olddata[oldlen - 1 - suflen] )
+            suflen++;
+    }
+
+    // Resume after the last boundary strictly before the first changed character, so that the edit
+    // cannot have extended the token that ends there.
+    int startidx = -1;
+    for ( int i = this->_incPoints.count() - 1; i >= 0; i-- ) {
+        if ( static_cast<qsizetype>(this->_incPoints.at(i)._lexMark._posIdx) < prelen ) {
+            startidx = i;
+            break;
+        }
+    }
+
+    QList<IncrPoint> pointlist;
+    int basecnt = 0;
+    if ( startidx >= 0 ) {
+        const IncrPoint &startpt = this->_incPoints.at(startidx);
+        basecnt = startpt._nodeCnt;
+        pointlist = this->_incPoints.mid(0, startidx + 1);
+        this->_synReader.startReadAt(startpt._lexMark, basecnt > 0);
+    } else {
+        this->_synReader.startRead();
+    }
+
+    // Read up to the first boundary behind the edit at which the old pass stood as well. Both passes see
+    // the same text from there on, in the same parser state, so the old nodes that follow are final.
+    qsizetype posdelta = newlen - oldlen;
+    int resyncidx = -1, scanidx = startidx + 1;
+    IncrPoint resyncpt = IncrPoint();
+    while ( this->_synReader.readNextToken() ) {
+        if ( !this->_synReader.isAtStatementBoundary() )
+            continue;
+
+        IncrPoint curpt;
+        curpt._lexMark = this->_synReader.getLexReader()->getMark();
+        curpt._nodeCnt = basecnt + this->_synReader.getStatementCount();
+
+        qsizetype curpos = static_cast<qsizetype>(curpt._lexMark._posIdx);
+        if ( !oldscript.isEmpty() && curpos >= newlen - suflen ) {
+            unsigned long oldpos = static_cast<unsigned long>(curpos - posdelta);
+            while ( scanidx < this->_incPoints.count() && this->_incPoints.at(scanidx)._lexMark._posIdx < oldpos )
+                scanidx++;
+
+            // An empty stack is the one state in which the parser acts differently on what follows.
+            if ( scanidx < this->_incPoints.count() &&
+                 this->_incPoints.at(scanidx)._lexMark._posIdx == oldpos &&
+                 this->_incPoints.at(scanidx)._lexMark._readOrder == curpt._lexMark._readOrder &&
+                 (this->_incPoints.at(scanidx)._nodeCnt > 0) == (curpt._nodeCnt > 0) ) {
+                resyncidx = scanidx;
+                resyncpt = curpt;
+                break;
+            }
+        }
+        pointlist.append(curpt);
+    }
+
+    QList<finSyntaxNode *> nodelist = this->_incNodes.mid(0, basecnt);
+    this->_synReader.takeSyntaxNodes(&nodelist);
+    QList<finSyntaxError> errlist = this->_synReader.getErrorList();
+    this->_synReader.stopRead();
+
+    int oldendcnt = this->_incNodes.count();
+    if ( resyncidx >= 0 ) {
+        const IncrPoint &oldpt = this->_incPoints.at(resyncidx);
+        const finLexReader::Mark &oldmark = oldpt._lexMark;
+        int rowdelta = static_cast<int>(resyncpt._lexMark._row) - static_cast<int>(oldmark._row);
+        int coldelta = static_cast<int>(resyncpt._lexMark._column) - static_cast<int>(oldmark._column);
+        int cntdelta = resyncpt._nodeCnt - oldpt._nodeCnt;
+
+        // Text after the resync point only moved: rows by the change in line count, and columns on the
+        // resync row by the change of its prefix.
+        for ( int i = oldpt._nodeCnt; i < this->_incNodes.count(); i++ ) {
+            finSyntaxNode *synnode = this->_incNodes.at(i);
+            _shiftSyntaxNode(synnode, posdelta, oldmark._row, rowdelta, coldelta);
+            nodelist.append(synnode);
+        }
+
+        for ( int i = resyncidx; i < this->_incPoints.count(); i++ ) {
+            IncrPoint curpt = this->_incPoints.at(i);
+            finLexReader::Mark &curmark = curpt._lexMark;
+            if ( curmark._row == oldmark._row )
+                curmark._column = static_cast<unsigned int>(static_cast<int>(curmark._column) + coldelta);
+            curmark._row = static_cast<unsigned int>(static_cast<int>(curmark._row) + rowdelta);
+            curmark._posIdx = static_cast<unsigned long>(static_cast<qsizetype>(curmark._posIdx) + posdelta);
+            curpt._nodeCnt += cntdelta;
+            pointlist.append(curpt);
+        }
+        oldendcnt = oldpt._nodeCnt;
+    }
+
+    // The old nodes between the two boundaries were read again.
+    for ( int i = basecnt; i < oldendcnt; i++ )
+        finSyntaxNode::releaseNode(this->_incNodes.at(i));
+
+    this->_incNodes = nodelist;
+    this->_incPoints = pointlist;
+    this->_incScript = script;
+    return errlist;
+}
+
 finSyntaxTree *finExecCompiler::buildErrorTree(const QString &errstr) const
 {
     finSyntaxTree *rettree = new finSyntaxTree();
@@ -81,3 +241,859 @@ finSyntaxTree *finExecCompiler::buildErrorTree(const QString &errstr) const
     rettree->appendSyntaxError(synerr);
     return rettree;
 }
+
+finErrorCode finExecCompiler::lowerSyntaxTree(finSyntaxTree *syntree, finExecBytecode *bytecode)
+{
+    finErrorCode errcode;
+
+    if ( syntree == nullptr || bytecode == nullptr )
+        return finErrorKits::EC_NULL_POINTER;
+    if ( syntree->getErrorCount() > 0 )
+        return finErrorKits::EC_STATE_ERROR;
+
+    bytecode->clear();
+    this->_lowerFuncNodes.clear();
+
+    try {
+        errcode = this->lowerCodeUnit(syntree->getRootNode(), QStringList(), bytecode);
+        if ( finErrorKits::isErrorResult(errcode) )
+            goto err;
+
+        // Function bodies are lowered into their own code units, all owned by the program unit so that
+        // the machine can find the body of any finExecFunction by its syntax node.
+        while ( !this->_lowerFuncNodes.empty() ) {
+            finSyntaxNode *fnnode = this->_lowerFuncNodes.takeFirst();
+            finSyntaxNode *bodynode = fnnode->getSubSyntaxNode(2);
+            if ( bytecode->findSubCode(bodynode) != nullptr )
+                continue;
+
+            // Parameters sit in slots 0..n-1 of the call environment, see finExecFunction. They are
+            // only resolved when the body opens its own block, so that nothing else is declared there.
+            QStringList paramnames;
+            finLexNode *bodylex = bodynode->getCommandLexNode();
+            if ( bodylex->getType() != finLexNode::TP_OPERATOR ||
+                 bodylex->getOperator() != finLexNode::OP_L_FLW_BRCKT ||
+                 !this->getFuncParamNames(fnnode->getSubSyntaxNode(1), &paramnames) )
+                paramnames.clear();
+
+            finExecBytecode *subcode = new finExecBytecode();
+            errcode = this->lowerCodeUnit(bodynode, paramnames, subcode);
+            if ( finErrorKits::isErrorResult(errcode) ) {
+                delete subcode;
+                goto err;
+            }
+            bytecode->appendSubCode(bodynode, subcode);
+        }
+    } catch (finException &e) {
+        errcode = e.getErrorCode();
+        goto err;
+    }
+
+    this->_lowerCode = nullptr;
+    return finErrorKits::EC_SUCCESS;
+
+err:
+    this->_lowerCode = nullptr;
+    this->_lowerBlocks.clear();
+    this->_lowerLoops.clear();
+    this->_lowerScopes.clear();
+    this->_lowerFuncNodes.clear();
+    bytecode->clear();
+    return errcode;
+}
+
+finErrorCode
+finExecCompiler::lowerCodeUnit(finSyntaxNode *synnode, const QStringList &paramnames, finExecBytecode *bytecode)
+{
+    finErrorCode errcode;
+
+    this->_lowerCode = bytecode;
+    this->_lowerEnvDepth = 0;
+    this->_lowerBlocks.clear();
+    this->_lowerLoops.clear();
+
+    // Scope 0 is the environment the code unit is called in; only function parameters are known there.
+    LowerScope basescope;
+    for ( int i = 0; i < paramnames.count(); i++ )
+        basescope._slotMap.insert(paramnames.at(i), i);
+    this->_lowerScopes.clear();
+    this->_lowerScopes.append(basescope);
+
+    if ( synnode->getType() != finSyntaxNode::TP_PROGRAM )
+        return this->lowerStatement(synnode);
+
+    // A program always runs in its own child environment, see finExecMachine::instExecProgram.
+    this->emitInst(finExecBytecode::BC_ENTER_ENV, 0, 0, synnode);
+    this->enterLowerScope(synnode);
+    errcode = this->lowerStatIn(synnode);
+    if ( finErrorKits::isErrorResult(errcode) )
+        return errcode;
+    this->leaveLowerScope();
+    this->emitInst(finExecBytecode::BC_LEAVE_ENV, 0, 0, synnode);
+    return finErrorKits::EC_SUCCESS;
+}
+
+bool finExecCompiler::getFuncParamNames(finSyntaxNode *synnode, QStringList *paramnames)
+{
+    finLexNode *lexnode = synnode->getCommandLexNode();
+
+    if ( synnode->getType() != finSyntaxNode::TP_EXPRESS || lexnode->getType() != finLexNode::TP_OPERATOR ||
+         lexnode->getOperator() != finLexNode::OP_L_RND_BRCKT )
+        return false;
+    if ( synnode->getSubListCount() <= 0 )
+        return true;
+
+    finSyntaxNode *insynnode = synnode->getSubSyntaxNode(0);
+    finLexNode *inlexnode = insynnode->getCommandLexNode();
+    if ( insynnode->getType() != finSyntaxNode::TP_EXPRESS )
+        return false;
+
+    if ( inlexnode->getType() == finLexNode::TP_VARIABLE ) {
+        paramnames->append(inlexnode->getString());
+        return true;
+    } else if ( inlexnode->getType() != finLexNode::TP_OPERATOR ||
+                inlexnode->getOperator() != finLexNode::OP_COMMA ) {
+        return false;
+    }
+
+    for ( int i = 0; i < insynnode->getSubListCount(); i++ ) {
+        finSyntaxNode *argsynnode = insynnode->getSubSyntaxNode(i);
+        if ( argsynnode->getType() != finSyntaxNode::TP_EXPRESS ||
+             argsynnode->getCommandLexNode()->getType() != finLexNode::TP_VARIABLE )
+            return false;
+        paramnames->append(argsynnode->getCommandLexNode()->getString());
+    }
+    return true;
+}
+
+int finExecCompiler::emitInst(finExecOpCode opcode, int arg1, int arg2, finSyntaxNode *synnode)
+{
+    return this->emitInst(opcode, arg1, arg2, 0, synnode);
+}
+
+int finExecCompiler::emitInst(finExecOpCode opcode, int arg1, int arg2, int arg3, finSyntaxNode *synnode)
+{
+    finLexNode *lexnode = (synnode != nullptr ? synnode->getCommandLexNode() : nullptr);
+    return this->_lowerCode->appendInstruction(opcode, arg1, arg2, arg3, lexnode);
+}
+
+int finExecCompiler::emitLeaveEnv(int envdepth, finSyntaxNode *synnode)
+{
+    int leavecnt = 0;
+    for ( int depth = this->_lowerEnvDepth; depth > envdepth; depth-- ) {
+        this->emitInst(finExecBytecode::BC_LEAVE_ENV, 0, 0, synnode);
+        leavecnt++;
+    }
+    return leavecnt;
+}
+
+void finExecCompiler::patchJumps(const QList<int> &fixups, int target)
+{
+    for ( int i = 0; i < fixups.count(); i++ )
+        this->_lowerCode->setInstructionArg(fixups.at(i), target);
+}
+
+void finExecCompiler::enterLowerScope(finSyntaxNode *synnode)
+{
+    LowerScope scope;
+    this->collectScopeNames(synnode, true, &scope);
+
+    this->_lowerScopes.append(scope);
+    this->_lowerEnvDepth++;
+}
+
+void finExecCompiler::leaveLowerScope()
+{
+    this->_lowerScopes.removeLast();
+    this->_lowerEnvDepth--;
+}
+
+void finExecCompiler::collectScopeNames(finSyntaxNode *synnode, bool isroot, LowerScope *scope)
+{
+    finLexNode *lexnode = synnode->getCommandLexNode();
+
+    switch ( synnode->getType() ) {
+      case finSyntaxNode::TP_DECLARE:
+        for ( int i = 0; i < synnode->getSubListCount(); i++ )
+            this->collectDeclareNames(synnode->getSubSyntaxNode(i), scope);
+        return;
+
+      case finSyntaxNode::TP_FUNCTION:
+      case finSyntaxNode::TP_EXPRESS:
+        return;
+
+      case finSyntaxNode::TP_STATEMENT:
+        // A nested block declares into its own environment.
+        if ( !isroot && lexnode != nullptr && lexnode->getType() == finLexNode::TP_OPERATOR &&
+             lexnode->getOperator() == finLexNode::OP_L_FLW_BRCKT )
+            return;
+        break;
+
+      default:
+        break;
+    }
+
+    for ( int i = 0; i < synnode->getSubListCount(); i++ )
+        this->collectScopeNames(synnode->getSubSyntaxNode(i), false, scope);
+}
+
+void finExecCompiler::collectDeclareNames(finSyntaxNode *synnode, LowerScope *scope)
+{
+    finLexNode *lexnode = synnode->getCommandLexNode();
+    if ( synnode->getType() != finSyntaxNode::TP_EXPRESS || lexnode == nullptr )
+        return;
+
+    if ( lexnode->getType() == finLexNode::TP_VARIABLE ) {
+        if ( !scope->_slotMap.contains(lexnode->getString()) )
+            scope->_slotMap.insert(lexnode->getString(), scope->_slotMap.count());
+    } else if ( lexnode->getType() == finLexNode::TP_OPERATOR &&
+                lexnode->getOperator() == finLexNode::OP_LET ) {
+        if ( synnode->getSubListCount() > 0 )
+            this->collectDeclareNames(synnode->getSubSyntaxNode(0), scope);
+    } else if ( lexnode->getType() == finLexNode::TP_OPERATOR &&
+                lexnode->getOperator() == finLexNode::OP_COMMA ) {
+        for ( int i = 0; i < synnode->getSubListCount(); i++ )
+            this->collectDeclareNames(synnode->getSubSyntaxNode(i), scope);
+    }
+}
+
+bool finExecCompiler::resolveVariableSlot(const QString &varname, int *depth, int *slot)
+{
+    // Every name that can be declared in a scope owns a slot there, so the innermost scope listing
+    // the name is the only place it can be shadowed. An empty slot at run time means the declaration
+    // has not happened (yet), and the VM then falls back to the dynamic lookup.
+    for ( int scpidx = this->_lowerScopes.count() - 1; scpidx >= 0; scpidx-- ) {
+        QHash<QString, int>::const_iterator it = this->_lowerScopes.at(scpidx)._slotMap.constFind(varname);
+        if ( it == this->_lowerScopes.at(scpidx)._slotMap.constEnd() )
+            continue;
+
+        *depth = scpidx;
+        *slot = it.value();
+        return true;
+    }
+    return false;
+}
+
+finErrorCode finExecCompiler::lowerStatement(finSyntaxNode *synnode)
+{
+    finErrorCode errcode;
+
+    switch ( synnode->getType() ) {
+      case finSyntaxNode::TP_DECLARE:
+        return this->lowerDeclare(synnode);
+
+      case finSyntaxNode::TP_STATEMENT:
+        return this->lowerStatBlock(synnode);
+
+      case finSyntaxNode::TP_EXPRESS:
+        errcode = this->lowerExpress(synnode);
+        if ( finErrorKits::isErrorResult(errcode) )
+            return errcode;
+        this->emitInst(finExecBytecode::BC_SET_RESULT, 0, 0, synnode);
+        return finErrorKits::EC_SUCCESS;
+
+      case finSyntaxNode::TP_FUNCTION:
+        return this->lowerFunction(synnode);
+
+      case finSyntaxNode::TP_BRANCH:
+        return this->lowerBranch(synnode);
+
+      case finSyntaxNode::TP_LOOP:
+        return this->lowerLoop(synnode);
+
+      case finSyntaxNode::TP_LABEL:
+        return this->lowerLabel(synnode);
+
+      case finSyntaxNode::TP_JUMP:
+        return this->lowerJump(synnode);
+
+      default:
+        return this->lowerTreeExec(synnode);
+    }
+}
+
+finErrorCode finExecCompiler::lowerTreeExec(finSyntaxNode *synnode)
+{
+    int nodeidx = this->_lowerCode->appendSyntaxNode(synnode);
+    this->emitInst(finExecBytecode::BC_TREE_EXEC, nodeidx, 0, synnode);
+    return finErrorKits::EC_SUCCESS;
+}
+
+finErrorCode finExecCompiler::lowerStatIn(finSyntaxNode *synnode)
+{
+    finErrorCode errcode;
+    LowerBlock block;
+    block._synNode = synnode;
+    block._envDepth = this->_lowerEnvDepth;
+
+    this->_lowerBlocks.append(block);
+    int blockidx = this->_lowerBlocks.count() - 1;
+
+    if ( synnode->getSubListCount() <= 0 )
+        this->emitInst(finExecBytecode::BC_CLEAR_RESULT, 0, 0, synnode);
+
+    for ( int i = 0; i < synnode->getSubListCount(); i++ ) {
+        this->_lowerBlocks[blockidx]._childPos.append(this->_lowerCode->getInstructionCount());
+
+        errcode = this->lowerStatement(synnode->getSubSyntaxNode(i));
+        if ( finErrorKits::isErrorResult(errcode) )
+            return errcode;
+    }
+
+    const LowerBlock &doneblock = this->_lowerBlocks.at(blockidx);
+    for ( int i = 0; i < doneblock._gotoFixups.count(); i++ ) {
+        const QPair<int, int> &fixup = doneblock._gotoFixups.at(i);
+        this->_lowerCode->setInstructionArg(fixup.first, doneblock._childPos.at(fixup.second));
+    }
+    this->_lowerBlocks.removeLast();
+    return finErrorKits::EC_SUCCESS;
+}
+
+finErrorCode finExecCompiler::lowerStatBlock(finSyntaxNode *synnode)
+{
+    finErrorCode errcode;
+    finLexNode *lexnode = synnode->getCommandLexNode();
+
+    if ( lexnode->getType() != finLexNode::TP_OPERATOR ||
+         lexnode->getOperator() != finLexNode::OP_L_FLW_BRCKT )
+        return this->lowerStatIn(synnode);
+
+    this->emitInst(finExecBytecode::BC_ENTER_ENV, 0, 0, synnode);
+    this->enterLowerScope(synnode);
+    errcode = this->lowerStatIn(synnode);
+    if ( finErrorKits::isErrorResult(errcode) )
+        return errcode;
+    this->leaveLowerScope();
+    this->emitInst(finExecBytecode::BC_LEAVE_ENV, 0, 0, synnode);
+    return finErrorKits::EC_SUCCESS;
+}
+
+bool finExecCompiler::isLowerableDeclare(finSyntaxNode *synnode)
+{
+    finLexNode *lexnode = synnode->getCommandLexNode();
+
+    if ( synnode->getType() != finSyntaxNode::TP_EXPRESS )
+        return false;
+
+    if ( lexnode->getType() == finLexNode::TP_VARIABLE )
+        return true;
+    if ( lexnode->getType() != finLexNode::TP_OPERATOR )
+        return false;
+
+    if ( lexnode->getOperator() == finLexNode::OP_LET ) {
+        if ( synnode->getSubListCount() < 2 )
+            return false;
+
+        finSyntaxNode *varnode = synnode->getSubSyntaxNode(0);
+        return (varnode->getType() == finSyntaxNode::TP_EXPRESS &&
+                varnode->getCommandLexNode()->getType() == finLexNode::TP_VARIABLE);
+    } else if ( lexnode->getOperator() == finLexNode::OP_COMMA ) {
+        if ( synnode->getSubListCount() < 1 )
+            return false;
+
+        for ( int i = 0; i < synnode->getSubListCount(); i++ ) {
+            if ( !this->isLowerableDeclare(synnode->getSubSyntaxNode(i)) )
+                return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+finErrorCode finExecCompiler::lowerDeclare(finSyntaxNode *synnode)
+{
+    // Malformed declarations are left to the tree walker, which reports them at run time.
+    if ( synnode->getSubListCount() != 1 || !this->isLowerableDeclare(synnode->getSubSyntaxNode(0)) )
+        return this->lowerTreeExec(synnode);
+
+    return this->lowerDeclareExpr(synnode->getSubSyntaxNode(0));
+}
+
+finErrorCode finExecCompiler::lowerDeclareExpr(finSyntaxNode *synnode)
+{
+    finErrorCode errcode;
+    finLexNode *lexnode = synnode->getCommandLexNode();
+
+    const QHash<QString, int> &slotmap = this->_lowerScopes.last()._slotMap;
+
+    if ( lexnode->getType() == finLexNode::TP_VARIABLE ) {
+        int nodeidx = this->_lowerCode->appendSyntaxNode(synnode);
+        this->emitInst(finExecBytecode::BC_DECLARE, nodeidx, slotmap.value(lexnode->getString(), -1), synnode);
+    } else if ( lexnode->getOperator() == finLexNode::OP_LET ) {
+        finSyntaxNode *varnode = synnode->getSubSyntaxNode(0);
+        QString varname = varnode->getCommandLexNode()->getString();
+        int nameidx = this->_lowerCode->appendName(varname);
+        int nodeidx = this->_lowerCode->appendSyntaxNode(varnode);
+
+        this->emitInst(finExecBytecode::BC_DECLARE_CHECK, nameidx, 0, synnode);
+        errcode = this->lowerExpress(synnode->getSubSyntaxNode(1));
+        if ( finErrorKits::isErrorResult(errcode) )
+            return errcode;
+        this->emitInst(finExecBytecode::BC_DECLARE_INIT, nameidx, nodeidx, slotmap.value(varname, -1), synnode);
+    } else {
+        for ( int i = 0; i < synnode->getSubListCount(); i++ ) {
+            errcode = this->lowerDeclareExpr(synnode->getSubSyntaxNode(i));
+            if ( finErrorKits::isErrorResult(errcode) )
+                return errcode;
+        }
+    }
+    return finErrorKits::EC_SUCCESS;
+}
+
+finErrorCode finExecCompiler::lowerExpress(finSyntaxNode *synnode, bool store)
+{
+    finErrorCode errcode;
+    finLexNode *lexnode = synnode->getCommandLexNode();
+
+    if ( synnode->getType() != finSyntaxNode::TP_EXPRESS )
+        goto tree_eval;
+
+    switch ( lexnode->getType() ) {
+      case finLexNode::TP_DUMMY:
+        this->emitInst(finExecBytecode::BC_PUSH_NULL, 0, 0, synnode);
+        return finErrorKits::EC_SUCCESS;
+
+      case finLexNode::TP_VARIABLE:
+      {
+        int depth, slot;
+        int nameidx = this->_lowerCode->appendName(lexnode->getString());
+        if ( this->resolveVariableSlot(lexnode->getString(), &depth, &slot) )
+            this->emitInst(finExecBytecode::BC_LOAD_SLOT, nameidx, depth, slot, synnode);
+        else
+            this->emitInst(finExecBytecode::BC_LOAD_VAR, nameidx, 0, synnode);
+        return finErrorKits::EC_SUCCESS;
+      }
+
+      case finLexNode::TP_DECIMAL:
+        this->emitInst(finExecBytecode::BC_PUSH_NUM,
+                       this->_lowerCode->appendNumericConst(lexnode->getFloatValue()), 0, synnode);
+        return finErrorKits::EC_SUCCESS;
+
+      case finLexNode::TP_STRING:
+        this->emitInst(finExecBytecode::BC_PUSH_STR,
+                       this->_lowerCode->appendStringConst(lexnode->getStringValue()), 0, synnode);
+        return finErrorKits::EC_SUCCESS;
+
+      case finLexNode::TP_OPERATOR:
+        if ( lexnode->getOperator() == finLexNode::OP_FUNCTION )
+            return this->lowerExprFunc(synnode);
+        if ( synnode->isOperatorExpress(finLexNode::OP_LET, 2) &&
+             synnode->getSubSyntaxNode(0)->isOperatorExpress(finLexNode::OP_ACCESS, 2) )
+            return this->lowerExprItem(synnode, true);
+        if ( !store && synnode->isOperatorExpress(finLexNode::OP_ACCESS, 2) )
+            return this->lowerExprItem(synnode, false);
+
+        for ( int i = 0; i < synnode->getSubListCount(); i++ ) {
+            errcode = this->lowerExpress(synnode->getSubSyntaxNode(i),
+                                         finExecOperartorCalc::isStoreOperand(lexnode->getOperator(), i, store));
+            if ( finErrorKits::isErrorResult(errcode) )
+                return errcode;
+        }
+        this->emitInst(finExecBytecode::BC_CALC, finExecOperartorCalc::findOpCalcIdx(lexnode->getOperator()),
+                       synnode->getSubListCount(), (int)lexnode->getOperator(), synnode);
+        return finErrorKits::EC_SUCCESS;
+
+      default:
+        break;
+    }
+
+tree_eval:
+    this->emitInst(finExecBytecode::BC_TREE_EVAL, this->_lowerCode->appendSyntaxNode(synnode), 0, synnode);
+    return finErrorKits::EC_SUCCESS;
+}
+
+finErrorCode finExecCompiler::lowerExprItem(finSyntaxNode *synnode, bool store)
+{
+    finErrorCode errcode;
+
+    // A store "a[i] = v" pushes the array (itself a store target), the index and the value.
+    if ( store ) {
+        finSyntaxNode *dstnode = synnode->getSubSyntaxNode(0);
+        errcode = this->lowerExpress(dstnode->getSubSyntaxNode(0), true);
+        if ( finErrorKits::isErrorResult(errcode) )
+            return errcode;
+        errcode = this->lowerExpress(dstnode->getSubSyntaxNode(1));
+        if ( finErrorKits::isErrorResult(errcode) )
+            return errcode;
+        errcode = this->lowerExpress(synnode->getSubSyntaxNode(1));
+        if ( finErrorKits::isErrorResult(errcode) )
+            return errcode;
+
+        this->emitInst(finExecBytecode::BC_STORE_ITEM, 0, 3, synnode);
+        return finErrorKits::EC_SUCCESS;
+    }
+
+    // A read such as m[i][j] pushes the innermost array followed by every index.
+    QList<finSyntaxNode *> idxnodes;
+    finSyntaxNode *basenode = synnode;
+    while ( basenode->isOperatorExpress(finLexNode::OP_ACCESS, 2) ) {
+        idxnodes.prepend(basenode->getSubSyntaxNode(1));
+        basenode = basenode->getSubSyntaxNode(0);
+    }
+
+    errcode = this->lowerExpress(basenode);
+    if ( finErrorKits::isErrorResult(errcode) )
+        return errcode;
+    for ( int i = 0; i < idxnodes.count(); i++ ) {
+        errcode = this->lowerExpress(idxnodes.at(i));
+        if ( finErrorKits::isErrorResult(errcode) )
+            return errcode;
+    }
+
+    this->emitInst(finExecBytecode::BC_LOAD_ITEM, 0, idxnodes.count() + 1, synnode);
+    return finErrorKits::EC_SUCCESS;
+}
+
+finErrorCode finExecCompiler::lowerExprFunc(finSyntaxNode *synnode)
+{
+    finErrorCode errcode;
+    finSyntaxNode *fnsynn, *argsynn, *insynn;
+    finLexNode *fnlexn, *arglexn, *inlexn;
+    int argcnt = 0;
+
+    if ( synnode->getSubListCount() != 2 )
+        goto tree_eval;
+
+    fnsynn = synnode->getSubSyntaxNode(0);
+    fnlexn = fnsynn->getCommandLexNode();
+    if ( fnsynn->getType() != finSyntaxNode::TP_EXPRESS || fnlexn->getType() != finLexNode::TP_VARIABLE )
+        goto tree_eval;
+
+    argsynn = synnode->getSubSyntaxNode(1);
+    arglexn = argsynn->getCommandLexNode();
+    if ( argsynn->getType() != finSyntaxNode::TP_EXPRESS ||
+         arglexn->getType() != finLexNode::TP_OPERATOR || arglexn->getOperator() != finLexNode::OP_L_RND_BRCKT )
+        goto tree_eval;
+
+    if ( argsynn->getSubListCount() > 0 ) {
+        insynn = argsynn->getSubSyntaxNode(0);
+        inlexn = insynn->getCommandLexNode();
+        if ( insynn->getType() != finSyntaxNode::TP_EXPRESS )
+            goto tree_eval;
+
+        if ( inlexn->getType() == finLexNode::TP_OPERATOR && inlexn->getOperator() == finLexNode::OP_COMMA ) {
+            for ( int i = 0; i < insynn->getSubListCount(); i++ ) {
+                errcode = this->lowerExpress(insynn->getSubSyntaxNode(i));
+                if ( finErrorKits::isErrorResult(errcode) )
+                    return errcode;
+                argcnt++;
+            }
+        } else {
+            errcode = this->lowerExpress(insynn);
+            if ( finErrorKits::isErrorResult(errcode) )
+                return errcode;
+            argcnt++;
+        }
+    }
+
+    this->emitInst(finExecBytecode::BC_CALL, this->_lowerCode->appendName(fnlexn->getString()), argcnt, synnode);
+    return finErrorKits::EC_SUCCESS;
+
+tree_eval:
+    this->emitInst(finExecBytecode::BC_TREE_EVAL, this->_lowerCode->appendSyntaxNode(synnode), 0, synnode);
+    return finErrorKits::EC_SUCCESS;
+}
+
+finErrorCode finExecCompiler::lowerFunction(finSyntaxNode *synnode)
+{
+    // The definition itself is still built by the machine at run time; only the body is lowered.
+    this->emitInst(finExecBytecode::BC_DEF_FUNC, this->_lowerCode->appendSyntaxNode(synnode), 0, synnode);
+
+    if ( synnode->getSubListCount() >= 3 &&
+         synnode->getSubSyntaxNode(2)->getType() == finSyntaxNode::TP_STATEMENT )
+        this->_lowerFuncNodes.append(synnode);
+    return finErrorKits::EC_SUCCESS;
+}
+
+finSyntaxNode *finExecCompiler::getCondition(finSyntaxNode *synnode)
+{
+    if ( synnode == nullptr )
+        return nullptr;
+
+    finLexNode *lexnode = synnode->getCommandLexNode();
+    if ( lexnode->getType() == finLexNode::TP_OPERATOR &&
+         lexnode->getOperator() == finLexNode::OP_L_RND_BRCKT ) {
+        if ( synnode->getSubListCount() < 1 )
+            return nullptr;
+        return synnode->getSubSyntaxNode(0);
+    }
+    return synnode;
+}
+
+finErrorCode finExecCompiler::lowerBranch(finSyntaxNode *synnode)
+{
+    finErrorCode errcode;
+    QList<int> endfixups;
+    int bridx;
+
+    for ( bridx = 0; bridx + 1 < synnode->getSubListCount(); bridx += 2 ) {
+        if ( synnode->getSubSyntaxNode(bridx)->getType() != finSyntaxNode::TP_EXPRESS )
+            return this->lowerTreeExec(synnode);
+    }
+
+    for ( bridx = 0; bridx + 1 < synnode->getSubListCount(); bridx += 2 ) {
+        // An empty condition is always false, so its branch body can never run.
+        finSyntaxNode *condnode = this->getCondition(synnode->getSubSyntaxNode(bridx));
+        if ( condnode == nullptr )
+            continue;
+
+        errcode = this->lowerExpress(condnode);
+        if ( finErrorKits::isErrorResult(errcode) )
+            return errcode;
+        int falsejump = this->emitInst(finExecBytecode::BC_JUMP_FALSE, -1, 0, synnode);
+
+        errcode = this->lowerStatement(synnode->getSubSyntaxNode(bridx + 1));
+        if ( finErrorKits::isErrorResult(errcode) )
+            return errcode;
+        endfixups.append(this->emitInst(finExecBytecode::BC_JUMP, -1, 0, synnode));
+
+        this->_lowerCode->setInstructionArg(falsejump, this->_lowerCode->getInstructionCount());
+    }
+
+    if ( bridx < synnode->getSubListCount() ) {
+        errcode = this->lowerStatement(synnode->getSubSyntaxNode(bridx));
+        if ( finErrorKits::isErrorResult(errcode) )
+            return errcode;
+    } else {
+        this->emitInst(finExecBytecode::BC_CLEAR_RESULT, 0, 0, synnode);
+    }
+
+    this->patchJumps(endfixups, this->_lowerCode->getInstructionCount());
+    return finErrorKits::EC_SUCCESS;
+}
+
+finErrorCode finExecCompiler::lowerLoopWhile(finSyntaxNode *synnode)
+{
+    finErrorCode errcode;
+
+    if ( synnode->getSubListCount() < 2 ||
+         synnode->getSubSyntaxNode(0)->getType() != finSyntaxNode::TP_EXPRESS )
+        return this->lowerTreeExec(synnode);
+
+    int toppos = this->_lowerCode->getInstructionCount();
+    int exitjump = -1;
+
+    // An empty condition is always true.
+    finSyntaxNode *condnode = this->getCondition(synnode->getSubSyntaxNode(0));
+    if ( condnode != nullptr ) {
+        errcode = this->lowerExpress(condnode);
+        if ( finErrorKits::isErrorResult(errcode) )
+            return errcode;
+        exitjump = this->emitInst(finExecBytecode::BC_LOOP_EXIT, -1, 0, synnode);
+    }
+
+    LowerLoop loop;
+    loop._envDepth = this->_lowerEnvDepth;
+    this->_lowerLoops.append(loop);
+
+    errcode = this->lowerStatement(synnode->getSubSyntaxNode(1));
+    if ( finErrorKits::isErrorResult(errcode) )
+        return errcode;
+    this->emitInst(finExecBytecode::BC_JUMP, toppos, 0, synnode);
+
+    int endpos = this->_lowerCode->getInstructionCount();
+    if ( exitjump >= 0 )
+        this->_lowerCode->setInstructionArg(exitjump, endpos);
+
+    loop = this->_lowerLoops.takeLast();
+    this->patchJumps(loop._breakFixups, endpos);
+    this->patchJumps(loop._contiFixups, toppos);
+    return finErrorKits::EC_SUCCESS;
+}
+
+finErrorCode finExecCompiler::lowerLoopFor(finSyntaxNode *synnode)
+{
+    finErrorCode errcode;
+    finSyntaxNode *headsn, *initsn, *condsn, *stepsn, *bodysn;
+    finLexNode *headlex, *condlex;
+
+    // Anything instExecLoopForHead() would reject is handed to the tree walker unchanged.
+    if ( synnode->getSubListCount() < 2 )
+        return this->lowerTreeExec(synnode);
+
+    headsn = synnode->getSubSyntaxNode(0);
+    headlex = headsn->getCommandLexNode();
+    if ( headsn->getType() != finSyntaxNode::TP_EXPRESS || headsn->getSubListCount() < 3 ||
+         headlex->getType() != finLexNode::TP_OPERATOR || headlex->getOperator() != finLexNode::OP_L_RND_BRCKT )
+        return this->lowerTreeExec(synnode);
+
+    initsn = headsn->getSubSyntaxNode(0);
+    if ( !finSyntaxNode::isStatementLevelType(initsn->getType()) )
+        return this->lowerTreeExec(synnode);
+
+    condsn = headsn->getSubSyntaxNode(1);
+    condlex = condsn->getCommandLexNode();
+    if ( condsn->getType() != finSyntaxNode::TP_STATEMENT ||
+         condlex->getType() != finLexNode::TP_OPERATOR || condlex->getOperator() != finLexNode::OP_SPLIT )
+        return this->lowerTreeExec(synnode);
+    if ( condsn->getSubListCount() < 1 ) {
+        condsn = nullptr;
+    } else {
+        condsn = condsn->getSubSyntaxNode(0);
+        if ( condsn->getType() != finSyntaxNode::TP_EXPRESS )
+            return this->lowerTreeExec(synnode);
+    }
+
+    stepsn = headsn->getSubSyntaxNode(2);
+    bodysn = synnode->getSubSyntaxNode(1);
+    if ( !finSyntaxNode::isStatementLevelType(bodysn->getType()) )
+        return this->lowerTreeExec(synnode);
+
+    errcode = this->lowerStatement(initsn);
+    if ( finErrorKits::isErrorResult(errcode) )
+        return errcode;
+
+    int toppos = this->_lowerCode->getInstructionCount();
+    int exitjump = -1;
+
+    condsn = this->getCondition(condsn);
+    if ( condsn != nullptr ) {
+        errcode = this->lowerExpress(condsn);
+        if ( finErrorKits::isErrorResult(errcode) )
+            return errcode;
+        exitjump = this->emitInst(finExecBytecode::BC_LOOP_EXIT, -1, 0, synnode);
+    }
+
+    LowerLoop loop;
+    loop._envDepth = this->_lowerEnvDepth;
+    this->_lowerLoops.append(loop);
+
+    errcode = this->lowerStatement(bodysn);
+    if ( finErrorKits::isErrorResult(errcode) )
+        return errcode;
+
+    int steppos = this->_lowerCode->getInstructionCount();
+    errcode = this->lowerStatement(stepsn);
+    if ( finErrorKits::isErrorResult(errcode) )
+        return errcode;
+    this->emitInst(finExecBytecode::BC_JUMP, toppos, 0, synnode);
+
+    int endpos = this->_lowerCode->getInstructionCount();
+    if ( exitjump >= 0 )
+        this->_lowerCode->setInstructionArg(exitjump, endpos);
+
+    loop = this->_lowerLoops.takeLast();
+    this->patchJumps(loop._breakFixups, endpos);
+    this->patchJumps(loop._contiFixups, steppos);
+    return finErrorKits::EC_SUCCESS;
+}
+
+finErrorCode finExecCompiler::lowerLoop(finSyntaxNode *synnode)
+{
+    QString loophdstr = synnode->getCommandLexNode()->getString();
+
+    if ( QString::compare(loophdstr, QString("while")) == 0 )
+        return this->lowerLoopWhile(synnode);
+    else if ( QString::compare(loophdstr, QString("for")) == 0 )
+        return this->lowerLoopFor(synnode);
+    else
+        return this->lowerTreeExec(synnode);
+}
+
+finErrorCode finExecCompiler::lowerLabel(finSyntaxNode *synnode)
+{
+    if ( synnode->getCommandLexNode()->getType() != finLexNode::TP_VARIABLE )
+        return this->lowerTreeExec(synnode);
+
+    this->emitInst(finExecBytecode::BC_CLEAR_RESULT, 0, 0, synnode);
+    return finErrorKits::EC_SUCCESS;
+}
+
+finErrorCode finExecCompiler::lowerJumpGoto(finSyntaxNode *synnode)
+{
+    if ( synnode->getSubListCount() < 1 )
+        return this->lowerTreeExec(synnode);
+
+    finSyntaxNode *lblsynnode = synnode->getSubSyntaxNode(0);
+    finLexNode *lbllexnode = lblsynnode->getCommandLexNode();
+    if ( lblsynnode->getType() != finSyntaxNode::TP_EXPRESS || lbllexnode->getType() != finLexNode::TP_VARIABLE )
+        return this->lowerTreeExec(synnode);
+
+    // Same search order as the tree walker: the innermost enclosing statement list first. A resolved goto
+    // only has to find its target among the blocks.
+    finSyntaxNode *gototarget = synnode->getJumpTarget();
+    for ( int blockidx = this->_lowerBlocks.count() - 1; blockidx >= 0; blockidx-- ) {
+        finSyntaxNode *blocknode = this->_lowerBlocks.at(blockidx)._synNode;
+        int labelidx;
+        if ( gototarget != nullptr )
+            labelidx = (gototarget == blocknode ? synnode->getJumpLabelIdx() : -1);
+        else
+            labelidx = blocknode->findLabelIdx(lbllexnode->getString());
+        if ( labelidx < 0 )
+            continue;
+
+        this->emitInst(finExecBytecode::BC_CLEAR_RESULT, 0, 0, synnode);
+        this->emitLeaveEnv(this->_lowerBlocks.at(blockidx)._envDepth, synnode);
+        int jumpidx = this->emitInst(finExecBytecode::BC_JUMP, -1, 0, synnode);
+        this->_lowerBlocks[blockidx]._gotoFixups.append(qMakePair(jumpidx, labelidx));
+        return finErrorKits::EC_SUCCESS;
+    }
+
+    this->emitInst(finExecBytecode::BC_FLOW_ERROR, 0, 0, synnode);
+    return finErrorKits::EC_SUCCESS;
+}
+
+finErrorCode finExecCompiler::lowerJumpValue(finSyntaxNode *synnode, finExecOpCode opcode)
+{
+    finErrorCode errcode;
+
+    if ( synnode->getSubListCount() < 1 ) {
+        this->emitInst(opcode, 0, 0, synnode);
+        return finErrorKits::EC_SUCCESS;
+    }
+
+    finSyntaxNode *basesn = synnode->getSubSyntaxNode(0);
+    finLexNode *baseln = basesn->getCommandLexNode();
+    if ( basesn->getType() != finSyntaxNode::TP_EXPRESS )
+        return this->lowerTreeExec(synnode);
+
+    if ( baseln->getType() == finLexNode::TP_OPERATOR &&
+         baseln->getOperator() == finLexNode::OP_L_RND_BRCKT ) {
+        if ( basesn->getSubListCount() < 1 ) {
+            this->emitInst(opcode, 0, 0, (opcode == finExecBytecode::BC_EXIT ? basesn : synnode));
+            return finErrorKits::EC_SUCCESS;
+        }
+        basesn = basesn->getSubSyntaxNode(0);
+    }
+
+    errcode = this->lowerExpress(basesn);
+    if ( finErrorKits::isErrorResult(errcode) )
+        return errcode;
+    this->emitInst(opcode, 1, 0, (opcode == finExecBytecode::BC_EXIT ? basesn : synnode));
+    return finErrorKits::EC_SUCCESS;
+}
+
+finErrorCode finExecCompiler::lowerJumpLoop(finSyntaxNode *synnode, bool isbreak)
+{
+    if ( this->_lowerLoops.empty() ) {
+        this->emitInst(finExecBytecode::BC_FLOW_ERROR, 0, 0, synnode);
+        return finErrorKits::EC_SUCCESS;
+    }
+
+    this->emitInst(finExecBytecode::BC_CLEAR_RESULT, 0, 0, synnode);
+    this->emitLeaveEnv(this->_lowerLoops.last()._envDepth, synnode);
+    int jumpidx = this->emitInst(finExecBytecode::BC_JUMP, -1, 0, synnode);
+    if ( isbreak )
+        this->_lowerLoops.last()._breakFixups.append(jumpidx);
+    else
+        this->_lowerLoops.last()._contiFixups.append(jumpidx);
+    return finErrorKits::EC_SUCCESS;
+}
+
+finErrorCode finExecCompiler::lowerJump(finSyntaxNode *synnode)
+{
+    QString jumpkw = synnode->getCommandLexNode()->getString();
+
+    if ( QString::compare(jumpkw, "goto") == 0 )
+        return this->lowerJumpGoto(synnode);
+    else if ( QString::compare(jumpkw, "return") == 0 )
+        return this->lowerJumpValue(synnode, finExecBytecode::BC_RETURN);
+    else if ( QString::compare(jumpkw, "exit") == 0 )
+        return this->lowerJumpValue(synnode, finExecBytecode::BC_EXIT);
+    else if ( QString::compare(jumpkw, "continue") == 0 )
+        return this->lowerJumpLoop(synnode, false);
+    else if ( QString::compare(jumpkw, "break") == 0 )
+        return this->lowerJumpLoop(synnode, true);
+    else
+        return this->lowerTreeExec(synnode);
+}
@@ -10,12 +10,19 @@
  *
  *  This header defines finExecCompiler, a small adapter used by the execution layer to feed script
  *  text into finSyntaxReader and retrieve the resulting finSyntaxTree. When compilation cannot produce
- *  a normal tree, the wrapper builds a fallback tree that carries syntax-error information.
+ *  a normal tree, the wrapper builds a fallback tree that carries syntax-error information. Successive
+ *  compiles of an edited script re-parse only the top-level statements the edit touched.
  */
 #ifndef FINEXECCOMPILER_H
 #define FINEXECCOMPILER_H
 
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QStringList>
+
 #include "finErrorCode.h"
+#include "finExecBytecode.h"
 #include "finSyntaxReader.h"
 #include "finSyntaxTree.h"
 
@@ -28,14 +35,39 @@
  *  setScriptCode() installs the source text, and compile() drives finSyntaxReader until it produces a
  *  finSyntaxTree or an error tree containing a diagnostic message.
  *
+ *  The compiler remembers the top-level nodes and statement boundaries of its last error-free parse.
+ *  The next compile() resumes reading at the last boundary before the first changed character, and stops
+ *  at the first boundary behind the edit where the old parse stood in the same state; the old nodes after
+ *  that point are reused with their source positions moved. The resulting tree is identical to the one a
+ *  full parse of the new script builds.
+ *
+ *  The top-level nodes are not copied into the returned tree: the tree shares them with the compiler
+ *  (finSyntaxNode::shareNode()), so an unchanged statement costs nothing on the next compile. A tree must
+ *  therefore be destroyed before the compiler, and should be destroyed before the next compile(), which
+ *  moves the source positions of the statements it reuses. A tree that is to be rewritten in place has to
+ *  call finSyntaxTree::detachSharedNodes() first.
+ *
  *  \see finSyntaxReader
  *  \see finSyntaxTree
  */
 class finExecCompiler
 {
 private:
-    QString _scriptCode;         //!< Script source text to be compiled on the next compile() call.
-    finSyntaxReader _synReader;  //!< Wrapped parser pipeline used to build the syntax tree.
+    QString _scriptCode;            //!< Script source text to be compiled on the next compile() call.
+    finExecObjectArena _nodeArena;  //!< Holds the nodes of the parser, of _incNodes and of the trees sharing them.
+    finSyntaxReader _synReader;     //!< Wrapped parser pipeline used to build the syntax tree.
+
+    /*! \struct finExecCompiler::IncrPoint
+     *  \brief A top-level statement boundary of the last parsed script.
+     */
+    struct IncrPoint {
+        finLexReader::Mark _lexMark;  //!< Lexer state right after the boundary.
+        int _nodeCnt;                 //!< Number of top-level nodes finished before the boundary.
+    };
+
+    QString _incScript;                //!< Script of the last error-free parse; empty if there is none.
+    QList<finSyntaxNode *> _incNodes;  //!< Its top-level nodes in source order, shared with the trees built.
+    QList<IncrPoint> _incPoints;       //!< Its statement boundaries, in ascending position.
 
 public:
     /*!
@@ -81,7 +113,106 @@ public:
      */
     finSyntaxTree *compile();
 
+    /*!
+     *  \brief Forgets the last parse, so that the next compile() reads the whole script.
+     */
+    void clearIncrementalState();
+
+    /*!
+     *  \brief Lowers a compiled syntax tree into VM bytecode.
+     *
+     *  The program and every user-function body found in it are lowered into \a bytecode; the function
+     *  bodies become code units owned by \a bytecode. Constructs that cannot be lowered are kept as
+     *  tree-walker escapes, so the lowered program behaves exactly like the syntax tree.
+     *
+     *  \param syntree   Syntax tree returned by compile(); must outlive \a bytecode.
+     *  \param bytecode  Empty code unit receiving the lowered program.
+     *  \return EC_SUCCESS, or an error code if the tree carries syntax errors or lowering failed.
+     */
+    finErrorCode lowerSyntaxTree(finSyntaxTree *syntree, finExecBytecode *bytecode);
+
 private:
+    /*! \struct finExecCompiler::LowerBlock
+     *  \brief Lowering state of one statement list, the scope in which \c goto looks for labels.
+     */
+    struct LowerBlock {
+        finSyntaxNode *_synNode;              //!< The statement list.
+        int _envDepth;                        //!< Environment depth of the statements in the list.
+        QList<int> _childPos;                 //!< Code position of each lowered child statement.
+        QList<QPair<int, int> > _gotoFixups;  //!< (jump instruction, target child index) pairs.
+    };
+
+    /*! \struct finExecCompiler::LowerLoop
+     *  \brief Lowering state of one loop, the target of \c break and \c continue.
+     */
+    struct LowerLoop {
+        int _envDepth;            //!< Environment depth of the loop statement.
+        QList<int> _breakFixups;  //!< Jumps to be patched to the loop exit.
+        QList<int> _contiFixups;  //!< Jumps to be patched to the loop continuation point.
+    };
+
+    /*! \struct finExecCompiler::LowerScope
+     *  \brief Resolver state of one runtime environment opened by the current code unit.
+     */
+    struct LowerScope {
+        QHash<QString, int> _slotMap;  //!< Slot index of every name that may be declared in the scope.
+    };
+
+    finExecBytecode *_lowerCode;             //!< Code unit currently being emitted.
+    int _lowerEnvDepth;                      //!< Environments opened so far in the current code unit.
+    QList<LowerScope> _lowerScopes;          //!< Scope of each environment depth, outermost first.
+    QList<LowerBlock> _lowerBlocks;          //!< Enclosing statement lists, innermost last.
+    QList<LowerLoop> _lowerLoops;            //!< Enclosing loops, innermost last.
+    QList<finSyntaxNode *> _lowerFuncNodes;  //!< Function definitions whose bodies are not lowered yet.
+
+    /*! \name Bytecode Lowering Helpers
+     *  \brief Lower one syntax-node kind into the current code unit.
+     */
+    ///@{
+    finErrorCode lowerCodeUnit(finSyntaxNode *synnode, const QStringList &paramnames, finExecBytecode *bytecode);
+    bool getFuncParamNames(finSyntaxNode *synnode, QStringList *paramnames);
+    int emitInst(finExecOpCode opcode, int arg1, int arg2, finSyntaxNode *synnode);
+    int emitInst(finExecOpCode opcode, int arg1, int arg2, int arg3, finSyntaxNode *synnode);
+    int emitLeaveEnv(int envdepth, finSyntaxNode *synnode);
+    void patchJumps(const QList<int> &fixups, int target);
+
+    void enterLowerScope(finSyntaxNode *synnode);
+    void leaveLowerScope();
+    void collectScopeNames(finSyntaxNode *synnode, bool isroot, LowerScope *scope);
+    void collectDeclareNames(finSyntaxNode *synnode, LowerScope *scope);
+    bool resolveVariableSlot(const QString &varname, int *depth, int *slot);
+
+    finErrorCode lowerStatement(finSyntaxNode *synnode);
+    finErrorCode lowerTreeExec(finSyntaxNode *synnode);
+    finErrorCode lowerStatIn(finSyntaxNode *synnode);
+    finErrorCode lowerStatBlock(finSyntaxNode *synnode);
+    bool isLowerableDeclare(finSyntaxNode *synnode);
+    finErrorCode lowerDeclare(finSyntaxNode *synnode);
+    finErrorCode lowerDeclareExpr(finSyntaxNode *synnode);
+    finErrorCode lowerExpress(finSyntaxNode *synnode, bool store = false);
+    finErrorCode lowerExprItem(finSyntaxNode *synnode, bool store);
+    finErrorCode lowerExprFunc(finSyntaxNode *synnode);
+    finErrorCode lowerFunction(finSyntaxNode *synnode);
+    finSyntaxNode *getCondition(finSyntaxNode *synnode);
+    finErrorCode lowerBranch(finSyntaxNode *synnode);
+    finErrorCode lowerLoopWhile(finSyntaxNode *synnode);
+    finErrorCode lowerLoopFor(finSyntaxNode *synnode);
+    finErrorCode lowerLoop(finSyntaxNode *synnode);
+    finErrorCode lowerLabel(finSyntaxNode *synnode);
+    finErrorCode lowerJumpGoto(finSyntaxNode *synnode);
+    finErrorCode lowerJumpValue(finSyntaxNode *synnode, finExecOpCode opcode);
+    finErrorCode lowerJumpLoop(finSyntaxNode *synnode, bool isbreak);
+    finErrorCode lowerJump(finSyntaxNode *synnode);
+    ///@}
+
+    /*!
+     *  \brief Parses the stored script into _incNodes, reusing what the edit left intact.
+     *
+     *  \return The syntax errors recorded while reading.
+     *  \throws finException if the script cannot be parsed.
+     */
+    QList<finSyntaxError> readIncremental();
+
     /*!
      *  \brief Builds a fallback syntax tree containing one syntax error.
      *
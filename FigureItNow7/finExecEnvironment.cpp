@@ -10,7 +10,7 @@
  *  \brief Implementations of the runtime environment and scope-chain container.
  *
  *  Provides the environment object that owns runtime variables and functions, resolves names through
- *  parent links, tracks function-call ownership, and manages the lazily initialized root environment.
+ *  parent links, tracks function-call ownership, and manages the lazily built, read-only root environment.
  */
 
 #include "finExecEnvironment.h"
@@ -21,6 +21,7 @@
 #include "finExecFunction.h"
 #include "finExecMachine.h"
 #include "finExecOperartorCalc.h"
+#include "finSymbolTable.h"
 
 
 finExecEnvironment::finExecEnvironment()
@@ -28,6 +29,9 @@ finExecEnvironment::finExecEnvironment()
     this->_envName = QString("");
     this->_varList.clear();
     this->_funcList.clear();
+    this->_slotList.clear();
+    this->_sysVarList.clear();
+    this->_readOnly = false;
     this->_belongFunc = nullptr;
     this->_figContainer = nullptr;
     this->_prevEnv = nullptr;
@@ -35,16 +39,39 @@ finExecEnvironment::finExecEnvironment()
 
 finExecEnvironment::~finExecEnvironment()
 {
-    while ( !this->_varList.empty() ) {
-        finExecVariable *evar = this->_varList.first();
-        this->_varList.remove(evar->getName());
-        delete evar;
-    }
-    while ( !this->_funcList.empty() ) {
-        finExecFunction *efunc = this->_funcList.first();
-        this->_funcList.remove(efunc->getFunctionName());
-        delete efunc;
-    }
+    this->_slotList.clear();
+
+    // Detach the maps first, so the destructors below never see a half-emptied environment.
+    QHash<int, finExecVariable *> varlist;
+    varlist.swap(this->_varList);
+    qDeleteAll(varlist);
+
+    QHash<int, finExecFunction *> funclist;
+    funclist.swap(this->_funcList);
+    qDeleteAll(funclist);
+
+    // Last, as the variables above may still have been linked to these.
+    QHash<int, finExecVariable *> sysvarlist;
+    sysvarlist.swap(this->_sysVarList);
+    qDeleteAll(sysvarlist);
+}
+
+void *finExecEnvironment::operator new(size_t size)
+{
+    return finExecEnvironment::getObjectPool()->allocate(size);
+}
+
+void finExecEnvironment::operator delete(void *ptr, size_t size)
+{
+    finExecEnvironment::getObjectPool()->release(ptr, size);
+}
+
+finExecObjectPool *finExecEnvironment::getObjectPool()
+{
+    // Never destroyed, so the root environment can still be released during static destruction.
+    static finExecObjectPool *envpool =
+            new finExecObjectPool(QString("environment"), sizeof (finExecEnvironment), 1024);
+    return envpool;
 }
 
 finErrorCode
@@ -61,6 +88,16 @@ finExecEnvironment::buildChildEnvironment(finExecEnvironment **chdenv)
     newchdenv->_figContainer = this->_figContainer;
     newchdenv->_prevEnv = this;
 
+    // A global scope copies every system variable of the root up front, so its lookups never write to it
+    // and plot workers below it may resolve names concurrently.
+    if ( this->_readOnly ) {
+        foreach ( int varnameid, this->_varList.keys() ) {
+            finExecVariable *sysvar = finExecVariable::buildSystemVariable(varnameid);
+            if ( sysvar != nullptr )
+                newchdenv->_sysVarList.insert(varnameid, sysvar);
+        }
+    }
+
     *chdenv = newchdenv;
     return finErrorKits::EC_SUCCESS;
 }
@@ -77,130 +114,206 @@ finExecEnvironment::setEnvironmentName(const QString &envname)
     this->_envName = envname;
 }
 
+bool
+finExecEnvironment::isReadOnly() const
+{
+    return this->_readOnly;
+}
+
 finExecVariable *
 finExecEnvironment::getVariableHere(const QString &varname)
 {
-    if ( varname.isEmpty() )
-        return nullptr;
-
-    return this->_varList.value(varname, nullptr);
+    return this->getVariableHere(finSymbolTable::findSymbolId(varname));
 }
 
 finExecVariable *
 finExecEnvironment::findVariable(const QString &varname)
 {
-    finExecVariable *retvar = this->getVariableHere(varname);
-    if ( retvar != nullptr )
-        return retvar;
+    return this->findVariable(finSymbolTable::findSymbolId(varname));
+}
 
-    if ( this->_prevEnv != nullptr )
-        return this->_prevEnv->findVariable(varname);
-    else
+finExecVariable *
+finExecEnvironment::findVariableUntil(const QString &varname, const QString &envname)
+{
+    return this->findVariableUntil(finSymbolTable::findSymbolId(varname), envname);
+}
+
+finExecVariable *
+finExecEnvironment::findVariableUntil(const QString &varname, finExecFunction *blngfunc)
+{
+    return this->findVariableUntil(finSymbolTable::findSymbolId(varname), blngfunc);
+}
+
+finExecVariable *
+finExecEnvironment::findVariableUntil(const QString &varname, int envlevel)
+{
+    return this->findVariableUntil(finSymbolTable::findSymbolId(varname), envlevel);
+}
+
+finExecFunction *
+finExecEnvironment::getFunctionHere(const QString &funcname)
+{
+    return this->getFunctionHere(finSymbolTable::findSymbolId(funcname));
+}
+
+finExecFunction *
+finExecEnvironment::findFunction(const QString &funcname)
+{
+    return this->findFunction(finSymbolTable::findSymbolId(funcname));
+}
+
+finExecFunction *
+finExecEnvironment::findFunctionUntil(const QString &funcname, const QString &envname)
+{
+    return this->findFunctionUntil(finSymbolTable::findSymbolId(funcname), envname);
+}
+
+finExecFunction *
+finExecEnvironment::findFunctionUntil(const QString &funcname, finExecFunction *blngfunc)
+{
+    return this->findFunctionUntil(finSymbolTable::findSymbolId(funcname), blngfunc);
+}
+
+finExecFunction *
+finExecEnvironment::findFunctionUntil(const QString &funcname, int envlevel)
+{
+    return this->findFunctionUntil(finSymbolTable::findSymbolId(funcname), envlevel);
+}
+
+finExecVariable *
+finExecEnvironment::getVariableHere(int varnameid)
+{
+    // An unknown or empty name has no ID, and nothing is ever stored under SYM_NONE.
+    if ( varnameid == finSymbolTable::SYM_NONE )
         return nullptr;
+
+    return this->_varList.value(varnameid, nullptr);
 }
 
 finExecVariable *
-finExecEnvironment::findVariableUntil(const QString &varname, const QString &envname)
+finExecEnvironment::findVariable(int varnameid)
 {
-    finExecVariable *retvar = this->getVariableHere(varname);
+    if ( varnameid == finSymbolTable::SYM_NONE )
+        return nullptr;
+
+    for ( finExecEnvironment *curenv = this; curenv != nullptr; curenv = curenv->_prevEnv ) {
+        finExecVariable *retvar = curenv->_varList.value(varnameid, nullptr);
+        if ( retvar != nullptr )
+            return retvar;
+
+        // The global scope answers for the shared root with copies of its own.
+        if ( curenv->_prevEnv != nullptr && curenv->_prevEnv->_readOnly )
+            return curenv->getSystemVariableCopy(varnameid);
+    }
+    return nullptr;
+}
+
+finExecVariable *
+finExecEnvironment::findVariableUntil(int varnameid, const QString &envname)
+{
+    finExecVariable *retvar = this->getVariableHere(varnameid);
     if ( retvar != nullptr )
         return retvar;
 
     if ( QString::compare(this->_envName, envname) != 0 && this->_prevEnv != nullptr )
-        return this->_prevEnv->findVariableUntil(varname, envname);
+        return (this->_prevEnv->_readOnly ? this->getSystemVariableCopy(varnameid)
+                                          : this->_prevEnv->findVariableUntil(varnameid, envname));
     else
         return nullptr;
 }
 
 finExecVariable *
-finExecEnvironment::findVariableUntil(const QString &varname, finExecFunction *blngfunc)
+finExecEnvironment::findVariableUntil(int varnameid, finExecFunction *blngfunc)
 {
-    finExecVariable *retvar = this->getVariableHere(varname);
+    finExecVariable *retvar = this->getVariableHere(varnameid);
     if ( retvar != nullptr )
         return retvar;
 
     if ( blngfunc != this->_belongFunc && this->_prevEnv != nullptr )
-        return this->_prevEnv->findVariableUntil(varname, blngfunc);
+        return (this->_prevEnv->_readOnly ? this->getSystemVariableCopy(varnameid)
+                                          : this->_prevEnv->findVariableUntil(varnameid, blngfunc));
     else
         return nullptr;
 }
 
 finExecVariable *
-finExecEnvironment::findVariableUntil(const QString &varname, int envlevel)
+finExecEnvironment::findVariableUntil(int varnameid, int envlevel)
 {
     if ( envlevel < 0 )
         return nullptr;
 
-    finExecVariable *retvar = this->getVariableHere(varname);
+    finExecVariable *retvar = this->getVariableHere(varnameid);
     if ( retvar != nullptr )
         return retvar;
 
     if ( envlevel > 0 && this->_prevEnv != nullptr )
-        return this->_prevEnv->findVariableUntil(varname, envlevel - 1);
+        return (this->_prevEnv->_readOnly ? this->getSystemVariableCopy(varnameid)
+                                          : this->_prevEnv->findVariableUntil(varnameid, envlevel - 1));
     else
         return nullptr;
 }
 
 finExecFunction *
-finExecEnvironment::getFunctionHere(const QString &funcname)
+finExecEnvironment::getFunctionHere(int funcnameid)
 {
-    if ( funcname.isEmpty() )
+    if ( funcnameid == finSymbolTable::SYM_NONE )
         return nullptr;
 
-    return this->_funcList.value(funcname, nullptr);
+    return this->_funcList.value(funcnameid, nullptr);
 }
 
 finExecFunction *
-finExecEnvironment::findFunction(const QString &funcname)
+finExecEnvironment::findFunction(int funcnameid)
 {
-    finExecFunction *retfunc = this->getFunctionHere(funcname);
-    if ( retfunc != nullptr )
-        return retfunc;
-
-    if ( this->_prevEnv != nullptr )
-        return this->_prevEnv->findFunction(funcname);
-    else
+    if ( funcnameid == finSymbolTable::SYM_NONE )
         return nullptr;
+
+    for ( finExecEnvironment *curenv = this; curenv != nullptr; curenv = curenv->_prevEnv ) {
+        finExecFunction *retfunc = curenv->_funcList.value(funcnameid, nullptr);
+        if ( retfunc != nullptr )
+            return retfunc;
+    }
+    return nullptr;
 }
 
 finExecFunction *
-finExecEnvironment::findFunctionUntil(const QString &funcname, const QString &envname)
+finExecEnvironment::findFunctionUntil(int funcnameid, const QString &envname)
 {
-    finExecFunction *retfunc = this->getFunctionHere(funcname);
+    finExecFunction *retfunc = this->getFunctionHere(funcnameid);
     if ( retfunc != nullptr )
         return retfunc;
 
     if ( QString::compare(this->_envName, envname) != 0 && this->_prevEnv != nullptr )
-        return this->_prevEnv->findFunctionUntil(funcname, envname);
+        return this->_prevEnv->findFunctionUntil(funcnameid, envname);
     else
         return nullptr;
 }
 
 finExecFunction *
-finExecEnvironment::findFunctionUntil(const QString &funcname, finExecFunction *blngfunc)
+finExecEnvironment::findFunctionUntil(int funcnameid, finExecFunction *blngfunc)
 {
-    finExecFunction *retfunc = this->getFunctionHere(funcname);
+    finExecFunction *retfunc = this->getFunctionHere(funcnameid);
     if ( retfunc != nullptr )
         return retfunc;
 
     if ( blngfunc != this->_belongFunc && this->_prevEnv != nullptr )
-        return this->_prevEnv->findFunctionUntil(funcname, blngfunc);
+        return this->_prevEnv->findFunctionUntil(funcnameid, blngfunc);
     else
         return nullptr;
 }
 
 finExecFunction *
-finExecEnvironment::findFunctionUntil(const QString &funcname, int envlevel)
+finExecEnvironment::findFunctionUntil(int funcnameid, int envlevel)
 {
     if ( envlevel < 0 )
         return nullptr;
 
-    finExecFunction *retfunc = this->getFunctionHere(funcname);
+    finExecFunction *retfunc = this->getFunctionHere(funcnameid);
     if ( retfunc != nullptr )
         return retfunc;
 
     if ( envlevel > 0 && this->_prevEnv != nullptr )
-        return this->_prevEnv->findFunctionUntil(funcname, envlevel - 1);
+        return this->_prevEnv->findFunctionUntil(funcnameid, envlevel - 1);
     else
         return nullptr;
 }
@@ -233,17 +346,17 @@ finExecEnvironment::addVariable(finExecVariable *var)
 {
     if ( var == nullptr )
         return finErrorKits::EC_NULL_POINTER;
-    if ( !var->isLeftValue() )
+    if ( this->_readOnly || !var->isLeftValue() )
         return finErrorKits::EC_STATE_ERROR;
 
-    if ( var->getName().isEmpty() )
+    if ( var->getNameId() == finSymbolTable::SYM_NONE )
         return finErrorKits::EC_INVALID_PARAM;
 
-    finExecVariable *oldvar = this->getVariableHere(var->getName());
+    finExecVariable *oldvar = this->getVariableHere(var->getNameId());
     if ( oldvar != nullptr )
         return finErrorKits::EC_CONTENTION;
 
-    this->_varList.insert(var->getName(), var);
+    this->_varList.insert(var->getNameId(), var);
     return finErrorKits::EC_SUCCESS;
 }
 
@@ -252,14 +365,16 @@ finExecEnvironment::addFunction(finExecFunction *func)
 {
     if ( func == nullptr )
         return finErrorKits::EC_NULL_POINTER;
-    if ( func->getFunctionName().isEmpty() )
+    if ( this->_readOnly )
+        return finErrorKits::EC_STATE_ERROR;
+    if ( func->getFunctionNameId() == finSymbolTable::SYM_NONE )
         return finErrorKits::EC_INVALID_PARAM;
 
-    finExecFunction *oldfunc = this->getFunctionHere(func->getFunctionName());
+    finExecFunction *oldfunc = this->getFunctionHere(func->getFunctionNameId());
     if ( oldfunc != nullptr )
         return finErrorKits::EC_CONTENTION;
 
-    this->_funcList.insert(func->getFunctionName(), func);
+    this->_funcList.insert(func->getFunctionNameId(), func);
     return finErrorKits::EC_SUCCESS;
 }
 
@@ -267,11 +382,17 @@ finErrorCode finExecEnvironment::removeVariable(finExecVariable *var)
 {
     if ( var == nullptr )
         return finErrorKits::EC_NULL_POINTER;
-    finExecVariable *envvar = this->_varList.value(var->getName(), nullptr);
+    if ( this->_readOnly )
+        return finErrorKits::EC_STATE_ERROR;
+    finExecVariable *envvar = this->_varList.value(var->getNameId(), nullptr);
     if ( envvar != var )
         return finErrorKits::EC_NOT_FOUND;
 
-    this->_varList.remove(var->getName());
+    this->_varList.remove(var->getNameId());
+
+    int slotidx = this->_slotList.indexOf(var);
+    if ( slotidx >= 0 )
+        this->_slotList[slotidx] = nullptr;
     return finErrorKits::EC_SUCCESS;
 }
 
@@ -279,11 +400,13 @@ finErrorCode finExecEnvironment::removeFunction(finExecFunction *func)
 {
     if ( func == nullptr )
         return finErrorKits::EC_NULL_POINTER;
-    finExecFunction *envfunc = this->_funcList.value(func->getFunctionName(), nullptr);
+    if ( this->_readOnly )
+        return finErrorKits::EC_STATE_ERROR;
+    finExecFunction *envfunc = this->_funcList.value(func->getFunctionNameId(), nullptr);
     if ( envfunc != func )
         return finErrorKits::EC_NOT_FOUND;
 
-    this->_funcList.remove(func->getFunctionName());
+    this->_funcList.remove(func->getFunctionNameId());
     return finErrorKits::EC_SUCCESS;
 }
 
@@ -297,6 +420,30 @@ QList<finExecFunction *> finExecEnvironment::getAllFunctionList()
     return this->_funcList.values();
 }
 
+finExecVariable *finExecEnvironment::getVariableAtSlot(int slot) const
+{
+    if ( slot < 0 || slot >= this->_slotList.count() )
+        return nullptr;
+    return this->_slotList.at(slot);
+}
+
+finErrorCode finExecEnvironment::bindVariableSlot(int slot, finExecVariable *var)
+{
+    if ( var == nullptr )
+        return finErrorKits::EC_NULL_POINTER;
+    if ( slot < 0 )
+        return finErrorKits::EC_INVALID_PARAM;
+    if ( this->_readOnly )
+        return finErrorKits::EC_STATE_ERROR;
+    if ( this->_varList.value(var->getNameId(), nullptr) != var )
+        return finErrorKits::EC_NOT_FOUND;
+
+    while ( this->_slotList.count() <= slot )
+        this->_slotList.append(nullptr);
+    this->_slotList[slot] = var;
+    return finErrorKits::EC_SUCCESS;
+}
+
 finExecFunction *finExecEnvironment::getBelongFunctionHere() const
 {
     return this->_belongFunc;
@@ -461,49 +608,35 @@ finExecEnvironment::setParentEnvironment(finExecEnvironment *prevenv)
     return finErrorKits::EC_SUCCESS;
 }
 
-finExecEnvironment *finExecEnvironment::_rootEnv = nullptr;
-
-finErrorCode
-finExecEnvironment::setupRootEnvironment()
+finExecEnvironment *
+finExecEnvironment::getRootEnvironment()
 {
-    if ( _rootEnv != nullptr )
-        return finErrorKits::EC_DUPLICATE_OP;
-
-    _rootEnv = new finExecEnvironment();
-    if ( _rootEnv == nullptr )
-        return finErrorKits::EC_OUT_OF_MEMORY;
-
-    _rootEnv->setEnvironmentName(QString("root"));
-    finExecVariable::installSystemVariables(_rootEnv);
-    finExecFunction::installSystemFunctions(_rootEnv);
-    _rootEnv->setFigureContainer(nullptr);
-    _rootEnv->setParentEnvironment(nullptr);
-
-    return finErrorKits::EC_SUCCESS;
+    // Built under the thread-safe static initialization and never changed, nor destroyed, afterwards.
+    static finExecEnvironment *const rootenv = []() {
+        finExecEnvironment *newrootenv = new finExecEnvironment();
+        newrootenv->setEnvironmentName(QString("root"));
+        finExecVariable::installSystemVariables(newrootenv);
+        finExecFunction::installSystemFunctions(newrootenv);
+        newrootenv->setFigureContainer(nullptr);
+        newrootenv->setParentEnvironment(nullptr);
+        newrootenv->_readOnly = true;
+        return newrootenv;
+    }();
+    return rootenv;
 }
 
 finErrorCode
-finExecEnvironment::disposeRootEnvironment()
-{
-    if ( _rootEnv == nullptr )
-        return finErrorKits::EC_DUPLICATE_OP;
-
-    delete _rootEnv;
-    _rootEnv = nullptr;
-    return finErrorKits::EC_SUCCESS;
-}
-
-finExecEnvironment *
-finExecEnvironment::getRootEnvironment()
+finExecEnvironment::buildRootChildEnvironment(finExecEnvironment **chdenv)
 {
-    if ( _rootEnv == nullptr )
-        finExecEnvironment::setupRootEnvironment();
+    finExecEnvironment *rootenv = finExecEnvironment::getRootEnvironment();
+    if ( rootenv == nullptr )
+        return finErrorKits::EC_STATE_ERROR;
 
-    return _rootEnv;
+    return rootenv->buildChildEnvironment(chdenv);
 }
 
-finErrorCode
-finExecEnvironment::buildRootChildEnvironment(finExecEnvironment **chdenv)
+finExecVariable *
+finExecEnvironment::getSystemVariableCopy(int varnameid) const
 {
-    return _rootEnv->buildChildEnvironment(chdenv);
+    return this->_sysVarList.value(varnameid, nullptr);
 }
@@ -15,12 +15,14 @@
 #ifndef FINEXECENVIRONMENT_H
 #define FINEXECENVIRONMENT_H
 
-#include <QMap>
+#include <QHash>
+#include <QList>
 #include <QString>
 
 #include "finErrorCode.h"
 #include "finSyntaxNode.h"
 #include "finFigureContainer.h"
+#include "finExecPool.h"
 
 class finExecVariable;
 class finExecFunction;
@@ -36,7 +38,15 @@ class finExecMachine;
  *  used by the interpreter for names, function-call ownership, and figure-output propagation.
  *
  *  The class also manages a process-wide root environment that holds predefined system variables and
- *  functions. Script-specific environments are typically created as children of that root.
+ *  functions. Script-specific environments are typically created as children of that root. The root is
+ *  built once and is read-only from then on, so any number of threads may look names up in it without
+ *  locking. Each child of the root acts as the global scope of one script: when a lookup from below
+ *  reaches a system variable, the global scope hands out a private copy of it, so scripts never touch
+ *  a shared variable.
+ *
+ *  Variables and functions are keyed by the finSymbolTable ID of their names. The lookups taking a
+ *  symbol ID compare integers only; the ones taking a QString resolve the name to its ID once and then
+ *  do the same.
  *
  *  \see finExecVariable
  *  \see finExecFunction
@@ -46,15 +56,16 @@ class finExecEnvironment
 protected:
     QString _envName;                            //!< Human-readable environment name.
 
-    QMap<QString, finExecVariable *> _varList;   //!< Variables owned directly by this environment.
-    QMap<QString, finExecFunction *> _funcList;  //!< Functions owned directly by this environment.
+    QHash<int, finExecVariable *> _varList;      //!< Variables owned directly by this environment, by name ID.
+    QHash<int, finExecFunction *> _funcList;     //!< Functions owned directly by this environment, by name ID.
+    QList<finExecVariable *> _slotList;          //!< Variables of _varList bound to resolved slot indices.
+    QHash<int, finExecVariable *> _sysVarList;   //!< Private copies of the root's system variables, by name ID.
+    bool _readOnly;                              //!< Whether definitions can no longer be added or removed.
 
     finExecFunction *_belongFunc;                //!< Function-call owner of this environment, or \c nullptr.
     finFigureContainer *_figContainer;           //!< Figure container shared by the active execution chain.
     finExecEnvironment *_prevEnv;                //!< Parent environment used for scope lookup and nesting.
 
-    static finExecEnvironment *_rootEnv;         //!< Process-wide root environment with system definitions.
-
 public:
     /*!
      *  \brief Constructs an empty environment with no parent, owner function, or figure container.
@@ -66,6 +77,21 @@ public:
      */
     ~finExecEnvironment();
 
+    /*! \name Memory Pooling
+     *  \brief Environments are recycled through a finExecObjectPool instead of the general heap.
+     */
+    ///@{
+
+    /*! \brief Allocates an environment from the environment pool. */
+    static void *operator new(size_t size);
+
+    /*! \brief Returns an environment to the environment pool. */
+    static void operator delete(void *ptr, size_t size);
+
+    /*! \brief Returns the process-wide environment pool. */
+    static finExecObjectPool *getObjectPool();
+    ///@}
+
     /*! \name Environment Construction
      *  \brief Create derived environments and configure environment metadata.
      */
@@ -87,6 +113,9 @@ public:
 
     /*! \brief Sets this environment's name. */
     void setEnvironmentName(const QString &envname);
+
+    /*! \brief Returns whether the definitions of this environment are frozen, as in the root. */
+    bool isReadOnly() const;
     ///@}
 
     /*! \name Name Lookup
@@ -125,6 +154,22 @@ public:
     finExecFunction *findFunctionUntil(const QString &funcname, int evnlevel);
     ///@}
 
+    /*! \name Name Lookup by Symbol ID
+     *  \brief The lookups above, keyed by the finSymbolTable ID of the name.
+     */
+    ///@{
+    finExecVariable *getVariableHere(int varnameid);
+    finExecFunction *getFunctionHere(int funcnameid);
+    finExecVariable *findVariable(int varnameid);
+    finExecFunction *findFunction(int funcnameid);
+    finExecVariable *findVariableUntil(int varnameid, const QString &envname);
+    finExecFunction *findFunctionUntil(int funcnameid, const QString &envname);
+    finExecVariable *findVariableUntil(int varnameid, finExecFunction *blngfunc);
+    finExecFunction *findFunctionUntil(int funcnameid, finExecFunction *blngfunc);
+    finExecVariable *findVariableUntil(int varnameid, int envlevel);
+    finExecFunction *findFunctionUntil(int funcnameid, int envlevel);
+    ///@}
+
     /*! \name Ownership Queries
      *  \brief Check whether a variable or function belongs to this environment.
      */
@@ -167,6 +212,21 @@ public:
     QList<finExecFunction *> getAllFunctionList();
     ///@}
 
+    /*! \name Resolved Slots
+     *  \brief Index variables by the slot coordinates assigned when a script is lowered to bytecode.
+     *
+     *  A slot is only a second, array-indexed handle to a variable that is also stored by name, so
+     *  name lookup keeps working for dynamic consumers such as run_function and ext_arg.
+     */
+    ///@{
+
+    /*! \brief Returns the variable bound to \a slot, or \c nullptr if the slot is empty. */
+    finExecVariable *getVariableAtSlot(int slot) const;
+
+    /*! \brief Binds \a slot to a variable stored directly in this environment. */
+    finErrorCode bindVariableSlot(int slot, finExecVariable *var);
+    ///@}
+
     /*! \name Function-Call Ownership Introspection
      *  \brief Inspect the function ownership markers attached to the environment chain.
      */
@@ -228,24 +288,26 @@ public:
     ///@}
 
     /*! \name Root Environment Helpers
-     *  \brief Manage the process-wide root environment that stores system definitions.
+     *  \brief Access the process-wide, read-only root environment that stores system definitions.
      */
     ///@{
 
-    /*! \brief Allocates and initializes the root environment if it does not already exist. */
-    static finErrorCode setupRootEnvironment();
-
-    /*! \brief Destroys the root environment and releases its owned definitions. */
-    static finErrorCode disposeRootEnvironment();
-
-    /*! \brief Returns the root environment, creating it lazily if needed. */
+    /*! \brief Returns the root environment, building it on first use; safe to call from any thread. */
     static finExecEnvironment *getRootEnvironment();
 
-    /*! \brief Creates a child environment under the root environment. */
+    /*! \brief Creates a child environment under the root environment, i.e. a new global scope. */
     static finErrorCode buildRootChildEnvironment(finExecEnvironment **chdenv);
     ///@}
 
 private:
+    /*! \brief Returns this global scope's copy of the system variable \a varnameid of the parent root.
+     *
+     *  The copies are made when the global scope is built and live as long as it.
+     *
+     *  \return The copy, or \c nullptr if the root has no such variable.
+     */
+    finExecVariable *getSystemVariableCopy(int varnameid) const;
+
     /*! \brief Recursive helper for locating the nearest owning function's environment depth. */
     int getBelongFuncEvnLevelIn(int curlevel) const;
 
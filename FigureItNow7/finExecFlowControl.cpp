@@ -21,24 +21,34 @@ finExecFlowControl::finExecFlowControl()
 {
     this->_type = finExecFlowControl::TP_NEXT;
     this->_label = QString();
+    this->_gotoTarget = nullptr;
+    this->_gotoLabelIdx = -1;
     this->_retVar = nullptr;
+    this->_retNumVal = 0.0;
+    this->_retIsNumeric = false;
 }
 
 void finExecFlowControl::resetFlowControl()
 {
     this->_type = finExecFlowControl::TP_NEXT;
     this->_label = QString();
+    this->_gotoTarget = nullptr;
+    this->_gotoLabelIdx = -1;
     this->releaseReturnVariable();
 }
 
 void finExecFlowControl::copyFlowControl(finExecFlowControl *srcfc)
 {
-    if ( this->_retVar != nullptr )
+    if ( this->_retVar != nullptr || this->_retIsNumeric )
         finThrow(finErrorKits::EC_STATE_ERROR, "Cannot copy flow control with existing return variable");
 
     this->_type = srcfc->getType();
     this->_label = srcfc->getGotoLabel();
-    this->_retVar = srcfc->getReturnVariable();
+    this->_gotoTarget = srcfc->getGotoTarget();
+    this->_gotoLabelIdx = srcfc->getGotoLabelIdx();
+    this->_retVar = srcfc->_retVar;
+    this->_retNumVal = srcfc->_retNumVal;
+    this->_retIsNumeric = srcfc->_retIsNumeric;
 }
 
 finExecFlowControlType finExecFlowControl::getType() const
@@ -64,18 +74,64 @@ QString finExecFlowControl::getGotoLabel() const
         return QString();
 }
 
+finSyntaxNode *finExecFlowControl::getGotoTarget() const
+{
+    if ( this->_type == finExecFlowControl::TP_GOTO )
+        return this->_gotoTarget;
+    else
+        return nullptr;
+}
+
+int finExecFlowControl::getGotoLabelIdx() const
+{
+    if ( this->_type == finExecFlowControl::TP_GOTO )
+        return this->_gotoLabelIdx;
+    else
+        return -1;
+}
+
 finExecVariable *finExecFlowControl::getReturnVariable()
 {
+    this->boxReturnNumeric();
     return this->_retVar;
 }
 
 finExecVariable *finExecFlowControl::pickReturnVariable()
 {
+    this->boxReturnNumeric();
+
     finExecVariable *retvar = this->_retVar;
     this->_retVar = nullptr;
     return retvar;
 }
 
+bool finExecFlowControl::isReturnNumeric() const
+{
+    return this->_retIsNumeric;
+}
+
+finExecValue finExecFlowControl::pickReturnValue()
+{
+    if ( this->_retIsNumeric ) {
+        this->_retIsNumeric = false;
+        return finExecFlowControl::makeNumericValue(this->_retNumVal);
+    }
+
+    finExecVariable *retvar = this->_retVar;
+    this->_retVar = nullptr;
+    return finExecFlowControl::makeVariableValue(retvar);
+}
+
+void finExecFlowControl::boxReturnNumeric()
+{
+    if ( !this->_retIsNumeric )
+        return;
+
+    this->_retVar = finExecFlowControl::buildValueVariable(
+                finExecFlowControl::makeNumericValue(this->_retNumVal));
+    this->_retIsNumeric = false;
+}
+
 bool finExecFlowControl::isFlowExit() const
 {
     return this->_type == finExecFlowControl::TP_EXIT;
@@ -188,30 +244,64 @@ void finExecFlowControl::setFlowNext()
 {
     this->_type = finExecFlowControl::TP_NEXT;
     this->_label = QString();
+    this->_gotoTarget = nullptr;
+    this->_gotoLabelIdx = -1;
 }
 
 void finExecFlowControl::setGotoAndLabel(const QString &label)
 {
     this->_type = finExecFlowControl::TP_GOTO;
     this->_label = label;
+    this->_gotoTarget = nullptr;
+    this->_gotoLabelIdx = -1;
+}
+
+void finExecFlowControl::setGotoAndTarget(const QString &label, finSyntaxNode *target, int labelidx)
+{
+    this->_type = finExecFlowControl::TP_GOTO;
+    this->_label = label;
+    this->_gotoTarget = target;
+    this->_gotoLabelIdx = (target != nullptr ? labelidx : -1);
 }
 
 void finExecFlowControl::setReturnVariable(finExecVariable *retvar)
 {
-    if ( this->_retVar != nullptr )
+    if ( this->_retVar != nullptr || this->_retIsNumeric )
         finThrow(finErrorKits::EC_STATE_ERROR, "Return variable already set");
 
     this->_retVar = retvar;
 }
 
+void finExecFlowControl::setReturnNumeric(double numval)
+{
+    if ( this->_retVar != nullptr || this->_retIsNumeric )
+        finThrow(finErrorKits::EC_STATE_ERROR, "Return variable already set");
+
+    this->_retNumVal = numval;
+    this->_retIsNumeric = true;
+}
+
+void finExecFlowControl::setReturnValue(const finExecValue &retval)
+{
+    if ( retval._isNumeric )
+        this->setReturnNumeric(retval._numVal);
+    else
+        this->setReturnVariable(retval._var);
+}
+
 finErrorCode finExecFlowControl::retVarSwitchEnv(finExecEnvironment *subenv)
 {
+    // An inline number never lives in an environment.
+    if ( this->_retIsNumeric )
+        return finErrorKits::EC_SUCCESS;
+
     this->_retVar = finExecVariable::buildFuncReturnVariable(this->_retVar, subenv);
     return finErrorKits::EC_SUCCESS;
 }
 
 finErrorCode finExecFlowControl::buildLinkedLeftVar()
 {
+    this->boxReturnNumeric();
     this->_retVar = finExecVariable::buildLinkLeftVariable(this->_retVar);
     return finErrorKits::EC_SUCCESS;
 }
@@ -220,6 +310,62 @@ void finExecFlowControl::releaseReturnVariable()
 {
     finExecVariable::releaseNonLeftVariable(this->_retVar);
     this->_retVar = nullptr;
+    this->_retIsNumeric = false;
+}
+
+finExecValue finExecFlowControl::makeVariableValue(finExecVariable *var)
+{
+    finExecValue val;
+    val._var = var;
+    val._numVal = 0.0;
+    val._isNumeric = false;
+    return val;
+}
+
+finExecValue finExecFlowControl::makeNumericValue(double numval)
+{
+    finExecValue val;
+    val._var = nullptr;
+    val._numVal = numval;
+    val._isNumeric = true;
+    return val;
+}
+
+bool finExecFlowControl::readValueNumeric(const finExecValue &val, double *numval)
+{
+    if ( val._isNumeric ) {
+        *numval = val._numVal;
+        return true;
+    }
+
+    finExecVariable *realvar = finExecVariable::transLinkTarget(val._var);
+    if ( realvar == nullptr || realvar->getType() != finExecVariable::TP_NUMERIC )
+        return false;
+
+    *numval = realvar->getNumericValue();
+    return true;
+}
+
+finExecVariable *finExecFlowControl::buildValueVariable(const finExecValue &val)
+{
+    if ( !val._isNumeric )
+        return val._var;
+
+    finExecVariable *numvar = new finExecVariable();
+    if ( numvar == nullptr )
+        return nullptr;
+
+    numvar->setType(finExecVariable::TP_NUMERIC);
+    numvar->setNumericValue(val._numVal);
+    numvar->clearLeftValue();
+    numvar->setWriteProtected();
+    return numvar;
+}
+
+void finExecFlowControl::releaseValue(const finExecValue &val)
+{
+    if ( !val._isNumeric )
+        finExecVariable::releaseNonLeftVariable(val._var);
 }
 
 
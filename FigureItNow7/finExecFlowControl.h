@@ -11,7 +11,7 @@
  *
  *  This header defines finExecFlowControl, the small runtime object used to carry control-transfer
  *  state such as \c return, \c break, \c continue, \c goto, and \c exit while the interpreter walks
- *  the syntax tree.
+ *  the syntax tree, together with finExecValue, the allocation-free operand type of the bytecode VM.
  */
 
 #ifndef FINEXECFLOWCONTROL_H
@@ -24,6 +24,20 @@
 #include "finLexNode.h"
 
 class finExecMachine;
+class finSyntaxNode;
+
+/*! \struct finExecValue
+ *  \brief A runtime value that is either a finExecVariable or a numeric scalar carried inline.
+ *
+ *  An inline number behaves exactly like a write-protected, non-left TP_NUMERIC variable. It is only
+ *  boxed into a heap finExecVariable when a consumer really needs one, so numeric temporaries (literals,
+ *  arithmetic and comparison results) do not allocate.
+ */
+struct finExecValue {
+    finExecVariable *_var;  //!< The value as a variable; \c nullptr for an inline number or a null value.
+    double _numVal;         //!< The inline number; only meaningful when _isNumeric is set.
+    bool _isNumeric;        //!< Whether the value is an inline number.
+};
 
 /*! \class finExecFlowControl
  *  \brief Runtime carrier for control-transfer state and return values.
@@ -55,7 +69,11 @@ public:
 protected:
     Type _type;                 //!< Current control-transfer kind.
     QString _label;             //!< Target label used when _type == TP_GOTO.
+    finSyntaxNode *_gotoTarget; //!< Statement list holding the label, when the goto was resolved beforehand.
+    int _gotoLabelIdx;          //!< Index of the label among the children of _gotoTarget.
     finExecVariable *_retVar;   //!< Optional return value carried with TP_RETURN or expression results.
+    double _retNumVal;          //!< Inline numeric return value, used instead of _retVar when _retIsNumeric.
+    bool _retIsNumeric;         //!< Whether the return value is carried inline in _retNumVal.
 
 public:
     /*!
@@ -95,17 +113,33 @@ public:
     /*! \brief Returns the goto label when the current state is TP_GOTO; otherwise an empty string. */
     QString getGotoLabel() const;
 
+    /*! \brief Returns the statement list holding the goto label, or \c nullptr if it is not known. */
+    finSyntaxNode *getGotoTarget() const;
+
+    /*! \brief Returns the index of the goto label among the children of getGotoTarget(). */
+    int getGotoLabelIdx() const;
+
     /*! \brief Returns whether the current state is TP_EXIT. */
     bool isFlowExit() const;
 
-    /*! \brief Returns the current return-variable pointer without transferring ownership. */
+    /*! \brief Returns the current return-variable pointer without transferring ownership.
+     *
+     *  An inline numeric return value is boxed into a variable first.
+     */
     finExecVariable *getReturnVariable();
 
     /*! \brief Detaches and returns the current return-variable pointer.
      *
-     *  After this call, the flow-control object no longer owns the returned pointer.
+     *  After this call, the flow-control object no longer owns the returned pointer. An inline numeric
+     *  return value is boxed into a variable first.
      */
     finExecVariable *pickReturnVariable();
+
+    /*! \brief Returns whether the return value is currently carried as an inline number. */
+    bool isReturnNumeric() const;
+
+    /*! \brief Detaches and returns the return value without boxing an inline number. */
+    finExecValue pickReturnValue();
     ///@}
 
     /*! \name Flow Validation Helpers
@@ -152,11 +186,25 @@ public:
     /*! \brief Sets the flow type to TP_GOTO and stores the target label. */
     void setGotoAndLabel(const QString &label);
 
+    /*! \brief Sets the flow type to TP_GOTO and stores a target resolved before execution.
+     *
+     *  \param label     Target label, kept for consumers that search by name.
+     *  \param target    Statement list holding the label; see finSyntaxNode::getJumpTarget().
+     *  \param labelidx  Index of the label among the children of \a target.
+     */
+    void setGotoAndTarget(const QString &label, finSyntaxNode *target, int labelidx);
+
     /*! \brief Attaches a return-variable pointer to this flow-control object.
      *
      *  \param retvar  Return variable to store.
      */
     void setReturnVariable(finExecVariable *retvar);
+
+    /*! \brief Attaches an inline numeric return value to this flow-control object. */
+    void setReturnNumeric(double numval);
+
+    /*! \brief Attaches a return value, keeping an inline number unboxed. */
+    void setReturnValue(const finExecValue &retval);
     ///@}
 
     /*! \name Return-Variable Ownership Helpers
@@ -174,11 +222,36 @@ public:
     void releaseReturnVariable();
     ///@}
 
+    /*! \name Inline Value Helpers
+     *  \brief Build, read, box, and release finExecValue operands.
+     */
+    ///@{
+
+    /*! \brief Returns a value referring to \a var (which may be \c nullptr for a null value). */
+    static finExecValue makeVariableValue(finExecVariable *var);
+
+    /*! \brief Returns an inline numeric value. */
+    static finExecValue makeNumericValue(double numval);
+
+    /*! \brief Reads \a val as a number if it is an inline number or a (linked) TP_NUMERIC variable. */
+    static bool readValueNumeric(const finExecValue &val, double *numval);
+
+    /*! \brief Returns the variable form of \a val, allocating one for an inline number. */
+    static finExecVariable *buildValueVariable(const finExecValue &val);
+
+    /*! \brief Releases \a val if it is a non-left variable; inline numbers need no release. */
+    static void releaseValue(const finExecValue &val);
+    ///@}
+
     /*! \brief No-op pass-through hook used by flow-check helpers.
      *
      *  \return Always returns \c finErrorKits::EC_SUCCESS.
      */
     finErrorCode directPass();
+
+private:
+    /*! \brief Replaces an inline numeric return value by an equivalent heap variable. */
+    void boxReturnNumeric();
 };
 
 /*! \typedef finExecFlowControlType
@@ -65,10 +65,7 @@ static finErrorCode _sysfunc_draw_dot(finExecFunction *self, finExecEnvironment
          cy->getType() != finExecVariable::TP_NUMERIC )
         return finErrorKits::EC_INVALID_PARAM;
 
-    auto fodot = std::make_unique<finFigureObjectDot>();
-    fodot->setPoint(cx->getNumericValue(), cy->getNumericValue());
-    env->getFigureContainer()->appendFigureObject(fodot.get());
-    fodot.release();
+    env->getFigureContainer()->appendDotPoint(QPointF(cx->getNumericValue(), cy->getNumericValue()));
 
     flowctl->setFlowNext();
     return finErrorKits::EC_SUCCESS;
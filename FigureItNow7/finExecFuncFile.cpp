@@ -85,16 +85,17 @@ static finErrorCode _sysfunc_load_numerical_csv(finExecFunction *self, finExecEn
     if ( !fp.open(QIODevice::ReadOnly | QIODevice::Text) )
         return finErrorKits::EC_FILE_NOT_OPEN;
 
-    retvar->setType(finExecVariable::TP_ARRAY);
-    int currow = 0;
+    // Rows are collected as plain numbers so a rectangular file becomes one packed matrix.
+    QList<QList<double>> rowlist;
     QTextStream tsin(&fp);
     while ( !tsin.atEnd() ) {
         QString lnstr = tsin.readLine();
-        finExecVariable *rowvar = retvar->getVariableItemAt(currow);
+        QList<double> numlist;
 
-        finExecAlg::csStringToNumArrayVar(lnstr, rowvar);
-        currow++;
+        finExecAlg::csStringToNumList(lnstr, &numlist);
+        rowlist.append(numlist);
     }
+    finExecAlg::listToNumMatVar(rowlist, retvar);
     retvar->setWriteProtected();
     retvar->clearLeftValue();
     fp.close();
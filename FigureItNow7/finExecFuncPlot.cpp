@@ -365,8 +365,9 @@ static struct finExecSysFuncRegItem _funcRegItem_plot_parametric = {
                                  "plotted function is given following the function name in the argument list."),
 };
 
-static finErrorCode _sysfunc_plot_equation(finExecFunction *self, finExecEnvironment *env,
-                                           finExecMachine *machine, finExecFlowControl *flowctl)
+static finErrorCode _plot_equation_in_mode(finExecFunction *self, finExecEnvironment *env,
+                                           finExecMachine *machine, finExecFlowControl *flowctl,
+                                           finPlotEquation2D::SolveMode mode)
 {
     if ( self == nullptr || env == nullptr || machine == nullptr || flowctl == nullptr )
         return finErrorKits::EC_NULL_POINTER;
@@ -402,6 +403,7 @@ static finErrorCode _sysfunc_plot_equation(finExecFunction *self, finExecEnviron
     ploteq.setFiguringRangeY(y1, y2);
     ploteq.setVariableXIndex(0);
     ploteq.setVariableYIndex(1);
+    ploteq.setSolveMode(mode);
 
     QList<finExecVariable *> extarglist = finExecFunction::getExtendArgList(env);
     ploteq.setCallArgList(&extarglist);
@@ -435,6 +437,30 @@ static struct finExecSysFuncRegItem _funcRegItem_plot_equation = {
                                  "given following the function name in the argument list."),
 };
 
+static finErrorCode _sysfunc_plot_equation(finExecFunction *self, finExecEnvironment *env,
+                                           finExecMachine *machine, finExecFlowControl *flowctl)
+{
+    return _plot_equation_in_mode(self, env, machine, flowctl, finPlotEquation2D::SM_FULL_GRID);
+}
+
+static finErrorCode _sysfunc_plot_equation_fast(finExecFunction *self, finExecEnvironment *env,
+                                                finExecMachine *machine, finExecFlowControl *flowctl)
+{
+    return _plot_equation_in_mode(self, env, machine, flowctl, finPlotEquation2D::SM_ADAPTIVE);
+}
+
+static struct finExecSysFuncRegItem _funcRegItem_plot_equation_fast = {
+    /*._funcName     =*/ QString("plot_equation_fast"),
+    /*._paramCsvList =*/ QString("x1,x2,y1,y2,func"),
+    /*._funcCall     =*/ _sysfunc_plot_equation_fast,
+    /*._category     =*/ _defFuncCtg,
+    /*._prototype    =*/ QString("plot_equation_fast (x1, x2, y1, y2, func, ...)"),
+    /*._description  =*/ QString("Plot the 2D equation figure like plot_equation, but skip the parts of the region "
+                                 "where a few probes show the function keeping one sign far from zero. Skipping is a "
+                                 "guess from the probed slopes, so a curve branch thinner than the probe spacing can "
+                                 "be missed; use plot_equation when every branch must appear."),
+};
+
 static finExecSysFuncRegItem _finSysFuncPlotList[] = {
     _funcRegItem_plot_dots,
     _funcRegItem_plot_line,
@@ -445,6 +471,7 @@ static finExecSysFuncRegItem _finSysFuncPlotList[] = {
     _funcRegItem_plot_polar,
     _funcRegItem_plot_parametric,
     _funcRegItem_plot_equation,
+    _funcRegItem_plot_equation_fast,
 
     { QString(), QString(), nullptr, _defFuncCtg, QString(), QString() }
 };
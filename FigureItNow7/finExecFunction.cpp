@@ -22,6 +22,7 @@
 #include "finExecVariable.h"
 #include "finExecEnvironment.h"
 #include "finExecMachine.h"
+#include "finSymbolTable.h"
 
 
 QString finExecFunction::_extArgPrefix("__ext_arg_");
@@ -29,6 +30,7 @@ QString finExecFunction::_extArgPrefix("__ext_arg_");
 finExecFunction::finExecFunction()
 {
     this->_type = TP_DUMMY;
+    this->_funcNameId = finSymbolTable::SYM_NONE;
     this->_u._rawPointer = nullptr;
 }
 
@@ -42,6 +44,11 @@ const QString &finExecFunction::getFunctionName() const
     return this->_funcName;
 }
 
+int finExecFunction::getFunctionNameId() const
+{
+    return this->_funcNameId;
+}
+
 int finExecFunction::getParameterCount() const
 {
     return this->_paramList.count();
@@ -57,6 +64,16 @@ QString finExecFunction::getParameterName(int idx) const
         return finExecFunction::getExtArgName(idx - this->_paramList.count());
 }
 
+int finExecFunction::getParameterNameId(int idx) const
+{
+    if ( idx < 0 )
+        return finSymbolTable::SYM_NONE;
+    else if ( idx < this->_paramIdList.count() )
+        return this->_paramIdList.at(idx);
+    else
+        return finExecFunction::getExtArgNameId(idx - this->_paramIdList.count());
+}
+
 bool finExecFunction::isParameterExist(const QString &paramname) const
 {
     for ( int i = 0; i < this->_paramList.count(); i++ ) {
@@ -81,6 +98,7 @@ void finExecFunction::setFunctionName(const QString &funcname)
         return;
 
     this->_funcName = funcname;
+    this->_funcNameId = finSymbolTable::getSymbolId(funcname);
 }
 
 void finExecFunction::appendParameterName(const QString &paramname)
@@ -89,6 +107,7 @@ void finExecFunction::appendParameterName(const QString &paramname)
         finThrow(finErrorKits::EC_INVALID_PARAM, "Parameter name is empty.");
 
     this->_paramList.append(paramname);
+    this->_paramIdList.append(finSymbolTable::getSymbolId(paramname));
 }
 
 void finExecFunction::clearParameterNames()
@@ -97,6 +116,15 @@ void finExecFunction::clearParameterNames()
         return;
 
     this->_paramList.clear();
+    this->_paramIdList.clear();
+}
+
+finSyntaxNode *finExecFunction::getFunctionSyntaxNode() const
+{
+    if ( this->_type != finExecFunction::TP_USER )
+        return nullptr;
+
+    return this->_u._funcNode;
 }
 
 void finExecFunction::setFunctionSyntaxNode(finSyntaxNode *funcnode)
@@ -247,7 +275,7 @@ finExecFunction::appendArgToSubenv(int idx, finSyntaxNode *argnode, finExecEnvir
     argvar = flowctl->pickReturnVariable();
     if ( argvar == nullptr )
         return finErrorKits::EC_OUT_OF_MEMORY;
-    argvar->setName(this->getParameterName(idx));
+    argvar->setNameId(this->getParameterNameId(idx));
 
     errcode = env->addVariable(argvar);
     if ( finErrorKits::isErrorResult(errcode) ) {
@@ -256,6 +284,7 @@ finExecFunction::appendArgToSubenv(int idx, finSyntaxNode *argnode, finExecEnvir
         delete argvar;
         return errcode;
     }
+    env->bindVariableSlot(idx, argvar);
     return finErrorKits::EC_SUCCESS;
 }
 
@@ -303,6 +332,73 @@ finExecFunction::execFunction(QList<finExecVariable *> *arglist, finExecEnvironm
     return finErrorKits::EC_SUCCESS;
 }
 
+finErrorCode
+finExecFunction::execFunctionByValues(QList<finExecVariable *> *argvals, finLexNode *lexnode,
+                                      finExecEnvironment *env, finExecMachine *machine,
+                                      finExecFlowControl *flowctl)
+{
+    finErrorCode errcode;
+    finExecEnvironment *subenv;
+
+    errcode = env->buildChildEnvironment(&subenv);
+    if ( finErrorKits::isErrorResult(errcode) ) {
+        machine->appendExecutionError(lexnode, QString("Internal error."));
+        goto err_args;
+    }
+    subenv->setEnvironmentName(this->_funcName);
+    subenv->setBelongFunction(this);
+
+    for ( int i = 0; i < argvals->count(); i++ ) {
+        finExecVariable *argvar = finExecVariable::buildLinkLeftVariable(argvals->at(i));
+        (*argvals)[i] = nullptr;
+        if ( argvar == nullptr ) {
+            errcode = finErrorKits::EC_OUT_OF_MEMORY;
+            goto err_env;
+        }
+        argvar->setNameId(this->getParameterNameId(i));
+
+        errcode = subenv->addVariable(argvar);
+        if ( finErrorKits::isErrorResult(errcode) ) {
+            machine->appendExecutionError(lexnode, QString("Internal error."));
+            delete argvar;
+            goto err_env;
+        }
+        subenv->bindVariableSlot(i, argvar);
+    }
+    argvals->clear();
+
+    flowctl->resetFlowControl();
+    if ( this->_type == finExecFunction::TP_SYSTEM ) {
+        errcode = this->execSysFunction(subenv, machine, flowctl);
+    } else if ( this->_type == finExecFunction::TP_USER ) {
+        errcode = this->execUserFunction(subenv, machine, flowctl);
+    } else {
+        machine->appendExecutionError(lexnode, QString("ERROR: Function type cannot be recognized."));
+        delete subenv;
+        return finErrorKits::EC_READ_ERROR;
+    }
+    if ( finErrorKits::isErrorResult(errcode) ) {
+        delete subenv;
+        return errcode;
+    }
+
+    errcode = flowctl->checkFlowForProgram(nullptr, lexnode, machine);
+    if ( finErrorKits::isErrorResult(errcode) ) {
+        delete subenv;
+        return errcode;
+    }
+    flowctl->retVarSwitchEnv(subenv);
+    delete subenv;
+    return finErrorKits::EC_SUCCESS;
+
+err_env:
+    delete subenv;
+err_args:
+    while ( !argvals->empty() )
+        finExecVariable::releaseNonLeftVariable(argvals->takeLast());
+    return errcode;
+}
+
 finErrorCode
 finExecFunction::processArgsInSubEnv(QList<finExecVariable *> *arglist, finExecEnvironment *env)
 {
@@ -315,7 +411,7 @@ finExecFunction::processArgsInSubEnv(QList<finExecVariable *> *arglist, finExecE
 
         argvar->setLinkTarget(arglist->at(i));
 
-        argvar->setName(this->getParameterName(i));
+        argvar->setNameId(this->getParameterNameId(i));
         argvar->setLeftValue();
 
         errcode = env->addVariable(argvar);
@@ -324,6 +420,7 @@ finExecFunction::processArgsInSubEnv(QList<finExecVariable *> *arglist, finExecE
             delete argvar;
             return errcode;
         }
+        env->bindVariableSlot(i, argvar);
     }
     return finErrorKits::EC_SUCCESS;
 }
@@ -331,7 +428,7 @@ finExecFunction::processArgsInSubEnv(QList<finExecVariable *> *arglist, finExecE
 finErrorCode
 finExecFunction::execUserFunction(finExecEnvironment *env, finExecMachine *machine, finExecFlowControl *flowctl)
 {
-    return machine->instantExecute(this->_u._funcNode, env, flowctl);
+    return machine->executeSyntaxNode(this->_u._funcNode, env, flowctl);
 }
 
 finErrorCode
@@ -352,6 +449,11 @@ QString finExecFunction::getExtArgName(int idx)
     return extargname;
 }
 
+int finExecFunction::getExtArgNameId(int idx)
+{
+    return finSymbolTable::getSymbolId(finExecFunction::getExtArgName(idx));
+}
+
 int finExecFunction::getExtendArgCountHere(finExecEnvironment *env)
 {
     finExecVariable *extargvar = nullptr;
@@ -469,6 +571,7 @@ finExecVariable *finExecFunction::getPreviousExtendArgAt(finExecEnvironment *env
 
 QList<finExecSysFuncRegItem> finExecFunction::_sysFuncList =
         QList<finExecSysFuncRegItem>();
+QHash<int, int> finExecFunction::_sysFuncIdxMap = QHash<int, int>();
 
 void finExecFunction::registSysFuncFromArray(finExecSysFuncRegItem *sysfunclist, const QString &category)
 {
@@ -479,6 +582,8 @@ void finExecFunction::registSysFuncFromArray(finExecSysFuncRegItem *sysfunclist,
             sysfunclist[i]._prototype = sysfunclist[i]._funcName + " (" + sysfunclist[i]._paramCsvList + ")";
 
         finExecFunction::_sysFuncList.append(sysfunclist[i]);
+        finExecFunction::_sysFuncIdxMap.insert(finSymbolTable::getSymbolId(sysfunclist[i]._funcName),
+                                               finExecFunction::_sysFuncList.count() - 1);
     }
 }
 
@@ -502,7 +607,9 @@ finExecFunction::installSystemFunctions (finExecEnvironment *rootenv)
     if ( rootenv == nullptr )
         return finErrorKits::EC_NULL_POINTER;
 
-    finExecFunction::registSysFuncAll();
+    // The registry is process-wide: fill it exactly once, however many roots are built and from which threads.
+    static const bool sysfuncregisted = (finExecFunction::registSysFuncAll(), true);
+    Q_UNUSED(sysfuncregisted);
 
     for ( i = 0; i < finExecFunction::_sysFuncList.count(); i++ ) {
         const finExecSysFuncRegItem &sysfunc = finExecFunction::_sysFuncList.at(i);
@@ -550,3 +657,12 @@ const QList<finExecSysFuncRegItem> &finExecFunction::getSysFuncRegList()
 {
     return finExecFunction::_sysFuncList;
 }
+
+const finExecSysFuncRegItem *finExecFunction::findSysFuncRegItem(int funcnameid)
+{
+    int idx = finExecFunction::_sysFuncIdxMap.value(funcnameid, -1);
+    if ( idx < 0 )
+        return nullptr;
+
+    return &finExecFunction::_sysFuncList.at(idx);
+}
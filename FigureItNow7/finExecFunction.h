@@ -15,6 +15,8 @@
 #ifndef FINEXECFUNCTION_H
 #define FINEXECFUNCTION_H
 
+#include <QHash>
+#include <QList>
 #include <QString>
 
 #include "finErrorCode.h"
@@ -78,7 +80,9 @@ public:
 protected:
     Type _type;              //!< Function implementation kind.
     QString _funcName;       //!< Script-visible function name.
+    int _funcNameId;         //!< finSymbolTable ID of _funcName.
     QStringList _paramList;  //!< Declared parameter names in call order.
+    QList<int> _paramIdList; //!< finSymbolTable IDs of _paramList, bound to arguments on every call.
 
     union {
         finSyntaxNode *_funcNode;   //!< User-function body node when _type == TP_USER.
@@ -105,9 +109,12 @@ public:
     ///@{
     Type getFunctionType() const;
     const QString &getFunctionName() const;
+    int getFunctionNameId() const;
     int getParameterCount() const;
     QString getParameterName(int idx) const;
+    int getParameterNameId(int idx) const;
     bool isParameterExist(const QString &paramname) const;
+    finSyntaxNode *getFunctionSyntaxNode() const;
     ///@}
 
     /*! \name Metadata Mutation
@@ -131,6 +138,16 @@ public:
                               finExecMachine *machine, finExecFlowControl *flowctl);
     finErrorCode execFunction(QList<finExecVariable *> *arglist, finExecEnvironment *env,
                               finExecMachine *machine, finExecFlowControl *flowctl);
+
+    /*! \brief Calls the function with argument values already evaluated by the bytecode VM.
+     *
+     *  Each value in \a argvals is bound the same way a syntax-tree argument is bound, and the list
+     *  is consumed: non-left values are either moved into the sub-environment or released. As on every
+     *  call path, argument \a i also occupies slot \a i of the call environment.
+     */
+    finErrorCode execFunctionByValues(QList<finExecVariable *> *argvals, finLexNode *lexnode,
+                                      finExecEnvironment *env, finExecMachine *machine,
+                                      finExecFlowControl *flowctl);
     ///@}
 
     /*! \name Extra-Argument Helpers
@@ -139,6 +156,7 @@ public:
     ///@{
     static QString getExtArgPrefix();
     static QString getExtArgName(int idx);
+    static int getExtArgNameId(int idx);
     static int getExtendArgCountHere(finExecEnvironment *env);
     static finExecVariable *getExtendArgHereAt(finExecEnvironment *env, int idx);
     static int getExtendArgCount(finExecEnvironment *env);
@@ -157,6 +175,10 @@ public:
     ///@{
     static finErrorCode installSystemFunctions (finExecEnvironment *rootenv);
     static const QList<finExecSysFuncRegItem> &getSysFuncRegList();
+
+    /*! \brief Returns the registration record of the system function named by symbol \a funcnameid, or
+     *         \c nullptr if there is none. */
+    static const finExecSysFuncRegItem *findSysFuncRegItem(int funcnameid);
     ///@}
 
 private:
@@ -175,6 +197,7 @@ private:
     finErrorCode execSysFunction(finExecEnvironment *env, finExecMachine *machine, finExecFlowControl *flowctl);
 
     static QList<finExecSysFuncRegItem> _sysFuncList;  //!< Process-wide registry of built-in functions.
+    static QHash<int, int> _sysFuncIdxMap;             //!< Symbol ID of each registered name to its index.
     /*! \brief Populates the full system-function registry. */
     static void registSysFuncAll();
 
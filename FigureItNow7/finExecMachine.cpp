@@ -10,16 +10,20 @@
  *  \brief Implementations of the FIN-7 tree-walking execution machine.
  *
  *  Provides the end-to-end runtime pipeline after parsing: environment initialization, compilation
- *  handoff, recursive syntax-node dispatch, expression and statement execution, and execution-
- *  diagnostic collection.
+ *  handoff, recursive syntax-node dispatch, expression and statement execution, the bytecode VM
+ *  dispatch loop, and execution-diagnostic collection.
  */
 
 #include "finExecMachine.h"
 
+#include <QMutexLocker>
+
+#include "finExecCompileCache.h"
 #include "finExecVariable.h"
 #include "finExecFunction.h"
 #include "finExecEnvironment.h"
 #include "finExecOperartorCalc.h"
+#include "finPlotParallel.h"
 
 finExecMachine::finExecMachine()
 {
@@ -27,6 +31,12 @@ finExecMachine::finExecMachine()
     this->_baseEnv = nullptr;
     this->_baseFigContainer = nullptr;
     this->_synTree = nullptr;
+    this->_execMode = finExecMachine::EM_BYTECODE;
+    this->_byteCode = nullptr;
+    this->_optOptions = QStringList();
+    this->_plotWorkerCnt = 1;
+    this->_varPoolCounter = finExecPoolCounter();
+    this->_envPoolCounter = finExecPoolCounter();
 }
 
 finExecMachine::finExecMachine(const QString &name)
@@ -35,12 +45,24 @@ finExecMachine::finExecMachine(const QString &name)
     this->_baseEnv = nullptr;
     this->_baseFigContainer = nullptr;
     this->_synTree = nullptr;
+    this->_execMode = finExecMachine::EM_BYTECODE;
+    this->_byteCode = nullptr;
+    this->_optOptions = QStringList();
+    this->_plotWorkerCnt = 1;
+    this->_varPoolCounter = finExecPoolCounter();
+    this->_envPoolCounter = finExecPoolCounter();
 }
 
 finExecMachine::~finExecMachine()
 {
     if ( this->_baseEnv != nullptr )
         delete this->_baseEnv;
+    if ( this->_byteCode != nullptr )
+        delete this->_byteCode;
+
+    // The tree shares its statements with _compiler, whose arena holds them, so it goes first.
+    if ( this->_synTree != nullptr )
+        delete this->_synTree;
 
     this->disposeExecutionError();
 }
@@ -93,6 +115,41 @@ finSyntaxError finExecMachine::getExecuteErrorAt(int idx) const
     return this->_errList.getEntryAt(idx);
 }
 
+finExecMachineExecMode finExecMachine::getExecMode() const
+{
+    return this->_execMode;
+}
+
+finExecBytecode *finExecMachine::getBytecode()
+{
+    return this->_byteCode;
+}
+
+QStringList finExecMachine::getOptimizeOption() const
+{
+    return this->_optOptions;
+}
+
+int finExecMachine::getPlotWorkerCount() const
+{
+    return this->_plotWorkerCnt;
+}
+
+void finExecMachine::setExecMode(finExecMachineExecMode mode)
+{
+    this->_execMode = mode;
+}
+
+void finExecMachine::setOptimizeOption(const QStringList &options)
+{
+    this->_optOptions = options;
+}
+
+void finExecMachine::setPlotWorkerCount(int cnt)
+{
+    this->_plotWorkerCnt = finPlotParallel::normalizeWorkerCount(cnt);
+}
+
 void finExecMachine::setName(const QString &name)
 {
     this->_name = name;
@@ -138,6 +195,17 @@ finErrorCode finExecMachine::initEnvironmentFromRoot()
     return finErrorKits::EC_SUCCESS;
 }
 
+finErrorCode finExecMachine::resetEnvironment()
+{
+    if ( this->_baseEnv == nullptr )
+        return finErrorKits::EC_STATE_ERROR;
+
+    finExecEnvironment *prevenv = this->_baseEnv->getParentEnvironment();
+    delete this->_baseEnv;
+    this->_baseEnv = nullptr;
+    return this->initEnvironment(prevenv);
+}
+
 finErrorCode finExecMachine::setFigureContainer(finFigureContainer *figcontainer)
 {
     this->_baseFigContainer = figcontainer;
@@ -165,16 +233,68 @@ bool finExecMachine::isCompiled() const
 
 finErrorCode finExecMachine::compile()
 {
+    // The bytecode refers to the syntax nodes of the old tree, so it must go first.
+    if ( this->_byteCode != nullptr ) {
+        delete this->_byteCode;
+        this->_byteCode = nullptr;
+    }
     if ( this->_synTree != nullptr )
         delete this->_synTree;
 
-    this->_synTree = this->_compiler.compile();
+    // Scripts compiled before skip lexing and parsing; only error-free trees are ever cached.
+    QString script = this->_compiler.getScriptCode();
+    this->_synTree = finExecCompileCache::loadSyntaxTree(script);
+    if ( this->_synTree == nullptr ) {
+        this->_synTree = this->_compiler.compile();
+
+        if ( this->_synTree == nullptr )
+            return finErrorKits::EC_OUT_OF_MEMORY;
+        if ( this->_synTree->getErrorCount() > 0 )
+            return finErrorKits::EC_NORMAL_WARN;
+
+        if ( !script.isEmpty() )
+            finExecCompileCache::storeSyntaxTree(script, this->_synTree);
+    }
+
+    // The cache keeps the unoptimized tree, so changing the passes never requires invalidating it.
+    if ( !this->_optOptions.isEmpty() ) {
+        this->_synTree->detachSharedNodes();
 
+        finSyntaxOptimzer optimizer;
+        optimizer.setSyntaxTree(this->_synTree);
+        optimizer.setOption(this->_optOptions);
+        optimizer.optimize();
+    }
+
+    // Jump targets point into this very tree, so they are resolved after the passes have reshaped it.
+    if ( this->_synTree->resolveJumpTargets() > 0 )
+        return finErrorKits::EC_NORMAL_WARN;
+
+    if ( this->_execMode == finExecMachine::EM_BYTECODE )
+        this->prepareBytecode();
+    return finErrorKits::EC_SUCCESS;
+}
+
+finErrorCode finExecMachine::prepareBytecode()
+{
     if ( this->_synTree == nullptr )
+        return finErrorKits::EC_STATE_ERROR;
+    if ( this->_byteCode != nullptr )
+        return finErrorKits::EC_DUPLICATE_OP;
+
+    finExecBytecode *bytecode = new finExecBytecode();
+    if ( bytecode == nullptr )
         return finErrorKits::EC_OUT_OF_MEMORY;
-    if ( this->_synTree->getErrorCount() > 0 )
-        return finErrorKits::EC_NORMAL_WARN;
 
+    finErrorCode errcode = this->_compiler.lowerSyntaxTree(this->_synTree, bytecode);
+    if ( finErrorKits::isErrorResult(errcode) ) {
+        // Not fatal: execute() simply keeps walking the syntax tree.
+        finWarning << "Bytecode lowering failed (" << errcode << "), falling back to the tree walker.";
+        delete bytecode;
+        return errcode;
+    }
+
+    this->_byteCode = bytecode;
     return finErrorKits::EC_SUCCESS;
 }
 
@@ -187,13 +307,51 @@ finErrorCode finExecMachine::execute()
 
     this->disposeExecutionError();
 
+    if ( this->_execMode == finExecMachine::EM_BYTECODE && this->_byteCode == nullptr &&
+         this->_synTree->getErrorCount() <= 0 )
+        this->prepareBytecode();
+
+    finExecPoolCounter varcnt = finExecVariable::getObjectPool()->getCounter();
+    finExecPoolCounter envcnt = finExecEnvironment::getObjectPool()->getCounter();
     finExecFlowControl flowctl;
-    finErrorCode errcode = this->instantExecute(this->_synTree->getRootNode(), this->_baseEnv, &flowctl);
-    if ( finErrorKits::isErrorResult(errcode) )
-        return errcode;
+    finErrorCode errcode;
+    finSyntaxNode *rootnode = this->_synTree->getRootNode();
+    if ( this->_execMode == finExecMachine::EM_BYTECODE && this->_byteCode != nullptr ) {
+        errcode = this->vmExecute(this->_byteCode, this->_baseEnv, &flowctl);
+        if ( !finErrorKits::isErrorResult(errcode) )
+            errcode = flowctl.checkFlowForProgram(nullptr, rootnode->getCommandLexNode(), this);
+    } else {
+        errcode = this->instantExecute(rootnode, this->_baseEnv, &flowctl);
+    }
+    if ( !finErrorKits::isErrorResult(errcode) ) {
+        flowctl.releaseReturnVariable();
+        errcode = finErrorKits::EC_SUCCESS;
+    }
+
+    // Record what the pools absorbed in this run, then hand the blocks this thread cached back to the heap.
+    // Both touch only the calling thread's part of the pools, so machines on other threads are unaffected.
+    this->_varPoolCounter = finExecObjectPool::diffCounter(
+                varcnt, finExecVariable::getObjectPool()->getCounter());
+    this->_envPoolCounter = finExecObjectPool::diffCounter(
+                envcnt, finExecEnvironment::getObjectPool()->getCounter());
+    finTraceDebug(finTraceKits::TC_EXEC)
+            << "Pooled allocations: variables" << this->_varPoolCounter._reuseCnt
+            << "reused /" << this->_varPoolCounter._heapAllocCnt << "from heap; environments"
+            << this->_envPoolCounter._reuseCnt << "reused /" << this->_envPoolCounter._heapAllocCnt
+            << "from heap.";
+    finExecVariable::getObjectPool()->trim();
+    finExecEnvironment::getObjectPool()->trim();
+    return errcode;
+}
 
-    flowctl.releaseReturnVariable();
-    return finErrorKits::EC_SUCCESS;
+finExecPoolCounter finExecMachine::getVariablePoolCounter() const
+{
+    return this->_varPoolCounter;
+}
+
+finExecPoolCounter finExecMachine::getEnvironmentPoolCounter() const
+{
+    return this->_envPoolCounter;
 }
 
 void finExecMachine::disposeExecutionError()
@@ -258,9 +416,435 @@ finExecMachine::instantExecute(finSyntaxNode *synnode, finExecEnvironment *env,
     //return finErrorKits::EC_UNKNOWN_ERROR;
 }
 
+finErrorCode
+finExecMachine::executeSyntaxNode(finSyntaxNode *synnode, finExecEnvironment *env, finExecFlowControl *flowctl)
+{
+    if ( this->_execMode == finExecMachine::EM_BYTECODE && this->_byteCode != nullptr ) {
+        finExecBytecode *subcode = this->_byteCode->findSubCode(synnode);
+        if ( subcode != nullptr )
+            return this->vmExecute(subcode, env, flowctl);
+    }
+    return this->instantExecute(synnode, env, flowctl);
+}
+
+finErrorCode
+finExecMachine::vmExecute(finExecBytecode *bytecode, finExecEnvironment *env, finExecFlowControl *flowctl)
+{
+    if ( bytecode == nullptr || env == nullptr || flowctl == nullptr )
+        return finErrorKits::EC_NULL_POINTER;
+
+    finErrorCode errcode = finErrorKits::EC_SUCCESS;
+    QList<finExecValue> stack;
+    QList<finExecEnvironment *> envstack;
+    finExecEnvironment *curenv = env;
+    const finExecInstruction *instdata = bytecode->getInstructionData();
+    int instcnt = bytecode->getInstructionCount();
+    int pc = 0;
+    bool goon = true;
+
+    flowctl->setFlowNext();
+
+    while ( pc < instcnt ) {
+        const finExecInstruction &inst = instdata[pc];
+        pc++;
+
+        switch ( inst._opCode ) {
+          case finExecBytecode::BC_NOP:
+            break;
+
+          case finExecBytecode::BC_PUSH_NULL:
+            stack.append(finExecFlowControl::makeVariableValue(nullptr));
+            break;
+
+          case finExecBytecode::BC_PUSH_NUM:
+            stack.append(finExecFlowControl::makeNumericValue(bytecode->getNumericConstAt(inst._arg1)));
+            break;
+
+          case finExecBytecode::BC_PUSH_STR:
+          {
+            finExecVariable *constvar = new finExecVariable();
+            if ( constvar == nullptr ) {
+                errcode = finErrorKits::EC_OUT_OF_MEMORY;
+                goto err;
+            }
+            constvar->setType(finExecVariable::TP_STRING);
+            constvar->setStringValue(bytecode->getStringConstAt(inst._arg1));
+            constvar->clearLeftValue();
+            constvar->setWriteProtected();
+            stack.append(finExecFlowControl::makeVariableValue(constvar));
+            break;
+          }
+
+          case finExecBytecode::BC_LOAD_VAR:
+          {
+            finExecVariable *var = curenv->findVariable(bytecode->getNameIdAt(inst._arg1));
+            if ( var == nullptr ) {
+                this->appendExecutionError(inst._lexNode, QString("Cannot find variable."));
+                errcode = finErrorKits::EC_NOT_FOUND;
+                goto err;
+            }
+            stack.append(finExecFlowControl::makeVariableValue(var));
+            break;
+          }
+
+          case finExecBytecode::BC_LOAD_SLOT:
+          {
+            finExecEnvironment *slotenv = (inst._arg2 == 0 ? env : envstack.at(inst._arg2 - 1));
+            finExecVariable *var = slotenv->getVariableAtSlot(inst._arg3);
+            if ( var == nullptr )
+                var = curenv->findVariable(bytecode->getNameIdAt(inst._arg1));
+            if ( var == nullptr ) {
+                this->appendExecutionError(inst._lexNode, QString("Cannot find variable."));
+                errcode = finErrorKits::EC_NOT_FOUND;
+                goto err;
+            }
+            stack.append(finExecFlowControl::makeVariableValue(var));
+            break;
+          }
+
+          case finExecBytecode::BC_CALC:
+          {
+            int stackbase = stack.count() - inst._arg2;
+            finLexOperatorType optype = (finLexOperatorType)inst._arg3;
+            double opnum1 = 0.0, opnum2 = 0.0, retnum = 0.0;
+
+            // Numeric temporaries are computed on doubles and stay inline; nothing is allocated.
+            if ( inst._arg2 >= 1 && inst._arg2 <= 2 &&
+                 finExecFlowControl::readValueNumeric(stack.at(stackbase), &opnum1) &&
+                 (inst._arg2 < 2 || finExecFlowControl::readValueNumeric(stack.at(stackbase + 1), &opnum2)) &&
+                 finExecOperartorCalc::execNumericOpCalc(optype, inst._arg2, opnum1, opnum2, &retnum) ) {
+                for ( int i = stackbase; i < stack.count(); i++ )
+                    finExecFlowControl::releaseValue(stack.at(i));
+                stack.resize(stackbase);
+                stack.append(finExecFlowControl::makeNumericValue(retnum));
+                break;
+            }
+
+            // Storing a number into a numeric (or null) variable updates it in place.
+            if ( optype == finLexNode::OP_LET && inst._arg2 == 2 && !stack.at(stackbase)._isNumeric &&
+                 finExecFlowControl::readValueNumeric(stack.at(stackbase + 1), &opnum2) ) {
+                finExecVariable *dstvar = finExecVariable::transLinkTarget(stack.at(stackbase)._var);
+                if ( dstvar != nullptr && dstvar->isLeftValue() && !dstvar->isWriteProtected() &&
+                     (dstvar->getType() == finExecVariable::TP_NULL ||
+                      dstvar->getType() == finExecVariable::TP_NUMERIC) ) {
+                    dstvar->setNumericValue(opnum2);
+                    finExecFlowControl::releaseValue(stack.at(stackbase));
+                    finExecFlowControl::releaseValue(stack.at(stackbase + 1));
+                    stack.resize(stackbase);
+                    stack.append(finExecFlowControl::makeVariableValue(dstvar));
+                    break;
+                }
+            }
+
+            finExecVariable *retvar = nullptr;
+            QList<finExecVariable *> oprands;
+            for ( int i = stackbase; i < stack.count(); i++ )
+                oprands.append(finExecFlowControl::buildValueVariable(stack.at(i)));
+            stack.resize(stackbase);
+
+            errcode = finExecOperartorCalc::execOpCalcAt(inst._arg1, &oprands, &retvar);
+            while ( !oprands.empty() )
+                finExecVariable::releaseNonLeftVariable(oprands.takeFirst());
+            if ( finErrorKits::isErrorResult(errcode) ) {
+                this->appendExecutionError(inst._lexNode, QString("Invalid expression."));
+                goto err;
+            }
+            stack.append(finExecFlowControl::makeVariableValue(retvar));
+            break;
+          }
+
+          case finExecBytecode::BC_LOAD_ITEM:
+          {
+            int stackbase = stack.count() - inst._arg2;
+            int idxcnt = inst._arg2 - 1;
+            double idxlist[2], retnum = 0.0;
+
+            // A number of a packed array is read straight from its buffer; nothing is allocated or unpacked.
+            if ( idxcnt >= 1 && idxcnt <= 2 && !stack.at(stackbase)._isNumeric &&
+                 finExecFlowControl::readValueNumeric(stack.at(stackbase + 1), &idxlist[0]) &&
+                 (idxcnt < 2 || finExecFlowControl::readValueNumeric(stack.at(stackbase + 2), &idxlist[1])) &&
+                 finExecOperartorCalc::execNumericReadAccess(stack.at(stackbase)._var, idxcnt, idxlist, &retnum) ) {
+                for ( int i = stackbase; i < stack.count(); i++ )
+                    finExecFlowControl::releaseValue(stack.at(i));
+                stack.resize(stackbase);
+                stack.append(finExecFlowControl::makeNumericValue(retnum));
+                break;
+            }
+
+            finExecVariable *retvar = nullptr;
+            QList<finExecVariable *> oprands;
+            for ( int i = stackbase; i < stack.count(); i++ )
+                oprands.append(finExecFlowControl::buildValueVariable(stack.at(i)));
+            stack.resize(stackbase);
+
+            errcode = finExecOperartorCalc::execReadAccess(&oprands, &retvar);
+            while ( !oprands.empty() )
+                finExecVariable::releaseNonLeftVariable(oprands.takeFirst());
+            if ( finErrorKits::isErrorResult(errcode) ) {
+                this->appendExecutionError(inst._lexNode, QString("Invalid expression."));
+                goto err;
+            }
+            stack.append(finExecFlowControl::makeVariableValue(retvar));
+            break;
+          }
+
+          case finExecBytecode::BC_STORE_ITEM:
+          {
+            int stackbase = stack.count() - inst._arg2;
+            double idxnum = 0.0, valnum = 0.0;
+
+            // A number stored into an existing item of a packed array is written into its buffer.
+            if ( !stack.at(stackbase)._isNumeric &&
+                 finExecFlowControl::readValueNumeric(stack.at(stackbase + 1), &idxnum) &&
+                 finExecFlowControl::readValueNumeric(stack.at(stackbase + 2), &valnum) &&
+                 finExecOperartorCalc::execNumericStoreAccess(stack.at(stackbase)._var, idxnum, valnum) ) {
+                for ( int i = stackbase; i < stack.count(); i++ )
+                    finExecFlowControl::releaseValue(stack.at(i));
+                stack.resize(stackbase);
+                stack.append(finExecFlowControl::makeNumericValue(valnum));
+                break;
+            }
+
+            finExecVariable *retvar = nullptr;
+            QList<finExecVariable *> oprands;
+            for ( int i = stackbase; i < stack.count(); i++ )
+                oprands.append(finExecFlowControl::buildValueVariable(stack.at(i)));
+            stack.resize(stackbase);
+
+            errcode = finExecOperartorCalc::execStoreAccess(&oprands, &retvar);
+            while ( !oprands.empty() )
+                finExecVariable::releaseNonLeftVariable(oprands.takeFirst());
+            if ( finErrorKits::isErrorResult(errcode) ) {
+                this->appendExecutionError(inst._lexNode, QString("Invalid expression."));
+                goto err;
+            }
+            stack.append(finExecFlowControl::makeVariableValue(retvar));
+            break;
+          }
+
+          case finExecBytecode::BC_CALL:
+          {
+            QList<finExecVariable *> argvals;
+            for ( int i = stack.count() - inst._arg2; i < stack.count(); i++ )
+                argvals.append(finExecFlowControl::buildValueVariable(stack.at(i)));
+            stack.resize(stack.count() - inst._arg2);
+
+            finExecFunction *func = curenv->findFunction(bytecode->getNameIdAt(inst._arg1));
+            if ( func == nullptr ) {
+                while ( !argvals.empty() )
+                    finExecVariable::releaseNonLeftVariable(argvals.takeFirst());
+                this->appendExecutionError(inst._lexNode, QString("Function name not found."));
+                errcode = finErrorKits::EC_NOT_FOUND;
+                goto err;
+            }
+
+            errcode = func->execFunctionByValues(&argvals, inst._lexNode, curenv, this, flowctl);
+            if ( finErrorKits::isErrorResult(errcode) ) {
+                this->appendExecutionError(inst._lexNode, QString("Execute function failed."));
+                goto err;
+            }
+
+            errcode = flowctl->checkFlowForExpress(&goon, inst._lexNode, this);
+            if ( finErrorKits::isErrorResult(errcode) )
+                goto err;
+            if ( !goon )
+                goto halt;
+            stack.append(flowctl->pickReturnValue());
+            break;
+          }
+
+          case finExecBytecode::BC_TREE_EVAL:
+            flowctl->resetFlowControl();
+            errcode = this->instantExecute(bytecode->getSyntaxNodeAt(inst._arg1), curenv, flowctl);
+            if ( finErrorKits::isErrorResult(errcode) )
+                goto err;
+
+            errcode = flowctl->checkFlowForExpress(&goon, inst._lexNode, this);
+            if ( finErrorKits::isErrorResult(errcode) )
+                goto err;
+            if ( !goon )
+                goto halt;
+            stack.append(flowctl->pickReturnValue());
+            break;
+
+          case finExecBytecode::BC_TREE_EXEC:
+            flowctl->resetFlowControl();
+            errcode = this->instantExecute(bytecode->getSyntaxNodeAt(inst._arg1), curenv, flowctl);
+            if ( finErrorKits::isErrorResult(errcode) )
+                goto err;
+
+            if ( flowctl->getType() == finExecFlowControl::TP_RETURN ||
+                 flowctl->getType() == finExecFlowControl::TP_EXIT )
+                goto halt;
+            if ( flowctl->getType() != finExecFlowControl::TP_NEXT ) {
+                this->appendExecutionError(inst._lexNode, QString("Encounter unhandlable flow control."));
+                errcode = finErrorKits::EC_READ_ERROR;
+                goto err;
+            }
+            break;
+
+          case finExecBytecode::BC_SET_RESULT:
+            flowctl->resetFlowControl();
+            flowctl->setReturnValue(stack.takeLast());
+            break;
+
+          case finExecBytecode::BC_CLEAR_RESULT:
+            flowctl->resetFlowControl();
+            break;
+
+          case finExecBytecode::BC_DECLARE:
+            flowctl->resetFlowControl();
+            errcode = this->instExecDeclareDirect(bytecode->getSyntaxNodeAt(inst._arg1), curenv, flowctl);
+            if ( finErrorKits::isErrorResult(errcode) )
+                goto err;
+            if ( inst._arg2 >= 0 )
+                curenv->bindVariableSlot(inst._arg2, flowctl->getReturnVariable());
+            break;
+
+          case finExecBytecode::BC_DECLARE_CHECK:
+            if ( curenv->getVariableHere(bytecode->getNameIdAt(inst._arg1)) != nullptr ) {
+                this->appendExecutionError(inst._lexNode, QString("Variable has already existed."));
+                errcode = finErrorKits::EC_CONTENTION;
+                goto err;
+            }
+            break;
+
+          case finExecBytecode::BC_DECLARE_INIT:
+          {
+            finExecVariable *initvar =
+                    finExecVariable::buildCopyLeftVariable(finExecFlowControl::buildValueVariable(stack.takeLast()));
+            flowctl->resetFlowControl();
+            if ( initvar == nullptr ) {
+                errcode = this->instExecDeclareDirect(bytecode->getSyntaxNodeAt(inst._arg2), curenv, flowctl);
+                if ( finErrorKits::isErrorResult(errcode) )
+                    goto err;
+                if ( inst._arg3 >= 0 )
+                    curenv->bindVariableSlot(inst._arg3, flowctl->getReturnVariable());
+                break;
+            }
+
+            initvar->setNameId(bytecode->getNameIdAt(inst._arg1));
+            errcode = curenv->addVariable(initvar);
+            if ( finErrorKits::isErrorResult(errcode) ) {
+                this->appendExecutionError(inst._lexNode, QString("Environment reject the variable."));
+                delete initvar;
+                goto err;
+            }
+            if ( inst._arg3 >= 0 )
+                curenv->bindVariableSlot(inst._arg3, initvar);
+            flowctl->setReturnVariable(initvar);
+            break;
+          }
+
+          case finExecBytecode::BC_DEF_FUNC:
+            flowctl->resetFlowControl();
+            errcode = this->instExecFunction(bytecode->getSyntaxNodeAt(inst._arg1), curenv, flowctl);
+            if ( finErrorKits::isErrorResult(errcode) )
+                goto err;
+            break;
+
+          case finExecBytecode::BC_ENTER_ENV:
+          {
+            finExecEnvironment *subenv = nullptr;
+            errcode = curenv->buildChildEnvironment(&subenv);
+            if ( finErrorKits::isErrorResult(errcode) )
+                goto err;
+            envstack.append(subenv);
+            curenv = subenv;
+            break;
+          }
+
+          case finExecBytecode::BC_LEAVE_ENV:
+            flowctl->retVarSwitchEnv(curenv);
+            delete envstack.takeLast();
+            curenv = (envstack.empty() ? env : envstack.last());
+            break;
+
+          case finExecBytecode::BC_JUMP:
+            pc = inst._arg1;
+            break;
+
+          case finExecBytecode::BC_JUMP_FALSE:
+          {
+            finExecValue condval = stack.takeLast();
+            bool condok = this->vmValueLogic(condval);
+            finExecFlowControl::releaseValue(condval);
+            if ( !condok )
+                pc = inst._arg1;
+            break;
+          }
+
+          case finExecBytecode::BC_LOOP_EXIT:
+          {
+            // A finished loop leaves its last condition value as the statement result.
+            finExecValue condval = stack.takeLast();
+            if ( this->vmValueLogic(condval) ) {
+                finExecFlowControl::releaseValue(condval);
+                break;
+            }
+            flowctl->resetFlowControl();
+            flowctl->setReturnValue(condval);
+            pc = inst._arg1;
+            break;
+          }
+
+          case finExecBytecode::BC_RETURN:
+          case finExecBytecode::BC_EXIT:
+            flowctl->resetFlowControl();
+            if ( inst._arg1 != 0 )
+                flowctl->setReturnValue(stack.takeLast());
+
+            if ( inst._opCode == finExecBytecode::BC_RETURN ) {
+                flowctl->setType(finExecFlowControl::TP_RETURN);
+            } else {
+                if ( inst._arg1 != 0 )
+                    this->appendExecutionError(inst._lexNode, QString("INFO: Exit requested with a value."));
+                else
+                    this->appendExecutionError(inst._lexNode, QString("INFO: Exit requested with void value."));
+                flowctl->setType(finExecFlowControl::TP_EXIT);
+            }
+            goto halt;
+
+          case finExecBytecode::BC_FLOW_ERROR:
+          default:
+            this->appendExecutionError(inst._lexNode, QString("Encounter unhandlable flow control."));
+            errcode = finErrorKits::EC_READ_ERROR;
+            goto err;
+        }
+    }
+
+halt:
+    // Returning or exiting from inside nested scopes still has to carry the value out of them.
+    while ( !stack.empty() )
+        finExecFlowControl::releaseValue(stack.takeLast());
+    while ( !envstack.empty() ) {
+        finExecEnvironment *subenv = envstack.takeLast();
+        flowctl->retVarSwitchEnv(subenv);
+        delete subenv;
+    }
+    return finErrorKits::EC_SUCCESS;
+
+err:
+    while ( !stack.empty() )
+        finExecFlowControl::releaseValue(stack.takeLast());
+    flowctl->resetFlowControl();
+    while ( !envstack.empty() )
+        delete envstack.takeLast();
+    return errcode;
+}
+
+bool
+finExecMachine::vmValueLogic(const finExecValue &val) const
+{
+    if ( val._isNumeric )
+        return !(val._numVal < 1.0e-8 && val._numVal > -1.0e-8);
+    return finExecOperartorCalc::varLogicValue(val._var);
+}
+
 void
 finExecMachine::appendExecutionOutput(finSyntaxError::Level level, finLexNode *lexnode, const QString &errinfo)
 {
+    QMutexLocker locker(&this->_errListMutex);
     this->_errList.appendEntry(level, finSyntaxError::ST_EXECUTE, lexnode, errinfo);
 }
 
@@ -302,7 +886,7 @@ finExecMachine::instExecDeclareDirect(finSyntaxNode *synnode, finExecEnvironment
     if ( newvar == nullptr )
         return finErrorKits::EC_OUT_OF_MEMORY;
 
-    newvar->setName(lexnode->getString());
+    newvar->setNameId(lexnode->getSymbolId());
     newvar->setType(finExecVariable::TP_NULL);
     newvar->setLeftValue();
     newvar->clearWriteProtected();
@@ -343,7 +927,7 @@ finExecMachine::instExecDeclareAssigned(finSyntaxNode *synnode, finExecEnvironme
         return finErrorKits::EC_READ_ERROR;
     }
 
-    if ( env->getVariableHere(varname_lexnode->getString()) != nullptr ) {
+    if ( env->getVariableHere(varname_lexnode->getSymbolId()) != nullptr ) {
         this->appendExecutionError(lexnode, QString("Variable has already existed."));
         return finErrorKits::EC_CONTENTION;
     }
@@ -363,7 +947,7 @@ finExecMachine::instExecDeclareAssigned(finSyntaxNode *synnode, finExecEnvironme
         return this->instExecDeclareDirect(varname_synnode, env, flowctl);
     }
 
-    initvar->setName(varname_lexnode->getString());
+    initvar->setNameId(varname_lexnode->getSymbolId());
     errcode = env->addVariable(initvar);
     if ( finErrorKits::isErrorResult(errcode) ) {
         this->appendExecutionError(lexnode, QString("Environment reject the variable."));
@@ -461,7 +1045,13 @@ finExecMachine::instExecStatIn(finSyntaxNode *synnode, finExecEnvironment *env,
 
         // Handle 'goto' sub-statement, and other flow control cases.
         if ( flowctl->isFlowGoto() ) {
-            int labelidx = synnode->findLabelIdx(flowctl->getGotoLabel());
+            // A resolved goto names its statement list directly; only unresolved ones search by name.
+            finSyntaxNode *gototarget = flowctl->getGotoTarget();
+            int labelidx;
+            if ( gototarget != nullptr )
+                labelidx = (gototarget == synnode ? flowctl->getGotoLabelIdx() : -1);
+            else
+                labelidx = synnode->findLabelIdx(flowctl->getGotoLabel());
             if ( labelidx >= 0 ) {
                 flowctl->setFlowNext();
                 i = labelidx - 1;
@@ -521,7 +1111,7 @@ finExecMachine::instExecExprVar(finSyntaxNode *synnode, finExecEnvironment *env,
     finExecVariable *retvar;
     finLexNode *lexnode = synnode->getCommandLexNode();
 
-    retvar = env->findVariable(lexnode->getString());
+    retvar = env->findVariable(lexnode->getSymbolId());
     if ( retvar == nullptr ) {
         this->appendExecutionError(lexnode, QString("Cannot find variable."));
         return finErrorKits::EC_NOT_FOUND;
@@ -587,8 +1177,7 @@ finExecMachine::instExecExprFunc(finSyntaxNode *synnode, finExecEnvironment *env
         this->appendExecutionError(fnlexn, QString("Invalid function name."));
         return finErrorKits::EC_READ_ERROR;
     }
-    QString funcname = fnlexn->getString();
-    finExecFunction *func = env->findFunction(funcname);
+    finExecFunction *func = env->findFunction(fnlexn->getSymbolId());
     if ( func == nullptr ) {
         this->appendExecutionError(fnlexn, QString("Function name not found."));
         return finErrorKits::EC_NOT_FOUND;
@@ -609,18 +1198,52 @@ finExecMachine::instExecExprFunc(finSyntaxNode *synnode, finExecEnvironment *env
 }
 
 finErrorCode
-finExecMachine::instExecExprOper(finSyntaxNode *synnode, finExecEnvironment *env, finExecFlowControl *flowctl)
+finExecMachine::instExecExprOper(finSyntaxNode *synnode, finExecEnvironment *env, finExecFlowControl *flowctl,
+                                 bool store)
 {
     finErrorCode errcode = finErrorKits::EC_SUCCESS;
     finLexNode *lexnode = synnode->getCommandLexNode();
+    finLexOperatorType optype = lexnode->getOperator();
     QList<finExecVariable *> oprands;
+    QList<finSyntaxNode *> oprnodes;
+    QList<bool> oprstores;
     finExecVariable *retvar;
 
-    for ( int i = 0; i < synnode->getSubListCount(); i++ ) {
+    // "a[i] = v" and reading a[i][j] go through the item routes, which keep packed arrays packed.
+    bool itemstore = (optype == finLexNode::OP_LET && synnode->getSubListCount() == 2 &&
+                      synnode->getSubSyntaxNode(0)->isOperatorExpress(finLexNode::OP_ACCESS, 2));
+    bool itemread = (!store && synnode->isOperatorExpress(finLexNode::OP_ACCESS, 2));
+    if ( itemstore ) {
+        finSyntaxNode *dstnode = synnode->getSubSyntaxNode(0);
+        oprnodes << dstnode->getSubSyntaxNode(0) << dstnode->getSubSyntaxNode(1) << synnode->getSubSyntaxNode(1);
+        oprstores << true << false << false;
+    } else if ( itemread ) {
+        finSyntaxNode *basenode = synnode;
+        while ( basenode->isOperatorExpress(finLexNode::OP_ACCESS, 2) ) {
+            oprnodes.prepend(basenode->getSubSyntaxNode(1));
+            oprstores.prepend(false);
+            basenode = basenode->getSubSyntaxNode(0);
+        }
+        oprnodes.prepend(basenode);
+        oprstores.prepend(false);
+    } else {
+        for ( int i = 0; i < synnode->getSubListCount(); i++ ) {
+            oprnodes.append(synnode->getSubSyntaxNode(i));
+            oprstores.append(finExecOperartorCalc::isStoreOperand(optype, i, store));
+        }
+    }
+
+    for ( int i = 0; i < oprnodes.count(); i++ ) {
+        finSyntaxNode *oprnode = oprnodes.at(i);
+        finLexNode *oprlexnode = oprnode->getCommandLexNode();
         finExecVariable *oprand;
         flowctl->resetFlowControl();
 
-        errcode = instantExecute(synnode->getSubSyntaxNode(i), env, flowctl);
+        if ( oprstores.at(i) && oprnode->getType() == finSyntaxNode::TP_EXPRESS && oprlexnode != nullptr &&
+             oprlexnode->getType() == finLexNode::TP_OPERATOR && oprlexnode->getOperator() != finLexNode::OP_FUNCTION )
+            errcode = this->instExecExprOper(oprnode, env, flowctl, true);
+        else
+            errcode = instantExecute(oprnode, env, flowctl);
         if ( finErrorKits::isErrorResult(errcode) )
             goto out;
 
@@ -633,7 +1256,12 @@ finExecMachine::instExecExprOper(finSyntaxNode *synnode, finExecEnvironment *env
         oprands.append(oprand);
     }
 
-    errcode = finExecOperartorCalc::execOpCalc(lexnode->getOperator(), &oprands, &retvar);
+    if ( itemstore )
+        errcode = finExecOperartorCalc::execStoreAccess(&oprands, &retvar);
+    else if ( itemread )
+        errcode = finExecOperartorCalc::execReadAccess(&oprands, &retvar);
+    else
+        errcode = finExecOperartorCalc::execOpCalc(optype, &oprands, &retvar);
     if ( finErrorKits::isErrorResult(errcode) ) {
         this->appendExecutionError(lexnode, QString("Invalid expression."));
         goto out;
@@ -692,7 +1320,7 @@ finExecMachine::instExecFuncName(finSyntaxNode *synnode, finExecEnvironment *env
     }
 
     QString funcname = lexnode->getString();
-    if ( env->getFunctionHere(funcname) != nullptr ) {
+    if ( env->getFunctionHere(lexnode->getSymbolId()) != nullptr ) {
         this->appendExecutionError(lexnode, QString("Function is redefined."));
         return finErrorKits::EC_CONTENTION;
     }
@@ -1178,7 +1806,10 @@ finErrorCode finExecMachine::instExecJumpGoto(finSyntaxNode *synnode, finExecFlo
         return finErrorKits::EC_READ_ERROR;
     }
 
-    flowctl->setGotoAndLabel(lbllexnode->getString());
+    if ( synnode->getJumpTarget() != nullptr )
+        flowctl->setGotoAndTarget(lbllexnode->getString(), synnode->getJumpTarget(), synnode->getJumpLabelIdx());
+    else
+        flowctl->setGotoAndLabel(lbllexnode->getString());
     return finErrorKits::EC_SUCCESS;
 }
 
@@ -16,10 +16,14 @@
 #define FINEXECMACHINE_H
 
 #include <QString>
+#include <QStringList>
 #include <QList>
+#include <QMutex>
 
 #include "finErrorCode.h"
+#include "finExecBytecode.h"
 #include "finExecFlowControl.h"
+#include "finExecPool.h"
 #include "finExecCompiler.h"
 #include "finFigureContainer.h"
 #include "finLexNode.h"
@@ -27,6 +31,7 @@
 #include "finSyntaxError.h"
 #include "finSyntaxErrorDump.h"
 #include "finSyntaxErrorList.h"
+#include "finSyntaxOptimzer.h"
 #include "finSyntaxTree.h"
 
 class finExecVariable;
@@ -45,12 +50,25 @@ class finExecMachine;
  *  During execution it uses finExecFlowControl to propagate return values and non-local control-flow
  *  states between nested execution helpers.
  *
+ *  By default the compiled syntax tree is further lowered into finExecBytecode and run by a small
+ *  stack VM; the recursive tree walker stays available as the EM_TREE_WALK execution mode, and the VM
+ *  falls back to it for any construct the lowering pass leaves as a syntax-node escape.
+ *
  *  \see finExecCompiler
  *  \see finExecEnvironment
  *  \see finExecFlowControl
  */
 class finExecMachine
 {
+public:
+    /*! \enum finExecMachine::ExecMode
+     *  \brief Strategy used by execute() to run the compiled script.
+     */
+    enum ExecMode {
+        EM_TREE_WALK,  //!< Walk the syntax tree recursively.
+        EM_BYTECODE    //!< Lower the syntax tree into bytecode and run it on the VM.
+    };
+
 protected:
     QString _name;                         //!< Human-readable machine name for diagnostics and UI.
 
@@ -60,6 +78,15 @@ protected:
     finExecCompiler _compiler;             //!< Compiler wrapper that produces the syntax tree.
     finSyntaxTree *_synTree;               //!< Last compiled syntax tree, owned by this machine.
     finSyntaxErrorList _errList;           //!< Execution diagnostics accumulated by this machine.
+    QMutex _errListMutex;                  //!< Serializes diagnostics appended by plotting worker threads.
+
+    ExecMode _execMode;                    //!< Execution strategy used by execute().
+    finExecBytecode *_byteCode;            //!< Bytecode lowered from _synTree, owned by this machine.
+    QStringList _optOptions;               //!< Optimizer passes compile() applies to a fresh tree; none by default.
+    int _plotWorkerCnt;                    //!< Threads an implicit-equation plot may solve with.
+
+    finExecPoolCounter _varPoolCounter;    //!< Variable-pool activity of the last execute() call.
+    finExecPoolCounter _envPoolCounter;    //!< Environment-pool activity of the last execute() call.
 
 public:
     /*! \name Construction And Lifetime
@@ -108,11 +135,47 @@ public:
 
     /*! \brief Returns one execution diagnostic by index. */
     finSyntaxError getExecuteErrorAt(int idx) const;
+
+    /*! \brief Returns the execution strategy used by execute(). */
+    ExecMode getExecMode() const;
+
+    /*! \brief Returns the lowered bytecode of the compiled script, or \c nullptr. */
+    finExecBytecode *getBytecode();
+
+    /*! \brief Returns the finSyntaxOptimzer passes applied by compile(). */
+    QStringList getOptimizeOption() const;
+
+    /*! \brief Returns how many threads implicit-equation plots solve with; 1 keeps them serial. */
+    int getPlotWorkerCount() const;
+
+    /*! \brief Returns how many variable allocations the pool absorbed during the last execute() on its thread. */
+    finExecPoolCounter getVariablePoolCounter() const;
+
+    /*! \brief Returns how many environment allocations the pool absorbed during the last execute() on its thread. */
+    finExecPoolCounter getEnvironmentPoolCounter() const;
     ///@}
 
     /*! \brief Sets the machine name. */
     void setName(const QString &name);
 
+    /*! \brief Selects the execution strategy used by execute(). */
+    void setExecMode(ExecMode mode);
+
+    /*! \brief Selects the finSyntaxOptimzer passes applied by compile(); an empty list disables them.
+     *
+     *  A new machine runs no passes. Callers opt in, usually with finSyntaxOptimzer::getDefaultOption().
+     */
+    void setOptimizeOption(const QStringList &options);
+
+    /*! \brief Sets how many threads implicit-equation plots solve with.
+     *
+     *  Zero or negative picks one thread per logical core. With more than one thread the equation function
+     *  runs concurrently in child environments, so it must not write or link variables outside its scope;
+     *  one that names an array of the calling scope is solved serially (finPlotParallel::isWorkerSafe()).
+     *  plot_function always samples serially, because each of its steps depends on the previous point.
+     */
+    void setPlotWorkerCount(int cnt);
+
     /*! \name Environment Setup
      *  \brief Initialize the base execution environment for a script run.
      */
@@ -121,8 +184,19 @@ public:
     /*! \brief Creates a base child environment under \a prevenv or under root when \a prevenv is null. */
     finErrorCode initEnvironment(finExecEnvironment *prevenv);
 
-    /*! \brief Creates a base child environment directly under the global root environment. */
+    /*! \brief Creates a base child environment directly under the global root environment.
+     *
+     *  The base environment then is the machine's own global scope. The root is read-only and shared, so
+     *  machines set up this way may run on different threads at the same time.
+     */
     finErrorCode initEnvironmentFromRoot();
+
+    /*! \brief Replaces the base environment with an empty one under the same parent.
+     *
+     *  Drops whatever earlier executions defined, so that a compiled machine can run its script again
+     *  from a clean state.
+     */
+    finErrorCode resetEnvironment();
     ///@}
 
     /*! \name Input And Output Configuration
@@ -163,6 +237,13 @@ public:
      *  finExecFunction.
      */
     finErrorCode instantExecute(finSyntaxNode *synnode, finExecEnvironment *env, finExecFlowControl *flowctl);
+
+    /*! \brief Executes one syntax node with the current execution strategy.
+     *
+     *  Runs the lowered code unit of \a synnode when the machine is in EM_BYTECODE mode and one exists
+     *  (e.g. the body of a user function), and falls back to instantExecute() otherwise.
+     */
+    finErrorCode executeSyntaxNode(finSyntaxNode *synnode, finExecEnvironment *env, finExecFlowControl *flowctl);
     ///@}
 
     /*! \name Diagnostic Reporting
@@ -181,6 +262,15 @@ public:
     ///@}
 
 private:
+    /*! \name Bytecode Execution
+     *  \brief Lower the compiled syntax tree and run the resulting code units.
+     */
+    ///@{
+    finErrorCode prepareBytecode();
+    finErrorCode vmExecute(finExecBytecode *bytecode, finExecEnvironment *env, finExecFlowControl *flowctl);
+    bool vmValueLogic(const finExecValue &val) const;
+    ///@}
+
     /*! \name Top-Level Syntax Dispatch
      *  \brief Dispatch one syntax node by its high-level finSyntaxNode type.
      */
@@ -219,7 +309,8 @@ private:
     finErrorCode instExecExprNum(finSyntaxNode *synnode, finExecFlowControl *flowctl);
     finErrorCode instExecExprStr(finSyntaxNode *synnode, finExecFlowControl *flowctl);
     finErrorCode instExecExprFunc(finSyntaxNode *synnode, finExecEnvironment *env, finExecFlowControl *flowctl);
-    finErrorCode instExecExprOper(finSyntaxNode *synnode, finExecEnvironment *env, finExecFlowControl *flowctl);
+    finErrorCode instExecExprOper(finSyntaxNode *synnode, finExecEnvironment *env, finExecFlowControl *flowctl,
+                                  bool store = false);
     ///@}
 
     /*! \name Function Definition Helpers
@@ -271,4 +362,9 @@ private:
     ///@}
 };
 
+/*! \typedef finExecMachineExecMode
+ *  \brief Shorthand alias for finExecMachine::ExecMode.
+ */
+typedef finExecMachine::ExecMode finExecMachineExecMode;
+
 #endif // FINEXECMACHINE_H
@@ -139,6 +139,312 @@ finExecOperartorCalc::execOpCalc(
     return curitem->_opcall(oprands, retval);
 }
 
+int finExecOperartorCalc::findOpCalcIdx(finLexOperatorType optype)
+{
+    for ( int i = 0; i < _glOperatorCalcDbCnt; i++ ) {
+        if ( _glOperatorCalcDb[i]._optype == optype )
+            return i;
+    }
+    return -1;
+}
+
+finErrorCode
+finExecOperartorCalc::execOpCalcAt(int opidx, QList<finExecVariable *> *oprands, finExecVariable **retval)
+{
+    if ( oprands == nullptr || retval == nullptr )
+        return finErrorKits::EC_NULL_POINTER;
+    if ( opidx < 0 || opidx >= _glOperatorCalcDbCnt )
+        return finErrorKits::EC_NOT_FOUND;
+
+    struct finExecOperartorCalcDatabase *curitem = &_glOperatorCalcDb[opidx];
+    if ( curitem->_opcall == nullptr )
+        return finErrorKits::EC_NOT_FOUND;
+
+    if ( oprands->count() < curitem->_oprandCnt )
+        return finErrorKits::EC_INVALID_PARAM;
+
+    return curitem->_opcall(oprands, retval);
+}
+
+/*
+ * Computes a numeric-only operator directly on doubles, without any finExecVariable. The results match the
+ * generic operator calls for numeric operands exactly; comparisons and logic operators yield 1.0 or 0.0 as
+ * buildStdLogicVar does. Returns false when the operator or its operand count has no numeric fast path, in
+ * which case the caller must fall back to execOpCalc.
+ */
+bool
+finExecOperartorCalc::execNumericOpCalc(finLexOperatorType optype, int oprandcnt,
+                                        double opnum1, double opnum2, double *retnum)
+{
+    if ( retnum == nullptr )
+        return false;
+
+    bool blval1 = !(opnum1 < 1.0e-8 && opnum1 > -1.0e-8);
+    bool blval2 = !(opnum2 < 1.0e-8 && opnum2 > -1.0e-8);
+
+    if ( oprandcnt == 1 ) {
+        switch ( optype ) {
+          case finLexNode::OP_POSITIVE:
+            *retnum = opnum1;
+            return true;
+
+          case finLexNode::OP_NEGATIVE:
+            *retnum = 0.0 - opnum1;
+            return true;
+
+          case finLexNode::OP_LOGIC_NOT:
+            *retnum = (blval1 ? 0.0 : 1.0);
+            return true;
+
+          default:
+            return false;
+        }
+    } else if ( oprandcnt != 2 ) {
+        return false;
+    }
+
+    switch ( optype ) {
+      case finLexNode::OP_ADD:
+        *retnum = opnum1 + opnum2;
+        break;
+
+      case finLexNode::OP_SUB:
+        *retnum = opnum1 - opnum2;
+        break;
+
+      case finLexNode::OP_MUL:
+        *retnum = opnum1 * opnum2;
+        break;
+
+      case finLexNode::OP_DIV:
+        *retnum = opnum1 / opnum2;
+        break;
+
+      case finLexNode::OP_MOD:
+        *retnum = opnum1 - (floor(opnum1 / opnum2) * opnum2);
+        break;
+
+      case finLexNode::OP_POWER:
+        *retnum = pow(opnum1, opnum2);
+        break;
+
+      case finLexNode::OP_EQUAL:
+        *retnum = (opnum1 == opnum2 ? 1.0 : 0.0);
+        break;
+
+      case finLexNode::OP_NONEQUAL:
+        *retnum = (opnum1 == opnum2 ? 0.0 : 1.0);
+        break;
+
+      case finLexNode::OP_GRT:
+        *retnum = (opnum1 > opnum2 ? 1.0 : 0.0);
+        break;
+
+      case finLexNode::OP_LES:
+        *retnum = (opnum1 < opnum2 ? 1.0 : 0.0);
+        break;
+
+      case finLexNode::OP_GRT_EQ:
+        *retnum = (opnum1 >= opnum2 ? 1.0 : 0.0);
+        break;
+
+      case finLexNode::OP_LES_EQ:
+        *retnum = (opnum1 <= opnum2 ? 1.0 : 0.0);
+        break;
+
+      case finLexNode::OP_LOGIC_AND:
+        *retnum = (blval1 && blval2 ? 1.0 : 0.0);
+        break;
+
+      case finLexNode::OP_LOGIC_OR:
+        *retnum = (blval1 || blval2 ? 1.0 : 0.0);
+        break;
+
+      case finLexNode::OP_LOGIC_XOR:
+        *retnum = (blval1 == blval2 ? 0.0 : 1.0);
+        break;
+
+      default:
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Tells whether operand idx of an operator is written to: the target of an assignment, the operand of an
+ * increment or decrement, and, when the operator itself is a store target (store), the array of an access or
+ * whatever a bracket or comma passes through.
+ */
+bool finExecOperartorCalc::isStoreOperand(finLexOperatorType optype, int idx, bool store)
+{
+    switch ( optype ) {
+      case finLexNode::OP_LET:
+        return (idx == 0);
+
+      case finLexNode::OP_ACCUMLT:
+      case finLexNode::OP_ACCUMLT_2:
+      case finLexNode::OP_DESCEND:
+      case finLexNode::OP_DESCEND_2:
+        return true;
+
+      case finLexNode::OP_ACCESS:
+        return (store && idx == 0);
+
+      case finLexNode::OP_L_RND_BRCKT:
+      case finLexNode::OP_L_SQR_BRCKT:
+      case finLexNode::OP_COMMA:
+        return store;
+
+      default:
+        return false;
+    }
+}
+
+static finExecVariable *_buildNumericTempVar(double numval)
+{
+    finExecVariable *retvar = new finExecVariable();
+    if ( retvar == nullptr )
+        return nullptr;
+
+    retvar->setType(finExecVariable::TP_NUMERIC);
+    retvar->setNumericValue(numval);
+    retvar->setWriteProtected();
+    retvar->clearLeftValue();
+    return retvar;
+}
+
+/*
+ * Reads an item chain such as m[i][j], where oprands hold the array followed by each index. Unlike the access
+ * operator, which hands out the item variable itself and so has to unpack a packed array first, the items of a
+ * packed array are read from its buffer into temporaries, and the array is left untouched.
+ */
+finErrorCode
+finExecOperartorCalc::execReadAccess(QList<finExecVariable *> *oprands, finExecVariable **retval)
+{
+    if ( oprands == nullptr || retval == nullptr )
+        return finErrorKits::EC_NULL_POINTER;
+    if ( oprands->count() < 2 )
+        return finErrorKits::EC_INVALID_PARAM;
+
+    finExecVariable *curvar = oprands->at(0);
+    bool owned = false;
+    for ( int i = 1; i < oprands->count(); i++ ) {
+        finExecVariable *parent = finExecVariable::transLinkTarget(curvar);
+        finExecVariable *aryidx = finExecVariable::transLinkTarget(oprands->at(i));
+        finExecVariable *child = nullptr;
+        finErrorCode errcode = finErrorKits::EC_SUCCESS;
+
+        if ( parent != nullptr && parent->isPackedArray() &&
+             aryidx != nullptr && aryidx->getType() == finExecVariable::TP_NUMERIC ) {
+            int idx = (int)aryidx->getNumericValue();
+            finExecVariable *colidx = (i + 1 < oprands->count() ?
+                                           finExecVariable::transLinkTarget(oprands->at(i + 1)) : nullptr);
+            double numval;
+
+            if ( colidx != nullptr && colidx->getType() == finExecVariable::TP_NUMERIC &&
+                 parent->readPackedItemAt(idx, (int)colidx->getNumericValue(), &numval) ) {
+                child = _buildNumericTempVar(numval);
+                if ( child == nullptr )
+                    errcode = finErrorKits::EC_OUT_OF_MEMORY;
+                i++;
+            } else {
+                child = parent->buildPackedItemAt(idx);
+            }
+        }
+        if ( child == nullptr && !finErrorKits::isErrorResult(errcode) ) {
+            // Not packed, or out of range: the access operator grows the array just as before.
+            QList<finExecVariable *> accoprands;
+            accoprands.append(curvar);
+            accoprands.append(oprands->at(i));
+            errcode = _accessOpCall(&accoprands, &child);
+        }
+
+        if ( owned )
+            finExecVariable::releaseNonLeftVariable(curvar);
+        if ( finErrorKits::isErrorResult(errcode) )
+            return errcode;
+        curvar = child;
+        owned = true;
+    }
+
+    *retval = curvar;
+    return finErrorKits::EC_SUCCESS;
+}
+
+/*
+ * Stores oprands[2] into the item oprands[1] of the array oprands[0], as "a[i] = v" does. A number stored into an
+ * existing item of a packed array is written into the buffer; any other store unpacks the array and goes through the
+ * access and assignment operators.
+ */
+finErrorCode
+finExecOperartorCalc::execStoreAccess(QList<finExecVariable *> *oprands, finExecVariable **retval)
+{
+    if ( oprands == nullptr || retval == nullptr )
+        return finErrorKits::EC_NULL_POINTER;
+    if ( oprands->count() < 3 )
+        return finErrorKits::EC_INVALID_PARAM;
+
+    finExecVariable *aryidx = finExecVariable::transLinkTarget(oprands->at(1));
+    finExecVariable *srcvar = finExecVariable::transLinkTarget(oprands->at(2));
+    if ( aryidx != nullptr && aryidx->getType() == finExecVariable::TP_NUMERIC &&
+         srcvar != nullptr && srcvar->getType() == finExecVariable::TP_NUMERIC &&
+         finExecOperartorCalc::execNumericStoreAccess(oprands->at(0), aryidx->getNumericValue(),
+                                                      srcvar->getNumericValue()) ) {
+        *retval = _buildNumericTempVar(srcvar->getNumericValue());
+        if ( *retval == nullptr )
+            return finErrorKits::EC_OUT_OF_MEMORY;
+        return finErrorKits::EC_SUCCESS;
+    }
+
+    finExecVariable *child = nullptr;
+    QList<finExecVariable *> letoprands;
+    letoprands.append(oprands->at(0));
+    letoprands.append(oprands->at(1));
+    finErrorCode errcode = _accessOpCall(&letoprands, &child);
+    if ( finErrorKits::isErrorResult(errcode) )
+        return errcode;
+
+    letoprands.clear();
+    letoprands.append(child);
+    letoprands.append(oprands->at(2));
+    errcode = _letOpCall(&letoprands, retval);
+    if ( finErrorKits::isErrorResult(errcode) )
+        finExecVariable::releaseNonLeftVariable(child);
+    return errcode;
+}
+
+/*
+ * The numeric-only form of execReadAccess: reads a[i] or m[i][j] from a packed array straight into a double.
+ * Returns false whenever the item is not a number held in a packed buffer.
+ */
+bool
+finExecOperartorCalc::execNumericReadAccess(finExecVariable *parent, int idxcnt, const double *idxlist,
+                                            double *retnum)
+{
+    parent = finExecVariable::transLinkTarget(parent);
+    if ( parent == nullptr || idxlist == nullptr || retnum == nullptr )
+        return false;
+
+    if ( idxcnt == 1 )
+        return parent->readPackedItemAt((int)idxlist[0], retnum);
+    else if ( idxcnt == 2 )
+        return parent->readPackedItemAt((int)idxlist[0], (int)idxlist[1], retnum);
+    return false;
+}
+
+/*
+ * The numeric-only form of execStoreAccess: writes a number into an existing item of a packed array. Returns false,
+ * having changed nothing, when the store has to take the generic path.
+ */
+bool finExecOperartorCalc::execNumericStoreAccess(finExecVariable *parent, double idx, double val)
+{
+    parent = finExecVariable::transLinkTarget(parent);
+    if ( parent == nullptr || !parent->isLeftValue() )
+        return false;
+
+    return parent->writePackedItemAt((int)idx, val);
+}
+
 static finErrorCode
 _brcktOpCall(QList<finExecVariable *> *oprands, finExecVariable **retval)
 {
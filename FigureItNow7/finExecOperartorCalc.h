@@ -32,6 +32,18 @@ public:
 
     static finErrorCode execOpCalc(finLexOperatorType optype,
                                    QList<finExecVariable *> *oprands, finExecVariable **retval);
+
+    static int findOpCalcIdx(finLexOperatorType optype);
+    static finErrorCode execOpCalcAt(int opidx, QList<finExecVariable *> *oprands, finExecVariable **retval);
+
+    static bool execNumericOpCalc(finLexOperatorType optype, int oprandcnt,
+                                  double opnum1, double opnum2, double *retnum);
+
+    static bool isStoreOperand(finLexOperatorType optype, int idx, bool store);
+    static finErrorCode execReadAccess(QList<finExecVariable *> *oprands, finExecVariable **retval);
+    static finErrorCode execStoreAccess(QList<finExecVariable *> *oprands, finExecVariable **retval);
+    static bool execNumericReadAccess(finExecVariable *parent, int idxcnt, const double *idxlist, double *retnum);
+    static bool execNumericStoreAccess(finExecVariable *parent, double idx, double val);
 };
 
 #endif // FINEXECOPERARTORCLAC_H
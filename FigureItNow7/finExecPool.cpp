@@ -0,0 +1,256 @@
+/*-
+ * GNU GENERAL PUBLIC LICENSE, version 3
+ * See LICENSE file for detail.
+ *
+ * Author: Yulong Yu
+ * Copyright(c) 2015-2026 Yulong Yu. All rights reserved.
+ */
+
+/*! \file finExecPool.cpp
+ *  \brief Implementations of the fixed-size object pool and the chunked object arena.
+ */
+
+#include "finExecPool.h"
+
+#include <new>
+
+#include <stddef.h>
+
+
+finExecPoolCache::finExecPoolCache()
+{
+    this->_freeList = nullptr;
+    this->_freeCount = 0;
+    this->_counter._heapAllocCnt = 0;
+    this->_counter._reuseCnt = 0;
+    this->_counter._releaseCnt = 0;
+}
+
+finExecPoolCache::~finExecPoolCache()
+{
+    this->trim();
+}
+
+void finExecPoolCache::trim()
+{
+    void *blklist = this->_freeList;
+    this->_freeList = nullptr;
+    this->_freeCount = 0;
+
+    while ( blklist != nullptr ) {
+        void *nextblk = *(void **)blklist;
+        ::operator delete(blklist);
+        blklist = nextblk;
+    }
+}
+
+finExecObjectPool::finExecObjectPool(const QString &name, size_t blksize, int maxfreecnt)
+    : _poolName(name), _localCache()
+{
+    // Each free block stores the link to the next one in its first bytes.
+    this->_blockSize = (blksize < sizeof (void *) ? sizeof (void *) : blksize);
+    this->_maxFreeCount = maxfreecnt;
+}
+
+finExecObjectPool::~finExecObjectPool()
+{
+    this->trim();
+}
+
+QString finExecObjectPool::getPoolName() const
+{
+    return this->_poolName;
+}
+
+size_t finExecObjectPool::getBlockSize() const
+{
+    return this->_blockSize;
+}
+
+finExecPoolCache *finExecObjectPool::getLocalCache() const
+{
+    finExecPoolCache *cache = this->_localCache.localData();
+    if ( cache == nullptr ) {
+        cache = new finExecPoolCache();
+        this->_localCache.setLocalData(cache);
+    }
+    return cache;
+}
+
+int finExecObjectPool::getFreeCount() const
+{
+    return this->getLocalCache()->_freeCount;
+}
+
+finExecPoolCounter finExecObjectPool::getCounter() const
+{
+    return this->getLocalCache()->_counter;
+}
+
+finExecPoolCounter
+finExecObjectPool::diffCounter(const finExecPoolCounter &from, const finExecPoolCounter &to)
+{
+    finExecPoolCounter diff;
+    diff._heapAllocCnt = to._heapAllocCnt - from._heapAllocCnt;
+    diff._reuseCnt = to._reuseCnt - from._reuseCnt;
+    diff._releaseCnt = to._releaseCnt - from._releaseCnt;
+    return diff;
+}
+
+void *finExecObjectPool::allocate(size_t size)
+{
+    if ( size != this->_blockSize )
+        return ::operator new(size);
+
+    finExecPoolCache *cache = this->getLocalCache();
+    if ( cache->_freeList != nullptr ) {
+        void *blk = cache->_freeList;
+        cache->_freeList = *(void **)blk;
+        cache->_freeCount--;
+        cache->_counter._reuseCnt++;
+        return blk;
+    }
+    cache->_counter._heapAllocCnt++;
+    return ::operator new(this->_blockSize);
+}
+
+void finExecObjectPool::release(void *ptr, size_t size)
+{
+    if ( ptr == nullptr )
+        return;
+    if ( size != this->_blockSize ) {
+        ::operator delete(ptr);
+        return;
+    }
+
+    finExecPoolCache *cache = this->getLocalCache();
+    cache->_counter._releaseCnt++;
+    if ( cache->_freeCount < this->_maxFreeCount ) {
+        *(void **)ptr = cache->_freeList;
+        cache->_freeList = ptr;
+        cache->_freeCount++;
+        return;
+    }
+    ::operator delete(ptr);
+}
+
+void finExecObjectPool::trim()
+{
+    if ( this->_localCache.hasLocalData() && this->_localCache.localData() != nullptr )
+        this->_localCache.localData()->trim();
+}
+
+// Every arena block starts with the arena it belongs to, padded to keep the object maximally aligned.
+static const size_t _finArenaHeadSize = alignof (max_align_t);
+
+thread_local finExecObjectArena *finExecObjectArena::_curArena = nullptr;
+
+finExecObjectArena::Scope::Scope(finExecObjectArena *arena)
+{
+    this->_prevArena = finExecObjectArena::_curArena;
+    finExecObjectArena::_curArena = arena;
+}
+
+finExecObjectArena::Scope::~Scope()
+{
+    finExecObjectArena::_curArena = this->_prevArena;
+}
+
+finExecObjectArena::finExecObjectArena(const QString &name, size_t objsize, int chunkcnt)
+    : _arenaName(name), _chunkList()
+{
+    size_t alignsize = (objsize + _finArenaHeadSize - 1) / _finArenaHeadSize * _finArenaHeadSize;
+    this->_objSize = objsize;
+    this->_blockSize = _finArenaHeadSize + alignsize;
+    this->_chunkCount = (chunkcnt < 1 ? 1 : chunkcnt);
+    this->_freeList = nullptr;
+    this->_liveCount = 0;
+    this->_counter._heapAllocCnt = 0;
+    this->_counter._reuseCnt = 0;
+    this->_counter._releaseCnt = 0;
+}
+
+finExecObjectArena::~finExecObjectArena()
+{
+    Q_ASSERT(this->_liveCount == 0);
+    if ( this->_liveCount != 0 )
+        return;
+
+    foreach ( void *chunk, this->_chunkList )
+        ::operator delete(chunk);
+    this->_chunkList.clear();
+    this->_freeList = nullptr;
+}
+
+QString finExecObjectArena::getArenaName() const
+{
+    return this->_arenaName;
+}
+
+size_t finExecObjectArena::getObjectSize() const
+{
+    return this->_objSize;
+}
+
+int finExecObjectArena::getLiveCount() const
+{
+    return this->_liveCount;
+}
+
+finExecPoolCounter finExecObjectArena::getCounter() const
+{
+    return this->_counter;
+}
+
+finExecObjectArena *finExecObjectArena::getCurrentArena()
+{
+    return finExecObjectArena::_curArena;
+}
+
+void *finExecObjectArena::allocate(size_t size)
+{
+    finExecObjectArena *arena = finExecObjectArena::_curArena;
+    char *blk;
+    if ( arena == nullptr || size != arena->_objSize ) {
+        arena = nullptr;
+        blk = static_cast<char *>(::operator new(_finArenaHeadSize + size));
+    } else if ( arena->_freeList != nullptr ) {
+        blk = static_cast<char *>(arena->_freeList);
+        arena->_freeList = *(void **)blk;
+        arena->_liveCount++;
+        arena->_counter._reuseCnt++;
+    } else {
+        // Hand out the first block of a new chunk and queue the rest in address order.
+        char *chunk = static_cast<char *>(::operator new(arena->_blockSize * arena->_chunkCount));
+        arena->_chunkList.append(chunk);
+        for ( int i = arena->_chunkCount - 1; i > 0; i-- ) {
+            void *freeblk = chunk + arena->_blockSize * i;
+            *(void **)freeblk = arena->_freeList;
+            arena->_freeList = freeblk;
+        }
+        blk = chunk;
+        arena->_liveCount++;
+        arena->_counter._heapAllocCnt++;
+    }
+
+    *(finExecObjectArena **)blk = arena;
+    return blk + _finArenaHeadSize;
+}
+
+void finExecObjectArena::release(void *ptr)
+{
+    if ( ptr == nullptr )
+        return;
+
+    char *blk = static_cast<char *>(ptr) - _finArenaHeadSize;
+    finExecObjectArena *arena = *(finExecObjectArena **)blk;
+    if ( arena == nullptr ) {
+        ::operator delete(blk);
+        return;
+    }
+
+    *(void **)blk = arena->_freeList;
+    arena->_freeList = blk;
+    arena->_liveCount--;
+    arena->_counter._releaseCnt++;
+}
@@ -0,0 +1,199 @@
+/*-
+ * GNU GENERAL PUBLIC LICENSE, version 3
+ * See LICENSE file for detail.
+ *
+ * Author: Yulong Yu
+ * Copyright(c) 2015-2026 Yulong Yu. All rights reserved.
+ */
+/*! \file finExecPool.h
+ *  \brief Declarations of the fixed-size object pool backing runtime variables and environments.
+ *
+ *  This header defines finExecObjectPool, a typed free-list allocator that finExecVariable and
+ *  finExecEnvironment route their class-specific operator new / delete through, so the short-lived
+ *  temporaries and call environments of a script run recycle memory instead of hitting the heap; and
+ *  finExecObjectArena, the chunked arena that holds the nodes of one syntax tree.
+ */
+
+#ifndef FINEXECPOOL_H
+#define FINEXECPOOL_H
+
+#include <QList>
+#include <QString>
+#include <QThreadStorage>
+#include <QtGlobal>
+
+#include <stddef.h>
+
+
+/*! \struct finExecPoolCounter
+ *  \brief Snapshot of the allocation counters of one finExecObjectPool.
+ */
+struct finExecPoolCounter {
+    quint64 _heapAllocCnt;  //!< Heap requests for new blocks; one per chunk in an arena.
+    quint64 _reuseCnt;      //!< Allocations served from the free list, i.e. absorbed by the pool.
+    quint64 _releaseCnt;    //!< Blocks given back to the pool.
+};
+
+/*! \struct finExecPoolCache
+ *  \brief The free list and counters one thread keeps for one finExecObjectPool.
+ *
+ *  Destroying the cache, which QThreadStorage does when its thread finishes, returns its blocks to the heap.
+ */
+struct finExecPoolCache {
+    void *_freeList;             //!< Head of the free list of released blocks.
+    int _freeCount;              //!< Number of blocks on the free list.
+    finExecPoolCounter _counter; //!< Allocation counters of this thread.
+
+    finExecPoolCache();
+    ~finExecPoolCache();
+
+    /*! \brief Returns every block on the free list to the heap. */
+    void trim();
+};
+
+/*! \class finExecObjectPool
+ *  \brief A free-list pool of fixed-size memory blocks, kept separately by each thread.
+ *
+ *  Released blocks are kept on a singly linked free list (the link lives in the block itself) and handed
+ *  out again by the next allocation of the same size. Requests of any other size, e.g. from a derived
+ *  class, bypass the pool. The free list is bounded during execution and emptied by trim(), which
+ *  finExecMachine::execute() calls when a script run finishes; live objects are never affected.
+ *
+ *  Each thread has its own free list and counters, so allocation takes no lock, and machines running on
+ *  different threads neither wait for each other nor see each other's counts. A block released on another
+ *  thread than the one that allocated it simply joins the releasing thread's free list. The counters,
+ *  getFreeCount() and trim() all refer to the calling thread.
+ *
+ *  \see finExecVariable
+ *  \see finExecEnvironment
+ */
+class finExecObjectPool
+{
+protected:
+    QString _poolName;           //!< Name used in diagnostics.
+    size_t _blockSize;           //!< Size of the blocks managed by this pool.
+    int _maxFreeCount;           //!< Upper bound of blocks kept on each thread's free list.
+
+    mutable QThreadStorage<finExecPoolCache *> _localCache;  //!< Free list and counters of each thread.
+
+    /*! \brief Returns the cache of the calling thread, creating it on first use. */
+    finExecPoolCache *getLocalCache() const;
+
+public:
+    /*!
+     *  \brief Constructs an empty pool managing blocks of \a blksize bytes.
+     */
+    finExecObjectPool(const QString &name, size_t blksize, int maxfreecnt = 65536);
+
+    /*!
+     *  \brief Destroys the pool and returns the blocks cached by the calling thread to the heap.
+     */
+    ~finExecObjectPool();
+
+    /*! \brief Returns the pool name. */
+    QString getPoolName() const;
+
+    /*! \brief Returns the size of the blocks managed by this pool. */
+    size_t getBlockSize() const;
+
+    /*! \brief Returns the number of blocks currently cached on the calling thread's free list. */
+    int getFreeCount() const;
+
+    /*! \brief Returns a snapshot of the allocation counters of the calling thread. */
+    finExecPoolCounter getCounter() const;
+
+    /*! \brief Returns the counters accumulated between two snapshots \a from and \a to. */
+    static finExecPoolCounter diffCounter(const finExecPoolCounter &from, const finExecPoolCounter &to);
+
+    /*! \brief Allocates \a size bytes, from the free list when \a size equals the block size. */
+    void *allocate(size_t size);
+
+    /*! \brief Releases memory obtained from allocate() with the same \a size. */
+    void release(void *ptr, size_t size);
+
+    /*! \brief Returns the free blocks cached by the calling thread to the heap. */
+    void trim();
+};
+
+/*! \class finExecObjectArena
+ *  \brief A chunked arena of fixed-size blocks that belongs to one owner, such as a syntax tree.
+ *
+ *  Blocks are carved from arrays of \a chunkcnt blocks, so objects allocated together sit next to each
+ *  other and the heap is asked once per chunk. A released block goes back onto the free list of its own
+ *  arena, and all chunks return to the heap at once when the arena is destroyed; the owner has to release
+ *  every block before that.
+ *
+ *  allocate() takes its blocks from the arena a finExecObjectArena::Scope made current on the calling
+ *  thread, or from the heap if there is none. Each block is preceded by a header naming the arena it came
+ *  from, so release() puts it back to the right place whatever scope is active. An arena has no lock: it
+ *  must only be used by the thread that works on its owner.
+ *
+ *  \see finSyntaxNode
+ *  \see finSyntaxTree
+ */
+class finExecObjectArena
+{
+protected:
+    QString _arenaName;          //!< Name used in diagnostics.
+    size_t _objSize;             //!< Size of the objects served from this arena.
+    size_t _blockSize;           //!< Size of one block, the header included.
+    int _chunkCount;             //!< Blocks carved from one heap request.
+    QList<void *> _chunkList;    //!< Chunks obtained from the heap.
+
+    void *_freeList;             //!< Head of the free list of unused blocks.
+    int _liveCount;              //!< Number of blocks handed out and not yet released.
+    finExecPoolCounter _counter; //!< Allocation counters accumulated since the arena was created.
+
+    static thread_local finExecObjectArena *_curArena;  //!< Arena made current on this thread, if any.
+
+    Q_DISABLE_COPY(finExecObjectArena)
+
+public:
+    /*! \class finExecObjectArena::Scope
+     *  \brief Makes an arena current on the calling thread for the lifetime of the scope object.
+     */
+    class Scope
+    {
+    private:
+        finExecObjectArena *_prevArena;  //!< Arena that was current before, restored on destruction.
+
+    public:
+        Scope(finExecObjectArena *arena);
+        ~Scope();
+    };
+
+    /*!
+     *  \brief Constructs an empty arena for objects of \a objsize bytes, carved \a chunkcnt at a time.
+     */
+    finExecObjectArena(const QString &name, size_t objsize, int chunkcnt = 256);
+
+    /*!
+     *  \brief Destroys the arena and returns its chunks to the heap.
+     *
+     *  Chunks still holding a live block are leaked rather than freed under the feet of their objects.
+     */
+    ~finExecObjectArena();
+
+    /*! \brief Returns the arena name. */
+    QString getArenaName() const;
+
+    /*! \brief Returns the size of the objects served from this arena. */
+    size_t getObjectSize() const;
+
+    /*! \brief Returns the number of blocks currently in use. */
+    int getLiveCount() const;
+
+    /*! \brief Returns a snapshot of the allocation counters. */
+    finExecPoolCounter getCounter() const;
+
+    /*! \brief Returns the arena current on the calling thread, or \c nullptr. */
+    static finExecObjectArena *getCurrentArena();
+
+    /*! \brief Allocates \a size bytes from the current arena if it serves that size, or from the heap. */
+    static void *allocate(size_t size);
+
+    /*! \brief Releases memory obtained from allocate() back to where it came from. */
+    static void release(void *ptr);
+};
+
+#endif // FINEXECPOOL_H
@@ -14,10 +14,11 @@
 #include "finExecEnvironment.h"
 #include "finExecMachine.h"
 #include "finExecOperartorCalc.h"
+#include "finSymbolTable.h"
 
 
 finExecVariable::finExecVariable()
-    : _varName(), _itemList()
+    : _varName(), _nameId(finSymbolTable::SYM_NONE), _itemList()
 {
     this->_type = TP_NULL;
     this->_leftValue = false;
@@ -27,10 +28,12 @@ finExecVariable::finExecVariable()
     this->_image = QImage();
     this->_linkTarget = nullptr;
     this->_parentVar = nullptr;
+    this->_packed = false;
+    this->_packedCols = 0;
 }
 
 finExecVariable::finExecVariable(const QString &name)
-    : _varName(name), _itemList()
+    : _varName(name), _nameId(finSymbolTable::getSymbolId(name)), _itemList()
 {
     this->_type = TP_NULL;
     this->_leftValue = false;
@@ -40,6 +43,8 @@ finExecVariable::finExecVariable(const QString &name)
     this->_image = QImage();
     this->_linkTarget = nullptr;
     this->_parentVar = nullptr;
+    this->_packed = false;
+    this->_packedCols = 0;
 }
 
 finExecVariable::~finExecVariable()
@@ -49,11 +54,33 @@ finExecVariable::~finExecVariable()
     this->dispose();
 }
 
+void *finExecVariable::operator new(size_t size)
+{
+    return finExecVariable::getObjectPool()->allocate(size);
+}
+
+void finExecVariable::operator delete(void *ptr, size_t size)
+{
+    finExecVariable::getObjectPool()->release(ptr, size);
+}
+
+finExecObjectPool *finExecVariable::getObjectPool()
+{
+    // Never destroyed, so variables released during static destruction still find their pool.
+    static finExecObjectPool *varpool = new finExecObjectPool(QString("variable"), sizeof (finExecVariable));
+    return varpool;
+}
+
 const QString &finExecVariable::getName() const
 {
     return this->_varName;
 }
 
+int finExecVariable::getNameId() const
+{
+    return this->_nameId;
+}
+
 finExecVariableType finExecVariable::getType() const
 {
     return this->_type;
@@ -78,6 +105,19 @@ void finExecVariable::setName(const QString &name)
         return;
 
     this->_varName = name;
+    this->_nameId = finSymbolTable::getSymbolId(name);
+}
+
+void finExecVariable::setNameId(int nameid)
+{
+    if ( nameid == finSymbolTable::SYM_NONE )
+        finWarning << "Variable (" << this->_varName << ") name is set to be empty.";
+
+    if ( this->_nameId == nameid )
+        return;
+
+    this->_varName = finSymbolTable::getSymbolName(nameid);
+    this->_nameId = nameid;
 }
 
 void finExecVariable::setType(finExecVariableType type)
@@ -187,6 +227,10 @@ int finExecVariable::getArrayLength() const
     if ( this->_type != TP_ARRAY )
         return 0;
 
+    if ( this->_packed && this->_packedCols > 0 )
+        return this->_packedData.count() / this->_packedCols;
+    else if ( this->_packed )
+        return this->_packedData.count();
     return this->_itemList.count();
 }
 
@@ -200,6 +244,7 @@ void finExecVariable::preallocArrayLength(int len)
     if ( this->_type == TP_NULL )
         this->_type = TP_ARRAY;
 
+    this->unpackArray();
     if ( this->_itemList.count() >= len )
         return;
 
@@ -215,17 +260,6 @@ void finExecVariable::preallocArrayLength(int len)
     }
 }
 
-finExecVariable *finExecVariable::getVariableItemAt(int idx) const
-{
-    if ( this->_type != TP_ARRAY )
-        return nullptr;
-
-    if ( idx < 0 || idx >= this->_itemList.count() )
-        return nullptr;
-
-    return this->_itemList.at(idx);
-}
-
 finExecVariable *finExecVariable::getVariableItemAt(int idx)
 {
     if ( this->_type != TP_ARRAY && this->_type != TP_NULL )
@@ -236,6 +270,7 @@ finExecVariable *finExecVariable::getVariableItemAt(int idx)
     if ( idx < 0 )
         return nullptr;
 
+    this->unpackArray();
     if ( idx < this->_itemList.count() )
         return this->_itemList.at(idx);
 
@@ -266,6 +301,10 @@ void finExecVariable::clearArrayItems()
     if ( this->_type == TP_NULL )
         this->_type = TP_ARRAY;
 
+    this->_packed = false;
+    this->_packedCols = 0;
+    this->_packedData.clear();
+
     if ( this->_itemList.count() <= 0 )
         return;
 
@@ -276,6 +315,116 @@ void finExecVariable::clearArrayItems()
     }
 }
 
+bool finExecVariable::isPackedArray() const
+{
+    return (this->_type == TP_ARRAY && this->_packed);
+}
+
+int finExecVariable::getPackedColumnCount() const
+{
+    if ( !this->isPackedArray() )
+        return 0;
+
+    return this->_packedCols;
+}
+
+const QList<double> &finExecVariable::getPackedData() const
+{
+    return this->_packedData;
+}
+
+void finExecVariable::setupPackedArray(const QList<double> &data, int colcnt)
+{
+    if ( this->_type != TP_ARRAY && this->_type != TP_NULL )
+        finThrow(finErrorKits::EC_STATE_ERROR, "Cannot pack numbers into this variable type.");
+    if ( colcnt < 0 || (colcnt > 0 && data.count() % colcnt != 0) )
+        finThrow(finErrorKits::EC_INVALID_PARAM, "Packed data does not fill whole matrix rows.");
+
+    this->clearArrayItems();
+    this->_packed = true;
+    this->_packedCols = colcnt;
+    this->_packedData = data;
+}
+
+void finExecVariable::unpackArray()
+{
+    if ( !this->isPackedArray() )
+        return;
+
+    QList<double> data = this->_packedData;
+    int colcnt = this->_packedCols;
+    this->_packed = false;
+    this->_packedCols = 0;
+    this->_packedData.clear();
+
+    // Unpack only one level: the rows of a matrix stay packed until they are indexed themselves.
+    if ( colcnt <= 0 ) {
+        this->preallocArrayLength(data.count());
+        for ( int i = 0; i < data.count(); i++ )
+            this->_itemList.at(i)->setNumericValue(data.at(i));
+    } else {
+        int rowcnt = data.count() / colcnt;
+        this->preallocArrayLength(rowcnt);
+        for ( int i = 0; i < rowcnt; i++ )
+            this->_itemList.at(i)->setupPackedArray(data.mid(i * colcnt, colcnt));
+    }
+}
+
+bool finExecVariable::readPackedItemAt(int idx, double *val) const
+{
+    if ( !this->isPackedArray() || this->_packedCols > 0 )
+        return false;
+    if ( idx < 0 || idx >= this->_packedData.count() )
+        return false;
+
+    *val = this->_packedData.at(idx);
+    return true;
+}
+
+bool finExecVariable::readPackedItemAt(int row, int col, double *val) const
+{
+    if ( !this->isPackedArray() || this->_packedCols <= 0 )
+        return false;
+    if ( row < 0 || row >= this->getArrayLength() || col < 0 || col >= this->_packedCols )
+        return false;
+
+    *val = this->_packedData.at(row * this->_packedCols + col);
+    return true;
+}
+
+finExecVariable *finExecVariable::buildPackedItemAt(int idx) const
+{
+    if ( !this->isPackedArray() || idx < 0 || idx >= this->getArrayLength() )
+        return nullptr;
+
+    // The item is a copy that lives on its own; the packed array itself is left as it is.
+    finExecVariable *itemvar = new finExecVariable();
+    if ( itemvar == nullptr )
+        return nullptr;
+
+    if ( this->_packedCols <= 0 ) {
+        itemvar->setType(TP_NUMERIC);
+        itemvar->setNumericValue(this->_packedData.at(idx));
+    } else {
+        itemvar->setType(TP_ARRAY);
+        itemvar->setupPackedArray(this->_packedData.mid(idx * this->_packedCols, this->_packedCols));
+    }
+    itemvar->clearLeftValue();
+    itemvar->setWriteProtected();
+    return itemvar;
+}
+
+bool finExecVariable::writePackedItemAt(int idx, double val)
+{
+    if ( !this->isPackedArray() || this->_packedCols > 0 || this->_writeProtect )
+        return false;
+    if ( idx < 0 || idx >= this->_packedData.count() )
+        return false;
+
+    this->_packedData[idx] = val;
+    return true;
+}
+
 bool finExecVariable::isInArray() const
 {
     return (this->_parentVar != nullptr);
@@ -307,23 +456,28 @@ bool finExecVariable::isNumericMatrix(int *rowcnt, int *colcnt) const
     if ( this->_type != TP_ARRAY )
         return false;
 
+    if ( this->_packed ) {
+        if ( this->_packedCols <= 0 && !this->_packedData.empty() )
+            return false;
+        if ( rowcnt != nullptr )
+            *rowcnt = this->getArrayLength();
+        if ( colcnt != nullptr )
+            *colcnt = this->_packedCols;
+        return true;
+    }
+
     int pcolcnt = 0;
     for ( int i = 0; i < this->_itemList.count(); i++ ) {
         finExecVariable *curitem = this->_itemList.at(i);
 
-        if ( curitem->_type != TP_ARRAY )
+        int curcolcnt = 0;
+        if ( !curitem->isNumericArray(&curcolcnt) )
             return false;
 
         if ( i == 0 )
-            pcolcnt = curitem->_itemList.count();
-        else if ( pcolcnt != curitem->_itemList.count() )
+            pcolcnt = curcolcnt;
+        else if ( pcolcnt != curcolcnt )
             return false;
-
-        for ( int j = 0; j < pcolcnt; j++) {
-            finExecVariable *chditem = curitem->_itemList.at(j);
-            if ( chditem->_type != TP_NUMERIC )
-                return false;
-        }
     }
 
     if ( rowcnt != nullptr )
@@ -338,6 +492,14 @@ bool finExecVariable::isNumericArray(int *cnt) const
     if ( this->_type != TP_ARRAY )
         return false;
 
+    if ( this->_packed ) {
+        if ( this->_packedCols > 0 && !this->_packedData.empty() )
+            return false;
+        if ( cnt != nullptr )
+            *cnt = this->getArrayLength();
+        return true;
+    }
+
     for ( int i = 0; i < this->_itemList.count(); i++ ) {
         finExecVariable *curitem = this->_itemList.at(i);
         if ( curitem->_type != TP_NUMERIC )
@@ -354,6 +516,14 @@ bool finExecVariable::isStringArray(int *cnt) const
     if ( this->_type != TP_ARRAY )
         return false;
 
+    if ( this->_packed ) {
+        if ( !this->_packedData.empty() )
+            return false;
+        if ( cnt != nullptr )
+            *cnt = 0;
+        return true;
+    }
+
     for ( int i = 0; i < this->_itemList.count(); i++ ) {
         finExecVariable *curitem = this->_itemList.at(i);
         if ( curitem->_type != TP_STRING )
@@ -370,6 +540,9 @@ int finExecVariable::maxArrayLevel() const
     if ( this->_type != TP_ARRAY )
         return 0;
 
+    if ( this->_packed )
+        return (this->_packedCols > 0 && !this->_packedData.empty() ? 2 : 1);
+
     int maxlevel = 0;
     foreach ( finExecVariable *curitem, this->_itemList ) {
         int curlevel = curitem->maxArrayLevel();
@@ -384,6 +557,9 @@ bool finExecVariable::hasMultiLevel() const
     if ( this->_type != TP_ARRAY )
         return false;
 
+    if ( this->_packed )
+        return (this->_packedCols > 0 && !this->_packedData.empty());
+
     foreach ( finExecVariable *curitem, this->_itemList ) {
         if ( curitem->getType() == TP_ARRAY )
             return true;
@@ -514,17 +690,23 @@ void finExecVariable::readColorValue(QColor *color) const
     if ( arylen != 3 && arylen != 4 )
         finThrow(finErrorKits::EC_INVALID_PARAM, "Color array must contain three or four values.");
 
-    double red, green, blue;
-    red = this->getVariableItemAt(0)->getNumericValue();
-    green = this->getVariableItemAt(1)->getNumericValue();
-    blue = this->getVariableItemAt(2)->getNumericValue();
+    // Read a packed array in place; a const reader must not unpack it.
+    double rgba[4];
+    for ( int i = 0; i < arylen; i++ ) {
+        if ( this->_packed )
+            rgba[i] = this->_packedData.at(i);
+        else
+            rgba[i] = this->_itemList.at(i)->getNumericValue();
+    }
+
+    double red = rgba[0], green = rgba[1], blue = rgba[2];
     red = (red < 0.0 ? 0.0 : (red > 1.0 ? 1.0 : red));
     green = (green < 0.0 ? 0.0 : (green > 1.0 ? 1.0 : green));
     blue = (blue < 0.0 ? 0.0 : (blue > 1.0 ? 1.0 : blue));
 
     double alpha = 1.0;
     if ( arylen == 4 ) {
-        alpha = this->getVariableItemAt(3)->getNumericValue();
+        alpha = rgba[3];
         alpha = (alpha < 0.0 ? 0.0 : (alpha > 1.0 ? 1.0 : alpha));
     }
 
@@ -597,6 +779,11 @@ bool finExecVariable::isSameName(const QString &name) const
     return (QString::compare(this->_varName, name) == 0);
 }
 
+bool finExecVariable::isSameName(int nameid) const
+{
+    return (this->_nameId == nameid);
+}
+
 bool finExecVariable::isSameValue(finExecVariable *var)
 {
     finExecVariable *var1 = this->getLinkTarget();
@@ -632,6 +819,10 @@ bool finExecVariable::isSameValue(finExecVariable *var)
         if ( var1->getArrayLength() != var2->getArrayLength() )
             return false;
 
+        if ( var1->isPackedArray() && var2->isPackedArray() &&
+             var1->getPackedColumnCount() == var2->getPackedColumnCount() )
+            return (var1->getPackedData() == var2->getPackedData());
+
         for ( int i = 0; i < var1->getArrayLength(); i++ ) {
             finExecVariable *subvar1 = var1->getVariableItemAt(i);
             finExecVariable *subvar2 = var2->getVariableItemAt(i);
@@ -651,6 +842,12 @@ void finExecVariable::copyArrayVariable(const finExecVariable *srcvar)
 {
     this->clearArrayItems();
 
+    // The packed buffer is implicitly shared, so copying it is O(1) until either side is modified.
+    if ( srcvar->_packed ) {
+        this->setupPackedArray(srcvar->_packedData, srcvar->_packedCols);
+        return;
+    }
+
     this->preallocArrayLength(srcvar->_itemList.count());
     for ( int i = 0; i < srcvar->_itemList.count(); i++ ) {
         finExecVariable *subsrcvar = srcvar->_itemList.at(i);
@@ -683,6 +880,10 @@ void finExecVariable::smartCopyVariableValue(finExecVariable *srcvar)
         return;
 
     if ( srcvar->getType() == finExecVariable::TP_ARRAY &&
+         !srcvar->isLeftValue() && srcvar->_packed ) {
+        this->setupPackedArray(srcvar->_packedData, srcvar->_packedCols);
+        srcvar->clearArrayItems();
+    } else if ( srcvar->getType() == finExecVariable::TP_ARRAY &&
          !srcvar->isLeftValue() ) {
         this->_itemList = srcvar->_itemList;
         srcvar->_itemList.clear();
@@ -706,7 +907,7 @@ void finExecVariable::copyVariable(finExecVariable *srcvar)
 {
     this->copyVariableValueIn(srcvar);
 
-    this->setName(srcvar->getName());
+    this->setNameId(srcvar->getNameId());
     this->setupWriteProtected(srcvar->isWriteProtected());
     this->setupLeftValue(srcvar->isLeftValue());
 
@@ -750,6 +951,7 @@ void finExecVariable::dispose()
     this->disposeValue();
 
     this->_varName.clear();
+    this->_nameId = finSymbolTable::SYM_NONE;
     this->clearWriteProtected();
     this->clearLeftValue();
 }
@@ -21,6 +21,7 @@
 #include <QList>
 
 #include "finErrorCode.h"
+#include "finExecPool.h"
 
 class finExecVariable;
 class finExecFunction;
@@ -34,6 +35,13 @@ class finExecMachine;
  * in their scripts, and also store the return values from operator calculation and the function execution. In FIN-7
  * system, there are three valid type of variables, number, string, and array. A number is a real number, a string is
  * a character-based string, and an array is a one-dimensioned list of variables.
+ *
+ * A purely numeric array or rectangular matrix can also be stored packed: all numbers sit in one row-major buffer
+ * (_packedData, implicitly shared and therefore copy-on-write) instead of one item variable per element. A packed
+ * array reports the same length and shape as its unpacked form. Reading an item is served from the buffer in place
+ * (readPackedItemAt(), buildPackedItemAt()), and so is storing a number into an existing item (writePackedItemAt()).
+ * Only when an item variable itself is requested, e.g. as the target of another kind of store, is the array unpacked,
+ * one level at a time, so that any value can be stored into the item.
  */
 class finExecVariable
 {
@@ -67,6 +75,7 @@ public:
 protected:
     Type _type;
     QString _varName;
+    int _nameId;
     bool _writeProtect;
     bool _leftValue;
 
@@ -79,17 +88,27 @@ protected:
     QList<finExecVariable *> _itemList;
     finExecVariable *_parentVar;
 
+    bool _packed;
+    int _packedCols;
+    QList<double> _packedData;
+
 public:
     finExecVariable();
     finExecVariable(const QString &name);
     ~finExecVariable();
 
+    static void *operator new(size_t size);
+    static void operator delete(void *ptr, size_t size);
+    static finExecObjectPool *getObjectPool();
+
     const QString &getName() const;
+    int getNameId() const;
     Type getType() const;
     bool isWriteProtected() const;
     bool isLeftValue() const;
 
     void setName(const QString &name);
+    void setNameId(int nameid);
     void setType(Type type);
     void setupWriteProtected(bool blval);
     void setWriteProtected();
@@ -108,10 +127,19 @@ public:
 
     int getArrayLength() const;
     void preallocArrayLength(int len);
-    finExecVariable *getVariableItemAt(int idx) const;
     finExecVariable *getVariableItemAt(int idx);
     void clearArrayItems();
 
+    bool isPackedArray() const;
+    int getPackedColumnCount() const;
+    const QList<double> &getPackedData() const;
+    void setupPackedArray(const QList<double> &data, int colcnt = 0);
+    void unpackArray();
+    bool readPackedItemAt(int idx, double *val) const;
+    bool readPackedItemAt(int row, int col, double *val) const;
+    finExecVariable *buildPackedItemAt(int idx) const;
+    bool writePackedItemAt(int idx, double val);
+
     bool isVariableInside(const finExecVariable *var) const;
     bool isInArray() const;
     finExecVariable *getParentVariable() const;
@@ -135,6 +163,7 @@ public:
     void setupColorValue(const QColor &color);
 
     bool isSameName(const QString &name) const;
+    bool isSameName(int nameid) const;
     bool isSameValue(finExecVariable *var);
 
     void copyVariableValue(finExecVariable *srcvar);
@@ -157,6 +186,9 @@ public:
     static finExecVariable *buildFuncReturnVariable(finExecVariable *var, finExecEnvironment *env);
 
     static void installSystemVariables(finExecEnvironment *rootenv);
+    static finExecVariable *buildSystemVariable(int nameid);
+    static bool findSystemConstant(const QString &name, double *val);
+    static bool findSystemConstant(int nameid, double *val);
 
 private:
     void copyVariableValueIn(finExecVariable *srcvar);
@@ -7,11 +7,13 @@
  */
 
 #include <qmath.h>
+#include <QHash>
 #include <QString>
 #include <memory>
 
 #include "finExecVariable.h"
 #include "finExecEnvironment.h"
+#include "finSymbolTable.h"
 
 
 static finExecVariable *_sysvar_nil();
@@ -160,6 +162,55 @@ finExecVariable::installSystemVariables(finExecEnvironment *rootenv)
     }
 }
 
+bool
+finExecVariable::findSystemConstant(const QString &name, double *val)
+{
+    return finExecVariable::findSystemConstant(finSymbolTable::findSymbolId(name), val);
+}
+
+bool
+finExecVariable::findSystemConstant(int nameid, double *val)
+{
+    // Taken from the generators themselves, so a folded constant always equals the installed variable.
+    static const QHash<int, double> sysconstmap = []() {
+        QHash<int, double> retmap;
+        for ( int i = 0; _finSysvarGencallList[i] != nullptr; i++ ) {
+            std::unique_ptr<finExecVariable> curvar(_finSysvarGencallList[i]());
+            if ( curvar != nullptr && curvar->getType() == finExecVariable::TP_NUMERIC )
+                retmap.insert(curvar->getNameId(), curvar->getNumericValue());
+        }
+        return retmap;
+    }();
+
+    auto it = sysconstmap.constFind(nameid);
+    if ( it == sysconstmap.constEnd() )
+        return false;
+
+    if ( val != nullptr )
+        *val = it.value();
+    return true;
+}
+
+finExecVariable *
+finExecVariable::buildSystemVariable(int nameid)
+{
+    static const QHash<int, int> sysvaridxmap = []() {
+        QHash<int, int> retmap;
+        for ( int i = 0; _finSysvarGencallList[i] != nullptr; i++ ) {
+            std::unique_ptr<finExecVariable> curvar(_finSysvarGencallList[i]());
+            if ( curvar != nullptr )
+                retmap.insert(curvar->getNameId(), i);
+        }
+        return retmap;
+    }();
+
+    // A fresh variable from the generator, equal to the one installed in the root.
+    int idx = sysvaridxmap.value(nameid, -1);
+    if ( idx < 0 )
+        return nullptr;
+    return _finSysvarGencallList[idx]();
+}
+
 static finExecVariable *_sysvar_nil()
 {
     auto retvar = std::make_unique<finExecVariable>();
@@ -9,6 +9,7 @@
 #include "finFigureAlg.h"
 
 #include <qmath.h>
+#include <QPair>
 
 finFigureAlg::finFigureAlg()
 {
@@ -324,6 +325,196 @@ bool finFigureAlg::isPolygonInsideRect(const QList<QPointF> &polygon, const QRec
     return true;
 }
 
+/*
+ * Liang-Barsky clipping. Moves the end points of the segment onto the rect when it crosses the border, and
+ * returns false if no part of it lies inside the rect. Segments with NaN or infinite coordinates are dropped.
+ */
+bool finFigureAlg::clipLineToRect(QPointF *pt1, QPointF *pt2, const QRectF &rect)
+{
+    double x1 = pt1->x(), y1 = pt1->y();
+    double dx = pt2->x() - x1, dy = pt2->y() - y1;
+    if ( !qIsFinite(x1) || !qIsFinite(y1) || !qIsFinite(dx) || !qIsFinite(dy) )
+        return false;
+
+    double p[4] = { -dx, dx, -dy, dy };
+    double q[4] = { x1 - rect.left(), rect.right() - x1, y1 - rect.top(), rect.bottom() - y1 };
+    double t0 = 0.0, t1 = 1.0;
+    for ( int i = 0; i < 4; i++ ) {
+        if ( p[i] == 0.0 ) {
+            if ( q[i] < 0.0 )
+                return false;
+            continue;
+        }
+
+        double r = q[i] / p[i];
+        if ( p[i] < 0.0 ) {
+            if ( r > t1 )
+                return false;
+            if ( r > t0 )
+                t0 = r;
+        } else {
+            if ( r < t0 )
+                return false;
+            if ( r < t1 )
+                t1 = r;
+        }
+    }
+
+    if ( t1 < 1.0 )
+        *pt2 = QPointF(x1 + t1 * dx, y1 + t1 * dy);
+    if ( t0 > 0.0 )
+        *pt1 = QPointF(x1 + t0 * dx, y1 + t0 * dy);
+    return true;
+}
+
+/*
+ * Splits the polyline into the pieces that lie inside the rect. If startlenlist is given, it receives for each
+ * piece its distance from the start of the polyline along the curve, e.g. to keep dash patterns in phase.
+ */
+QList<QList<QPointF> > finFigureAlg::clipPolylineToRect(const QList<QPointF> &ptlist, const QRectF &rect,
+                                                        QList<double> *startlenlist)
+{
+    QList<QList<QPointF> > piecelist;
+    QList<QPointF> curpiece;
+    double runlen = 0.0;
+
+    for ( int i = 0; i < ptlist.count() - 1; i++ ) {
+        const QPointF &pt1 = ptlist.at(i);
+        const QPointF &pt2 = ptlist.at(i + 1);
+        QPointF clippt1 = pt1, clippt2 = pt2;
+
+        if ( finFigureAlg::clipLineToRect(&clippt1, &clippt2, rect) ) {
+            // A segment not continuing the current piece has come back in from outside.
+            if ( curpiece.empty() || curpiece.last() != clippt1 ) {
+                if ( !curpiece.empty() )
+                    piecelist.append(curpiece);
+                curpiece.clear();
+                curpiece.append(clippt1);
+                if ( startlenlist != nullptr )
+                    startlenlist->append(runlen + finFigureAlg::pointsDistance(pt1, clippt1));
+            }
+            curpiece.append(clippt2);
+        } else if ( !curpiece.empty() ) {
+            piecelist.append(curpiece);
+            curpiece.clear();
+        }
+
+        double seglen = finFigureAlg::pointsDistance(pt1, pt2);
+        if ( qIsFinite(seglen) )
+            runlen += seglen;
+    }
+    if ( !curpiece.empty() )
+        piecelist.append(curpiece);
+    return piecelist;
+}
+
+QList<QPointF> finFigureAlg::clipPolygonToRect(const QList<QPointF> &polygon, const QRectF &rect)
+{
+    QList<QPointF> retpolygon = finFigureAlg::xMinCutPolygon(polygon, rect.left());
+    retpolygon = finFigureAlg::xMaxCutPolygon(retpolygon, rect.right());
+    retpolygon = finFigureAlg::yMinCutPolygon(retpolygon, rect.top());
+    retpolygon = finFigureAlg::yMaxCutPolygon(retpolygon, rect.bottom());
+    return retpolygon;
+}
+
+/*
+ * Within each run of consecutive points falling into the same pixel column, only the first, the lowest, the
+ * highest and the last point are kept, in their original order. The drawn column covers the same span, so
+ * dense data reduces to at most four points per column without a visible change.
+ */
+QList<QPointF> finFigureAlg::pixelColumnReducePolyline(const QList<QPointF> &ptlist)
+{
+    int ptcnt = ptlist.count();
+    if ( ptcnt <= 4 )
+        return ptlist;
+
+    QList<QPointF> retlist;
+    int runstart = 0;
+    while ( runstart < ptcnt ) {
+        double column = floor(ptlist.at(runstart).x());
+        int minidx = runstart, maxidx = runstart;
+        int runend = runstart + 1;
+        while ( runend < ptcnt && floor(ptlist.at(runend).x()) == column ) {
+            double cury = ptlist.at(runend).y();
+            if ( cury < ptlist.at(minidx).y() )
+                minidx = runend;
+            if ( cury > ptlist.at(maxidx).y() )
+                maxidx = runend;
+            runend++;
+        }
+
+        int keepidx[4] = { runstart, qMin(minidx, maxidx), qMax(minidx, maxidx), runend - 1 };
+        int previdx = -1;
+        for ( int i = 0; i < 4; i++ ) {
+            if ( keepidx[i] <= previdx )
+                continue;
+            retlist.append(ptlist.at(keepidx[i]));
+            previdx = keepidx[i];
+        }
+        runstart = runend;
+    }
+    return retlist;
+}
+
+/*
+ * Points closer than tolerance to the simplified line are dropped. The segments still to be split are kept
+ * on an explicit stack, so a long curve cannot exhaust the call stack. A point whose distance cannot be
+ * compared (NaN) is always kept.
+ */
+QList<QPointF> finFigureAlg::douglasPeuckerPolyline(const QList<QPointF> &ptlist, double tolerance)
+{
+    int ptcnt = ptlist.count();
+    if ( ptcnt <= 2 )
+        return ptlist;
+
+    QList<bool> keeplist(ptcnt, false);
+    keeplist[0] = true;
+    keeplist[ptcnt - 1] = true;
+
+    double tolsq = tolerance * tolerance;
+    QList<QPair<int, int> > seglist;
+    seglist.append(qMakePair(0, ptcnt - 1));
+    while ( !seglist.empty() ) {
+        QPair<int, int> seg = seglist.takeLast();
+        const QPointF &pt1 = ptlist.at(seg.first);
+        QPointF segvec = ptlist.at(seg.second) - pt1;
+        double seglensq = segvec.x() * segvec.x() + segvec.y() * segvec.y();
+
+        int maxidx = -1;
+        double maxdistsq = -1.0;
+        for ( int i = seg.first + 1; i < seg.second; i++ ) {
+            QPointF offvec = ptlist.at(i) - pt1;
+            if ( seglensq > 0.0 ) {
+                double t = (offvec.x() * segvec.x() + offvec.y() * segvec.y()) / seglensq;
+                offvec -= segvec * qBound(0.0, t, 1.0);
+            }
+            double distsq = offvec.x() * offvec.x() + offvec.y() * offvec.y();
+            if ( !(distsq <= maxdistsq) ) {
+                maxdistsq = distsq;
+                maxidx = i;
+            }
+        }
+        if ( maxidx < 0 || maxdistsq <= tolsq )
+            continue;
+
+        keeplist[maxidx] = true;
+        seglist.append(qMakePair(seg.first, maxidx));
+        seglist.append(qMakePair(maxidx, seg.second));
+    }
+
+    QList<QPointF> retlist;
+    for ( int i = 0; i < ptcnt; i++ ) {
+        if ( keeplist.at(i) )
+            retlist.append(ptlist.at(i));
+    }
+    return retlist;
+}
+
+QList<QPointF> finFigureAlg::simplifyPixelPolyline(const QList<QPointF> &ptlist, double tolerance)
+{
+    return finFigureAlg::douglasPeuckerPolyline(finFigureAlg::pixelColumnReducePolyline(ptlist), tolerance);
+}
+
 void finFigureAlg::dumpMatrix(const QTransform &matrix)
 {
     printf("Matrix = [ %lf, %lf, %lf ]\n", matrix.m11(), matrix.m21(), matrix.m31());
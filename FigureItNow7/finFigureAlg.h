@@ -60,6 +60,15 @@ public:
     static bool isRectInsideRect(const QRectF &rect, const QRectF &baserect);
     static bool isPolygonInsideRect(const QList<QPointF> &polygon, const QRectF &baserect);
 
+    static bool clipLineToRect(QPointF *pt1, QPointF *pt2, const QRectF &rect);
+    static QList<QList<QPointF> > clipPolylineToRect(const QList<QPointF> &ptlist, const QRectF &rect,
+                                                     QList<double> *startlenlist = nullptr);
+    static QList<QPointF> clipPolygonToRect(const QList<QPointF> &polygon, const QRectF &rect);
+
+    static QList<QPointF> pixelColumnReducePolyline(const QList<QPointF> &ptlist);
+    static QList<QPointF> douglasPeuckerPolyline(const QList<QPointF> &ptlist, double tolerance);
+    static QList<QPointF> simplifyPixelPolyline(const QList<QPointF> &ptlist, double tolerance);
+
     static void dumpMatrix(const QTransform &matrix);
     static QTransform threePointMatrix(const QPointF &pt00, const QPointF &pt10, const QPointF &pt01);
     static QTransform threePointMatrix(const QList<QPointF> &fromlist, const QList<QPointF> &tolist);
@@ -9,8 +9,6 @@
 #include "finFigureConfig.h"
 
 
-finFigureConfig *finFigureConfig::_defFigCfg = nullptr;
-
 finFigureConfig::finFigureConfig()
     : _borderPen(Qt::black, 1), _fillBrush(Qt::transparent), _startArrow(), _endArrow(),
       _textPen(Qt::transparent, 0), _textBrush(Qt::black), _font(QString("Arial"), 12)
@@ -257,10 +255,9 @@ void finFigureConfig::cloneFigureConfig(finFigureConfig *outcfg) const
 
 finFigureConfig *finFigureConfig::getDefaultFigureConfig()
 {
-    if ( finFigureConfig::_defFigCfg == nullptr )
-        finFigureConfig::_defFigCfg = new finFigureConfig();
-
-    return finFigureConfig::_defFigCfg;
+    // Built under the thread-safe static initialization, as figure containers are made on many threads.
+    static finFigureConfig *const deffigcfg = new finFigureConfig();
+    return deffigcfg;
 }
 
 void finFigureConfig::cloneFromDefaultFigureConfig(finFigureConfig *outfig)
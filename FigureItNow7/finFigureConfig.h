@@ -34,8 +34,6 @@ protected:
     QFont _font;
     QMarginsF _textMargins;
 
-    static finFigureConfig *_defFigCfg;
-
 public:
     finFigureConfig();
 
@@ -8,6 +8,8 @@
 
 #include "finFigureContainer.h"
 
+#include <memory>
+
 finFigureContainer::finFigureContainer()
 {
     finFigureConfig::cloneFromDefaultFigureConfig(&this->_curFigCfg);
@@ -57,6 +59,74 @@ void finFigureContainer::appendFigureObject(finFigureObject *figobj)
 {
     this->setFigureConfigForObject(figobj);
     this->_figList.append(figobj);
+
+    finFigurePathCache cache;
+    cache._cfgStamp = 0;
+    cache._errcode = finErrorKits::EC_SUCCESS;
+    this->_pathCacheList.append(cache);
+}
+
+/*
+ * Redrawing the same figures under an unchanged graph config reuses the paths of the last time. An object
+ * changed in place through getFigureObjectAt() must be passed to invalidateFigureObject() afterwards.
+ */
+finErrorCode
+finFigureContainer::getPixelFigurePathAt(int idx, QList<finFigurePath> *pathlist, finGraphConfig *cfg)
+{
+    if ( pathlist == nullptr || cfg == nullptr )
+        return finErrorKits::EC_NULL_POINTER;
+    if ( idx < 0 || idx >= this->_figList.count() )
+        return finErrorKits::EC_INVALID_PARAM;
+
+    finFigurePathCache &cache = this->_pathCacheList[idx];
+    quint64 cfgstamp = cfg->getVersionStamp();
+    if ( cache._cfgStamp != cfgstamp ) {
+        cache._pathList.clear();
+        cache._errcode = this->_figList.at(idx)->getPixelFigurePath(&cache._pathList, cfg);
+        cache._cfgStamp = cfgstamp;
+    }
+
+    pathlist->append(cache._pathList);
+    return cache._errcode;
+}
+
+void finFigureContainer::invalidateFigureObject(int idx)
+{
+    if ( idx < 0 || idx >= this->_pathCacheList.count() )
+        return;
+
+    this->_pathCacheList[idx]._cfgStamp = 0;
+    this->_pathCacheList[idx]._pathList.clear();
+}
+
+finFigureObjectPointCloud *finFigureContainer::getTrailingPointCloud()
+{
+    // Dots join the last object only if nothing was drawn after it and it would look the same for them.
+    if ( !this->_figList.empty() ) {
+        finFigureObject *lastobj = this->_figList.last();
+        if ( lastobj->getFigureType() == finFigureObject::TP_POINTCLOUD &&
+             lastobj->getFigureConfig()->getBorderPen() == this->_curFigCfg.getBorderPen() ) {
+            this->invalidateFigureObject(this->_figList.count() - 1);
+            return static_cast<finFigureObjectPointCloud *>(lastobj);
+        }
+    }
+
+    auto focloud = std::make_unique<finFigureObjectPointCloud>();
+    this->appendFigureObject(focloud.get());
+    return focloud.release();
+}
+
+void finFigureContainer::appendDotPoint(const QPointF &pt)
+{
+    this->getTrailingPointCloud()->appendPoint(pt);
+}
+
+void finFigureContainer::appendDotPoints(const QList<QPointF> &ptlist)
+{
+    if ( ptlist.empty() )
+        return;
+
+    this->getTrailingPointCloud()->appendPoints(ptlist);
 }
 
 void finFigureContainer::clearFigureObjects()
@@ -66,6 +136,7 @@ void finFigureContainer::clearFigureObjects()
         this->_figList.removeFirst();
         delete figobj;
     }
+    this->_pathCacheList.clear();
 }
 
 void finFigureContainer::dump() const
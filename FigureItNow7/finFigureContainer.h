@@ -10,19 +10,32 @@
 #define FINFIGURECONTAINER_H
 
 #include <QList>
+#include <QPointF>
 
 #include "finErrorCode.h"
 #include "finFigureConfig.h"
 #include "finGraphConfig.h"
 #include "finFigureObject.h"
+#include "finFigurePath.h"
 
 
+/*
+ * The pixel paths last generated for one figure object, and the version stamp of the graph config they were
+ * generated under; a stamp of 0 means nothing is cached.
+ */
+struct finFigurePathCache {
+    quint64 _cfgStamp;
+    finErrorCode _errcode;
+    QList<finFigurePath> _pathList;
+};
+
 class finFigureContainer
 {
 protected:
     finFigureConfig _curFigCfg;
     finGraphConfig _graphCfg;
     QList<finFigureObject *> _figList;
+    QList<finFigurePathCache> _pathCacheList;
 
 public:
     finFigureContainer();
@@ -38,10 +51,18 @@ public:
     finFigureObject *getFigureObjectAt(int idx);
 
     void appendFigureObject(finFigureObject *figobj);
+    void appendDotPoint(const QPointF &pt);
+    void appendDotPoints(const QList<QPointF> &ptlist);
+
+    finErrorCode getPixelFigurePathAt(int idx, QList<finFigurePath> *pathlist, finGraphConfig *cfg);
+    void invalidateFigureObject(int idx);
 
     void clearFigureObjects();
 
     void dump() const;
+
+private:
+    finFigureObjectPointCloud *getTrailingPointCloud();
 };
 
 #endif // FINFIGURECONTAINER_H
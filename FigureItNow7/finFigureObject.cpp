@@ -15,6 +15,40 @@
 #include "finFigureAlg.h"
 
 
+/*
+ * Geometry outside this rect is cut off before it reaches the painter. The margin keeps the cut edges, line
+ * joins and caps of the pen out of sight.
+ */
+static QRectF _getPixelClipRect(const finGraphConfig *cfg, const QPen &pen)
+{
+    double margin = qMax(pen.widthF(), 1.0) * 2.0 + 2.0;
+    return cfg->getWholePanelPixelRect().adjusted(-margin, -margin, margin, margin);
+}
+
+/*
+ * Cuts a closed pixel polygon to the panel with Sutherland-Hodgman; returns false if nothing is left. A dashed
+ * border would show its pattern shifting along a cut edge, so it is only cut far away from the panel, just
+ * to keep giant coordinates out of the painter.
+ */
+static bool _clipPixelPolygon(QPolygonF *polygon, const finGraphConfig *cfg, const QPen &pen)
+{
+    QRectF cliprect = _getPixelClipRect(cfg, pen);
+    if ( pen.style() != Qt::SolidLine && pen.style() != Qt::NoPen ) {
+        double farx = cliprect.width() * 8.0, fary = cliprect.height() * 8.0;
+        cliprect.adjust(-farx, -fary, farx, fary);
+    }
+    if ( finFigureAlg::isPolygonInsideRect(*polygon, cliprect) )
+        return true;
+
+    *polygon = QPolygonF(finFigureAlg::clipPolygonToRect(*polygon, cliprect));
+    if ( polygon->count() < 3 )
+        return false;
+
+    polygon->append(polygon->first());
+    return true;
+}
+
+
 finFigureObject::finFigureObject()
 {
     this->_type = finFigureObject::TP_DUMMY;
@@ -119,6 +153,98 @@ void finFigureObjectDot::dump() const
     printf(" * Fig Type: dot; Point: (%lf, %lf)\n", (double)this->_point.x(), (double)this->_point.y());
 }
 
+finFigureObjectPointCloud::finFigureObjectPointCloud()
+    : _ptList()
+{
+    this->_type = finFigureObject::TP_POINTCLOUD;
+}
+
+finFigureObjectPointCloud::~finFigureObjectPointCloud()
+{
+    return;
+}
+
+bool finFigureObjectPointCloud::is3DFigure() const
+{
+    return false;
+}
+
+int finFigureObjectPointCloud::getPointCount() const
+{
+    return this->_ptList.count();
+}
+
+QPointF finFigureObjectPointCloud::getPointAt(int idx) const
+{
+    return this->_ptList.at(idx);
+}
+
+void finFigureObjectPointCloud::appendPoint(const QPointF &pt)
+{
+    this->_ptList.append(pt);
+}
+
+void finFigureObjectPointCloud::appendPoint(double ptx, double pty)
+{
+    this->_ptList.append(QPointF(ptx, pty));
+}
+
+void finFigureObjectPointCloud::appendPoints(const QList<QPointF> &ptlist)
+{
+    this->_ptList.append(ptlist);
+}
+
+void finFigureObjectPointCloud::clearPoints()
+{
+    this->_ptList.clear();
+}
+
+finErrorCode finFigureObjectPointCloud::getPixelFigurePath(QList<finFigurePath> *pathlist, finGraphConfig *cfg) const
+{
+    if ( pathlist == nullptr || cfg == nullptr )
+        return finErrorKits::EC_NULL_POINTER;
+    if ( this->_ptList.empty() )
+        return finErrorKits::EC_NORMAL_WARN;
+
+    double dotsize = this->_figCfg.getDotSize();
+    bool rounddot = (this->_figCfg.getBorderPen().capStyle() == Qt::RoundCap);
+
+    // Dots whose marker cannot touch the panel are left out of the path altogether.
+    QRectF visrect = cfg->getWholePanelPixelRect().adjusted(-dotsize, -dotsize, dotsize, dotsize);
+
+    // Overlapping markers must not cancel each other out as they would under the odd-even rule.
+    QList<QPointF> pixptlist = cfg->transformPixelPointList(this->_ptList);
+    QPainterPath path;
+    path.setFillRule(Qt::WindingFill);
+    for ( int i = 0; i < pixptlist.count(); i++ ) {
+        const QPointF &pixpt = pixptlist.at(i);
+        if ( !visrect.contains(pixpt) )
+            continue;
+
+        if ( rounddot ) {
+            path.addEllipse(pixpt, dotsize, dotsize);
+        } else {
+            QPointF tlpt = pixpt - QPointF(dotsize / 2.0, dotsize / 2.0);
+            path.addRect(tlpt.x(), tlpt.y(), dotsize, dotsize);
+        }
+    }
+    if ( path.isEmpty() )
+        return finErrorKits::EC_SUCCESS;
+
+    finFigurePath figpath;
+    figpath.setPen(QPen(Qt::transparent));
+    figpath.setBrush(this->_figCfg.getBorderPen().brush());
+    figpath.setPath(path);
+    pathlist->append(figpath);
+
+    return finErrorKits::EC_SUCCESS;
+}
+
+void finFigureObjectPointCloud::dump() const
+{
+    printf(" * Fig Type: point cloud; Count: %ld\n", (long)this->_ptList.count());
+}
+
 finFigureObjectLine::finFigureObjectLine()
 {
     this->_type = finFigureObject::TP_LINE;
@@ -186,22 +312,29 @@ finErrorCode finFigureObjectLine::getPixelFigurePath(QList<finFigurePath> *pathl
 
     QPointF pt1 = cfg->transformPixelPoint(this->_pt1);
     QPointF pt2 = cfg->transformPixelPoint(this->_pt2);
-    QPainterPath path;
-
-    if ( this->_ignoreArrow ) {
-        path.moveTo(pt1);
-        path.lineTo(pt2);
-    } else {
-        QPointF spt1 = this->_figCfg.getStartArrow().lineShrinkPoint(pt1, pt2, &this->_figCfg);
-        QPointF spt2 = this->_figCfg.getEndArrow().lineShrinkPoint(pt2, pt1, &this->_figCfg);
-        path.moveTo(spt1);
-        path.lineTo(spt2);
+    QPointF spt1 = pt1, spt2 = pt2;
+    if ( !this->_ignoreArrow ) {
+        spt1 = this->_figCfg.getStartArrow().lineShrinkPoint(pt1, pt2, &this->_figCfg);
+        spt2 = this->_figCfg.getEndArrow().lineShrinkPoint(pt2, pt1, &this->_figCfg);
     }
 
-    finFigurePath figpath;
-    figpath.setPen(this->_figCfg.getBorderPen());
-    figpath.setPath(path);
-    pathlist->append(figpath);
+    QPen pen = this->_figCfg.getBorderPen();
+    QPointF clippt1 = spt1, clippt2 = spt2;
+    if ( finFigureAlg::clipLineToRect(&clippt1, &clippt2, _getPixelClipRect(cfg, pen)) ) {
+        QPainterPath path;
+        path.moveTo(clippt1);
+        path.lineTo(clippt2);
+
+        // Dash offsets are counted in pen widths.
+        if ( pen.style() != Qt::SolidLine && clippt1 != spt1 )
+            pen.setDashOffset(pen.dashOffset() +
+                              finFigureAlg::pointsDistance(spt1, clippt1) / qMax(pen.widthF(), 1.0));
+
+        finFigurePath figpath;
+        figpath.setPen(pen);
+        figpath.setPath(path);
+        pathlist->append(figpath);
+    }
 
     if ( !this->_ignoreArrow ) {
         this->_figCfg.getStartArrow().getPixelPath(pathlist, pt1, pt2, &this->_figCfg);
@@ -275,11 +408,7 @@ void finFigureObjectPolyline::setIgnoreArrow(bool blval)
 
 QList<QPointF> finFigureObjectPolyline::getTransformedPointList(finGraphConfig *cfg) const
 {
-    QList<QPointF> retptlist;
-    for ( int i = 0; i < this->_ptList.count(); i++ )
-        retptlist.append(cfg->transformPixelPoint(this->_ptList.at(i)));
-
-    return retptlist;
+    return cfg->transformPixelPointList(this->_ptList);
 }
 
 finErrorCode finFigureObjectPolyline::getPixelFigurePath(QList<finFigurePath> *pathlist, finGraphConfig *cfg) const
@@ -291,36 +420,54 @@ finErrorCode finFigureObjectPolyline::getPixelFigurePath(QList<finFigurePath> *p
     if ( ptcnt < 2 )
         return finErrorKits::EC_NORMAL_WARN;
 
-    QList<QPointF> ptlist = this->getTransformedPointList(cfg);
-    QPainterPath path;
+    static const double _simplifyTolerance = 0.25;
 
-    // The first point
-    if ( this->_ignoreArrow ) {
-        path.moveTo(ptlist.first());
-    } else {
-        QPointF spt0 = this->_figCfg.getStartArrow().lineShrinkPoint(
+    // The arrows shrink the end points of the line itself, but are drawn from the original end segments.
+    QList<QPointF> ptlist = this->getTransformedPointList(cfg);
+    QList<QPointF> lnptlist = ptlist;
+    if ( !this->_ignoreArrow ) {
+        lnptlist.first() = this->_figCfg.getStartArrow().lineShrinkPoint(
                     ptlist.at(0), ptlist.at(1), &this->_figCfg);
-        path.moveTo(spt0);
+        lnptlist.last() = this->_figCfg.getEndArrow().lineShrinkPoint(
+                    ptlist.at(ptcnt - 1), ptlist.at(ptcnt - 2), &this->_figCfg);
     }
 
-    // The medium points
-    for ( int i = 1; i < ptcnt - 1; i++ ) {
-        path.lineTo(ptlist.at(i));
-    }
+    // Only the pieces near the panel are kept, so far-off points never reach the painter. Each piece is
+    // then simplified, since points closer together than a pixel cannot be told apart.
+    QPen pen = this->_figCfg.getBorderPen();
+    QList<double> startlenlist;
+    QList<QList<QPointF> > piecelist =
+            finFigureAlg::clipPolylineToRect(lnptlist, _getPixelClipRect(cfg, pen), &startlenlist);
 
-    // The last point
-    if ( this->_ignoreArrow ) {
-        path.lineTo(ptlist.last());
-    } else {
-        QPointF sptN = this->_figCfg.getEndArrow().lineShrinkPoint(
-                    ptlist.at(ptcnt - 1), ptlist.at(ptcnt - 2), &this->_figCfg);
-        path.lineTo(sptN);
+    QPainterPath path;
+    for ( int i = 0; i < piecelist.count(); i++ ) {
+        QList<QPointF> drawptlist = finFigureAlg::simplifyPixelPolyline(piecelist.at(i), _simplifyTolerance);
+
+        // A dashed line restarts its pattern on every sub-path, so each piece gets a path of its own,
+        // with the dash offset (in pen widths) it would have had on the whole line.
+        if ( pen.style() != Qt::SolidLine ) {
+            if ( !path.isEmpty() ) {
+                finFigurePath figpath;
+                figpath.setPen(pen);
+                figpath.setPath(path);
+                pathlist->append(figpath);
+                path = QPainterPath();
+            }
+            pen.setDashOffset(this->_figCfg.getBorderPen().dashOffset() +
+                              startlenlist.at(i) / qMax(pen.widthF(), 1.0));
+        }
+
+        path.moveTo(drawptlist.first());
+        for ( int j = 1; j < drawptlist.count(); j++ )
+            path.lineTo(drawptlist.at(j));
     }
 
-    finFigurePath figpath;
-    figpath.setPen(this->_figCfg.getBorderPen());
-    figpath.setPath(path);
-    pathlist->append(figpath);
+    if ( !path.isEmpty() ) {
+        finFigurePath figpath;
+        figpath.setPen(pen);
+        figpath.setPath(path);
+        pathlist->append(figpath);
+    }
 
     if ( !this->_ignoreArrow ) {
         this->_figCfg.getStartArrow().getPixelPath(
@@ -462,9 +609,12 @@ finErrorCode finFigureObjectRect::getPixelFigurePath(QList<finFigurePath> *pathl
     if ( pathlist == nullptr || cfg == nullptr )
         return finErrorKits::EC_NULL_POINTER;
 
-    QPolygonF polygon = this->getPolygonInstance();
+    QPolygonF polygon = cfg->transformPixelPolygon(this->getPolygonInstance());
+    if ( !_clipPixelPolygon(&polygon, cfg, this->_figCfg.getBorderPen()) )
+        return finErrorKits::EC_SUCCESS;
+
     QPainterPath path;
-    path.addPolygon(cfg->transformPixelPolygon(polygon));
+    path.addPolygon(polygon);
 
     finFigurePath figpath;
     figpath.setPen(this->_figCfg.getBorderPen());
@@ -545,9 +695,12 @@ finFigureObjectPolygon::getPixelFigurePath(QList<finFigurePath> *pathlist, finGr
     if ( this->_ptList.count() < 2 )
         return finErrorKits::EC_NORMAL_WARN;
 
-    QPolygonF polygon = this->getPolygonInstance();
+    QPolygonF polygon = cfg->transformPixelPolygon(this->getPolygonInstance());
+    if ( !_clipPixelPolygon(&polygon, cfg, this->_figCfg.getBorderPen()) )
+        return finErrorKits::EC_SUCCESS;
+
     QPainterPath path;
-    path.addPolygon(cfg->transformPixelPolygon(polygon));
+    path.addPolygon(polygon);
 
     finFigurePath figpath;
     figpath.setPen(this->_figCfg.getBorderPen());
@@ -1935,9 +2088,13 @@ finFigureObjectLine3D::getPixelFigurePath(QList<finFigurePath> *pathlist, finGra
     if ( pathlist == nullptr || cfg == nullptr )
         return finErrorKits::EC_NULL_POINTER;
 
+    finFigurePoint3D endpts[2] = { this->_pt1, this->_pt2 };
+    QPointF pixpts[2];
+    cfg->transformPixelPoints3D(endpts, pixpts, 2);
+
     QPainterPath path;
-    path.moveTo(cfg->transformPixelPoint3D(this->_pt1));
-    path.lineTo(cfg->transformPixelPoint3D(this->_pt2));
+    path.moveTo(pixpts[0]);
+    path.lineTo(pixpts[1]);
 
     finFigurePath figpath;
     figpath.setPen(this->_figCfg.getBorderPen());
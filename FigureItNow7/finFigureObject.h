@@ -37,6 +37,7 @@ public:
         TP_IMAGE,
         TP_AXIS,
         TP_LINE3D,
+        TP_POINTCLOUD,
         TP_MAX
     };
 
@@ -80,6 +81,33 @@ public:
     virtual void dump() const;
 };
 
+/*
+ * Many dots sharing one figure config. The points are kept in one contiguous list and drawn as a single
+ * path, so a plot of many dots costs one figure object and one scene item instead of one per dot.
+ */
+class finFigureObjectPointCloud : public finFigureObject
+{
+protected:
+    QList<QPointF> _ptList;
+
+public:
+    finFigureObjectPointCloud();
+    virtual ~finFigureObjectPointCloud();
+
+    virtual bool is3DFigure() const;
+
+    int getPointCount() const;
+    QPointF getPointAt(int idx) const;
+
+    void appendPoint(const QPointF &pt);
+    void appendPoint(double ptx, double pty);
+    void appendPoints(const QList<QPointF> &ptlist);
+    void clearPoints();
+
+    virtual finErrorCode getPixelFigurePath(QList<finFigurePath> *pathlist, finGraphConfig *cfg) const;
+    virtual void dump() const;
+};
+
 class finFigureObjectLine : public finFigureObject
 {
 protected:
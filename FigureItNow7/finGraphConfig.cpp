@@ -10,6 +10,8 @@
 
 #include <qmath.h>
 
+#include "finExecAlgSimd.h"
+
 
 finGraphConfig::finGraphConfig()
 {
@@ -24,6 +26,7 @@ finGraphConfig::finGraphConfig()
     this->_transform = nullptr;
 
     this->_renderHints = QPainter::Antialiasing | QPainter::SmoothPixmapTransform;
+    this->_versionStamp = finGraphTrans::newVersionStamp();
 }
 
 finGraphConfig::~finGraphConfig()
@@ -44,6 +47,7 @@ void finGraphConfig::copyGraphConfig(const finGraphConfig *srccfg)
 
     this->cloneTransform(srccfg);
     this->_renderHints = srccfg->_renderHints;
+    this->_versionStamp = srccfg->_versionStamp;
 }
 
 const QSizeF &finGraphConfig::getPanelPixelSize() const
@@ -148,66 +152,89 @@ QPainter::RenderHints finGraphConfig::getRenderHints() const
     return this->_renderHints;
 }
 
+/*
+ * Any change takes a new stamp, so that figure paths generated under an earlier state are known to be stale.
+ * The transform keeps a stamp of its own, as it can also be changed directly through getTransform().
+ */
+quint64 finGraphConfig::getVersionStamp() const
+{
+    if ( this->_transform != nullptr && this->_transform->getVersionStamp() > this->_versionStamp )
+        return this->_transform->getVersionStamp();
+    return this->_versionStamp;
+}
+
 void finGraphConfig::setPanelPixelSize(const QSizeF &size)
 {
     this->_panelSize = size;
+    this->_versionStamp = finGraphTrans::newVersionStamp();
 }
 
 void finGraphConfig::setPanelPixelWidth(double width)
 {
     this->_panelSize.setWidth(width);
+    this->_versionStamp = finGraphTrans::newVersionStamp();
 }
 
 void finGraphConfig::setPanelPixelHeight(double height)
 {
     this->_panelSize.setHeight(height);
+    this->_versionStamp = finGraphTrans::newVersionStamp();
 }
 
 void finGraphConfig::setPanelPixelSize(double sizex, double sizey)
 {
     this->_panelSize.setWidth(sizex);
     this->_panelSize.setHeight(sizey);
+    this->_versionStamp = finGraphTrans::newVersionStamp();
 }
 
 void finGraphConfig::setBackgroundColor(const QColor &color)
 {
     this->_bgColor = color;
+    this->_versionStamp = finGraphTrans::newVersionStamp();
 }
 
 void finGraphConfig::setOriginPixelPoint(const QPointF &pt)
 {
     this->_originPoint = pt;
+    this->_versionStamp = finGraphTrans::newVersionStamp();
 }
 
 void finGraphConfig::setOriginPixelPointX(double ptx)
 {
     this->_originPoint.setX(ptx);
+    this->_versionStamp = finGraphTrans::newVersionStamp();
 }
 
 void finGraphConfig::setOriginPixelPointY(double pty)
 {
     this->_originPoint.setY(pty);
+    this->_versionStamp = finGraphTrans::newVersionStamp();
 }
 
 void finGraphConfig::setOriginPixelPoint(double ptx, double pty)
 {
     this->_originPoint.setX(ptx);
     this->_originPoint.setY(pty);
+    this->_versionStamp = finGraphTrans::newVersionStamp();
 }
 
 void finGraphConfig::setAxisUnitPixelSize(double size)
 {
     this->_axisUnitSize = size;
+    this->_versionStamp = finGraphTrans::newVersionStamp();
 }
 
 void finGraphConfig::setAxisRadZ(double rad)
 {
     this->_axisRadZ = rad;
+    this->_versionStamp = finGraphTrans::newVersionStamp();
 }
 
 void finGraphConfig::setAxisScaleZ(double scale)
 {
     this->_axisScaleZ = scale;
+    this->_versionStamp = finGraphTrans::newVersionStamp();
 }
 
 void finGraphConfig::setTransformType(finGraphTransType type)
@@ -237,6 +264,7 @@ void finGraphConfig::setTransformType(finGraphTransType type)
     this->_transform = newtrans;
     if ( oldtrans != nullptr )
         delete oldtrans;
+    this->_versionStamp = finGraphTrans::newVersionStamp();
     return;
 }
 
@@ -272,6 +300,7 @@ QTransform finGraphConfig::getNakePixelTransformMatrix() const
 void finGraphConfig::setRenderHints(QPainter::RenderHints hints)
 {
     this->_renderHints = hints;
+    this->_versionStamp = finGraphTrans::newVersionStamp();
 }
 
 QPointF finGraphConfig::transformPixelPoint3D(double x, double y, double z) const
@@ -299,6 +328,43 @@ QPointF finGraphConfig::transformPixelPoint(const QPointF &srcpt) const
     return midpt * this->_axisUnitSize + this->_originPoint;
 }
 
+/*
+ * The batch forms give the same results as transforming each point by itself, but let the transform and the
+ * pixel mapping each run as one SIMD pass over the whole array. dstpts may be the same array as srcpts.
+ */
+void finGraphConfig::transformPixelPoints(const QPointF *srcpts, QPointF *dstpts, int cnt) const
+{
+    if ( cnt <= 0 )
+        return;
+
+    const QPointF *midpts = srcpts;
+    if ( this->_transform != nullptr && this->_transform->getTransformType() != finGraphTrans::TP_NONE ) {
+        this->_transform->transPoints(srcpts, dstpts, cnt);
+        midpts = dstpts;
+    }
+
+    finExecAlgSimd::pointScale(reinterpret_cast<const double *>(midpts), reinterpret_cast<double *>(dstpts), cnt,
+                               this->_axisUnitSize, -this->_axisUnitSize,
+                               this->_originPoint.x(), this->_originPoint.y());
+}
+
+void finGraphConfig::transformPixelPoints3D(const finFigurePoint3D *srcpts, QPointF *dstpts, int cnt) const
+{
+    double cosz = cos(this->_axisRadZ), sinz = sin(this->_axisRadZ);
+    for ( int i = 0; i < cnt; i++ ) {
+        double zscaled = srcpts[i].getZ() * this->_axisScaleZ;
+        dstpts[i] = QPointF(srcpts[i].getX() + zscaled * cosz, srcpts[i].getY() + zscaled * sinz);
+    }
+    this->transformPixelPoints(dstpts, dstpts, cnt);
+}
+
+QList<QPointF> finGraphConfig::transformPixelPointList(const QList<QPointF> &srclist) const
+{
+    QList<QPointF> retlist(srclist.count());
+    this->transformPixelPoints(srclist.constData(), retlist.data(), srclist.count());
+    return retlist;
+}
+
 QPointF finGraphConfig::arcTransformPixelPoint(const QPointF &srcpt) const
 {
     QPointF midpt = srcpt;
@@ -335,11 +401,8 @@ QPainterPath finGraphConfig::arcTransformPixelPath(const QPainterPath &path) con
 
 QPolygonF finGraphConfig::transformPixelPolygon(const QPolygonF &polygon) const
 {
-    QPolygonF retpolygon;
-    for ( int i = 0; i < polygon.count(); i++ ) {
-        const QPointF &srcpt = polygon.at(i);
-        retpolygon.append(this->transformPixelPoint(srcpt));
-    }
+    QPolygonF retpolygon(polygon.count());
+    this->transformPixelPoints(polygon.constData(), retpolygon.data(), polygon.count());
     return retpolygon;
 }
 
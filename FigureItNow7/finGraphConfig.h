@@ -36,6 +36,7 @@ protected:
     finGraphTrans *_transform;
 
     QPainter::RenderHints _renderHints;
+    quint64 _versionStamp;
 
 public:
     finGraphConfig();
@@ -65,6 +66,7 @@ public:
     bool isLinearTransform() const;
 
     QPainter::RenderHints getRenderHints() const;
+    quint64 getVersionStamp() const;
 
     void setPanelPixelSize(const QSizeF &size);
     void setPanelPixelWidth(double width);
@@ -91,6 +93,9 @@ public:
     QPointF transformPixelPoint3D(const finFigurePoint3D &pt) const;
 
     QPointF transformPixelPoint(const QPointF &srcpt) const;
+    void transformPixelPoints(const QPointF *srcpts, QPointF *dstpts, int cnt) const;
+    void transformPixelPoints3D(const finFigurePoint3D *srcpts, QPointF *dstpts, int cnt) const;
+    QList<QPointF> transformPixelPointList(const QList<QPointF> &srclist) const;
     QPointF arcTransformPixelPoint(const QPointF &srcpt) const;
     QPainterPath transformPixelPath(const QPainterPath &path) const;
     QPainterPath arcTransformPixelPath(const QPainterPath &path) const;
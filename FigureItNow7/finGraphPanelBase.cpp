@@ -62,9 +62,7 @@ finErrorCode finGraphPanelBase::setFigureContainer(finFigureContainer *figcontai
     int failed = 0, success = 0;
 
     for ( int i = 0; i < figcontainer->getFigureObjectCount(); i++ ) {
-        finFigureObject *figobj = figcontainer->getFigureObjectAt(i);
-
-        errcode = this->appendFigureObject(figobj);
+        errcode = figcontainer->getPixelFigurePathAt(i, &this->_pathList, &this->_config);
         if ( finErrorKits::isErrorResult(errcode) ) {
             failed++;
             continue;
@@ -8,6 +8,13 @@
 
 #include "finGraphTrans.h"
 
+#include <QAtomicInteger>
+
+#include "finExecAlgSimd.h"
+
+// The batch transforms hand point arrays to the SIMD kernels as interleaved (x, y) doubles.
+static_assert(sizeof(QPointF) == 2 * sizeof(double), "QPointF must be a plain pair of doubles");
+
 
 QString finGraphTrans::getTransformTypeName(finGraphTransType type)
 {
@@ -71,9 +78,21 @@ void finGraphTrans::setComboBoxCurrentItemToType(QComboBox *cmbox, finGraphTrans
     cmbox->setCurrentIndex(idx);
 }
 
+/*
+ * Version stamps come from one process-wide counter, so a stamp is never handed out twice; two transforms or
+ * graph configs carry the same stamp only if one was copied from the other and neither changed since.
+ */
+static QAtomicInteger<quint64> _glVersionStamp(0);
+
+quint64 finGraphTrans::newVersionStamp()
+{
+    return _glVersionStamp.fetchAndAddRelaxed(1) + 1;
+}
+
 finGraphTrans::finGraphTrans()
 {
     this->_type = finGraphTrans::TP_NONE;
+    this->_versionStamp = finGraphTrans::newVersionStamp();
 }
 
 finGraphTrans::~finGraphTrans()
@@ -85,6 +104,8 @@ void finGraphTrans::cloneTransform(const finGraphTrans *trans)
 {
     if ( trans == nullptr || trans->getTransformType() != this->_type )
         finThrow(finErrorKits::EC_INVALID_PARAM, "Cannot clone transform with different type");
+
+    this->_versionStamp = trans->_versionStamp;
 }
 
 finGraphTransType finGraphTrans::getTransformType() const
@@ -92,6 +113,11 @@ finGraphTransType finGraphTrans::getTransformType() const
     return this->_type;
 }
 
+quint64 finGraphTrans::getVersionStamp() const
+{
+    return this->_versionStamp;
+}
+
 bool finGraphTrans::isLinear() const
 {
     return true;
@@ -107,6 +133,12 @@ QPointF finGraphTrans::arcTransPoint(const QPointF &ptr)
     return ptr;
 }
 
+void finGraphTrans::transPoints(const QPointF *inpts, QPointF *outpts, int cnt)
+{
+    for ( int i = 0; i < cnt; i++ )
+        outpts[i] = this->transPoint(inpts[i]);
+}
+
 finGraphTransRect::finGraphTransRect()
 {
     this->_type = finGraphTrans::TP_RECT;
@@ -149,6 +181,7 @@ void finGraphTransRect::setAxisZoomX(double zoomx)
         finThrow(finErrorKits::EC_INVALID_PARAM, "Axis zoom X must be positive");
 
     this->_axisZoomX = zoomx;
+    this->_versionStamp = finGraphTrans::newVersionStamp();
 }
 
 void finGraphTransRect::setAxisZoomY(double zoomy)
@@ -157,6 +190,7 @@ void finGraphTransRect::setAxisZoomY(double zoomy)
         finThrow(finErrorKits::EC_INVALID_PARAM, "Axis zoom Y must be positive");
 
     this->_axisZoomY = zoomy;
+    this->_versionStamp = finGraphTrans::newVersionStamp();
 }
 
 QPointF finGraphTransRect::transPoint(const QPointF &ptr)
@@ -175,6 +209,12 @@ QPointF finGraphTransRect::arcTransPoint(const QPointF &ptr)
     return resptr;
 }
 
+void finGraphTransRect::transPoints(const QPointF *inpts, QPointF *outpts, int cnt)
+{
+    finExecAlgSimd::pointScale(reinterpret_cast<const double *>(inpts), reinterpret_cast<double *>(outpts), cnt,
+                               this->_axisZoomX, this->_axisZoomY, 0.0, 0.0);
+}
+
 QString finGraphTransAffine::getAffineTransActionName(finGraphTransAffine::ActionType type)
 {
     switch ( type ) {
@@ -313,6 +353,7 @@ void finGraphTransAffine::reset()
     this->_actList.clear();
     this->_matrix.reset();
     this->_invMatrix.reset();
+    this->_versionStamp = finGraphTrans::newVersionStamp();
 }
 
 void finGraphTransAffine::calcInvertedMatrix()
@@ -331,6 +372,7 @@ void finGraphTransAffine::appendRotate(double rad)
     subtrans.rotateRadians(rad);
     this->_matrix *= subtrans;
     this->calcInvertedMatrix();
+    this->_versionStamp = finGraphTrans::newVersionStamp();
 
     finGraphTransAffine::Action act;
     act._type = finGraphTransAffine::AT_ROTATE;
@@ -344,6 +386,7 @@ void finGraphTransAffine::appendScale(double sx, double sy)
     subtrans.scale(sx, sy);
     this->_matrix *= subtrans;
     this->calcInvertedMatrix();
+    this->_versionStamp = finGraphTrans::newVersionStamp();
 
     finGraphTransAffine::Action act;
     act._type = finGraphTransAffine::AT_SCALE;
@@ -358,6 +401,7 @@ void finGraphTransAffine::appendTranslate(double tx, double ty)
     subtrans.translate(tx, ty);
     this->_matrix *= subtrans;
     this->calcInvertedMatrix();
+    this->_versionStamp = finGraphTrans::newVersionStamp();
 
     finGraphTransAffine::Action act;
     act._type = finGraphTransAffine::AT_TRANSLATE;
@@ -375,3 +419,16 @@ QPointF finGraphTransAffine::arcTransPoint(const QPointF &ptr)
 {
     return this->_invMatrix.map(ptr);
 }
+
+void finGraphTransAffine::transPoints(const QPointF *inpts, QPointF *outpts, int cnt)
+{
+    // The actions only compose affine matrices, but a projective one could not go through the kernel.
+    if ( this->_matrix.type() == QTransform::TxProject ) {
+        finGraphTrans::transPoints(inpts, outpts, cnt);
+        return;
+    }
+
+    const QTransform &mat = this->_matrix;
+    finExecAlgSimd::pointAffine(reinterpret_cast<const double *>(inpts), reinterpret_cast<double *>(outpts), cnt,
+                                mat.m11(), mat.m12(), mat.m21(), mat.m22(), mat.dx(), mat.dy());
+}
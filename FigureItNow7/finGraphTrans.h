@@ -33,6 +33,7 @@ public:
 
 protected:
     Type _type;
+    quint64 _versionStamp;
 
 public:
     finGraphTrans();
@@ -40,10 +41,13 @@ public:
 
     virtual void cloneTransform(const finGraphTrans *trans);
     Type getTransformType() const;
+    quint64 getVersionStamp() const;
+    static quint64 newVersionStamp();
     virtual bool isLinear() const;
 
     virtual QPointF transPoint(const QPointF &ptr);
     virtual QPointF arcTransPoint(const QPointF &ptr);
+    virtual void transPoints(const QPointF *inpts, QPointF *outpts, int cnt);
 };
 
 typedef finGraphTrans::Type finGraphTransType;
@@ -68,6 +72,7 @@ public:
 
     virtual QPointF transPoint(const QPointF &ptr);
     virtual QPointF arcTransPoint(const QPointF &ptr);
+    virtual void transPoints(const QPointF *inpts, QPointF *outpts, int cnt);
 };
 
 class finGraphTransAffine : public finGraphTrans
@@ -123,6 +128,7 @@ public:
 
     virtual QPointF transPoint(const QPointF &ptr);
     virtual QPointF arcTransPoint(const QPointF &ptr);
+    virtual void transPoints(const QPointF *inpts, QPointF *outpts, int cnt);
 
  private:
     void calcInvertedMatrix();
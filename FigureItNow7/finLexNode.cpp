@@ -19,24 +19,29 @@
 #include <stdlib.h>
 #include <QTextStream>
 
+#include "finSymbolTable.h"
+
 
 finLexNode::finLexNode()
-    : _type(TP_DUMMY), _string(), _stringValue(), _u({._rawData = { 0, }}), _row(0), _column(0)
+    : _string(), _u({._rawData = { 0, }}), _type(TP_DUMMY), _symbolId(finSymbolTable::SYM_NONE), _row(0),
+    _column(0), _spanPos(0), _spanLen(0)
 { /* Do nothing */ }
 
 finLexNode::finLexNode(const finLexNode &src)
-    : _type(src._type), _string(src._string), _stringValue(src._stringValue), _u(src._u),
-    _row(src._row), _column(src._column)
+    : _string(src._string), _u(src._u), _type(src._type), _symbolId(src._symbolId), _row(src._row),
+    _column(src._column), _spanPos(src._spanPos), _spanLen(src._spanLen)
 { /* Do nothing */ }
 
 void finLexNode::reset()
 {
     this->_string = QString();
     this->_type = TP_DUMMY;
-    this->_stringValue = QString();
+    this->_symbolId = finSymbolTable::SYM_NONE;
     memset(this->_u._rawData, 0, sizeof (this->_u));
     this->_row = 0;
     this->_column = 0;
+    this->_spanPos = 0;
+    this->_spanLen = 0;
 }
 
 void finLexNode::copyNode(const finLexNode *srcnode)
@@ -47,11 +52,13 @@ void finLexNode::copyNode(const finLexNode *srcnode)
         return;
     }
 
-    this->_string = srcnode->getString();
-    this->_type = srcnode->getType();
-    this->_stringValue = srcnode->getStringValue();
-    this->_row = srcnode->getRow();
-    this->_column = srcnode->getColumn();
+    this->_string = srcnode->_string;
+    this->_type = srcnode->_type;
+    this->_symbolId = srcnode->_symbolId;
+    this->_row = srcnode->_row;
+    this->_column = srcnode->_column;
+    this->_spanPos = srcnode->_spanPos;
+    this->_spanLen = srcnode->_spanLen;
 
     switch ( this->_type ) {
       case finLexNode::TP_DECIMAL:
@@ -78,6 +85,18 @@ QString finLexNode::getString() const
     return this->_string;
 }
 
+int finLexNode::getSymbolId() const
+{
+    switch ( this->_type ) {
+      case TP_VARIABLE:
+      case TP_KEYWORD:
+        return this->_symbolId;
+
+      default:
+        return finSymbolTable::SYM_NONE;
+    }
+}
+
 double finLexNode::getFloatValue() const
 {
     if ( this->_type != TP_DECIMAL )
@@ -99,7 +118,7 @@ QString finLexNode::getStringValue() const
     if ( this->_type != TP_STRING )
         return QString();
 
-    return this->_stringValue;
+    return this->_string;
 }
 
 unsigned int finLexNode::getRow() const
@@ -112,6 +131,16 @@ unsigned int finLexNode::getColumn() const
     return this->_column;
 }
 
+unsigned long finLexNode::getSpanPosition() const
+{
+    return this->_spanPos;
+}
+
+unsigned long finLexNode::getSpanLength() const
+{
+    return this->_spanLen;
+}
+
 void finLexNode::setType(finLexNodeType type)
 {
     this->_type = type;
@@ -120,6 +149,16 @@ void finLexNode::setType(finLexNodeType type)
 void finLexNode::setString(const QString &str)
 {
     this->_string = str;
+    if ( this->_type == TP_VARIABLE || this->_type == TP_KEYWORD )
+        this->_symbolId = finSymbolTable::getSymbolId(str);
+    else
+        this->_symbolId = finSymbolTable::SYM_NONE;
+}
+
+void finLexNode::setSymbol(int symid)
+{
+    this->_string = finSymbolTable::getSymbolName(symid);
+    this->_symbolId = symid;
 }
 
 void finLexNode::setFloatValue(double val)
@@ -143,7 +182,8 @@ void finLexNode::setStringValue(const QString &strval)
     if ( this->_type != TP_STRING )
         finThrowObj(finErrorKits::EC_STATE_ERROR, "Setup string to non-string lex node.");
 
-    this->_stringValue = strval;
+    this->_string = strval;
+    this->_symbolId = finSymbolTable::SYM_NONE;
 }
 
 void finLexNode::setRow(unsigned int row)
@@ -156,6 +196,14 @@ void finLexNode::setColumn(unsigned int column)
     this->_column = column;
 }
 
+void finLexNode::setSpan(unsigned long pos, unsigned long len)
+{
+    // Scripts stay far below 4G characters, so the span is stored in 32 bits.
+    Q_ASSERT(pos <= 0xFFFFFFFFUL && len <= 0xFFFFFFFFUL - pos);
+    this->_spanPos = static_cast<unsigned int>(pos);
+    this->_spanLen = static_cast<unsigned int>(len);
+}
+
 QString finLexNode::dumpObjInfo() const
 {
     QString retstr;
@@ -167,9 +215,12 @@ QString finLexNode::dumpObjInfo() const
         ts << this->_u._floatValue; break;
     case finLexNode::TP_OPERATOR:
         ts << this->_u._operator; break;
+    case finLexNode::TP_STRING:
+        ts << this->_string; break;
     default:
-        ts << this->_stringValue; break;
+        break;
     }
 
     return retstr;
 }
+
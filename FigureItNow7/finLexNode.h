@@ -27,14 +27,19 @@
  *
  *  finLexNode is a tagged-union value class. A node carries:
  *  - a top-level type (Type enum) telling callers which payload slot is valid;
- *  - the verbatim source text of the token (the slice of script consumed by the lexer);
- *  - a payload stored in a small union, covering numeric literals, decoded string literals,
- *    and operator kinds;
- *  - a 0-based source position (row, column) of the first character of the token.
+ *  - the text of the token: the verbatim source text, or the decoded value for a string literal;
+ *  - a payload stored in a small union, covering numeric literals and operator kinds;
+ *  - a 0-based source position (row, column) and the span of script characters of the token.
  *
  *  Nodes are produced by finLexReader::getNextLexNode(); they are mutable so the lexer can fill
  *  them in place rather than allocating a fresh one for every token.
  *
+ *  The layout is kept compact because a large script produces one node per token and every
+ *  syntax node embeds one. A string literal keeps only its decoded value; its verbatim text stays
+ *  reachable through the source span (finLexReader::getNodeSpan()). The text of identifiers,
+ *  keywords and operators is interned in finSymbolTable, so all tokens spelled alike share one
+ *  string buffer instead of owning a copy each, and carry the symbol ID runtime lookups key by.
+ *
  *  \see finLexReader
  *  \see finExceptionObject
  */
@@ -132,17 +137,18 @@ public:
     };
 
 private:
-    Type _type;                    //!< Top-level token type.
-    QString _string;               //!< Verbatim source text of the token (the slice consumed by the lexer).
-    QString _stringValue;          //!< Decoded payload: numeric text for TP_DECIMAL, unescaped text for TP_STRING.
+    QString _string;               //!< Source text of the token; the unescaped value for TP_STRING.
     union {                        //!< Type-specific payload; consult _type before reading any field.
-        long long _numericValue;   //!< Reserved for a future integer-literal type; currently unused.
         double _floatValue;        //!< Floating-point payload; valid when _type == TP_DECIMAL.
         Operator _operator;        //!< Operator kind; valid when _type == TP_OPERATOR.
         char _rawData[8];          //!< Raw byte view used to zero the union on reset and copy.
     } _u;
+    Type _type;                    //!< Top-level token type.
+    int _symbolId;                 //!< Symbol ID of the text of an identifier or keyword, else 0.
     unsigned int _row;             //!< 0-based source row of the token's first character.
     unsigned int _column;          //!< 0-based source column of the token's first character.
+    unsigned int _spanPos;         //!< Character index of the token's first character in the script.
+    unsigned int _spanLen;         //!< Number of script characters the token covers.
 
 public:
     /*!
@@ -175,10 +181,22 @@ public:
     Type getType() const;
 
     /*!
-     *  \brief Returns the verbatim source text of the token.
+     *  \brief Returns the text of the token.
+     *
+     *  This is the verbatim source text, except for TP_STRING nodes, which return their decoded
+     *  value like getStringValue().
      */
     QString getString() const;
 
+    /*!
+     *  \brief Returns the finSymbolTable ID of the text of an identifier or keyword.
+     *
+     *  Nodes of other types return finSymbolTable::SYM_NONE. The ID is assigned when the text is set by
+     *  setString() or setSymbol() after the type, never here, so nodes can be read from several threads
+     *  at once.
+     */
+    int getSymbolId() const;
+
     /*!
      *  \brief Returns the floating-point payload, or 0.0 if _type is not TP_DECIMAL.
      */
@@ -204,16 +222,34 @@ public:
      */
     unsigned int getColumn() const;
 
+    /*!
+     *  \brief Returns the character index of the token's first character in the script.
+     */
+    unsigned long getSpanPosition() const;
+
+    /*!
+     *  \brief Returns the number of script characters the token covers.
+     */
+    unsigned long getSpanLength() const;
+
     /*!
      *  \brief Sets the top-level token type.
      */
     void setType(Type type);
 
     /*!
-     *  \brief Sets the verbatim source text.
+     *  \brief Sets the text of the token.
+     *
+     *  On a TP_VARIABLE or TP_KEYWORD node the text is interned for its symbol ID; on a TP_STRING node
+     *  this replaces the decoded value as well.
      */
     void setString(const QString &str);
 
+    /*!
+     *  \brief Sets the text of the token to the interned spelling of \a symid, sharing its buffer.
+     */
+    void setSymbol(int symid);
+
     /*!
      *  \brief Sets the floating-point payload.
      *
@@ -229,7 +265,7 @@ public:
     void setOperator(Operator optype);
 
     /*!
-     *  \brief Sets the decoded string payload.
+     *  \brief Sets the decoded string payload, which is also the text of a TP_STRING node.
      *
      *  Throws finException with EC_STATE_ERROR if the current type is not TP_STRING.
      */
@@ -245,6 +281,11 @@ public:
      */
     void setColumn(unsigned int column);
 
+    /*!
+     *  \brief Sets the span of script characters the token was lexed from.
+     */
+    void setSpan(unsigned long pos, unsigned long len);
+
     /*!
      *  \brief Returns a one-line textual description of the node, used for logging.
      *
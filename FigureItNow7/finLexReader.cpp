@@ -9,9 +9,9 @@
 /*! \file finLexReader.cpp
  *  \brief Implementations of the FIN-7 streaming tokenizer.
  *
- *  Provides the constructors and destructor, the public state getters, the move / peek / slice
- *  helpers that walk the input, the token-probe dispatch (getNextLexNode / tryGetXxx) for each
- *  of the FIN-7 token types, and the per-operator character-recognition table used by
+ *  Provides the constructors and destructor, the public state getters, the move / peek helpers
+ *  that walk the input, the ASCII character-class table and the dispatch in getNextLexNode that
+ *  uses it to pick one scanner (tryGetXxx) per token, and the per-operator switch used by
  *  tryGetOperator.
  */
 
@@ -21,24 +21,26 @@
 #include <QtLogging>
 #include <QStringBuilder>
 
+#include "finSymbolTable.h"
+
 
 finLexReader::finLexReader()
     : _inputStr(), _posIdx(0), _curRow(0), _curCol(0),
     _lastNodeType(finLexNode::TP_DUMMY), _nextReadOrder(ORD_NUMBER_FIRST)
 {
-    finDebug << "An empty LexReader is constructed." << finDbgObj;
+    finTraceDebug(finTraceKits::TC_LEX) << "An empty LexReader is constructed." << finDbgObj;
 }
 
 finLexReader::finLexReader(const QString &inputstr)
     : _inputStr(inputstr), _posIdx(0), _curRow(0), _curCol(0),
     _lastNodeType(finLexNode::TP_DUMMY), _nextReadOrder(ORD_NUMBER_FIRST)
 {
-    finDebug << "A LexReader is constructed." << finDbgObj;
+    finTraceDebug(finTraceKits::TC_LEX) << "A LexReader is constructed." << finDbgObj;
 }
 
 finLexReader::~finLexReader()
 {
-    finDebug << "The LexReader is destructed." << finDbgObj;
+    finTraceDebug(finTraceKits::TC_LEX) << "The LexReader is destructed." << finDbgObj;
 }
 
 QString
@@ -92,7 +94,8 @@ finLexReader::setString(const QString &instr)
                     QString("Change script is not allowed for when LexReader is in processing."));
     }
 
-    finDebug << "Setup script to LexReader [" << dbgScript(instr) << "]." << finDbgObj;
+    finTraceDebug(finTraceKits::TC_LEX)
+            << "Setup script to LexReader [" << dbgScript(instr) << "]." << finDbgObj;
     this->_inputStr = instr;
     this->_posIdx = 0;
     this->_curRow = 0;
@@ -122,43 +125,139 @@ finLexReader::resetPosition()
     this->_curCol = 0;
 }
 
+const unsigned char finLexReader::_asciiCharClass[128] = {
+    /* 0x00 */ CC_INVALID,  CC_INVALID,  CC_INVALID,  CC_INVALID,  CC_INVALID,  CC_INVALID,  CC_INVALID,  CC_INVALID,
+    /* 0x08 */ CC_INVALID,  CC_BLANK,    CC_BLANK,    CC_BLANK,    CC_BLANK,    CC_BLANK,    CC_INVALID,  CC_INVALID,
+    /* 0x10 */ CC_INVALID,  CC_INVALID,  CC_INVALID,  CC_INVALID,  CC_INVALID,  CC_INVALID,  CC_INVALID,  CC_INVALID,
+    /* 0x18 */ CC_INVALID,  CC_INVALID,  CC_INVALID,  CC_INVALID,  CC_INVALID,  CC_INVALID,  CC_INVALID,  CC_INVALID,
+    /*  !"# */ CC_BLANK,    CC_OPERATOR, CC_QUOTE,    CC_INVALID,
+    /* $%&' */ CC_OPERATOR, CC_OPERATOR, CC_OPERATOR, CC_INVALID,
+    /* ()*+ */ CC_OPERATOR, CC_OPERATOR, CC_OPERATOR, CC_SIGN,
+    /* ,-./ */ CC_OPERATOR, CC_SIGN,     CC_INVALID,  CC_SLASH,
+    /* 0-7  */ CC_DIGIT,    CC_DIGIT,    CC_DIGIT,    CC_DIGIT,    CC_DIGIT,    CC_DIGIT,    CC_DIGIT,    CC_DIGIT,
+    /* 89:; */ CC_DIGIT,    CC_DIGIT,    CC_OPERATOR, CC_OPERATOR,
+    /* <=>? */ CC_OPERATOR, CC_OPERATOR, CC_OPERATOR, CC_INVALID,
+    /* @A-G */ CC_INVALID,  CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,
+    /* H-O  */ CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,
+    /* P-W  */ CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,
+    /* XYZ[ */ CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_OPERATOR,
+    /* \]^_ */ CC_INVALID,  CC_OPERATOR, CC_OPERATOR, CC_LETTER,
+    /* `a-g */ CC_INVALID,  CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,
+    /* h-o  */ CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,
+    /* p-w  */ CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_LETTER,
+    /* xyz{ */ CC_LETTER,   CC_LETTER,   CC_LETTER,   CC_OPERATOR,
+    /* |}~  */ CC_OPERATOR, CC_OPERATOR, CC_OPERATOR, CC_INVALID
+};
+
+finLexReader::finLexCharClass
+finLexReader::getCharClass(QChar ch)
+{
+    char16_t code = ch.unicode();
+    if ( code < 128 )
+        return static_cast<finLexCharClass>(_asciiCharClass[code]);
+
+    if ( ch.isSpace() )
+        return CC_BLANK;
+    else if ( ch.isLetter() )
+        return CC_LETTER;
+    else if ( ch.isDigit() )
+        return CC_DIGIT;
+    else
+        return CC_INVALID;
+}
+
 bool
 finLexReader::getNextLexNode(finLexNode *retnode)
 {
-    int typeordernum;
-    const finLexNodeType *typeorder;
-
     Q_ASSERT(retnode != nullptr);
 
-    finDebug << "getNextLexNode enter" << finDbgObj;
-
     // Check the current state of string inside the LexReader.
     if ( this->_inputStr.isEmpty() )
         finThrowObj(finErrorKits::EC_STATE_ERROR, "Cannot lex an empty script.");
 
     // Move the position pointer to the next non-blank char of the string.
-    if ( !this->moveToNextNonblank() ) {
-        finDebug << "getNextLexNode return false (end of script)" << finDbgObj;
+    if ( !this->moveToNextNonblank() )
         return false;
-    }
 
-    this->getLexTypeOrder(&typeorder, &typeordernum);
-    for ( int i = 0; i < typeordernum; i++ ) {
-        if ( this->tryGetTypedNode(retnode, typeorder[i]) ) {
-            finDebug << "getNextLexNode return true; token type=" << retnode->getType()
-                     << " str=\"" << retnode->getString() << "\""
-                     << " row=" << retnode->getRow() << " col=" << retnode->getColumn();
-            return true;
-        }
+    bool matched = false;
+    switch ( getCharClass(this->getScriptChar()) ) {
+      case CC_SLASH:
+        matched = this->tryGetNote(retnode) || this->tryGetOperator(retnode);
+        break;
+
+      case CC_QUOTE:
+        matched = this->tryGetString(retnode);
+        break;
+
+      case CC_LETTER:
+        matched = this->tryGetVariable(retnode);
+        break;
+
+      case CC_DIGIT:
+        matched = this->tryGetNumber(retnode);
+        break;
+
+      case CC_SIGN:
+        if ( this->_nextReadOrder == ORD_NUMBER_FIRST )
+            matched = this->tryGetNumber(retnode);
+        if ( !matched )
+            matched = this->tryGetOperator(retnode);
+        break;
+
+      case CC_OPERATOR:
+        matched = this->tryGetOperator(retnode);
+        break;
+
+      default:
+        break;
     }
+    if ( matched )
+        return true;
 
-    // No type probe matched the current character: this is a real lex error.
+    // No token starts at the current character: this is a real lex error.
     finThrowObj(finErrorKits::EC_READ_ERROR,
                 QString("Unrecognised character '%1' in script at %2:%3")
                     .arg(this->getScriptChar()).arg(this->_curRow).arg(this->_curCol));
     return false;  // Unreachable; satisfies the compiler.
 }
 
+QStringView
+finLexReader::getNodeSpan(const finLexNode *lexnode) const
+{
+    Q_ASSERT(lexnode != nullptr);
+
+    unsigned long strlength = this->scriptLength();
+    unsigned long spanpos = lexnode->getSpanPosition();
+    unsigned long spanlen = lexnode->getSpanLength();
+    if ( spanpos > strlength || spanlen > strlength - spanpos )
+        return QStringView();
+
+    return QStringView(this->_inputStr).mid(static_cast<qsizetype>(spanpos), static_cast<qsizetype>(spanlen));
+}
+
+finLexReader::Mark
+finLexReader::getMark() const
+{
+    Mark mark;
+    mark._posIdx = this->_posIdx;
+    mark._row = this->_curRow;
+    mark._column = this->_curCol;
+    mark._readOrder = static_cast<int>(this->_nextReadOrder);
+    return mark;
+}
+
+void
+finLexReader::restoreMark(const Mark &mark)
+{
+    if ( mark._posIdx > this->scriptLength() )
+        finThrowObj(finErrorKits::EC_INVALID_PARAM, QString("Mark at %1 is out of the script.").arg(mark._posIdx));
+
+    this->_posIdx = mark._posIdx;
+    this->_curRow = mark._row;
+    this->_curCol = mark._column;
+    this->_nextReadOrder = static_cast<finLexReaderOrder>(mark._readOrder);
+}
+
 unsigned long
 finLexReader::scriptLength() const
 {
@@ -180,66 +279,38 @@ finLexReader::getScriptChar() const
     return this->getScriptCharAt(this->_posIdx);
 }
 
-QString
-finLexReader::getScriptSubAt(unsigned long pos, unsigned long len) const
+void
+finLexReader::moveReadPosTo(unsigned long endpos)
 {
+    const QChar *data = this->_inputStr.constData();
     unsigned long strlength = this->scriptLength();
-    if ( pos >= strlength )
-        return QString("");
-
-    unsigned long endpos = pos + len;
-    if ( endpos >= strlength )
+    if ( endpos > strlength )
         endpos = strlength;
 
-    return this->_inputStr.mid(static_cast<int>(pos), static_cast<int>(endpos - pos));
-}
-
-QString
-finLexReader::getScriptSub(unsigned long len) const
-{
-    return getScriptSubAt(this->_posIdx, len);
-}
-
-bool
-finLexReader::moveReadPos()
-{
-    this->_posIdx++;
-
-    if ( this->isReachedBottom() ) {
-        this->_posIdx = this->scriptLength();
-        return false;
-    }
-
-    if ( this->getScriptChar() == QChar::LineFeed ) {
-        this->_curRow++;
-        this->_curCol = 0;
-    } else {
-        this->_curCol++;
-    }
-    return true;
-}
-
-bool
-finLexReader::moveReadPosWith(unsigned long detpos)
-{
-    for ( unsigned long i = 0; i < detpos; i++ ) {
-        if ( !this->moveReadPos() )
-            return false;
+    for ( unsigned long pos = this->_posIdx + 1; pos <= endpos && pos < strlength; pos++ ) {
+        if ( data[pos] == QChar::LineFeed ) {
+            this->_curRow++;
+            this->_curCol = 0;
+        } else {
+            this->_curCol++;
+        }
     }
-    return true;
+    this->_posIdx = endpos;
 }
 
 bool
 finLexReader::moveToNextNonblank()
 {
-    if ( this->isReachedBottom() )
-        return false;
+    const QChar *data = this->_inputStr.constData();
+    unsigned long strlength = this->scriptLength();
+    unsigned long trypos = this->_posIdx;
 
-    while ( this->getScriptChar().isSpace() ) {
-        if ( !this->moveReadPos() )
-            return false;
-    }
-    return true;
+    while ( trypos < strlength && getCharClass(data[trypos]) == CC_BLANK )
+        trypos++;
+
+    if ( trypos != this->_posIdx )
+        this->moveReadPosTo(trypos);
+    return trypos < strlength;
 }
 
 void
@@ -249,129 +320,69 @@ finLexReader::buildLexNode(finLexNode *retnode, finLexNodeType type, unsigned lo
         finThrowObj(finErrorKits::EC_INVALID_PARAM, QString("Wrong end pos at %1.").arg(endpos));
 
     unsigned long detpos = endpos - this->_posIdx;
+    QStringView spantext(this->_inputStr.constData() + this->_posIdx, static_cast<qsizetype>(detpos));
     retnode->setType(type);
-    retnode->setString(this->getScriptSub(detpos));
-    retnode->setRow(this->_curRow);
-    retnode->setColumn(this->_curCol);
+    retnode->setSpan(this->_posIdx, detpos);
 
-    this->moveReadPosWith(detpos);
-}
-
-void
-finLexReader::getLexTypeOrder(const finLexNodeType **typeorder, int *typenum)
-{
-    this->getLexTypeOrder(this->_nextReadOrder, typeorder, typenum);
-}
-
-void
-finLexReader::getLexTypeOrder(finLexReader::finLexReaderOrder order,
-                              const finLexNodeType **typeorder, int *typenum)
-{
-    static const int _MaxTypeNum = 5;
-    static const struct _infinLexTypeOrder {
-        int _typeNum;
-        finLexNodeType _typeOrder[_MaxTypeNum];
-    } _typeOrderConst[] = {
-        { 5, { finLexNode::TP_NOTE, finLexNode::TP_STRING,
-               finLexNode::TP_VARIABLE, finLexNode::TP_DECIMAL,
-               finLexNode::TP_OPERATOR }
-        },
-        { 5, { finLexNode::TP_NOTE, finLexNode::TP_STRING,
-               finLexNode::TP_VARIABLE, finLexNode::TP_OPERATOR,
-               finLexNode::TP_DECIMAL }
-        }
-    };
-
-    Q_ASSERT(typeorder != nullptr && typenum != nullptr);
-
-    switch ( order ) {
-      case ORD_NUMBER_FIRST:
-        if ( typeorder != nullptr )
-            *typeorder = &_typeOrderConst[0]._typeOrder[0];
-        if ( typenum != nullptr )
-            *typenum = _typeOrderConst[0]._typeNum;
-        break;
-
-      case ORD_OPERATOR_FIRST:
-        if ( typeorder != nullptr )
-            *typeorder = &_typeOrderConst[1]._typeOrder[0];
-        if ( typenum != nullptr )
-            *typenum = _typeOrderConst[1]._typeNum;
-        break;
-    }
-}
-
-bool finLexReader::tryGetTypedNode(finLexNode *retnode, finLexNodeType lextype)
-{
-    Q_ASSERT(retnode != nullptr);
-
-    finDebug << "tryGetTypedNode trying type=" << lextype
-             << " at " << this->_curRow << ":" << this->_curCol
-             << " char=\"" << this->getScriptChar() << "\"";
-
-    bool matched = false;
-    switch (lextype) {
+    // Notes keep no text, and a string literal gets its decoded value from the caller. Identifiers and
+    // operators are interned, so they carry their symbol ID and share the table's copy of the spelling.
+    switch ( type ) {
       case finLexNode::TP_NOTE:
-        matched = this->tryGetNote(retnode);
-        break;
-
       case finLexNode::TP_STRING:
-        matched = this->tryGetString(retnode);
+        retnode->setString(QString());
         break;
 
       case finLexNode::TP_VARIABLE:
-      case finLexNode::TP_KEYWORD:
-        matched = this->tryGetVariable(retnode);
-        break;
-
-      case finLexNode::TP_DECIMAL:
-        matched = this->tryGetNumber(retnode);
-        break;
-
-      case finLexNode::TP_OPERATOR:
-        matched = this->tryGetOperator(retnode);
+      case finLexNode::TP_OPERATOR: {
+        int symid = finSymbolTable::tryGetSymbolId(spantext);
+        if ( symid == finSymbolTable::SYM_NONE )
+            finThrowObj(finErrorKits::EC_OUT_OF_MEMORY,
+                        QString("Symbol table is full with %1 names.").arg(finSymbolTable::getSymbolLimit()));
+        retnode->setSymbol(symid);
         break;
+      }
 
       default:
+        retnode->setString(spantext.toString());
         break;
     }
+    retnode->setRow(this->_curRow);
+    retnode->setColumn(this->_curCol);
 
-    finDebug << "tryGetTypedNode type=" << lextype
-             << (matched ? " MATCHED" : " no-match");
-    return matched;
+    this->moveReadPosTo(endpos);
 }
 
 bool finLexReader::tryGetNote(finLexNode *retnode)
 {
+    const QChar *data = this->_inputStr.constData();
     unsigned long trypos = this->_posIdx;
     unsigned long strlength = this->scriptLength();
 
     Q_ASSERT(retnode != nullptr);
 
-    if ( trypos + 1 >= strlength || this->getScriptCharAt(trypos) != QChar('/') )
+    if ( trypos + 1 >= strlength || data[trypos] != QChar('/') )
         return false;
 
     trypos++;
-    if ( this->getScriptCharAt(trypos) == QChar('/') ) {
+    if ( data[trypos] == QChar('/') ) {
         trypos++;
         while ( trypos < strlength ) {
-            QChar curch = this->getScriptCharAt(trypos);
-            QChar::Category curchcat = curch.category();
+            QChar curch = data[trypos];
 
-            if ( curchcat == QChar::Separator_Line || curchcat == QChar::Separator_Paragraph ||
-                 curch == QChar::LineFeed || curch == QChar::CarriageReturn ||
+            // The line and paragraph separator categories hold exactly these two characters.
+            if ( curch == QChar::LineFeed || curch == QChar::CarriageReturn ||
                  curch == QChar::ParagraphSeparator || curch == QChar::LineSeparator )
                 break;
             trypos++;
         }
-    } else if ( this->getScriptCharAt(trypos) == QChar('*') ) {
+    } else if ( data[trypos] == QChar('*') ) {
         trypos++;
         bool hasendmark = false;
         QChar prechar = this->getScriptCharAt(trypos++);
         QChar curchar;
 
         while ( trypos < strlength ) {
-            curchar = this->getScriptCharAt(trypos++);
+            curchar = data[trypos++];
             if ( prechar == QChar('*') && curchar == QChar('/') ) {
                 hasendmark = true;
                 break;
@@ -385,70 +396,61 @@ bool finLexReader::tryGetNote(finLexNode *retnode)
     }
 
     this->buildLexNode(retnode, finLexNode::TP_NOTE, trypos);
-    finDebug << "tryGetNote matched" << finDbgObj;
     return true;
 }
 
-bool finLexReader::isVariableStartChar(const QChar &ch)
+bool finLexReader::isVariableChar(QChar ch)
 {
-    if ( ch.isLetter() || ch == QChar('_') )
-        return true;
-    else
-        return false;
-}
-
-bool finLexReader::isVariableChar(const QChar &ch)
-{
-    if ( ch.isLetter() || ch.isDigit() || ch == QChar('_') )
-        return true;
-    else
-        return false;
+    finLexCharClass chclass = getCharClass(ch);
+    return (chclass == CC_LETTER || chclass == CC_DIGIT);
 }
 
 bool finLexReader::tryGetVariable(finLexNode *retnode)
 {
+    const QChar *data = this->_inputStr.constData();
     unsigned long trypos = this->_posIdx;
     unsigned long strlength = this->scriptLength();
 
     Q_ASSERT(retnode != nullptr);
 
     // Check the first char in the string, it must be a letter.
-    if ( trypos >= strlength || !isVariableStartChar(this->getScriptCharAt(trypos)) )
+    if ( trypos >= strlength || getCharClass(data[trypos]) != CC_LETTER )
         return false;
     trypos++;
 
     // Check the rest char in the variable, it must be a letter or a digital.
-    while ( trypos < strlength ) {
-        if ( !isVariableChar(this->getScriptCharAt(trypos)) )
-            break;
-
+    while ( trypos < strlength && isVariableChar(data[trypos]) )
         trypos++;
-    }
 
     this->buildLexNode(retnode, finLexNode::TP_VARIABLE, trypos);
     this->tryRecogKeyword(retnode);
 
     this->_lastNodeType = retnode->getType();
     this->_nextReadOrder = ORD_OPERATOR_FIRST;
-    finDebug << "tryGetVariable matched" << finDbgObj;
     return true;
 }
 
 bool finLexReader::tryRecogKeyword(finLexNode *retnode)
 {
-    static QString kwlist[] = {
-        QString("if"), QString("elif"), QString("else"),
-        QString("for"), QString("while"),
-        QString("continue"), QString("break"),
-        QString("return"), QString("exit"), QString("goto"),
-        QString("var")
+    static const QLatin1String kwlist[] = {
+        QLatin1String("if"), QLatin1String("elif"), QLatin1String("else"),
+        QLatin1String("for"), QLatin1String("while"),
+        QLatin1String("continue"), QLatin1String("break"),
+        QLatin1String("return"), QLatin1String("exit"), QLatin1String("goto"),
+        QLatin1String("var")
     };
-    int kwlistcnt = sizeof (kwlist) / sizeof (QString);
+    static const int kwmaxlen = 8;
+    int kwlistcnt = sizeof (kwlist) / sizeof (QLatin1String);
 
     Q_ASSERT(retnode != nullptr);
 
+    // Most identifiers are longer than any keyword; skip the comparisons for them.
+    if ( retnode->getSpanLength() > static_cast<unsigned long>(kwmaxlen) )
+        return false;
+
+    QStringView name = this->getNodeSpan(retnode);
     for ( int i = 0; i < kwlistcnt; i++ ) {
-        if ( QString::compare(retnode->getString(), kwlist[i]) == 0 ) {
+        if ( name == kwlist[i] ) {
             retnode->setType(finLexNode::TP_KEYWORD);
             return true;
         }
@@ -471,6 +473,7 @@ bool finLexReader::tryGetNumber(finLexNode *retnode)
         _IN_NUMST_EX_INTEG1,
         _IN_NUMST_EX_INTEG
     } curstate = _IN_NUMST_INIT;
+    const QChar *data = this->_inputStr.constData();
     unsigned long trypos = this->_posIdx;
     unsigned long strlength = this->scriptLength();
     double basenum = 0.0, basestep = 0;
@@ -480,9 +483,14 @@ bool finLexReader::tryGetNumber(finLexNode *retnode)
     Q_ASSERT(retnode != nullptr);
 
     while (trypos < strlength) {
-        QChar curchar = this->getScriptCharAt(trypos);
+        QChar curchar = data[trypos];
+        finLexCharClass chclass = getCharClass(curchar);
+        int digit = 0;
         bool isfinish = false;
 
+        if ( chclass == CC_DIGIT )
+            digit = (curchar.unicode() < 128 ? curchar.unicode() - u'0' : curchar.digitValue());
+
         switch (curstate) {
         case _IN_NUMST_INIT:
             if ( curchar == QChar('-') ) {
@@ -491,8 +499,8 @@ bool finLexReader::tryGetNumber(finLexNode *retnode)
             } else if ( curchar == QChar('+') ) {
                 basesign = true;
                 curstate = _IN_NUMST_INTEG1;
-            } else if ( curchar.isDigit() ) {
-                basenum = static_cast<double>(curchar.digitValue());
+            } else if ( chclass == CC_DIGIT ) {
+                basenum = static_cast<double>(digit);
                 curstate = _IN_NUMST_INTEG;
             } else {
                 return false;
@@ -500,8 +508,8 @@ bool finLexReader::tryGetNumber(finLexNode *retnode)
             break;
 
         case _IN_NUMST_INTEG1:
-            if ( curchar.isDigit() ) {
-                basenum = static_cast<double>(curchar.digitValue());
+            if ( chclass == CC_DIGIT ) {
+                basenum = static_cast<double>(digit);
                 curstate = _IN_NUMST_INTEG;
             } else {
                 return false;
@@ -511,10 +519,10 @@ bool finLexReader::tryGetNumber(finLexNode *retnode)
         case _IN_NUMST_INTEG:
             if (curchar == QChar('.'))
                 curstate = _IN_NUMST_FLOAT1;
-            else if ( curchar.toLower() == QChar('e') )
+            else if ( curchar == QChar('e') || curchar == QChar('E') )
                 curstate = _IN_NUMST_EX_INIT;
-            else if ( curchar.isDigit() )
-                basenum = basenum * 10.0 + static_cast<double>(curchar.digitValue());
+            else if ( chclass == CC_DIGIT )
+                basenum = basenum * 10.0 + static_cast<double>(digit);
             else if ( curchar.isLetter() )
                 return false;
             else
@@ -522,9 +530,9 @@ bool finLexReader::tryGetNumber(finLexNode *retnode)
             break;
 
         case _IN_NUMST_FLOAT1:
-            if ( curchar.isDigit() ) {
+            if ( chclass == CC_DIGIT ) {
                 basestep = 0.1;
-                basenum += basestep * static_cast<double>(curchar.digitValue());
+                basenum += basestep * static_cast<double>(digit);
                 curstate = _IN_NUMST_FLOAT;
             } else {
                 return false;
@@ -532,10 +540,10 @@ bool finLexReader::tryGetNumber(finLexNode *retnode)
             break;
 
         case _IN_NUMST_FLOAT:
-            if ( curchar.toLower() == QChar('e') )
+            if ( curchar == QChar('e') || curchar == QChar('E') )
                 curstate = _IN_NUMST_EX_INIT;
-            else if ( curchar.isDigit() )
-                basenum += (basestep /= 10.0) * static_cast<double>(curchar.digitValue());
+            else if ( chclass == CC_DIGIT )
+                basenum += (basestep /= 10.0) * static_cast<double>(digit);
             else if ( curchar.isLetter() )
                 return false;
             else
@@ -550,8 +558,8 @@ bool finLexReader::tryGetNumber(finLexNode *retnode)
             } else if ( curchar == QChar('+') ) {
                 expsign = true;
                 curstate = _IN_NUMST_EX_INTEG1;
-            } else if ( curchar.isDigit() ) {
-                expnum = curchar.digitValue();
+            } else if ( chclass == CC_DIGIT ) {
+                expnum = digit;
                 curstate = _IN_NUMST_EX_INTEG;
             } else {
                 return false;
@@ -559,8 +567,8 @@ bool finLexReader::tryGetNumber(finLexNode *retnode)
             break;
 
         case _IN_NUMST_EX_INTEG1:
-            if ( curchar.isDigit() ) {
-                expnum = curchar.digitValue();
+            if ( chclass == CC_DIGIT ) {
+                expnum = digit;
                 curstate = _IN_NUMST_EX_INTEG;
             } else {
                 return false;
@@ -568,8 +576,8 @@ bool finLexReader::tryGetNumber(finLexNode *retnode)
             break;
 
         case _IN_NUMST_EX_INTEG:
-            if ( curchar.isDigit() )
-                expnum = expnum * 10 + curchar.digitValue();
+            if ( chclass == CC_DIGIT )
+                expnum = expnum * 10 + digit;
             else if ( curchar.isLetter() || curchar == QChar('.') )
                 return false;
             else
@@ -598,40 +606,44 @@ bool finLexReader::tryGetNumber(finLexNode *retnode)
 
     this->_lastNodeType = finLexNode::TP_DECIMAL;
     this->_nextReadOrder = ORD_OPERATOR_FIRST;
-    finDebug << "tryGetNumber matched" << finDbgObj;
     return true;
 }
 
 bool finLexReader::tryGetString(finLexNode *retnode)
 {
+    const QChar *data = this->_inputStr.constData();
     unsigned long trypos = this->_posIdx;
     unsigned long strlength = this->scriptLength();
 
     Q_ASSERT(retnode != nullptr);
-    if ( trypos >= strlength || this->getScriptCharAt(trypos) != QChar('\"'))
+    if ( trypos >= strlength || data[trypos] != QChar('\"'))
         return false;
 
     QString retstr("");  // Create an empty (not null) string to store the result string.
     unsigned long grabstart = ++trypos;
 
     while ( trypos < strlength ) {
-        QChar curch = this->getScriptCharAt(trypos);
+        QChar curch = data[trypos];
 
         // A string constant ends with another double-quote or a newline.
-        if ( curch == QChar('\"') ||
-             curch.category() == QChar::Separator_Line || curch.category() == QChar::Separator_Paragraph ) {
+        if ( curch == QChar('\"') || curch == QChar::LineSeparator || curch == QChar::ParagraphSeparator ) {
             if ( trypos > grabstart )
-                retstr += this->getScriptSubAt(grabstart, trypos - grabstart);
+                retstr.append(data + grabstart, static_cast<qsizetype>(trypos - grabstart));
             trypos++;
             break;
         }
 
         if ( curch == QChar('\\') ) {
             if ( trypos > grabstart )
-                retstr += this->getScriptSubAt(grabstart, trypos - grabstart);
+                retstr.append(data + grabstart, static_cast<qsizetype>(trypos - grabstart));
 
             // Read one more char if the transformer char is found at current location.
-            curch = this->_inputStr.at(static_cast<int>(++trypos));
+            if ( ++trypos >= strlength ) {
+                finThrowObj(finErrorKits::EC_READ_ERROR,
+                            QString("Unterminated escape sequence in string literal at %1:%2")
+                                .arg(this->_curRow).arg(this->_curCol));
+            }
+            curch = data[trypos];
 
             if ( curch == QChar('n') ) {
                 retstr += QChar::LineFeed;
@@ -657,12 +669,12 @@ bool finLexReader::tryGetString(finLexNode *retnode)
 
     this->_lastNodeType = finLexNode::TP_STRING;
     this->_nextReadOrder = ORD_OPERATOR_FIRST;
-    finDebug << "tryGetString matched" << finDbgObj;
     return true;
 }
 
 bool finLexReader::tryGetOperator(finLexNode *retnode)
 {
+    const QChar *data = this->_inputStr.constData();
     unsigned long trypos = this->_posIdx;
     unsigned long strlength = this->scriptLength();
 
@@ -671,166 +683,133 @@ bool finLexReader::tryGetOperator(finLexNode *retnode)
     if ( trypos >= strlength )
         return false;
 
-    QChar curchar = this->getScriptCharAt(trypos);
+    char16_t curchar = data[trypos].unicode();
+    char16_t nxtchar = (trypos + 1 < strlength ? data[trypos + 1].unicode() : u'\0');
     finLexOperatorType optype = finLexNode::OP_DUMMY;
     trypos++;
 
-    QChar nxtchar;
-#define READ_NEXT_CHAR  do {                         \
-        nxtchar = QChar('\0');                       \
-        if ( trypos < strlength )                    \
-            nxtchar = this->getScriptCharAt(trypos); \
-    } while (0)
-
-    if ( curchar == QChar('+') ) {
-        READ_NEXT_CHAR;
-        if ( nxtchar == QChar('+') ) {
+    // Operators taking a value on their right switch the reader to number-first order.
+    finLexReaderOrder nextorder = ORD_NUMBER_FIRST;
+    switch ( curchar ) {
+      case u'+':
+        if ( nxtchar == u'+' ) {
             optype = finLexNode::OP_ACCUMLT;
-            this->_nextReadOrder = ORD_OPERATOR_FIRST;
+            nextorder = ORD_OPERATOR_FIRST;
             trypos++;
         } else {
             optype = finLexNode::OP_ADD;
-            this->_nextReadOrder = ORD_NUMBER_FIRST;
         }
-    } else if ( curchar == QChar('-') ) {
-        READ_NEXT_CHAR;
-        if ( nxtchar == QChar('-') ) {
+        break;
+
+      case u'-':
+        if ( nxtchar == u'-' ) {
             optype = finLexNode::OP_DESCEND;
-            this->_nextReadOrder = ORD_OPERATOR_FIRST;
+            nextorder = ORD_OPERATOR_FIRST;
             trypos++;
         } else {
             optype = finLexNode::OP_SUB;
-            this->_nextReadOrder = ORD_NUMBER_FIRST;
         }
-    } else if ( curchar == QChar('*') ) {
-        optype = finLexNode::OP_MUL;
-        this->_nextReadOrder = ORD_NUMBER_FIRST;
-    } else if ( curchar == QChar('/') ) {
-        optype = finLexNode::OP_DIV;
-        this->_nextReadOrder = ORD_NUMBER_FIRST;
-    } else if ( curchar == QChar('%') ) {
-        optype = finLexNode::OP_MOD;
-        this->_nextReadOrder = ORD_NUMBER_FIRST;
-    } else if ( curchar == QChar('^') ) {
-        optype = finLexNode::OP_POWER;
-        this->_nextReadOrder = ORD_NUMBER_FIRST;
-    } else if ( curchar == QChar('=') ) {
-        READ_NEXT_CHAR;
-        if ( nxtchar == QChar('=') ) {
+        break;
+
+      case u'*':  optype = finLexNode::OP_MUL;    break;
+      case u'/':  optype = finLexNode::OP_DIV;    break;
+      case u'%':  optype = finLexNode::OP_MOD;    break;
+      case u'^':  optype = finLexNode::OP_POWER;  break;
+
+      case u'=':
+        if ( nxtchar == u'=' ) {
             optype = finLexNode::OP_EQUAL;
             trypos++;
         } else {
             optype = finLexNode::OP_LET;
         }
-        this->_nextReadOrder = ORD_NUMBER_FIRST;
-    } else if ( curchar == QChar('>') ) {
-        READ_NEXT_CHAR;
-        if ( nxtchar == QChar('=') ) {
+        break;
+
+      case u'>':
+        if ( nxtchar == u'=' ) {
             optype = finLexNode::OP_GRT_EQ;
             trypos++;
         } else {
             optype = finLexNode::OP_GRT;
         }
-        this->_nextReadOrder = ORD_NUMBER_FIRST;
-    } else if ( curchar == QChar('<') ) {
-        READ_NEXT_CHAR;
-        if ( nxtchar == QChar('=') ) {
+        break;
+
+      case u'<':
+        if ( nxtchar == u'=' ) {
             optype = finLexNode::OP_LES_EQ;
             trypos++;
-        } else if ( nxtchar == QChar('>') ) {
+        } else if ( nxtchar == u'>' ) {
             optype = finLexNode::OP_NONEQUAL;
             trypos++;
         } else {
             optype = finLexNode::OP_LES;
         }
-        this->_nextReadOrder = ORD_NUMBER_FIRST;
-    } else if ( curchar == QChar('!') ) {
-        READ_NEXT_CHAR;
-        if ( nxtchar == QChar('=') ) {
+        break;
+
+      case u'!':
+        if ( nxtchar == u'=' ) {
             optype = finLexNode::OP_NONEQUAL;
             trypos++;
         } else {
             // Style 'num!' (Factorial) goes first, because the syntax reader can change it to LOGIC-NOT.
             optype = finLexNode::OP_FACTORI;
-            //optype = finLexNode::OP_LOGIC_NOT;
         }
-        this->_nextReadOrder = ORD_NUMBER_FIRST;
-    } else if ( curchar == QChar('~') ) {
-        READ_NEXT_CHAR;
-        if ( nxtchar == QChar('~') ) {
+        break;
+
+      case u'~':
+        if ( nxtchar == u'~' ) {
             optype = finLexNode::OP_LOGIC_NOT;
             trypos++;
         } else {
             optype = finLexNode::OP_BIT_NOT;
         }
-        this->_nextReadOrder = ORD_NUMBER_FIRST;
-    } else if ( curchar == QChar('&') ) {
-        READ_NEXT_CHAR;
-        if ( nxtchar == QChar('&') ) {
+        break;
+
+      case u'&':
+        if ( nxtchar == u'&' ) {
             optype = finLexNode::OP_LOGIC_AND;
             trypos++;
         } else {
             optype = finLexNode::OP_BIT_AND;
         }
-        this->_nextReadOrder = ORD_NUMBER_FIRST;
-    } else if ( curchar == QChar('|') ) {
-        READ_NEXT_CHAR;
-        if ( nxtchar == QChar('|') ) {
+        break;
+
+      case u'|':
+        if ( nxtchar == u'|' ) {
             optype = finLexNode::OP_LOGIC_OR;
             trypos++;
         } else {
             optype = finLexNode::OP_BIT_OR;
         }
-        this->_nextReadOrder = ORD_NUMBER_FIRST;
-    } else if ( curchar == QChar('$') ) {
-        READ_NEXT_CHAR;
-        if ( nxtchar == QChar('$') ) {
+        break;
+
+      case u'$':
+        if ( nxtchar == u'$' ) {
             optype = finLexNode::OP_LOGIC_XOR;
             trypos++;
         } else {
             optype = finLexNode::OP_BIT_XOR;
         }
-        this->_nextReadOrder = ORD_NUMBER_FIRST;
-    } else if ( curchar == QChar('(') ) {
-        optype = finLexNode::OP_L_RND_BRCKT;
-        this->_nextReadOrder = ORD_NUMBER_FIRST;
-    } else if ( curchar == QChar(')') ) {
-        optype = finLexNode::OP_R_RND_BRCKT;
-        this->_nextReadOrder = ORD_OPERATOR_FIRST;
-    } else if ( curchar == QChar('[') ) {
-        optype = finLexNode::OP_L_SQR_BRCKT;
-        this->_nextReadOrder = ORD_NUMBER_FIRST;
-    } else if ( curchar == QChar(']') ) {
-        optype = finLexNode::OP_R_SQR_BRCKT;
-        this->_nextReadOrder = ORD_OPERATOR_FIRST;
-    } else if ( curchar == QChar('{') ) {
-        optype = finLexNode::OP_L_FLW_BRCKT;
-        this->_nextReadOrder = ORD_NUMBER_FIRST;
-    } else if ( curchar == QChar('}') ) {
-        optype = finLexNode::OP_R_FLW_BRCKT;
-        this->_nextReadOrder = ORD_OPERATOR_FIRST;
-    } else if ( curchar == QChar(';') ) {
-        optype = finLexNode::OP_SPLIT;
-        this->_nextReadOrder = ORD_NUMBER_FIRST;
-    } else if ( curchar == QChar(',') ) {
-        optype = finLexNode::OP_COMMA;
-        this->_nextReadOrder = ORD_NUMBER_FIRST;
-    } else if ( curchar == QChar(':') ) {
-        optype = finLexNode::OP_COLON;
-        this->_nextReadOrder = ORD_NUMBER_FIRST;
-    } else {
-        return false;
-    }
-#undef READ_NEXT_CHAR
+        break;
+
+      case u'(':  optype = finLexNode::OP_L_RND_BRCKT;  break;
+      case u')':  optype = finLexNode::OP_R_RND_BRCKT;  nextorder = ORD_OPERATOR_FIRST;  break;
+      case u'[':  optype = finLexNode::OP_L_SQR_BRCKT;  break;
+      case u']':  optype = finLexNode::OP_R_SQR_BRCKT;  nextorder = ORD_OPERATOR_FIRST;  break;
+      case u'{':  optype = finLexNode::OP_L_FLW_BRCKT;  break;
+      case u'}':  optype = finLexNode::OP_R_FLW_BRCKT;  nextorder = ORD_OPERATOR_FIRST;  break;
+      case u';':  optype = finLexNode::OP_SPLIT;        break;
+      case u',':  optype = finLexNode::OP_COMMA;        break;
+      case u':':  optype = finLexNode::OP_COLON;        break;
 
-    if ( optype == finLexNode::OP_DUMMY )
+      default:
         return false;
+    }
 
     this->buildLexNode(retnode, finLexNode::TP_OPERATOR, trypos);
     retnode->setOperator(optype);
 
+    this->_nextReadOrder = nextorder;
     this->_lastNodeType = finLexNode::TP_OPERATOR;
-    finDebug << "tryGetOperator matched operator=" << optype
-             << " str=\"" << retnode->getString() << "\"" << finDbgObj;
     return true;
 }
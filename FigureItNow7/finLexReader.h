@@ -10,7 +10,8 @@
  *  \brief Declarations of the FIN-7 streaming tokenizer.
  *
  *  This header defines finLexReader, the class that turns a FIN-7 source string into a sequence
- *  of finLexNode tokens, plus the private helpers used to walk the input and the inner
+ *  of finLexNode tokens, plus the private helpers used to walk the input, the character-class
+ *  table that selects a scanner from the first character of a token, and the inner
  *  finLexReaderOrder enum used to disambiguate overlapping token prefixes.
  */
 
@@ -18,6 +19,7 @@
 #define FINLEXREADER_H
 
 #include <QString>
+#include <QStringView>
 
 #include "finErrorCode.h"
 #include "finLexNode.h"
@@ -31,11 +33,14 @@
  *  the next token's type, source text, payload, and source position. Whitespace (space, tab,
  *  newline) is skipped automatically.
  *
- *  Disambiguation between token types that share a leading character (notably TP_DECIMAL vs
- *  TP_OPERATOR for `+` and `-`) is driven by a small state machine: after a value the reader
- *  expects an operator next, after an operator it expects a value next, and the tiebreaker
- *  order is driven by finLexReaderOrder. TP_NOTE / TP_STRING / TP_VARIABLE are always probed
- *  first because their leading characters do not overlap with the value/operator set.
+ *  Every token is lexed in one forward scan: the class of its first character (looked up in a
+ *  table for ASCII) selects exactly one scanner, which walks the raw character buffer. The only
+ *  ambiguous leading characters are `/` (a comment or the division operator) and `+` / `-` (a
+ *  signed number or an operator); the latter is resolved by finLexReaderOrder: after a value the
+ *  reader expects an operator next, after an operator it expects a value next.
+ *
+ *  Tokens record the span of source they were lexed from. Comment tokens keep only that span and
+ *  never copy their text; use getNodeSpan() to look at it while the script is loaded.
  *
  *  finLexReader is single-pass and non-reentrant; it does not buffer the input.
  *
@@ -51,6 +56,18 @@ private:
     finLexNodeType _lastNodeType;       //!< Type of the most recently lexed token; kept for diagnostics.
 
 public:
+    /*! \struct finLexReader::Mark
+     *  \brief A saved read position together with the context the next token is lexed in.
+     *
+     *  Lexing from a mark only looks at the script from the mark onward, so a mark taken on one
+     *  script can be restored on another one that shares the text behind it.
+     */
+    struct Mark {
+        unsigned long _posIdx;          //!< Read position.
+        unsigned int _row, _column;     //!< Source row and column at the read position.
+        int _readOrder;                 //!< finLexReaderOrder expected for the next token.
+    };
+
     /*!
      *  \brief Default-constructs an empty reader with no script loaded.
      */
@@ -108,18 +125,38 @@ public:
     /*!
      *  \brief Lexes the next token into \a retnode.
      *
-     *  Skips leading whitespace, then probes the token types in the order selected by
-     *  finLexReaderOrder and returns the first probe that successfully consumes a token.
+     *  Skips leading whitespace, then runs the scanner selected by the class of the first
+     *  character of the token.
      *
      *  \param retnode  Output node to fill; must not be \c nullptr.
      *  \return \c true if a token was lexed and stored in \a *retnode; \c false if the input
      *          was exhausted (only whitespace remained after the previous token).
      *
      *  \throws finException with EC_STATE_ERROR if the reader has no script loaded.
-     *  \throws finException with EC_READ_ERROR if no probe matched the current character.
+     *  \throws finException with EC_READ_ERROR if no token starts at the current character.
      */
     bool getNextLexNode(finLexNode *retnode);
 
+    /*!
+     *  \brief Returns a view of the source text \a lexnode was lexed from.
+     *
+     *  The view points into the loaded script and is invalidated by setString(). Returns an
+     *  empty view if the span is out of range of the current script.
+     */
+    QStringView getNodeSpan(const finLexNode *lexnode) const;
+
+    /*!
+     *  \brief Returns the current read position and lexing context as a Mark.
+     */
+    Mark getMark() const;
+
+    /*!
+     *  \brief Continues lexing the loaded script from \a mark.
+     *
+     *  \throws finException with EC_INVALID_PARAM if the mark lies beyond the end of the script.
+     */
+    void restoreMark(const Mark &mark);
+
     /*!
      *  \brief Returns a one-line textual description of the reader, used for logging.
      *
@@ -153,34 +190,13 @@ private:
     QChar getScriptChar() const;
 
     /*!
-     *  \brief Returns up to \a len characters of the input starting at absolute position \a pos.
-     *
-     *  Clamps to the end of the input if \a pos + \a len would overflow.
-     */
-    QString getScriptSubAt(unsigned long pos, unsigned long len) const;
-
-    /*!
-     *  \brief Returns up to \a len characters of the input starting at the current read position.
-     */
-    QString getScriptSub(unsigned long len) const;
-
-    /*!
-     *  \brief Advances the read position by one character, updating _curRow and _curCol.
-     *
-     *  A line feed increments the row and resets the column; any other character increments the
-     *  column.
-     *
-     *  \return \c true if the new position is still in range; \c false if the advance ran off
-     *          the end of the input (in which case _posIdx is clamped to scriptLength()).
-     */
-    bool moveReadPos();
-
-    /*!
-     *  \brief Advances the read position by up to \a detpos characters, stopping early at end-of-input.
+     *  \brief Advances the read position to absolute position \a endpos, updating _curRow and _curCol.
      *
-     *  \return \c true if the full \a detpos was consumed; \c false if end-of-input was hit first.
+     *  Each character stepped onto counts once: a line feed increments the row and resets the
+     *  column; any other character increments the column. The position is clamped to
+     *  scriptLength(), and stepping onto the end of the input leaves the row and column alone.
      */
-    bool moveReadPosWith(unsigned long detpos);
+    void moveReadPosTo(unsigned long endpos);
 
     /*!
      *  \brief Skips whitespace at the current read position.
@@ -194,52 +210,52 @@ private:
      *  \brief Fills \a retnode with a token of the given \a type covering the input up to
      *         absolute position \a endpos, then advances the read position to \a endpos.
      *
-     *  The verbatim source slice [_posIdx, \a endpos) is recorded as the node's source string,
-     *  and the current row/column (before the advance) is recorded as the source position.
+     *  The span [_posIdx, \a endpos) is recorded in the node, and so is the current row/column
+     *  (before the advance). The verbatim source slice is copied into the node's source string
+     *  for every type except TP_NOTE, which nothing downstream reads.
      *
      *  \throws finException with EC_INVALID_PARAM if \a endpos is not past the current position.
      */
     void buildLexNode(finLexNode *retnode, finLexNodeType type, unsigned long endpos);
 
     /*! \enum finLexReader::finLexReaderOrder
-     *  \brief Tiebreaker order used when probing token types in getNextLexNode().
-     *
-     *  The reader walks a fixed list of type probes (TP_NOTE, TP_STRING, TP_VARIABLE, then
-     *  either TP_DECIMAL or TP_OPERATOR last) and returns the first one that successfully
-     *  consumes a token. The two entries here swap the order of the last two probes:
+     *  \brief Tiebreaker used when a token starts with `+` or `-`.
      *
-     *  - ORD_NUMBER_FIRST probes TP_DECIMAL before TP_OPERATOR. Used right after an operator
+     *  - ORD_NUMBER_FIRST tries TP_DECIMAL before TP_OPERATOR. Used right after an operator
      *    so that `+5` lexes as a single signed number rather than as `+` followed by `5`.
-     *  - ORD_OPERATOR_FIRST probes TP_OPERATOR before TP_DECIMAL. Used right after a value so
-     *    that `5+3` lexes as three tokens (`5`, `+`, `3`) rather than as `5` followed by a
-     *    malformed number starting with `+`.
+     *  - ORD_OPERATOR_FIRST lexes the sign as TP_OPERATOR. Used right after a value so that
+     *    `5+3` lexes as three tokens (`5`, `+`, `3`) rather than as `5` followed by a
+     *    number starting with `+`.
      *
      *  The reader switches between the two orders automatically as it consumes tokens.
      */
     enum finLexReaderOrder {
-        ORD_NUMBER_FIRST,     //!< Probe TP_DECIMAL before TP_OPERATOR.
-        ORD_OPERATOR_FIRST    //!< Probe TP_OPERATOR before TP_DECIMAL.
+        ORD_NUMBER_FIRST,     //!< Try TP_DECIMAL before TP_OPERATOR.
+        ORD_OPERATOR_FIRST    //!< Lex a leading sign as TP_OPERATOR.
     };
 
     finLexReaderOrder _nextReadOrder;   //!< Tiebreaker order to use for the next call to getNextLexNode().
 
-    /*!
-     *  \brief Returns the current tiebreaker order and the matching type-probe list.
-     */
-    void getLexTypeOrder(const finLexNodeType **typeorder, int *typenum);
+    /*! \enum finLexReader::finLexCharClass
+     *  \brief Classes of the first character of a token; each selects one scanner.
+     */
+    enum finLexCharClass {
+        CC_INVALID = 0,   //!< Cannot start a token.
+        CC_BLANK,         //!< Whitespace, skipped between tokens.
+        CC_LETTER,        //!< Letter or underscore; starts TP_VARIABLE / TP_KEYWORD.
+        CC_DIGIT,         //!< Decimal digit; starts TP_DECIMAL.
+        CC_SIGN,          //!< `+` or `-`; starts TP_DECIMAL or TP_OPERATOR by finLexReaderOrder.
+        CC_SLASH,         //!< `/`; starts TP_NOTE or the division operator.
+        CC_QUOTE,         //!< `"`; starts TP_STRING.
+        CC_OPERATOR       //!< Any other operator or punctuation character.
+    };
 
-    /*!
-     *  \brief Returns the type-probe list for the explicit \a order.
-     */
-    void getLexTypeOrder(finLexReader::finLexReaderOrder order,
-                         const finLexNodeType **typeorder, int *typenum);
+    static const unsigned char _asciiCharClass[128];   //!< finLexCharClass of each ASCII character.
 
     /*!
-     *  \brief Dispatches to the matching tryGetXxx() helper for the given \a lextype.
-     *
-     *  Returns \c false for any lextype that has no tryGetXxx() helper.
+     *  \brief Returns the finLexCharClass of \a ch; table lookup for ASCII, QChar properties otherwise.
      */
-    bool tryGetTypedNode(finLexNode *retnode, finLexNodeType lextype);
+    static finLexCharClass getCharClass(QChar ch);
 
     /*!
      *  \brief Tries to lex a `//` line comment or a `/* ... * /` block comment.
@@ -249,7 +265,7 @@ private:
     bool tryGetNote(finLexNode *retnode);
 
     /*!
-     *  \brief Tries to lex an identifier and, on a match, promote it to a keyword.
+     *  \brief Lexes an identifier and, on a match, promotes it to a keyword.
      */
     bool tryGetVariable(finLexNode *retnode);
 
@@ -270,7 +286,7 @@ private:
     bool tryGetNumber(finLexNode *retnode);
 
     /*!
-     *  \brief Tries to lex a double-quoted string literal, decoding escape sequences.
+     *  \brief Lexes a double-quoted string literal, decoding escape sequences.
      *
      *  Supports `\\`, `\"`, `\n`, and `\t`. Other backslash sequences throw EC_READ_ERROR.
      */
@@ -283,15 +299,10 @@ private:
      */
     bool tryGetOperator(finLexNode *retnode);
 
-    /*!
-     *  \brief Returns \c true if \a ch can start a FIN-7 identifier (letter or underscore).
-     */
-    static bool isVariableStartChar(const QChar &ch);
-
     /*!
      *  \brief Returns \c true if \a ch can appear inside a FIN-7 identifier (letter, digit, or underscore).
      */
-    static bool isVariableChar(const QChar &ch);
+    static bool isVariableChar(QChar ch);
 };
 
 #endif // FINLEXREADER_H
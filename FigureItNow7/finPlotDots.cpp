@@ -92,12 +92,7 @@ finErrorCode finPlotDots::plot()
     if ( this->_figcontainer == nullptr )
         return finErrorKits::EC_STATE_ERROR;
 
-    for ( int i = 0; i < this->_ptList.count(); i++ ) {
-        auto fodot = std::make_unique<finFigureObjectDot>();
-        fodot->setPoint(this->_ptList.at(i));
-        this->_figcontainer->appendFigureObject(fodot.get());
-        fodot.release();
-    }
+    this->_figcontainer->appendDotPoints(this->_ptList);
     return finErrorKits::EC_SUCCESS;
 }
 
@@ -119,10 +114,7 @@ finErrorCode finPlotDotsLine::plot()
     if ( this->_ptList.count() == 0 ) {
         return finErrorKits::EC_SUCCESS;
     } else if ( this->_ptList.count() == 1 ) {
-        auto fodot = std::make_unique<finFigureObjectDot>();
-        fodot->setPoint(this->_ptList.first());
-        this->_figcontainer->appendFigureObject(fodot.get());
-        fodot.release();
+        this->_figcontainer->appendDotPoint(this->_ptList.first());
         return finErrorKits::EC_SUCCESS;
     }
 
@@ -274,6 +266,95 @@ finErrorCode finPlotDotsStream::plot()
     return finErrorKits::EC_SUCCESS;
 }
 
+finPlotDotsSpatialIndex::finPlotDotsSpatialIndex(double cellsize)
+    : _ptList(), _aliveList(), _cellMap()
+{
+    this->_cellSize = (cellsize < 1.0e-8 ? 1.0e-8 : cellsize);
+}
+
+int finPlotDotsSpatialIndex::getPointCount() const
+{
+    return this->_ptList.count();
+}
+
+const QPointF &finPlotDotsSpatialIndex::getPointAt(int id) const
+{
+    return this->_ptList.at(id);
+}
+
+bool finPlotDotsSpatialIndex::isPointAlive(int id) const
+{
+    return this->_aliveList.at(id);
+}
+
+qint64 finPlotDotsSpatialIndex::getCellIndex(double pos) const
+{
+    // Clamping keeps far away coordinates in range; it is monotonic, so range queries stay exact.
+    double cellpos = floor(pos / this->_cellSize);
+    if ( cellpos < -1.0e15 )
+        cellpos = -1.0e15;
+    else if ( cellpos > 1.0e15 )
+        cellpos = 1.0e15;
+    return (qint64)cellpos;
+}
+
+int finPlotDotsSpatialIndex::appendPoint(const QPointF &pt)
+{
+    int id = this->_ptList.count();
+    bool valid = !(qIsNaN(pt.x()) || qIsNaN(pt.y()) || qIsInf(pt.x()) || qIsInf(pt.y()));
+
+    this->_ptList.append(pt);
+    this->_aliveList.append(valid);
+    if ( valid )
+        this->_cellMap[qMakePair(this->getCellIndex(pt.x()), this->getCellIndex(pt.y()))].append(id);
+    return id;
+}
+
+void finPlotDotsSpatialIndex::removePoint(int id)
+{
+    if ( id < 0 || id >= this->_ptList.count() || !this->_aliveList.at(id) )
+        return;
+
+    const QPointF &pt = this->_ptList.at(id);
+    QPair<qint64, qint64> cellkey = qMakePair(this->getCellIndex(pt.x()), this->getCellIndex(pt.y()));
+    QList<int> &cell = this->_cellMap[cellkey];
+    cell.removeOne(id);
+    if ( cell.isEmpty() )
+        this->_cellMap.remove(cellkey);
+    this->_aliveList[id] = false;
+}
+
+int finPlotDotsSpatialIndex::findNearestPoint(const QPointF &chkpt, const QRectF &srchrange, double maxdist) const
+{
+    qint64 fromcx = this->getCellIndex(srchrange.left()), tocx = this->getCellIndex(srchrange.right());
+    qint64 fromcy = this->getCellIndex(srchrange.top()), tocy = this->getCellIndex(srchrange.bottom());
+    double mindist = maxdist;
+    int nearestid = -1;
+
+    // Equally near points resolve to the earliest appended one, the same as a linear scan in id order.
+    for ( qint64 cx = fromcx; cx <= tocx; cx++ ) {
+        for ( qint64 cy = fromcy; cy <= tocy; cy++ ) {
+            QHash<QPair<qint64, qint64>, QList<int> >::const_iterator cellit =
+                    this->_cellMap.constFind(qMakePair(cx, cy));
+            if ( cellit == this->_cellMap.constEnd() )
+                continue;
+
+            foreach ( int id, cellit.value() ) {
+                const QPointF &curpt = this->_ptList.at(id);
+                if ( !srchrange.contains(curpt) )
+                    continue;
+
+                double curdist = finFigureAlg::pointsDistance(chkpt, curpt);
+                if ( (curdist < mindist || (curdist == mindist && id < nearestid)) && curpt != chkpt ) {
+                    mindist = curdist;
+                    nearestid = id;
+                }
+            }
+        }
+    }
+    return nearestid;
+}
+
 finPlotDotsScatter::finPlotDotsScatter()
 {
     this->_distLimit = 0.1;
@@ -305,45 +386,24 @@ bool finPlotDotsScatter::isNaNOrInfPoint(const QPointF &pt) const
         return false;
 }
 
-int finPlotDotsScatter::findNearestPoint(const QPointF &chkpt, const QList<QPointF> &ptlist,
-                                         int exceptcnt, QPointF *outpt)
+QRectF finPlotDotsScatter::getSearchRange(const QPointF &chkpt) const
 {
     QRectF srchrange;
     srchrange.setX(chkpt.x() - this->_distLimit);
     srchrange.setY(chkpt.y() - this->_distLimit);
     srchrange.setSize(QSizeF(2 * this->_distLimit, 2 * this->_distLimit));
+    return srchrange;
+}
 
-    double mindist = this->_distLimit * 2.0;
-    int checkcnt = ptlist.count() - exceptcnt;
-    int nearestidx = -1;
-
-    for ( int i = 0; i < checkcnt; i++ ) {
-        const QPointF &curpt = ptlist.at(i);
-        if ( this->isNaNOrInfPoint(curpt) || !srchrange.contains(curpt) )
-            continue;
-
-        double curdist = finFigureAlg::pointsDistance(chkpt, curpt);
-        if ( curdist < mindist && curpt != chkpt ) {
-            mindist = curdist;
-            nearestidx = i;
-        }
-    }
-    if ( nearestidx < 0 )
-        return -1;
-
-    if ( outpt != nullptr )
-        *outpt = ptlist.at(nearestidx);
-    return nearestidx;
+int finPlotDotsScatter::findNearestPoint(const QPointF &chkpt, const finPlotDotsSpatialIndex &ptindex)
+{
+    return ptindex.findNearestPoint(chkpt, this->getSearchRange(chkpt), this->_distLimit * 2.0);
 }
 
 int finPlotDotsScatter::findNearestPointWithRad(const QPointF &chkpt, const QPointF &prevpt,
                                                 const QList<QPointF> &ptlist, int exceptcnt, QPointF *outpt)
 {
-    QRectF srchrange;
-    srchrange.setX(chkpt.x() - this->_distLimit);
-    srchrange.setY(chkpt.y() - this->_distLimit);
-    srchrange.setSize(QSizeF(2 * this->_distLimit, 2 * this->_distLimit));
-
+    QRectF srchrange = this->getSearchRange(chkpt);
     double mindist = this->_distLimit * 2.0;
     int checkcnt = ptlist.count() - exceptcnt;
     double chkrad = finFigureAlg::getVectorRadian(chkpt - prevpt);
@@ -373,7 +433,7 @@ int finPlotDotsScatter::findNearestPointWithRad(const QPointF &chkpt, const QPoi
 }
 
 void finPlotDotsScatter::handleEnclosePoint(
-        const QList<QPointF> &curptlist, const QList<QPointF> &pstptlist, finPlotDotsLine *lnplot)
+        const QList<QPointF> &curptlist, const finPlotDotsSpatialIndex &pstindex, finPlotDotsLine *lnplot)
 {
     if ( curptlist.empty() )
         return;
@@ -382,15 +442,15 @@ void finPlotDotsScatter::handleEnclosePoint(
     const QPointF &firstpt = curptlist.first();
     int lastnidx = -1, firstnidx = -1;
 
-    if ( !pstptlist.empty() ) {
-        lastnidx = this->findNearestPoint(lastpt, pstptlist);
+    if ( pstindex.getPointCount() > 0 ) {
+        lastnidx = this->findNearestPoint(lastpt, pstindex);
         if ( lastnidx >= 0 )
-            lnplot->appendPoint(pstptlist.at(lastnidx));
+            lnplot->appendPoint(pstindex.getPointAt(lastnidx));
 
         if ( curptlist.count() > 1 ) {
-            firstnidx = this->findNearestPoint(firstpt, pstptlist);
+            firstnidx = this->findNearestPoint(firstpt, pstindex);
             if ( firstnidx >= 0 )
-                lnplot->prependPoint(pstptlist.at(firstnidx));
+                lnplot->prependPoint(pstindex.getPointAt(firstnidx));
         } else {
             firstnidx = lastnidx;
         }
@@ -420,35 +480,44 @@ finErrorCode finPlotDotsScatter::plot()
     if ( this->_figcontainer == nullptr )
         return finErrorKits::EC_STATE_ERROR;
 
-    QList<QPointF> pendpt = this->_ptList;
+    // Pending points are indexed by their position in the point list, and stitched points by the order
+    // they were stitched in, so every lookup picks the same point as a scan over the plain lists would.
+    finPlotDotsSpatialIndex pendindex(this->_distLimit), postindex(this->_distLimit);
+    foreach ( const QPointF &pt, this->_ptList ) {
+        pendindex.appendPoint(pt);
+    }
+
     QList<QPointF> curptlist;
-    QList<QPointF> postpt;
     finPlotDotsLine lnplot;
     lnplot.setFigureContainer(this->_figcontainer);
 
-    while ( !pendpt.empty() ) {
-        QPointF curpt = pendpt.takeFirst();
-        if ( this->isNaNOrInfPoint(curpt) )
+    for ( int firstid = 0; firstid < this->_ptList.count(); firstid++ ) {
+        if ( !pendindex.isPointAlive(firstid) )
             continue;
 
+        QPointF curpt = this->_ptList.at(firstid);
+        pendindex.removePoint(firstid);
         lnplot.appendPoint(curpt);
         curptlist.append(curpt);
 
         while ( true ) {
-            int nearestidx = this->findNearestPoint(curpt, pendpt);
-            if ( nearestidx < 0 )
+            int nearestid = this->findNearestPoint(curpt, pendindex);
+            if ( nearestid < 0 )
                 break;
 
-            curpt = pendpt.takeAt(nearestidx);
+            curpt = pendindex.getPointAt(nearestid);
+            pendindex.removePoint(nearestid);
             lnplot.appendPoint(curpt);
             curptlist.append(curpt);
         }
 
-        this->handleEnclosePoint(curptlist, postpt, &lnplot);
+        this->handleEnclosePoint(curptlist, postindex, &lnplot);
         lnplot.plot();
 
         lnplot.clearPoints();
-        postpt.append(curptlist);
+        foreach ( const QPointF &pt, curptlist ) {
+            postindex.appendPoint(pt);
+        }
         curptlist.clear();
     }
     return finErrorKits::EC_SUCCESS;
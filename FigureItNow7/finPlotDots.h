@@ -9,8 +9,11 @@
 #ifndef FINPLOTDOTS_H
 #define FINPLOTDOTS_H
 
+#include <QHash>
 #include <QList>
+#include <QPair>
 #include <QPointF>
+#include <QRectF>
 
 #include "finFigureObject.h"
 #include "finFigureContainer.h"
@@ -77,6 +80,33 @@ private:
     bool isNanPoint(const QPointF &pt);
 };
 
+/*
+ * Uniform grid over points for nearest-neighbour lookups with deletion. Points are identified by the order
+ * they were appended in; NaN or infinite points get an identifier but are never found.
+ */
+class finPlotDotsSpatialIndex
+{
+protected:
+    double _cellSize;
+    QList<QPointF> _ptList;
+    QList<bool> _aliveList;
+    QHash<QPair<qint64, qint64>, QList<int> > _cellMap;
+
+public:
+    finPlotDotsSpatialIndex(double cellsize);
+
+    int getPointCount() const;
+    const QPointF &getPointAt(int id) const;
+    bool isPointAlive(int id) const;
+
+    int appendPoint(const QPointF &pt);
+    void removePoint(int id);
+    int findNearestPoint(const QPointF &chkpt, const QRectF &srchrange, double maxdist) const;
+
+private:
+    qint64 getCellIndex(double pos) const;
+};
+
 class finPlotDotsScatter : public finPlotDots
 {
 protected:
@@ -94,11 +124,11 @@ public:
 private:
     bool isNaNOrInfPoint(const QPointF &pt) const;
 
-    int findNearestPoint(const QPointF &chkpt, const QList<QPointF> &ptlist,
-                         int exceptcnt = 0, QPointF *outpt = nullptr);
+    QRectF getSearchRange(const QPointF &chkpt) const;
+    int findNearestPoint(const QPointF &chkpt, const finPlotDotsSpatialIndex &ptindex);
     int findNearestPointWithRad(const QPointF &chkpt, const QPointF &prevpt, const QList<QPointF> &ptlist,
                                 int exceptcnt = 0, QPointF *outpt = nullptr);
-    void handleEnclosePoint(const QList<QPointF> &curptlist, const QList<QPointF> &pstptlist,
+    void handleEnclosePoint(const QList<QPointF> &curptlist, const finPlotDotsSpatialIndex &pstindex,
                             finPlotDotsLine *lnplot);
 };
 
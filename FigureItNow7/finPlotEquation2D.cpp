@@ -11,6 +11,15 @@
 #include <qmath.h>
 
 #include "finExecFunction.h"
+#include "finPlotParallel.h"
+
+/* The adaptive solver starts from square tiles of this many grid cells, and probes every tile on a lattice
+ * of five by five nodes. Tiles that the probe cannot exclude are split until they are no larger than the
+ * leaf size, and leaf tiles are solved on the full grid.
+ */
+static const int _glRootTileCells = 64;
+static const int _glLeafTileCells = 8;
+static const int _glTileProbeSteps = 4;
 
 
 finPlotEquation2D::finPlotEquation2D()
@@ -27,6 +36,7 @@ finPlotEquation2D::finPlotEquation2D()
     this->_environment = nullptr;
     this->_machine = nullptr;
     this->_flowctl = nullptr;
+    this->_solveMode = finPlotEquation2D::SM_FULL_GRID;
     this->_scrtPlot.setFigureContainer(nullptr);
     this->_scrtPlot.clearPoints();
 }
@@ -159,6 +169,16 @@ void finPlotEquation2D::setFigureContainer(finFigureContainer *figcontainer)
     this->_scrtPlot.setFigureContainer(figcontainer);
 }
 
+finPlotEquation2D::SolveMode finPlotEquation2D::getSolveMode() const
+{
+    return this->_solveMode;
+}
+
+void finPlotEquation2D::setSolveMode(SolveMode mode)
+{
+    this->_solveMode = mode;
+}
+
 bool finPlotEquation2D::checkValid() const
 {
     if ( this->_funcname.isEmpty() || this->_fromX >= this->_toX || this->_fromY >= this->_toY)
@@ -227,6 +247,58 @@ finErrorCode finPlotEquation2D::buildFuncArgList(QList<finExecVariable *> *varli
 }
 
 
+finErrorCode finPlotEquation2D::buildWorkerContext(finPlotEquation2DContext *ctx)
+{
+    finErrorCode errcode = this->_environment->buildChildEnvironment(&ctx->_environment);
+    if ( finErrorKits::isErrorResult(errcode) )
+        return errcode;
+
+    ctx->_flowctl = new finExecFlowControl();
+    ctx->_lastX = 0.0;
+    ctx->_lastY = 0.0;
+
+    // Private copies of the extended arguments keep the parameter links of every call inside the worker.
+    ctx->_argList.clear();
+    foreach ( finExecVariable *argvar, *this->_callArgList ) {
+        finExecVariable *cpyvar = new finExecVariable();
+        cpyvar->copyVariableValue(finExecVariable::transLinkTarget(argvar));
+        cpyvar->setLeftValue();
+        ctx->_argList.append(cpyvar);
+    }
+
+    ctx->_xVar = new finExecVariable();
+    ctx->_xVar->setType(finExecVariable::TP_NUMERIC);
+    ctx->_xVar->setLeftValue();
+    ctx->_xVar->clearWriteProtected();
+    ctx->_yVar = new finExecVariable();
+    ctx->_yVar->setType(finExecVariable::TP_NUMERIC);
+    ctx->_yVar->setLeftValue();
+    ctx->_yVar->clearWriteProtected();
+
+    if ( this->_xidx < this->_yidx ) {
+        ctx->_argList.insert(this->_xidx, ctx->_xVar);
+        ctx->_argList.insert(this->_yidx, ctx->_yVar);
+    } else {
+        ctx->_argList.insert(this->_yidx, ctx->_yVar);
+        ctx->_argList.insert(this->_xidx, ctx->_xVar);
+    }
+    return finErrorKits::EC_SUCCESS;
+}
+
+void finPlotEquation2D::releaseWorkerContext(finPlotEquation2DContext *ctx)
+{
+    delete ctx->_flowctl;
+    delete ctx->_environment;
+    foreach ( finExecVariable *argvar, ctx->_argList ) {
+        delete argvar;
+    }
+    ctx->_argList.clear();
+    ctx->_flowctl = nullptr;
+    ctx->_environment = nullptr;
+    ctx->_xVar = nullptr;
+    ctx->_yVar = nullptr;
+}
+
 finErrorCode finPlotEquation2D::buildSearchPositions(double from, double to, double step, QList<double> *poslist)
 {
     if ( poslist == nullptr )
@@ -260,29 +332,33 @@ finErrorCode finPlotEquation2D::disposeSearchRangeList()
 {
     this->_posListX.clear();
     this->_posListY.clear();
+    this->_gridValList.clear();
+    this->_gridNeedList.clear();
+    this->_gridEvalList.clear();
     return finErrorKits::EC_SUCCESS;
 }
 
-finErrorCode finPlotEquation2D::calcAPoint(
-        double x, double y, finExecFunction *func, QList<finExecVariable *> *varlist,
-        finExecVariable *xvar, finExecVariable *yvar, double *retval, bool *goon)
+finErrorCode finPlotEquation2D::calcAPoint(double x, double y, finExecFunction *func,
+                                           finPlotEquation2DContext *ctx, double *retval, bool *goon)
 {
-    if ( varlist == nullptr || xvar == nullptr || xvar == nullptr || retval == nullptr || goon == nullptr )
+    if ( ctx == nullptr || ctx->_xVar == nullptr || ctx->_yVar == nullptr || retval == nullptr || goon == nullptr )
         return finErrorKits::EC_NULL_POINTER;
 
     finErrorCode errcode;
-    xvar->setNumericValue(x);
-    yvar->setNumericValue(y);
+    ctx->_lastX = x;
+    ctx->_lastY = y;
+    ctx->_xVar->setNumericValue(x);
+    ctx->_yVar->setNumericValue(y);
 
-    errcode = func->execFunction(varlist, this->_environment, this->_machine, this->_flowctl);
+    errcode = func->execFunction(&ctx->_argList, ctx->_environment, this->_machine, ctx->_flowctl);
     if ( finErrorKits::isErrorResult(errcode) )
         return errcode;
 
-    errcode = this->_flowctl->checkFlowForExpress(goon, nullptr, this->_machine);
+    errcode = ctx->_flowctl->checkFlowForExpress(goon, nullptr, this->_machine);
     if ( finErrorKits::isErrorResult(errcode) || !(*goon) )
         return errcode;
 
-    finExecVariable *retvar = this->_flowctl->pickReturnVariable();
+    finExecVariable *retvar = ctx->_flowctl->pickReturnVariable();
     if ( retvar == nullptr || retvar->getType() != finExecVariable::TP_NUMERIC ) {
         finExecVariable::releaseNonLeftVariable(retvar);
         return finErrorKits::EC_INVALID_PARAM;
@@ -293,31 +369,52 @@ finErrorCode finPlotEquation2D::calcAPoint(
     return finErrorKits::EC_SUCCESS;
 }
 
+finErrorCode finPlotEquation2D::calcAGridPoint(int xidx, int yidx, finExecFunction *func,
+                                               finPlotEquation2DContext *ctx, QHash<qint64, double> *cache,
+                                               double *retval, bool *goon)
+{
+    qint64 key = (qint64)xidx * this->_posListY.count() + yidx;
+    *goon = true;
+    if ( cache->contains(key) ) {
+        *retval = cache->value(key);
+        return finErrorKits::EC_SUCCESS;
+    }
+
+    finErrorCode errcode = this->calcAPoint(this->_posListX.at(xidx), this->_posListY.at(yidx), func, ctx,
+                                            retval, goon);
+    if ( finErrorKits::isErrorResult(errcode) || !(*goon) )
+        return errcode;
+
+    cache->insert(key, *retval);
+    return finErrorKits::EC_SUCCESS;
+}
+
 enum finPlotEquation2DSearchResFlag {
     FIN_PE_SRF_SELF   = 0x01,
     FIN_PE_SRF_SRCH_X = 0x02,
     FIN_PE_SRF_SRCH_Y = 0x04,
 };
 
-finErrorCode finPlotEquation2D::checkOnePosition(int xidx, int yidx, double curretval, QList<double> *prevretval,
-                                                 unsigned long *srchflags)
+finErrorCode finPlotEquation2D::checkOnePosition(int xidx, int yidx, double curretval, unsigned long *srchflags) const
 {
-    if ( xidx < 0 || yidx < 0 || (xidx > 0 && yidx >= prevretval->count()) )
+    if ( xidx < 0 || yidx < 0 )
         return finErrorKits::EC_INVALID_PARAM;
-    if ( prevretval == nullptr || srchflags == nullptr )
+    if ( srchflags == nullptr )
         return finErrorKits::EC_NULL_POINTER;
 
+    // Neighbours skipped by the adaptive solver have no value and take part in no search.
+    int ycnt = this->_posListY.count();
     *srchflags = 0x00;
     if ( curretval > -1.0e-8 && curretval < 1.0e-8 ) {
         *srchflags |= FIN_PE_SRF_SELF;
     } else {
-        if ( yidx > 0 ) {
-            double preyval = prevretval->at(yidx - 1);
+        if ( yidx > 0 && this->_gridNeedList.at(xidx * ycnt + yidx - 1) ) {
+            double preyval = this->_gridValList.at(xidx * ycnt + yidx - 1);
             if ( !(preyval > -1.0e-8 && preyval < 1.0e-8) && (preyval * curretval < 0.0) )
                 *srchflags |= FIN_PE_SRF_SRCH_Y;
         }
-        if ( xidx > 0 ) {
-            double prexval = prevretval->at(yidx);
+        if ( xidx > 0 && this->_gridNeedList.at((xidx - 1) * ycnt + yidx) ) {
+            double prexval = this->_gridValList.at((xidx - 1) * ycnt + yidx);
             if ( !(prexval > -1.0e-8 && prexval < 1.0e-8) && (prexval * curretval < 0.0) )
                 *srchflags |= FIN_PE_SRF_SRCH_X;
         }
@@ -325,25 +422,246 @@ finErrorCode finPlotEquation2D::checkOnePosition(int xidx, int yidx, double curr
     return finErrorKits::EC_SUCCESS;
 }
 
-finErrorCode finPlotEquation2D::updateRetValList(int xidx, int yidx, double curretval, QList<double> *prevretval)
+finErrorCode finPlotEquation2D::checkTileExcluded(const finPlotEquation2DTile &tile, finExecFunction *func,
+                                                  finPlotEquation2DContext *ctx, QHash<qint64, double> *cache,
+                                                  bool *excluded, bool *goon)
 {
-    if ( xidx == 0 ) {
-        while ( prevretval->count() < yidx )
-            prevretval->append(0.0);
-        prevretval->insert(yidx, curretval);
-    } else {
-        prevretval->replace(yidx, curretval);
+    QList<int> xprobe, yprobe;
+    for ( int i = 0; i <= _glTileProbeSteps; i++ ) {
+        int xidx = tile._fromXIdx + (tile._toXIdx - tile._fromXIdx) * i / _glTileProbeSteps;
+        int yidx = tile._fromYIdx + (tile._toYIdx - tile._fromYIdx) * i / _glTileProbeSteps;
+        if ( xprobe.isEmpty() || xprobe.last() != xidx )
+            xprobe.append(xidx);
+        if ( yprobe.isEmpty() || yprobe.last() != yidx )
+            yprobe.append(yidx);
+    }
+
+    int xcnt = xprobe.count(), ycnt = yprobe.count();
+    QList<double> probeval(xcnt * ycnt);
+    for ( int i = 0; i < xcnt; i++ ) {
+        for ( int j = 0; j < ycnt; j++ ) {
+            finErrorCode errcode = this->calcAGridPoint(xprobe.at(i), yprobe.at(j), func, ctx, cache,
+                                                        &probeval[i * ycnt + j], goon);
+            if ( finErrorKits::isErrorResult(errcode) || !(*goon) )
+                return errcode;
+        }
+    }
+
+    // The tile is skipped only when all probes have one sign and the smallest of them is still far above
+    // what the steepest probed slope can change over the distance to the nearest probe. This is a heuristic,
+    // not a bound: the slope is only sampled, so a narrow spike or a thin closed curve between the probes
+    // can still cross zero inside an excluded tile.
+    *excluded = false;
+    double minabs = -1.0, maxslope = 0.0, maxgapx = 0.0, maxgapy = 0.0;
+    for ( int i = 0; i < xcnt; i++ ) {
+        for ( int j = 0; j < ycnt; j++ ) {
+            double val = probeval.at(i * ycnt + j);
+            if ( qIsNaN(val) || qIsInf(val) || (val > -1.0e-8 && val < 1.0e-8) || val * probeval.at(0) < 0.0 )
+                return finErrorKits::EC_SUCCESS;
+            if ( minabs < 0.0 || fabs(val) < minabs )
+                minabs = fabs(val);
+
+            if ( i > 0 ) {
+                double gap = this->_posListX.at(xprobe.at(i)) - this->_posListX.at(xprobe.at(i - 1));
+                double slope = fabs(val - probeval.at((i - 1) * ycnt + j)) / gap;
+                if ( gap > maxgapx )
+                    maxgapx = gap;
+                if ( slope > maxslope )
+                    maxslope = slope;
+            }
+            if ( j > 0 ) {
+                double gap = this->_posListY.at(yprobe.at(j)) - this->_posListY.at(yprobe.at(j - 1));
+                double slope = fabs(val - probeval.at(i * ycnt + j - 1)) / gap;
+                if ( gap > maxgapy )
+                    maxgapy = gap;
+                if ( slope > maxslope )
+                    maxslope = slope;
+            }
+        }
+    }
+
+    double reach = sqrt(maxgapx * maxgapx + maxgapy * maxgapy) / 2.0;
+    *excluded = (minabs > 2.0 * maxslope * reach);
+    return finErrorKits::EC_SUCCESS;
+}
+
+finErrorCode finPlotEquation2D::searchActiveTiles(const finPlotEquation2DTile &tile, finExecFunction *func,
+                                                  finPlotEquation2DContext *ctx, QHash<qint64, double> *cache,
+                                                  QList<finPlotEquation2DTile> *activelist, bool *goon)
+{
+    int xcells = tile._toXIdx - tile._fromXIdx, ycells = tile._toYIdx - tile._fromYIdx;
+    *goon = true;
+    if ( xcells <= _glLeafTileCells && ycells <= _glLeafTileCells ) {
+        activelist->append(tile);
+        return finErrorKits::EC_SUCCESS;
+    }
+
+    bool excluded = false;
+    finErrorCode errcode = this->checkTileExcluded(tile, func, ctx, cache, &excluded, goon);
+    if ( finErrorKits::isErrorResult(errcode) || !(*goon) || excluded )
+        return errcode;
+
+    // Quadtree split; the halves share their middle row or column of nodes.
+    int xmid = (xcells > _glLeafTileCells ? tile._fromXIdx + xcells / 2 : tile._toXIdx);
+    int ymid = (ycells > _glLeafTileCells ? tile._fromYIdx + ycells / 2 : tile._toYIdx);
+    finPlotEquation2DTile subtile;
+    for ( int i = 0; i < 2; i++ ) {
+        subtile._fromXIdx = (i == 0 ? tile._fromXIdx : xmid);
+        subtile._toXIdx = (i == 0 ? xmid : tile._toXIdx);
+        if ( subtile._fromXIdx >= subtile._toXIdx )
+            continue;
+
+        for ( int j = 0; j < 2; j++ ) {
+            subtile._fromYIdx = (j == 0 ? tile._fromYIdx : ymid);
+            subtile._toYIdx = (j == 0 ? ymid : tile._toYIdx);
+            if ( subtile._fromYIdx >= subtile._toYIdx )
+                continue;
+
+            errcode = this->searchActiveTiles(subtile, func, ctx, cache, activelist, goon);
+            if ( finErrorKits::isErrorResult(errcode) || !(*goon) )
+                return errcode;
+        }
+    }
+    return finErrorKits::EC_SUCCESS;
+}
+
+finErrorCode finPlotEquation2D::markNeededNodes(finExecFunction *func, finPlotEquation2DContext *mainctx,
+                                                QList<finPlotEquation2DContext> *workerctx, bool *goon)
+{
+    int xposcnt = this->_posListX.count(), yposcnt = this->_posListY.count();
+    *goon = true;
+    if ( this->_solveMode != finPlotEquation2D::SM_ADAPTIVE ) {
+        this->_gridNeedList.fill(true, xposcnt * yposcnt);
+        return finErrorKits::EC_SUCCESS;
+    }
+    this->_gridNeedList.fill(false, xposcnt * yposcnt);
+
+    QList<finPlotEquation2DTile> roottiles;
+    for ( int x0 = 0; x0 < xposcnt - 1; x0 += _glRootTileCells ) {
+        for ( int y0 = 0; y0 < yposcnt - 1; y0 += _glRootTileCells ) {
+            finPlotEquation2DTile tile;
+            tile._fromXIdx = x0;
+            tile._toXIdx = (x0 + _glRootTileCells < xposcnt - 1 ? x0 + _glRootTileCells : xposcnt - 1);
+            tile._fromYIdx = y0;
+            tile._toYIdx = (y0 + _glRootTileCells < yposcnt - 1 ? y0 + _glRootTileCells : yposcnt - 1);
+            roottiles.append(tile);
+        }
+    }
+
+    // Each root tile keeps its probes apart, since neighbouring tiles probe their shared edge nodes.
+    QList<QList<finPlotEquation2DTile>> activelists(roottiles.count());
+    QList<finPlotEquation2DTile> *activedata = activelists.data();
+    QList<QHash<qint64, double>> caches(roottiles.count());
+    QHash<qint64, double> *cachedata = caches.data();
+    finErrorCode errcode = this->runChunks(roottiles.count(),
+                                           [&](finPlotEquation2DContext *ctx, int from, int to, bool *chkgoon) {
+        for ( int i = from; i < to; i++ ) {
+            finErrorCode tileerr = this->searchActiveTiles(roottiles.at(i), func, ctx, &cachedata[i],
+                                                           &activedata[i], chkgoon);
+            if ( finErrorKits::isErrorResult(tileerr) || !(*chkgoon) )
+                return tileerr;
+        }
+        return finErrorKits::EC_SUCCESS;
+    }, func, mainctx, workerctx, goon);
+    if ( finErrorKits::isErrorResult(errcode) || !(*goon) )
+        return errcode;
+
+    // The probed values go into the grid, so that evalGridColumns() does not compute them a second time.
+    foreach ( const QHash<qint64, double> &cache, caches ) {
+        for ( auto it = cache.constBegin(); it != cache.constEnd(); ++it ) {
+            this->_gridValList[it.key()] = it.value();
+            this->_gridEvalList[it.key()] = true;
+        }
+    }
+
+    foreach ( const QList<finPlotEquation2DTile> &activelist, activelists ) {
+        foreach ( const finPlotEquation2DTile &tile, activelist ) {
+            for ( int xidx = tile._fromXIdx; xidx <= tile._toXIdx; xidx++ ) {
+                for ( int yidx = tile._fromYIdx; yidx <= tile._toYIdx; yidx++ )
+                    this->_gridNeedList[xidx * yposcnt + yidx] = true;
+            }
+        }
+    }
+    return finErrorKits::EC_SUCCESS;
+}
+
+finErrorCode finPlotEquation2D::evalGridColumns(finExecFunction *func, finPlotEquation2DContext *ctx,
+                                                int from, int to, bool *goon)
+{
+    int yposcnt = this->_posListY.count();
+    const bool *needdata = this->_gridNeedList.constData();
+    const bool *evaldata = this->_gridEvalList.constData();
+    double *valdata = this->_gridValList.data();
+
+    for ( int xidx = from; xidx < to; xidx++ ) {
+        const double &xval = this->_posListX.at(xidx);
+        for ( int yidx = 0; yidx < yposcnt; yidx++ ) {
+            if ( !needdata[xidx * yposcnt + yidx] || evaldata[xidx * yposcnt + yidx] )
+                continue;
+
+            finErrorCode errcode = this->calcAPoint(xval, this->_posListY.at(yidx), func, ctx,
+                                                    &valdata[xidx * yposcnt + yidx], goon);
+            if ( finErrorKits::isErrorResult(errcode) || !(*goon) )
+                return errcode;
+        }
+    }
+    return finErrorKits::EC_SUCCESS;
+}
+
+finErrorCode finPlotEquation2D::solveGridColumns(finExecFunction *func, finPlotEquation2DContext *ctx,
+                                                 int from, int to, QList<QPointF> *colpts, bool *goon)
+{
+    int yposcnt = this->_posListY.count();
+    unsigned long srchflags = 0x00;
+    finErrorCode errcode;
+
+    for ( int xidx = from; xidx < to; xidx++ ) {
+        const double &xval = this->_posListX.at(xidx);
+        QList<QPointF> &pts = colpts[xidx];
+        pts.clear();
+
+        for ( int yidx = 0; yidx < yposcnt; yidx++ ) {
+            if ( !this->_gridNeedList.at(xidx * yposcnt + yidx) )
+                continue;
+
+            const double &yval = this->_posListY.at(yidx);
+            double curretval = this->_gridValList.at(xidx * yposcnt + yidx);
+            errcode = this->checkOnePosition(xidx, yidx, curretval, &srchflags);
+            if ( finErrorKits::isErrorResult(errcode) )
+                return errcode;
+
+            double realx = xval, realy = yval;
+            if ( srchflags & FIN_PE_SRF_SELF ) {
+                pts.append(QPointF(xval, yval));
+            }
+            if ( xidx > 0 && (srchflags & FIN_PE_SRF_SRCH_X) ) {
+                errcode = this->searchBinary(this->_posListX.at(xidx - 1), yval,
+                                             this->_gridValList.at((xidx - 1) * yposcnt + yidx),
+                                             xval, yval, curretval, func, ctx, &realx, &realy, goon);
+                if ( finErrorKits::isErrorResult(errcode) || !(*goon) )
+                    return errcode;
+
+                pts.append(QPointF(realx, realy));
+            }
+            if ( yidx > 0 && (srchflags & FIN_PE_SRF_SRCH_Y) ) {
+                errcode = this->searchBinary(xval, this->_posListY.at(yidx - 1),
+                                             this->_gridValList.at(xidx * yposcnt + yidx - 1),
+                                             xval, yval, curretval, func, ctx, &realx, &realy, goon);
+                if ( finErrorKits::isErrorResult(errcode) || !(*goon) )
+                    return errcode;
+
+                pts.append(QPointF(realx, realy));
+            }
+        }
     }
     return finErrorKits::EC_SUCCESS;
 }
 
 finErrorCode finPlotEquation2D::searchBinary(
         double x1, double y1, double retval1, double x2, double y2, double retval2,
-        finExecFunction *func, QList<finExecVariable *> *varlist, finExecVariable *xvar, finExecVariable *yvar,
-        double *xret, double *yret, bool *goon, int level)
+        finExecFunction *func, finPlotEquation2DContext *ctx, double *xret, double *yret, bool *goon, int level)
 {
-    if ( func == nullptr || varlist == nullptr || xvar == nullptr || yvar == nullptr ||
-         xret == nullptr || yret == nullptr || goon == nullptr)
+    if ( func == nullptr || ctx == nullptr || xret == nullptr || yret == nullptr || goon == nullptr)
         return finErrorKits::EC_NULL_POINTER;
 
     *goon = true;
@@ -368,15 +686,15 @@ finErrorCode finPlotEquation2D::searchBinary(
 
     double xmid = (x1 + x2) / 2.0, ymid = (y1 + y2) / 2.0;
     double retvalmid = 0.0;
-    finErrorCode errcode = this->calcAPoint(xmid, ymid, func, varlist, xvar, yvar, &retvalmid, goon);
+    finErrorCode errcode = this->calcAPoint(xmid, ymid, func, ctx, &retvalmid, goon);
     if ( finErrorKits::isErrorResult(errcode) || !(*goon) )
         return errcode;
 
     if ( retvalmid * retval1 < 0 ) {
-        return this->searchBinary(x1, y1, retval1, xmid, ymid, retvalmid, func, varlist, xvar, yvar,
+        return this->searchBinary(x1, y1, retval1, xmid, ymid, retvalmid, func, ctx,
                                   xret, yret, goon, level + 1);
     } else if ( retvalmid * retval2 < 0 ) {
-        return this->searchBinary(xmid, ymid, retvalmid, x2, y2, retval2, func, varlist, xvar, yvar,
+        return this->searchBinary(xmid, ymid, retvalmid, x2, y2, retval2, func, ctx,
                                   xret, yret, goon, level + 1);
     }
     *xret = xmid;
@@ -384,6 +702,46 @@ finErrorCode finPlotEquation2D::searchBinary(
     return finErrorKits::EC_SUCCESS;
 }
 
+finErrorCode finPlotEquation2D::runChunks(int itemcnt, const finPlotEquation2DChunkTask &task,
+                                          finExecFunction *func, finPlotEquation2DContext *mainctx,
+                                          QList<finPlotEquation2DContext> *workerctx, bool *goon)
+{
+    *goon = true;
+    if ( workerctx->isEmpty() )
+        return task(mainctx, 0, itemcnt, goon);
+
+    int wkcnt = workerctx->count();
+    finPlotEquation2DContext *wkctxdata = workerctx->data();
+    QList<int> failchunk(wkcnt, -1);
+    QList<QPointF> failpt(wkcnt);
+    int *failchunkdata = failchunk.data();
+    QPointF *failptdata = failpt.data();
+
+    int failidx = finPlotParallel::runChunks(itemcnt, wkcnt, 1, [&](int wkidx, int chunkidx, int from, int to) {
+        finPlotEquation2DContext *ctx = &wkctxdata[wkidx];
+        bool chkgoon = true;
+        finErrorCode errcode = task(ctx, from, to, &chkgoon);
+        if ( !finErrorKits::isErrorResult(errcode) && chkgoon )
+            return true;
+
+        failchunkdata[wkidx] = chunkidx;
+        failptdata[wkidx] = QPointF(ctx->_lastX, ctx->_lastY);
+        return false;
+    });
+    if ( failidx < 0 )
+        return finErrorKits::EC_SUCCESS;
+
+    // Replay the earliest failed evaluation in the caller context to leave its error and flow state behind.
+    double retval = 0.0;
+    const QPointF &pt = failpt.at(failchunk.indexOf(failidx));
+    finErrorCode errcode = this->calcAPoint(pt.x(), pt.y(), func, mainctx, &retval, goon);
+    if ( finErrorKits::isErrorResult(errcode) || !(*goon) )
+        return errcode;
+
+    *goon = false;
+    return finErrorKits::EC_STATE_ERROR;
+}
+
 finErrorCode finPlotEquation2D::plot()
 {
     if ( !this->checkValid() )
@@ -401,61 +759,67 @@ finErrorCode finPlotEquation2D::plot()
     if ( finErrorKits::isErrorResult(errcode) )
         return errcode;
 
-    QList<finExecVariable *> funcarglist;
-    finExecVariable *xvar, *yvar;
-    errcode = this->buildFuncArgList(&funcarglist, &xvar, &yvar);
+    finPlotEquation2DContext mainctx;
+    mainctx._environment = this->_environment;
+    mainctx._flowctl = this->_flowctl;
+    mainctx._lastX = 0.0;
+    mainctx._lastY = 0.0;
+    errcode = this->buildFuncArgList(&mainctx._argList, &mainctx._xVar, &mainctx._yVar);
     if ( finErrorKits::isErrorResult(errcode) )
         return errcode;
 
-    int xposcnt = this->_posListX.count(), yposcnt = this->_posListY.count();
-    QList<double> retvallist;
-    double curretval;
-    bool goon = true;
-    unsigned long srchflags = 0x00;
-
-    this->_scrtPlot.clearPoints();
-    for ( int xidx = 0; xidx < xposcnt; xidx++ ) {
-        const double &xval = this->_posListX.at(xidx);
-
-        for ( int yidx = 0; yidx < yposcnt; yidx++ ) {
-            const double &yval = this->_posListY.at(yidx);
-
-            errcode = this->calcAPoint(xval, yval, func, &funcarglist, xvar, yvar, &curretval, &goon);
-            if ( finErrorKits::isErrorResult(errcode) || !goon )
-                return errcode;
-
-            errcode = this->checkOnePosition(xidx, yidx, curretval, &retvallist, &srchflags);
-            if ( finErrorKits::isErrorResult(errcode) )
-                return errcode;
-
-            double realx = xval, realy = yval;
-            if ( srchflags & FIN_PE_SRF_SELF ) {
-                this->_scrtPlot.appendPoint(xval, yval);
-            }
-            if ( xidx > 0 && (srchflags & FIN_PE_SRF_SRCH_X) ) {
-                errcode = this->searchBinary(this->_posListX.at(xidx - 1), yval, retvallist.at(yidx),
-                                             xval, yval, curretval, func, &funcarglist, xvar, yvar,
-                                             &realx, &realy, &goon);
-                if ( finErrorKits::isErrorResult(errcode) || !goon )
-                    return errcode;
-
-                this->_scrtPlot.appendPoint(realx, realy);
-            }
-            if ( yidx > 0 && (srchflags & FIN_PE_SRF_SRCH_Y) ) {
-                errcode = this->searchBinary(xval, this->_posListY.at(yidx - 1), retvallist.at(yidx - 1),
-                                             xval, yval, curretval, func, &funcarglist, xvar, yvar,
-                                             &realx, &realy, &goon);
-                if ( finErrorKits::isErrorResult(errcode) || !goon )
-                    return errcode;
+    QList<finPlotEquation2DContext> workerctx;
+    int wkcnt = this->_machine->getPlotWorkerCount();
+    if ( !finPlotParallel::isWorkerSafe(func, this->_environment) )
+        wkcnt = 1;
+    for ( int i = 0; wkcnt > 1 && i < wkcnt; i++ ) {
+        finPlotEquation2DContext ctx;
+        errcode = this->buildWorkerContext(&ctx);
+        if ( finErrorKits::isErrorResult(errcode) )
+            goto out;
+        workerctx.append(ctx);
+    }
 
-                this->_scrtPlot.appendPoint(realx, realy);
+    {
+        // The grid is split into column bands for the workers. Every band writes only its own grid values
+        // and points, and the points are merged column by column, so the scatter receives them in the same
+        // order as a serial scan would produce.
+        int xposcnt = this->_posListX.count(), yposcnt = this->_posListY.count();
+        bool goon = true;
+
+        this->_gridValList.fill(0.0, xposcnt * yposcnt);
+        this->_gridEvalList.fill(false, xposcnt * yposcnt);
+        errcode = this->markNeededNodes(func, &mainctx, &workerctx, &goon);
+        if ( finErrorKits::isErrorResult(errcode) || !goon )
+            goto out;
+
+        errcode = this->runChunks(xposcnt, [&](finPlotEquation2DContext *ctx, int from, int to, bool *chkgoon) {
+            return this->evalGridColumns(func, ctx, from, to, chkgoon);
+        }, func, &mainctx, &workerctx, &goon);
+        if ( finErrorKits::isErrorResult(errcode) || !goon )
+            goto out;
+
+        QList<QList<QPointF>> colpts(xposcnt);
+        QList<QPointF> *colptsdata = colpts.data();
+        errcode = this->runChunks(xposcnt, [&](finPlotEquation2DContext *ctx, int from, int to, bool *chkgoon) {
+            return this->solveGridColumns(func, ctx, from, to, colptsdata, chkgoon);
+        }, func, &mainctx, &workerctx, &goon);
+        if ( finErrorKits::isErrorResult(errcode) || !goon )
+            goto out;
+
+        this->_scrtPlot.clearPoints();
+        foreach ( const QList<QPointF> &pts, colpts ) {
+            foreach ( const QPointF &pt, pts ) {
+                this->_scrtPlot.appendPoint(pt.x(), pt.y());
             }
-
-            errcode = this->updateRetValList(xidx, yidx, curretval, &retvallist);
-            if ( finErrorKits::isErrorResult(errcode) )
-                return errcode;
         }
     }
 
-    return this->_scrtPlot.plot();
+    errcode = this->_scrtPlot.plot();
+
+out:
+    for ( int i = 0; i < workerctx.count(); i++ )
+        this->releaseWorkerContext(&workerctx[i]);
+    this->disposeSearchRangeList();
+    return errcode;
 }
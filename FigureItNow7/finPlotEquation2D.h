@@ -11,6 +11,10 @@
 
 #include <QString>
 #include <QList>
+#include <QHash>
+#include <QPointF>
+
+#include <functional>
 
 #include "finExecVariable.h"
 #include "finExecEnvironment.h"
@@ -19,12 +23,49 @@
 #include "finPlotDots.h"
 
 
+/*
+ * Interpreter state owned by one solving thread: environment, flow control, argument list and the two
+ * independent variables.
+ */
+struct finPlotEquation2DContext {
+    finExecEnvironment *_environment;
+    finExecFlowControl *_flowctl;
+    QList<finExecVariable *> _argList;
+    finExecVariable *_xVar, *_yVar;
+    double _lastX, _lastY;
+};
+
+/*
+ * A rectangle of search grid nodes, bounds included on both ends.
+ */
+struct finPlotEquation2DTile {
+    int _fromXIdx, _toXIdx;
+    int _fromYIdx, _toYIdx;
+};
+
+typedef std::function<finErrorCode (finPlotEquation2DContext *ctx, int from, int to, bool *goon)>
+        finPlotEquation2DChunkTask;
+
 class finPlotEquation2D
 {
+public:
+    /*
+     * SM_FULL_GRID evaluates every grid node and finds every sign change the grid can see. SM_ADAPTIVE skips
+     * tiles that look sign-definite from a few probes; that is a heuristic, and it can drop a branch thinner
+     * than the probe spacing, so it is only used when a script asks for it.
+     */
+    enum SolveMode {
+        SM_FULL_GRID,
+        SM_ADAPTIVE,
+    };
+
 protected:
     QString _funcname;
     double _fromX, _toX, _fromY, _toY;
     QList<double> _posListX, _posListY;
+    QList<double> _gridValList;
+    QList<bool> _gridNeedList;
+    QList<bool> _gridEvalList;
     int _xidx, _yidx;
 
     QList<finExecVariable *> *_callArgList;
@@ -33,6 +74,7 @@ protected:
 
     finExecFlowControl *_flowctl;
     finPlotDotsScatter _scrtPlot;
+    SolveMode _solveMode;
 
 public:
     finPlotEquation2D();
@@ -63,6 +105,9 @@ public:
     void setFlowControl(finExecFlowControl *flowctl);
     void setFigureContainer(finFigureContainer *figcontainer);
 
+    SolveMode getSolveMode() const;
+    void setSolveMode(SolveMode mode);
+
     bool checkValid() const;
     finErrorCode plot();
 
@@ -71,20 +116,38 @@ private:
     finErrorCode buildFuncArgList(QList<finExecVariable *> *varlist,
                                   finExecVariable **xvar, finExecVariable **yvar);
 
+    finErrorCode buildWorkerContext(finPlotEquation2DContext *ctx);
+    void releaseWorkerContext(finPlotEquation2DContext *ctx);
+
     finErrorCode buildSearchPositions(double from, double to, double step, QList<double> *poslist);
     finErrorCode buildSearchRangeList(double step);
     finErrorCode disposeSearchRangeList();
 
-    finErrorCode calcAPoint(double x, double y, finExecFunction *func, QList<finExecVariable *> *varlist,
-                            finExecVariable *xvar, finExecVariable *yvar, double *retval, bool *goon);
-    finErrorCode checkOnePosition(int xidx, int yidx, double curretval, QList<double> *prevretval,
-                                   unsigned long *srchflags);
-    finErrorCode updateRetValList(int xidx, int yidx, double curretval, QList<double> *prevretval);
+    finErrorCode calcAPoint(double x, double y, finExecFunction *func, finPlotEquation2DContext *ctx,
+                            double *retval, bool *goon);
+    finErrorCode calcAGridPoint(int xidx, int yidx, finExecFunction *func, finPlotEquation2DContext *ctx,
+                                QHash<qint64, double> *cache, double *retval, bool *goon);
+    finErrorCode checkOnePosition(int xidx, int yidx, double curretval, unsigned long *srchflags) const;
+
+    finErrorCode checkTileExcluded(const finPlotEquation2DTile &tile, finExecFunction *func,
+                                   finPlotEquation2DContext *ctx, QHash<qint64, double> *cache, bool *excluded,
+                                   bool *goon);
+    finErrorCode searchActiveTiles(const finPlotEquation2DTile &tile, finExecFunction *func,
+                                   finPlotEquation2DContext *ctx, QHash<qint64, double> *cache,
+                                   QList<finPlotEquation2DTile> *activelist, bool *goon);
+    finErrorCode markNeededNodes(finExecFunction *func, finPlotEquation2DContext *mainctx,
+                                 QList<finPlotEquation2DContext> *workerctx, bool *goon);
+    finErrorCode evalGridColumns(finExecFunction *func, finPlotEquation2DContext *ctx, int from, int to,
+                                 bool *goon);
+    finErrorCode solveGridColumns(finExecFunction *func, finPlotEquation2DContext *ctx, int from, int to,
+                                  QList<QPointF> *colpts, bool *goon);
 
     finErrorCode searchBinary(double x1, double y1, double retval1, double x2, double y2, double retval2,
-                              finExecFunction *func, QList<finExecVariable *> *varlist,
-                              finExecVariable *xvar, finExecVariable *yvar,
+                              finExecFunction *func, finPlotEquation2DContext *ctx,
                               double *xret, double *yret, bool *goon, int level = 0);
+    finErrorCode runChunks(int itemcnt, const finPlotEquation2DChunkTask &task, finExecFunction *func,
+                           finPlotEquation2DContext *mainctx, QList<finPlotEquation2DContext> *workerctx,
+                           bool *goon);
 };
 
 #endif // FINPLOTEQUATION2D_H
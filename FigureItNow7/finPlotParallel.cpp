@@ -0,0 +1,113 @@
+/*-
+ * GNU GENERAL PUBLIC LICENSE, version 3
+ * See LICENSE file for detail.
+ *
+ * Author: Yulong Yu
+ * Copyright(c) 2015-2026 Yulong Yu. All rights reserved.
+ */
+
+#include "finPlotParallel.h"
+
+#include <QAtomicInt>
+#include <QThread>
+#include <QThreadPool>
+
+#include "finExecEnvironment.h"
+#include "finExecFunction.h"
+#include "finExecVariable.h"
+#include "finSyntaxNode.h"
+
+
+int finPlotParallel::normalizeWorkerCount(int cnt)
+{
+    // Zero or negative picks one worker per logical core.
+    if ( cnt <= 0 )
+        cnt = QThread::idealThreadCount();
+    return (cnt < 1 ? 1 : cnt);
+}
+
+int finPlotParallel::runChunks(int itemcnt, int wkcnt, int minchunksize, const finPlotParallelTask &task)
+{
+    if ( itemcnt <= 0 || wkcnt < 1 )
+        return -1;
+
+    // Several chunks per worker balance the uneven cost of the items.
+    int chunksize = itemcnt / (wkcnt * 8);
+    if ( chunksize < minchunksize )
+        chunksize = minchunksize;
+    if ( chunksize < 1 )
+        chunksize = 1;
+    int chunkcnt = (itemcnt + chunksize - 1) / chunksize;
+
+    QAtomicInt nextchunk(0), firstfail(chunkcnt);
+    QThreadPool pool;
+    pool.setMaxThreadCount(wkcnt);
+    for ( int w = 0; w < wkcnt; w++ ) {
+        pool.start([&, w]() {
+            int chunkidx;
+            while ( (chunkidx = nextchunk.fetchAndAddRelaxed(1)) < chunkcnt ) {
+                // Chunks behind a failed one would be discarded anyway.
+                if ( chunkidx > firstfail.loadRelaxed() )
+                    break;
+
+                int from = chunkidx * chunksize;
+                int to = (from + chunksize < itemcnt ? from + chunksize : itemcnt);
+                if ( task(w, chunkidx, from, to) )
+                    continue;
+
+                int curfail = firstfail.loadRelaxed();
+                while ( chunkidx < curfail && !firstfail.testAndSetRelaxed(curfail, chunkidx) )
+                    curfail = firstfail.loadRelaxed();
+                break;
+            }
+        });
+    }
+    pool.waitForDone();
+
+    int failidx = firstfail.loadRelaxed();
+    return (failidx < chunkcnt ? failidx : -1);
+}
+
+bool finPlotParallel::isWorkerSafe(finExecFunction *func, finExecEnvironment *env)
+{
+    if ( func == nullptr || env == nullptr )
+        return false;
+
+    // System functions only see their arguments, which every worker holds private copies of.
+    if ( func->getFunctionType() != finExecFunction::TP_USER )
+        return true;
+
+    QList<finExecFunction *> visited;
+    visited.append(func);
+    return finPlotParallel::isWorkerSafeNode(func->getFunctionSyntaxNode(), env, &visited);
+}
+
+bool finPlotParallel::isWorkerSafeNode(finSyntaxNode *synnode, finExecEnvironment *env,
+                                       QList<finExecFunction *> *visited)
+{
+    if ( synnode == nullptr )
+        return true;
+
+    // A local that shadows an outer array is refused as well; that only costs the parallel speed-up.
+    finLexNode *lexnode = synnode->getCommandLexNode();
+    if ( synnode->getType() == finSyntaxNode::TP_EXPRESS && lexnode != nullptr &&
+         lexnode->getType() == finLexNode::TP_VARIABLE ) {
+        finExecVariable *var = finExecVariable::transLinkTarget(env->findVariable(lexnode->getSymbolId()));
+        if ( var != nullptr && var->getType() == finExecVariable::TP_ARRAY )
+            return false;
+
+        finExecFunction *callee = env->findFunction(lexnode->getSymbolId());
+        if ( callee != nullptr && callee->getFunctionType() == finExecFunction::TP_USER &&
+             !visited->contains(callee) ) {
+            visited->append(callee);
+            if ( !finPlotParallel::isWorkerSafeNode(callee->getFunctionSyntaxNode(), env, visited) )
+                return false;
+        }
+    }
+
+    for ( int i = 0; i < synnode->getSubListCount(); i++ ) {
+        if ( !finPlotParallel::isWorkerSafeNode(synnode->getSubSyntaxNode(i), env, visited) )
+            return false;
+    }
+    return true;
+}
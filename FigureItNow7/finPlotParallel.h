@@ -0,0 +1,46 @@
+/*-
+ * GNU GENERAL PUBLIC LICENSE, version 3
+ * See LICENSE file for detail.
+ *
+ * Author: Yulong Yu
+ * Copyright(c) 2015-2026 Yulong Yu. All rights reserved.
+ */
+
+#ifndef FINPLOTPARALLEL_H
+#define FINPLOTPARALLEL_H
+
+#include <QList>
+
+#include <functional>
+
+class finExecEnvironment;
+class finExecFunction;
+class finSyntaxNode;
+
+/*
+ * The task run on items [from, to) of one chunk by the worker of index wkidx. It returns false when the chunk
+ * failed, and then must not touch any later chunk of the same worker.
+ */
+typedef std::function<bool (int wkidx, int chunkidx, int from, int to)> finPlotParallelTask;
+
+/*
+ * Chunked work distribution shared by the plotters that sample on several threads. Each worker owns its own
+ * interpreter context, so the plotted function must not write or link variables outside its own scope.
+ * runChunks() returns the index of the earliest failed chunk, or -1 when every chunk succeeded.
+ *
+ * Reading an array can still write to it, e.g. when a system function unpacks a packed argument, so
+ * isWorkerSafe() only admits functions that, together with the user functions they call, name no array
+ * variable of the calling scope. Any other function is plotted on the calling thread.
+ */
+class finPlotParallel
+{
+public:
+    static int normalizeWorkerCount(int cnt);
+    static int runChunks(int itemcnt, int wkcnt, int minchunksize, const finPlotParallelTask &task);
+    static bool isWorkerSafe(finExecFunction *func, finExecEnvironment *env);
+
+private:
+    static bool isWorkerSafeNode(finSyntaxNode *synnode, finExecEnvironment *env, QList<finExecFunction *> *visited);
+};
+
+#endif // FINPLOTPARALLEL_H
@@ -0,0 +1,108 @@
+/*-
+ * GNU GENERAL PUBLIC LICENSE, version 3
+ * See LICENSE file for detail.
+ *
+ * Author: Yulong Yu
+ * Copyright(c) 2015-2026 Yulong Yu. All rights reserved.
+ */
+
+/*! \file finSymbolTable.cpp
+ *  \brief Implementations of the process-wide identifier interner.
+ */
+
+#include "finSymbolTable.h"
+
+#include <QHash>
+#include <QReadLocker>
+#include <QWriteLocker>
+
+
+QList<QString> finSymbolTable::_nameList = QList<QString>();
+QMultiHash<size_t, int> finSymbolTable::_hashIdxMap = QMultiHash<size_t, int>();
+QReadWriteLock finSymbolTable::_lock;
+QAtomicInt finSymbolTable::_symbolLimit(1 << 20);
+
+finSymbolTable::finSymbolTable()
+{
+    /* Do Nothing because you should not call this constructor. */
+}
+
+int finSymbolTable::findSymbolIdLocked(QStringView name, size_t namehash)
+{
+    // Hashing the view keeps lookups free of temporary strings.
+    for ( auto it = _hashIdxMap.constFind(namehash); it != _hashIdxMap.cend() && it.key() == namehash; ++it ) {
+        if ( _nameList.at(it.value() - 1) == name )
+            return it.value();
+    }
+    return SYM_NONE;
+}
+
+int finSymbolTable::getSymbolId(QStringView name)
+{
+    return internSymbolId(name, 0);
+}
+
+int finSymbolTable::tryGetSymbolId(QStringView name)
+{
+    return internSymbolId(name, _symbolLimit.loadRelaxed());
+}
+
+int finSymbolTable::internSymbolId(QStringView name, int limit)
+{
+    if ( name.isEmpty() )
+        return SYM_NONE;
+
+    size_t namehash = qHash(name);
+    {
+        QReadLocker locker(&_lock);
+        int symid = findSymbolIdLocked(name, namehash);
+        if ( symid != SYM_NONE )
+            return symid;
+    }
+
+    QWriteLocker locker(&_lock);
+    // Another thread may have interned the same spelling between the two locks.
+    int symid = findSymbolIdLocked(name, namehash);
+    if ( symid != SYM_NONE || (limit > 0 && _nameList.count() >= limit) )
+        return symid;
+
+    _nameList.append(name.toString());
+    symid = _nameList.count();
+    _hashIdxMap.insert(namehash, symid);
+    return symid;
+}
+
+int finSymbolTable::findSymbolId(QStringView name)
+{
+    if ( name.isEmpty() )
+        return SYM_NONE;
+
+    size_t namehash = qHash(name);
+    QReadLocker locker(&_lock);
+    return findSymbolIdLocked(name, namehash);
+}
+
+QString finSymbolTable::getSymbolName(int symid)
+{
+    QReadLocker locker(&_lock);
+    if ( symid <= SYM_NONE || symid > _nameList.count() )
+        return QString();
+
+    return _nameList.at(symid - 1);
+}
+
+int finSymbolTable::getSymbolCount()
+{
+    QReadLocker locker(&_lock);
+    return _nameList.count();
+}
+
+int finSymbolTable::getSymbolLimit()
+{
+    return _symbolLimit.loadRelaxed();
+}
+
+void finSymbolTable::setSymbolLimit(int limit)
+{
+    _symbolLimit.storeRelaxed(limit);
+}
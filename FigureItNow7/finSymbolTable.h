@@ -0,0 +1,106 @@
+/*-
+ * GNU GENERAL PUBLIC LICENSE, version 3
+ * See LICENSE file for detail.
+ *
+ * Author: Yulong Yu
+ * Copyright(c) 2015-2026 Yulong Yu. All rights reserved.
+ */
+
+/*! \file finSymbolTable.h
+ *  \brief Declarations of the process-wide identifier interner.
+ *
+ *  This header defines finSymbolTable, which maps every identifier spelling to a small integer symbol ID.
+ *  The lexer interns identifiers as it reads them, and environments, functions and variables key their
+ *  names by the same IDs, so a name lookup at run time compares integers instead of strings.
+ */
+
+#ifndef FINSYMBOLTABLE_H
+#define FINSYMBOLTABLE_H
+
+#include <QAtomicInt>
+#include <QList>
+#include <QMultiHash>
+#include <QReadWriteLock>
+#include <QString>
+#include <QStringView>
+
+
+/*! \class finSymbolTable
+ *  \brief Process-wide, append-only table of interned identifier spellings.
+ *
+ *  finSymbolTable is used as a namespace. IDs are dense and start at 1; SYM_NONE (0) stands for the empty
+ *  name and for spellings that were never interned. An ID stays valid, and keeps naming the same
+ *  spelling, for the lifetime of the process, so IDs may be cached anywhere, e.g. in syntax trees,
+ *  bytecode or variables. The table never shrinks, so only names drawn from a script's vocabulary, such
+ *  as identifiers, keywords and operators, should be interned. All methods are thread-safe.
+ *
+ *  Scripts reach the table through the lexer, which interns with tryGetSymbolId(). Once the table holds
+ *  getSymbolLimit() spellings, a script bringing a new one fails to compile, so a long-running process
+ *  such as the render server cannot be grown without bound by the scripts it is fed.
+ *
+ *  \see finLexNode::getSymbolId()
+ *  \see finExecEnvironment
+ */
+class finSymbolTable
+{
+public:
+    /*! \brief The symbol ID of the empty name. */
+    static const int SYM_NONE = 0;
+
+private:
+    static QList<QString> _nameList;              //!< Interned spellings; the spelling of ID i is at i - 1.
+    static QMultiHash<size_t, int> _hashIdxMap;   //!< Hash of each spelling to the IDs carrying that hash.
+    static QReadWriteLock _lock;                  //!< Guards the two containers above.
+    static QAtomicInt _symbolLimit;               //!< Most spellings tryGetSymbolId() lets the table hold.
+
+    finSymbolTable();
+
+public:
+    /*!
+     *  \brief Returns the symbol ID of \a name, interning the spelling on first use.
+     *
+     *  \return The ID of \a name, or SYM_NONE if \a name is empty.
+     */
+    static int getSymbolId(QStringView name);
+
+    /*!
+     *  \brief Returns the symbol ID of \a name like getSymbolId(), unless that needs a new entry in a table
+     *         that already holds getSymbolLimit() spellings.
+     *
+     *  \return The ID of \a name, or SYM_NONE if \a name is empty or the table is full.
+     */
+    static int tryGetSymbolId(QStringView name);
+
+    /*!
+     *  \brief Returns the symbol ID of \a name without interning it.
+     *
+     *  \return The ID of \a name, or SYM_NONE if \a name is empty or was never interned. A name that was
+     *          never interned cannot be stored anywhere under an ID, so lookups may treat SYM_NONE as a
+     *          miss.
+     */
+    static int findSymbolId(QStringView name);
+
+    /*!
+     *  \brief Returns the interned spelling of \a symid, or an empty string for SYM_NONE and unknown IDs.
+     *
+     *  The returned string shares its buffer with the table.
+     */
+    static QString getSymbolName(int symid);
+
+    /*! \brief Returns the number of interned spellings. */
+    static int getSymbolCount();
+
+    /*! \brief Returns how many spellings tryGetSymbolId() lets the table hold; 1048576 by default. */
+    static int getSymbolLimit();
+
+    /*! \brief Sets how many spellings tryGetSymbolId() lets the table hold; zero or negative lifts the limit. */
+    static void setSymbolLimit(int limit);
+
+private:
+    static int internSymbolId(QStringView name, int limit);
+
+    // Expects _lock to be held by the caller, for reading at least.
+    static int findSymbolIdLocked(QStringView name, size_t namehash);
+};
+
+#endif // FINSYMBOLTABLE_H
@@ -125,17 +125,16 @@ QString finSyntaxError::makeErrorInfoString() const
 
 const finSyntaxError &finSyntaxError::dummySyntaxError()
 {
-    static finSyntaxError retval;
-    static bool retval_isset = false;
-
-    if ( !retval_isset ) {
-        retval._level = LV_DUMMY;
-        retval._stage = ST_DUMMY;
-        retval._row = 0;
-        retval._column = 0;
-        retval._errString = QObject::tr("Invalid syntax error entry.");
-        retval_isset = true;
-    }
+    // Built by the first caller under the thread-safe static initialization, as machines may run concurrently.
+    static const finSyntaxError retval = []() {
+        finSyntaxError synerr;
+        synerr._level = LV_DUMMY;
+        synerr._stage = ST_DUMMY;
+        synerr._row = 0;
+        synerr._column = 0;
+        synerr._errString = QObject::tr("Invalid syntax error entry.");
+        return synerr;
+    }();
 
     return retval;
 }
@@ -9,9 +9,9 @@
 /*! \file finSyntaxNode.cpp
  *  \brief Implementations of the finSyntaxNode value class.
  *
- *  Provides the constructors and destructor, the recursive copyNode helper, the type-discriminated
- *  getters and setters, the child-list append / prepend / pick operations, the disposal helpers
- *  that own the child sub-trees, the static isExpressLevelType / isStatementLevelType
+ *  Provides the constructors and destructor, the arena operator new / delete, the recursive
+ *  copyNode helper, the type-discriminated getters and setters, the child-list append / prepend /
+ *  pick operations, the disposal helpers that own the child sub-trees, the static isExpressLevelType / isStatementLevelType
  *  classifiers, the pretty-print dump / dumpLeveled pair, and the dumpObjInfo() formatter used
  *  when a finSyntaxNode is attached to a logged finException.
  */
@@ -21,7 +21,7 @@
 #include <QtGlobal>
 
 finSyntaxNode::finSyntaxNode()
-    : _type(TP_DUMMY), _cmdLexNode(), _subSyntaxList()
+    : _type(TP_DUMMY), _jumpLabelIdx(-1), _shareCount(0), _cmdLexNode(), _subSyntaxList(), _jumpTarget(nullptr)
 { /* Do nothing */ }
 
 finSyntaxNode::~finSyntaxNode()
@@ -29,6 +29,16 @@ finSyntaxNode::~finSyntaxNode()
     this->disposeAll();
 }
 
+void *finSyntaxNode::operator new(size_t size)
+{
+    return finExecObjectArena::allocate(size);
+}
+
+void finSyntaxNode::operator delete(void *ptr)
+{
+    finExecObjectArena::release(ptr);
+}
+
 void finSyntaxNode::copyNode(const finSyntaxNode *srcnode)
 {
     this->disposeAll();
@@ -38,6 +48,7 @@ void finSyntaxNode::copyNode(const finSyntaxNode *srcnode)
 
     this->_type = srcnode->getType();
     this->_cmdLexNode.copyNode(srcnode->getCommandLexNode());
+    this->_subSyntaxList.reserve(srcnode->getSubListCount());
 
     for ( int i = 0; i < srcnode->getSubListCount(); i++ ) {
         finSyntaxNode *synnode = new finSyntaxNode();
@@ -51,6 +62,28 @@ void finSyntaxNode::copyNode(const finSyntaxNode *srcnode)
     }
 }
 
+finSyntaxNode *finSyntaxNode::shareNode()
+{
+    this->_shareCount++;
+    return this;
+}
+
+bool finSyntaxNode::isShared() const
+{
+    return (this->_shareCount > 0);
+}
+
+void finSyntaxNode::releaseNode(finSyntaxNode *synnode)
+{
+    if ( synnode == nullptr )
+        return;
+
+    if ( synnode->_shareCount > 0 )
+        synnode->_shareCount--;
+    else
+        delete synnode;
+}
+
 finSyntaxNodeType finSyntaxNode::getType() const
 {
     return this->_type;
@@ -93,6 +126,22 @@ void finSyntaxNode::setCommandLexNode(const finLexNode *lexnode)
     this->_cmdLexNode.copyNode(lexnode);
 }
 
+finSyntaxNode *finSyntaxNode::getJumpTarget() const
+{
+    return this->_jumpTarget;
+}
+
+int finSyntaxNode::getJumpLabelIdx() const
+{
+    return this->_jumpLabelIdx;
+}
+
+void finSyntaxNode::setJumpTarget(finSyntaxNode *target, int labelidx)
+{
+    this->_jumpTarget = target;
+    this->_jumpLabelIdx = (target != nullptr ? labelidx : -1);
+}
+
 void finSyntaxNode::appendSubSyntaxNode(finSyntaxNode *synnode)
 {
     Q_ASSERT(synnode != nullptr);
@@ -117,6 +166,19 @@ finSyntaxNode *finSyntaxNode::pickSubSyntaxNode(int idx)
     return retnode;
 }
 
+finSyntaxNode *finSyntaxNode::replaceSubSyntaxNode(int idx, finSyntaxNode *synnode)
+{
+    Q_ASSERT(synnode != nullptr);
+    if ( idx < 0 || idx >= this->_subSyntaxList.count() ) {
+        finThrowObj(finErrorKits::EC_INVALID_PARAM,
+                    QString("Idx-%1 out of range (%2).").arg(idx).arg(this->_subSyntaxList.count()));
+    }
+
+    finSyntaxNode *retnode = this->_subSyntaxList.at(idx);
+    this->_subSyntaxList[idx] = synnode;
+    return retnode;
+}
+
 bool finSyntaxNode::isExpressLevelType(finSyntaxNodeType type)
 {
     switch ( type ) {
@@ -139,17 +201,18 @@ void finSyntaxNode::disposeSubSyntaxNodes()
     if ( this->_subSyntaxList.count() == 0 )
         return;
 
-    while ( this->_subSyntaxList.count() > 0 ) {
-        finSyntaxNode *subtk = this->_subSyntaxList.at(0);
-        this->_subSyntaxList.removeFirst();
-        delete subtk;
-    }
+    // Detach the list first, so the children never see a half-emptied parent.
+    QList<finSyntaxNode *> sublist;
+    sublist.swap(this->_subSyntaxList);
+    foreach ( finSyntaxNode *synnode, sublist )
+        finSyntaxNode::releaseNode(synnode);
 }
 
 void finSyntaxNode::disposeAll()
 {
     this->disposeCommandLexNode();
     this->disposeSubSyntaxNodes();
+    this->setJumpTarget(nullptr, -1);
 }
 
 bool finSyntaxNode::isStatementLevelType(finSyntaxNodeType type)
@@ -220,3 +283,11 @@ int finSyntaxNode::findLabelIdx(const QString &labelname)
     }
     return -1;
 }
+
+bool finSyntaxNode::isOperatorExpress(finLexOperatorType optype, int subcnt) const
+{
+    const finLexNode *lexnode = this->getCommandLexNode();
+    return (this->_type == finSyntaxNode::TP_EXPRESS && lexnode != nullptr &&
+            lexnode->getType() == finLexNode::TP_OPERATOR && lexnode->getOperator() == optype &&
+            this->getSubListCount() == subcnt);
+}
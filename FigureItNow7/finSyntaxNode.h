@@ -18,7 +18,10 @@
 
 #include <QList>
 
+#include <stddef.h>
+
 #include "finErrorCode.h"
+#include "finExecPool.h"
 #include "finLexNode.h"
 
 /*! \class finSyntaxNode : public finExceptionObject
@@ -36,6 +39,15 @@
  *  executor, and AST peephole pass treat each Type value. Children are owned by the parent
  *  and are freed when the parent is destroyed or when one of the dispose*() methods is called.
  *
+ *  Nodes are allocated through the class-specific operator new / delete from the finExecObjectArena
+ *  that is current on the calling thread: a syntax tree makes its own arena current while it builds
+ *  nodes, and the compiler does the same while parsing. The nodes of one tree thus lie close together,
+ *  and its chunks go back to the heap with the tree. Without a current arena, nodes come from the heap.
+ *
+ *  A node can have more than one owner: the compiler hands its top-level statements to every tree it
+ *  builds through shareNode() instead of copying them. Owners give a node up with releaseNode(), which
+ *  deletes it only when the last owner lets go; a shared node must not be modified.
+ *
  *  \see finSyntaxReader
  *  \see finExecMachine
  *  \see finExceptionObject
@@ -74,8 +86,11 @@ public:
 
 protected:
     Type _type;                          //!< The node's top-level type.
+    int _jumpLabelIdx;                   //!< Index of the target label in _jumpTarget; -1 if unresolved.
+    int _shareCount;                     //!< Owners besides the first one; 0 for a node owned once.
     finLexNode _cmdLexNode;              //!< The head lex node (the "command" this node is built around).
     QList<finSyntaxNode *> _subSyntaxList;   //!< Owned children; freed by disposeSubSyntaxNodes() or disposeAll().
+    finSyntaxNode *_jumpTarget;          //!< For a resolved goto, the statement list holding its label.
 
 public:
     /*!
@@ -88,12 +103,20 @@ public:
      */
     virtual ~finSyntaxNode();
 
+    /*! \name Arena Allocation
+     *  \brief Route node allocation through the current finExecObjectArena.
+     */
+    ///@{
+    static void *operator new(size_t size);
+    static void operator delete(void *ptr);
+    ///@}
+
     /*!
      *  \brief Deep-copies the source node's type, head lex node, and entire sub-tree.
      *
      *  Existing children of this node are disposed first. The copy is recursive: each child is
      *  allocated via `new finSyntaxNode()` and is then itself copyNode()'d from the matching
-     *  source child.
+     *  source child. Resolved jump targets point into the source tree, so they are not copied.
      *
      *  \param srcnode  The source node to copy from.
      *  \throws finException with EC_NULL_POINTER if \a srcnode is \c nullptr.
@@ -101,6 +124,23 @@ public:
      */
     void copyNode(const finSyntaxNode *srcnode);
 
+    /*!
+     *  \brief Adds an owner to this node and returns it, for a second parent to append without copying.
+     */
+    finSyntaxNode *shareNode();
+
+    /*!
+     *  \brief Returns \c true if the node has more than one owner.
+     */
+    bool isShared() const;
+
+    /*!
+     *  \brief Gives up one ownership of \a synnode, deleting it when no other owner is left.
+     *
+     *  All owners of a node must live on the same thread. \a synnode may be \c nullptr.
+     */
+    static void releaseNode(finSyntaxNode *synnode);
+
     /*!
      *  \brief Returns the node's top-level type.
      */
@@ -128,6 +168,19 @@ public:
      */
     finSyntaxNode *getSubSyntaxNode(int idx) const;
 
+    /*!
+     *  \brief Returns the statement list that holds the target label of this goto node.
+     *
+     *  The target is set by finSyntaxTree::resolveJumpTargets(), and is \c nullptr for every other
+     *  node and for a goto whose label could not be resolved.
+     */
+    finSyntaxNode *getJumpTarget() const;
+
+    /*!
+     *  \brief Returns the index of the target label among the children of getJumpTarget(), or -1.
+     */
+    int getJumpLabelIdx() const;
+
     /*!
      *  \brief Prints the node and its sub-tree to stdout in a human-readable indented form.
      *
@@ -153,6 +206,13 @@ public:
      */
     void setCommandLexNode(const finLexNode *lexnode);
 
+    /*!
+     *  \brief Records that this goto jumps to the child \a labelidx of \a target.
+     *
+     *  \a target is not owned; it must be an ancestor of this node in the same tree.
+     */
+    void setJumpTarget(finSyntaxNode *target, int labelidx);
+
     /*!
      *  \brief Appends \a synnode to the end of the child list.
      *
@@ -179,18 +239,26 @@ public:
      */
     finSyntaxNode *pickSubSyntaxNode(int idx);
 
+    /*!
+     *  \brief Puts \a synnode in place of the child at \a idx and returns the old child, un-owned.
+     *
+     *  \throws finException with EC_INVALID_PARAM if \a idx is out of range.
+     */
+    finSyntaxNode *replaceSubSyntaxNode(int idx, finSyntaxNode *synnode);
+
     /*!
      *  \brief Resets the head lex node to an empty TP_DUMMY state.
      */
     void disposeCommandLexNode();
 
     /*!
-     *  \brief Deletes every child node and clears the child list.
+     *  \brief Releases every child node and clears the child list.
      */
     void disposeSubSyntaxNodes();
 
     /*!
-     *  \brief Calls disposeCommandLexNode() followed by disposeSubSyntaxNodes().
+     *  \brief Calls disposeCommandLexNode() followed by disposeSubSyntaxNodes(), and drops the jump
+     *         target.
      */
     void disposeAll();
 
@@ -218,6 +286,11 @@ public:
      */
     int findLabelIdx(const QString &labelname);
 
+    /*!
+     *  \brief Returns \c true if this is an expression applying operator \a optype to exactly \a subcnt operands.
+     */
+    bool isOperatorExpress(finLexOperatorType optype, int subcnt) const;
+
 private:
     /*!
      *  \brief Recursive helper for dump() that prints this node and its children indented
@@ -9,42 +9,52 @@
 #include "finSyntaxOptimzer.h"
 
 #include <QMap>
+#include <QSet>
 #include <QString>
 
+#include "finExecOperartorCalc.h"
+#include "finExecVariable.h"
+
 
 typedef void (*finSynOptFunc)(finSyntaxNode *synnode);
 
 static void _testOptFunc(finSyntaxNode *synnode);
+static void _constFoldOptFunc(finSyntaxNode *synnode);
+static void _deadBranchOptFunc(finSyntaxNode *synnode);
+static void _strengthOptFunc(finSyntaxNode *synnode);
 
 static struct {
     QString _optName;
     finSynOptFunc _func;
 } _optFuncList[] = {
-    { QString("test"), _testOptFunc },
+    { QString("test"),       _testOptFunc       },
+    { QString("constfold"),  _constFoldOptFunc  },
+    { QString("deadbranch"), _deadBranchOptFunc },
+    { QString("strength"),   _strengthOptFunc   },
 
-    { QString(),       nullptr      },
+    { QString(),             nullptr            },
 };
 
-static QMap<QString, finSynOptFunc> _optFuncMap = QMap<QString, finSynOptFunc>();
-static bool _isOptFuncMapInstalled = false;
-
-static void _installOptFuncMap()
+static const QMap<QString, finSynOptFunc> &_getOptFuncMap()
 {
-    if ( _isOptFuncMapInstalled )
-        return;
-
-    for ( int i = 0; _optFuncList[i]._func != nullptr; i++ ) {
-        _optFuncMap.insert(_optFuncList[i]._optName, _optFuncList[i]._func);
-    }
-    _isOptFuncMapInstalled = true;
+    // Machines compile on worker threads as well, so the map is built under the static-local guard.
+    static const QMap<QString, finSynOptFunc> optfuncmap = []() {
+        QMap<QString, finSynOptFunc> retmap;
+        for ( int i = 0; _optFuncList[i]._func != nullptr; i++ ) {
+            retmap.insert(_optFuncList[i]._optName, _optFuncList[i]._func);
+        }
+        return retmap;
+    }();
+    return optfuncmap;
 }
 
 static QList<finSynOptFunc> _getOptFuncFromOptions(const QStringList &options)
 {
+    const QMap<QString, finSynOptFunc> &optfuncmap = _getOptFuncMap();
     QList<finSynOptFunc> retlist;
 
     foreach ( QString optname, options ) {
-        finSynOptFunc optfunc = _optFuncMap.value(optname, nullptr);
+        finSynOptFunc optfunc = optfuncmap.value(optname, nullptr);
         if ( optfunc == nullptr )
             continue;
 
@@ -57,9 +67,12 @@ finSyntaxOptimzer::finSyntaxOptimzer()
     : _optOptions()
 {
     this->_synTree = nullptr;
+}
 
-    // Install the optimzer function list on the first instance constructed.
-    _installOptFuncMap();
+QStringList finSyntaxOptimzer::getDefaultOption()
+{
+    // Folding goes first so that the later passes see the constant conditions and exponents it produces.
+    return QStringList() << QString("constfold") << QString("deadbranch") << QString("strength");
 }
 
 finSyntaxTree *finSyntaxOptimzer::getSyntaxTree() const
@@ -91,6 +104,8 @@ void finSyntaxOptimzer::optimize()
     if ( this->_optOptions.isEmpty() )
         return;
 
+    // Nodes the passes build belong to the tree they are rewriting.
+    finExecObjectArena::Scope arenascope(this->_synTree->getNodeArena());
     finSyntaxNode *rootnode = this->_synTree->getRootNode();
     QList<finSynOptFunc> optfunclist = _getOptFuncFromOptions(this->_optOptions);
 
@@ -107,3 +122,238 @@ static void _testOptFunc(finSyntaxNode *synnode)
     if ( synnode == nullptr )
         return;
 }
+
+static bool _isOperatorNode(finSyntaxNode *synnode, finLexOperatorType optype)
+{
+    if ( synnode == nullptr || synnode->getType() != finSyntaxNode::TP_EXPRESS )
+        return false;
+
+    finLexNode *lexnode = synnode->getCommandLexNode();
+    return (lexnode->getType() == finLexNode::TP_OPERATOR && lexnode->getOperator() == optype);
+}
+
+static finSyntaxNode *_skipRoundBracket(finSyntaxNode *synnode)
+{
+    // A parenthesis passes its only operand through unchanged at runtime.
+    while ( _isOperatorNode(synnode, finLexNode::OP_L_RND_BRCKT) && synnode->getSubListCount() == 1 )
+        synnode = synnode->getSubSyntaxNode(0);
+    return synnode;
+}
+
+static bool _getConstValue(finSyntaxNode *synnode, double *val)
+{
+    synnode = _skipRoundBracket(synnode);
+    if ( synnode == nullptr || synnode->getType() != finSyntaxNode::TP_EXPRESS )
+        return false;
+
+    finLexNode *lexnode = synnode->getCommandLexNode();
+    if ( lexnode->getType() != finLexNode::TP_DECIMAL )
+        return false;
+
+    *val = lexnode->getFloatValue();
+    return true;
+}
+
+static void _setConstValue(finSyntaxNode *synnode, double val)
+{
+    // The head lex node keeps its row, column and span, so diagnostics still point at the folded operator.
+    finLexNode *lexnode = synnode->getCommandLexNode();
+    lexnode->setType(finLexNode::TP_DECIMAL);
+    lexnode->setString(QString::number(val, 'g', 17));
+    lexnode->setFloatValue(val);
+
+    synnode->disposeSubSyntaxNodes();
+}
+
+static bool _isConstTrue(double val)
+{
+    double notval = 0.0;
+    finExecOperartorCalc::execNumericOpCalc(finLexNode::OP_LOGIC_NOT, 1, val, 0.0, &notval);
+    return (notval == 0.0);
+}
+
+static void _collectDeclaredNames(finSyntaxNode *synnode, QSet<int> *names)
+{
+    if ( synnode == nullptr || synnode->getType() != finSyntaxNode::TP_EXPRESS )
+        return;
+
+    finLexNode *lexnode = synnode->getCommandLexNode();
+    if ( lexnode->getType() == finLexNode::TP_VARIABLE ) {
+        names->insert(lexnode->getSymbolId());
+    } else if ( _isOperatorNode(synnode, finLexNode::OP_LET) ) {
+        if ( synnode->getSubListCount() > 0 )
+            _collectDeclaredNames(synnode->getSubSyntaxNode(0), names);
+    } else if ( _isOperatorNode(synnode, finLexNode::OP_COMMA) ||
+                _isOperatorNode(synnode, finLexNode::OP_L_RND_BRCKT) ) {
+        for ( int i = 0; i < synnode->getSubListCount(); i++ )
+            _collectDeclaredNames(synnode->getSubSyntaxNode(i), names);
+    }
+}
+
+static void _collectBoundNames(finSyntaxNode *synnode, QSet<int> *names)
+{
+    if ( synnode == nullptr )
+        return;
+
+    if ( synnode->getType() == finSyntaxNode::TP_DECLARE ) {
+        for ( int i = 0; i < synnode->getSubListCount(); i++ )
+            _collectDeclaredNames(synnode->getSubSyntaxNode(i), names);
+    } else if ( synnode->getType() == finSyntaxNode::TP_FUNCTION && synnode->getSubListCount() > 1 ) {
+        _collectDeclaredNames(synnode->getSubSyntaxNode(1), names);
+    }
+
+    for ( int i = 0; i < synnode->getSubListCount(); i++ )
+        _collectBoundNames(synnode->getSubSyntaxNode(i), names);
+}
+
+static bool _getOperandValue(finSyntaxNode *synnode, const QSet<int> &boundnames, double *val)
+{
+    synnode = _skipRoundBracket(synnode);
+    if ( _getConstValue(synnode, val) )
+        return true;
+    if ( synnode == nullptr || synnode->getType() != finSyntaxNode::TP_EXPRESS )
+        return false;
+
+    // A system constant may only be inlined when no declaration or parameter anywhere could shadow it.
+    finLexNode *lexnode = synnode->getCommandLexNode();
+    if ( lexnode->getType() != finLexNode::TP_VARIABLE || boundnames.contains(lexnode->getSymbolId()) )
+        return false;
+    return finExecVariable::findSystemConstant(lexnode->getSymbolId(), val);
+}
+
+static void _constFoldNode(finSyntaxNode *synnode, const QSet<int> &boundnames)
+{
+    for ( int i = 0; i < synnode->getSubListCount(); i++ )
+        _constFoldNode(synnode->getSubSyntaxNode(i), boundnames);
+
+    if ( synnode->getType() != finSyntaxNode::TP_EXPRESS )
+        return;
+
+    finLexNode *lexnode = synnode->getCommandLexNode();
+    int oprandcnt = synnode->getSubListCount();
+    if ( lexnode->getType() != finLexNode::TP_OPERATOR || oprandcnt < 1 || oprandcnt > 2 )
+        return;
+
+    double opnum[2] = { 0.0, 0.0 };
+    for ( int i = 0; i < oprandcnt; i++ ) {
+        if ( !_getOperandValue(synnode->getSubSyntaxNode(i), boundnames, &opnum[i]) )
+            return;
+    }
+
+    // Only the operators with an exact numeric fast path are folded; everything else stays for runtime.
+    double retnum = 0.0;
+    if ( !finExecOperartorCalc::execNumericOpCalc(lexnode->getOperator(), oprandcnt, opnum[0], opnum[1], &retnum) )
+        return;
+
+    _setConstValue(synnode, retnum);
+}
+
+static void _constFoldOptFunc(finSyntaxNode *synnode)
+{
+    if ( synnode == nullptr )
+        return;
+
+    QSet<int> boundnames;
+    _collectBoundNames(synnode, &boundnames);
+    _constFoldNode(synnode, boundnames);
+}
+
+static void _deadBranchOnBranch(finSyntaxNode *synnode)
+{
+    int bridx = 0;
+    double condval = 0.0;
+
+    while ( bridx + 1 < synnode->getSubListCount() ) {
+        if ( !_getConstValue(synnode->getSubSyntaxNode(bridx), &condval) ) {
+            bridx += 2;
+            continue;
+        }
+
+        if ( !_isConstTrue(condval) ) {
+            // This arm is never taken: drop its condition and its body.
+            delete synnode->pickSubSyntaxNode(bridx);
+            delete synnode->pickSubSyntaxNode(bridx);
+            continue;
+        }
+
+        // This arm is always taken once reached: its body becomes the else arm, and the rest is unreachable.
+        delete synnode->pickSubSyntaxNode(bridx);
+        while ( synnode->getSubListCount() > bridx + 1 )
+            delete synnode->pickSubSyntaxNode(bridx + 1);
+        break;
+    }
+}
+
+static void _deadBranchOnLoop(finSyntaxNode *synnode)
+{
+    if ( synnode->getSubListCount() < 2 )
+        return;
+
+    finSyntaxNode *condnode = nullptr;
+    QString loophdstr = synnode->getCommandLexNode()->getString();
+    if ( QString::compare(loophdstr, QString("while")) == 0 ) {
+        condnode = synnode->getSubSyntaxNode(0);
+    } else if ( QString::compare(loophdstr, QString("for")) == 0 ) {
+        finSyntaxNode *headnode = synnode->getSubSyntaxNode(0);
+        if ( headnode->getSubListCount() < 3 || headnode->getSubSyntaxNode(1)->getSubListCount() < 1 )
+            return;
+        condnode = headnode->getSubSyntaxNode(1)->getSubSyntaxNode(0);
+    }
+
+    // A loop whose condition is constantly false never enters its body. The loop itself stays, since
+    // the for-loop initializer still runs and the condition still yields the loop result.
+    double condval = 0.0;
+    if ( condnode == nullptr || !_getConstValue(condnode, &condval) || _isConstTrue(condval) )
+        return;
+
+    finSyntaxNode *bodynode = synnode->getSubSyntaxNode(1);
+    if ( bodynode->getType() == finSyntaxNode::TP_STATEMENT )
+        bodynode->disposeSubSyntaxNodes();
+}
+
+static void _deadBranchOptFunc(finSyntaxNode *synnode)
+{
+    if ( synnode == nullptr )
+        return;
+
+    if ( synnode->getType() == finSyntaxNode::TP_BRANCH )
+        _deadBranchOnBranch(synnode);
+    else if ( synnode->getType() == finSyntaxNode::TP_LOOP )
+        _deadBranchOnLoop(synnode);
+
+    for ( int i = 0; i < synnode->getSubListCount(); i++ )
+        _deadBranchOptFunc(synnode->getSubSyntaxNode(i));
+}
+
+static void _strengthOptFunc(finSyntaxNode *synnode)
+{
+    if ( synnode == nullptr )
+        return;
+
+    for ( int i = 0; i < synnode->getSubListCount(); i++ )
+        _strengthOptFunc(synnode->getSubSyntaxNode(i));
+
+    double expval = 0.0;
+    if ( !_isOperatorNode(synnode, finLexNode::OP_POWER) || synnode->getSubListCount() != 2 ||
+         !_getConstValue(synnode->getSubSyntaxNode(1), &expval) || expval != 2.0 )
+        return;
+
+    // x^2 becomes x*x. The base is evaluated twice afterwards, so only plain variables are duplicated.
+    // Both operators accept numeric operands only, hence a non-numeric base fails the same way.
+    finSyntaxNode *basenode = synnode->getSubSyntaxNode(0);
+    if ( basenode->getType() != finSyntaxNode::TP_EXPRESS ||
+         basenode->getCommandLexNode()->getType() != finLexNode::TP_VARIABLE )
+        return;
+
+    finSyntaxNode *dupnode = new finSyntaxNode();
+    if ( dupnode == nullptr )
+        return;
+    dupnode->copyNode(basenode);
+
+    delete synnode->pickSubSyntaxNode(1);
+    synnode->appendSubSyntaxNode(dupnode);
+
+    finLexNode *lexnode = synnode->getCommandLexNode();
+    lexnode->setOperator(finLexNode::OP_MUL);
+    lexnode->setString(QString("*"));
+}
@@ -17,6 +17,13 @@
 #include <QStringList>
 
 
+/*! \class finSyntaxOptimzer
+ *  \brief Rewrites a compiled syntax tree in place with the passes named in the option list.
+ *
+ *  The passes are "constfold" (folds numeric literals and unshadowed system constants), "deadbranch"
+ *  (drops branch arms and loop bodies behind constant conditions), and "strength" (turns \c x^2 into
+ *  \c x*x). Every pass preserves the runtime result of the script; unknown option names are ignored.
+ */
 class finSyntaxOptimzer
 {
 protected:
@@ -31,6 +38,9 @@ public:
     QStringList getOption() const;
     void setOption(const QStringList &options);
 
+    /*! \brief Returns the full pass list, in its intended order, for callers that opt in to optimizing. */
+    static QStringList getDefaultOption();
+
     void optimize();
 };
 
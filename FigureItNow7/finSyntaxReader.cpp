@@ -23,6 +23,8 @@ finSyntaxReader::finSyntaxReader()
     : _lexReader(), _syntaxStack()
 {
     this->_state = ST_DUMMY;
+    this->_stableCnt = 0;
+    this->_baseNode = nullptr;
 }
 
 const finLexReader *finSyntaxReader::getLexReader() const
@@ -150,6 +152,71 @@ finSyntaxTree *finSyntaxReader::getSyntaxTree()
     return syntree;
 }
 
+void finSyntaxReader::startReadAt(const finLexReader::Mark &mark, bool hasbase)
+{
+    this->startRead();
+    this->_lexReader.restoreMark(mark);
+    if ( !hasbase )
+        return;
+
+    // The parser only ever asks the statements before the mark whether they are a statement at all,
+    // and whether the newest one is a branch; an empty statement gives the same answers.
+    finSyntaxNode *basenode = new finSyntaxNode();
+    if ( basenode == nullptr )
+        finThrowObj(finErrorKits::EC_OUT_OF_MEMORY, "Alloc base statement node failed.");
+    basenode->setType(finSyntaxNode::TP_STATEMENT);
+
+    this->_syntaxStack.append(basenode);
+    this->_baseNode = basenode;
+    this->_stableCnt = 1;
+}
+
+bool finSyntaxReader::isAtStatementBoundary()
+{
+    int stackcnt = this->_syntaxStack.count();
+    if ( stackcnt <= this->_stableCnt )
+        return (stackcnt == this->_stableCnt);
+
+    // An open branch can still be extended by a following elif or else.
+    if ( this->_syntaxStack.first()->getType() == finSyntaxNode::TP_BRANCH )
+        return false;
+
+    // Oldest unchecked node first, since an open bracket or keyword usually sits right there.
+    for ( int i = stackcnt - this->_stableCnt - 1; i >= 0; i-- ) {
+        finSyntaxNodeType type = this->_syntaxStack.at(i)->getType();
+        if ( type != finSyntaxNode::TP_FUNCTION && !finSyntaxNode::isStatementLevelType(type) )
+            return false;
+    }
+
+    this->_stableCnt = stackcnt;
+    return true;
+}
+
+int finSyntaxReader::getStatementCount() const
+{
+    return (this->_baseNode != nullptr ? this->_stableCnt - 1 : this->_stableCnt);
+}
+
+QList<finSyntaxError> finSyntaxReader::getErrorList() const
+{
+    return this->_errList;
+}
+
+void finSyntaxReader::takeSyntaxNodes(QList<finSyntaxNode *> *list)
+{
+    Q_ASSERT(list != nullptr);
+
+    while ( !this->_syntaxStack.empty() ) {
+        finSyntaxNode *synnode = this->_syntaxStack.takeLast();
+        if ( synnode == this->_baseNode )
+            delete synnode;
+        else
+            list->append(synnode);
+    }
+    this->_baseNode = nullptr;
+    this->_stableCnt = 0;
+}
+
 
 void finSyntaxReader::disposeAllRead()
 {
@@ -160,6 +227,8 @@ void finSyntaxReader::disposeAllRead()
     }
 
     this->_errList.clear();
+    this->_stableCnt = 0;
+    this->_baseNode = nullptr;
 }
 
 void finSyntaxReader::processTypedNextToken(finLexNode *lexnode, finLexNodeType lextype)
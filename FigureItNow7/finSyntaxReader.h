@@ -80,6 +80,8 @@ protected:
     QList<finSyntaxNode *> _syntaxStack; //!< Parser working stack; the newest node is at index 0.
                                          //!< Every node in this list is heap-allocated and owned by the reader.
     QList<finSyntaxError> _errList;      //!< Parse errors recorded so far; attached to the syntax tree.
+    int _stableCnt;                      //!< Number of bottom stack nodes that no later token can change.
+    finSyntaxNode *_baseNode;            //!< Stand-in for the statements before a resumed read, or nullptr.
 
 public:
     /*!
@@ -175,6 +177,48 @@ public:
      */
     finSyntaxTree *getSyntaxTree();
 
+    /*! \name Resumable Reading
+     *  \brief Parse only part of a script, for incremental compilation.
+     *
+     *  A finished top-level statement is never touched again by the tokens after it, apart from
+     *  the check whether the newest one is an open branch. A read can therefore resume at any
+     *  statement boundary of an earlier pass on an empty stack, as long as one placeholder node
+     *  stands in for the statements that came before.
+     */
+    ///@{
+
+    /*!
+     *  \brief Like startRead(), but lexes from \a mark on; \a hasbase tells whether any
+     *         statement precedes the mark.
+     *
+     *  \throws finException with EC_STATE_ERROR if the parser is not in the ST_READY state.
+     */
+    void startReadAt(const finLexReader::Mark &mark, bool hasbase);
+
+    /*!
+     *  \brief Returns \c true if the stack holds finished top-level statements only, and the
+     *         newest of them is not a branch that may still take an elif or else arm.
+     */
+    bool isAtStatementBoundary();
+
+    /*!
+     *  \brief Returns how many top-level nodes were finished at the last statement boundary.
+     */
+    int getStatementCount() const;
+
+    /*!
+     *  \brief Returns the parse errors recorded so far.
+     */
+    QList<finSyntaxError> getErrorList() const;
+
+    /*!
+     *  \brief Moves the top-level nodes read so far, in source order, to the end of \a list.
+     *
+     *  The caller owns the moved nodes; the placeholder of startReadAt() is not among them.
+     */
+    void takeSyntaxNodes(QList<finSyntaxNode *> *list);
+    ///@}
+
     /*!
      *  \brief Returns a one-line textual description of the reader, used for logging.
      *
@@ -9,17 +9,21 @@
 #include "finSyntaxTree.h"
 
 #include <QtGlobal>
+#include <QHash>
 #include <QTextStream>
 
+#include "finSymbolTable.h"
+
 
 finSyntaxTree::finSyntaxTree()
-    : _rootNode(), _scriptCodes(), _errList()
+    : _nodeArena(QString("syntax tree"), sizeof (finSyntaxNode)), _rootNode(), _scriptCodes(), _errList()
 {
     this->_rootNode.setType(finSyntaxNode::TP_PROGRAM);
 }
 
 finSyntaxTree::~finSyntaxTree()
 {
+    // The nodes go before the arena holding them.
     this->disposeAll();
 }
 
@@ -33,6 +37,11 @@ finSyntaxNode *finSyntaxTree::getRootNode()
     return &this->_rootNode;
 }
 
+finExecObjectArena *finSyntaxTree::getNodeArena()
+{
+    return &this->_nodeArena;
+}
+
 QString finSyntaxTree::getScriptCode() const
 {
     QString retstr;
@@ -74,6 +83,7 @@ void finSyntaxTree::setRootNode(const finSyntaxNode *rtnode)
 
     rtnode->dump();
 
+    finExecObjectArena::Scope arenascope(&this->_nodeArena);
     this->_rootNode.copyNode(rtnode);
 }
 
@@ -81,6 +91,7 @@ void finSyntaxTree::appendSyntaxNode(const finSyntaxNode *synnode)
 {
     Q_ASSERT(synnode != nullptr);
 
+    finExecObjectArena::Scope arenascope(&this->_nodeArena);
     finSyntaxNode *mynode = new finSyntaxNode();
     if (mynode == nullptr)
         finThrowObj(finErrorKits::EC_OUT_OF_MEMORY, "Alloc syntax node failed.");
@@ -98,6 +109,7 @@ void finSyntaxTree::prependSyntaxNode(const finSyntaxNode *synnode)
 {
     Q_ASSERT(synnode != nullptr);
 
+    finExecObjectArena::Scope arenascope(&this->_nodeArena);
     finSyntaxNode *mynode = new finSyntaxNode();
     if (mynode == nullptr)
         finThrowObj(finErrorKits::EC_OUT_OF_MEMORY, "Alloc syntax node failed.");
@@ -143,11 +155,140 @@ void finSyntaxTree::appendSyntaxNodeStack(const QList<finSyntaxNode *> *list)
     }
 }
 
+void finSyntaxTree::shareSyntaxNodeList(const QList<finSyntaxNode *> *list)
+{
+    Q_ASSERT(list != nullptr);
+
+    // The nodes stay in the arena of their first owner, which therefore has to outlive this tree.
+    for ( int i = 0; i < list->count(); i++ ) {
+        finSyntaxNode *synnode = list->at(i);
+        if ( synnode == nullptr ) {
+            finWarning << "Null syntax node in list at " << i;
+            continue;
+        }
+
+        this->_rootNode.appendSubSyntaxNode(synnode->shareNode());
+    }
+}
+
+int finSyntaxTree::detachSharedNodes()
+{
+    // Passes that rewrite the tree in place must not touch the nodes another owner still holds.
+    finExecObjectArena::Scope arenascope(&this->_nodeArena);
+    int detachcnt = 0;
+    for ( int i = 0; i < this->_rootNode.getSubListCount(); i++ ) {
+        finSyntaxNode *synnode = this->_rootNode.getSubSyntaxNode(i);
+        if ( !synnode->isShared() )
+            continue;
+
+        finSyntaxNode *mynode = new finSyntaxNode();
+        if ( mynode == nullptr )
+            finThrowObj(finErrorKits::EC_OUT_OF_MEMORY, "Alloc syntax node failed.");
+
+        try {
+            mynode->copyNode(synnode);
+        } catch (finException &e) {
+            delete mynode;
+            throw e;
+        }
+        finSyntaxNode::releaseNode(this->_rootNode.replaceSubSyntaxNode(i, mynode));
+        detachcnt++;
+    }
+    return detachcnt;
+}
+
 void finSyntaxTree::clearSyntaxNodes()
 {
     finThrowObj(finErrorKits::EC_NON_IMPLEMENT, "Not implemented.");
 }
 
+struct finSyntaxLabelScope {
+    finSyntaxNode *_synNode;
+    QHash<int, int> _labelIdxMap;
+};
+
+static void _resolveJumpTargets(finSyntaxNode *synnode, QList<finSyntaxLabelScope> *scopelist,
+                                QList<finSyntaxError> *errlist)
+{
+    finSyntaxNodeType type = synnode->getType();
+    finLexNode *lexnode = synnode->getCommandLexNode();
+
+    if ( type == finSyntaxNode::TP_FUNCTION ) {
+        // A function body runs on a flow of its own, so no goto can leave it.
+        QList<finSyntaxLabelScope> funcscopes;
+        for ( int i = 0; i < synnode->getSubListCount(); i++ )
+            _resolveJumpTargets(synnode->getSubSyntaxNode(i), &funcscopes, errlist);
+        return;
+    }
+
+    if ( type == finSyntaxNode::TP_JUMP && lexnode != nullptr && lexnode->getString() == QString("goto") ) {
+        synnode->setJumpTarget(nullptr, -1);
+        if ( synnode->getSubListCount() < 1 )
+            return;
+
+        // Malformed targets are left to the executor, which reports them as it always did.
+        finSyntaxNode *lblsynnode = synnode->getSubSyntaxNode(0);
+        finLexNode *lbllexnode = lblsynnode->getCommandLexNode();
+        if ( lblsynnode->getType() != finSyntaxNode::TP_EXPRESS || lbllexnode == nullptr ||
+             lbllexnode->getType() != finLexNode::TP_VARIABLE )
+            return;
+
+        // Same search order as the executor: the innermost enclosing statement list first.
+        int lblid = lbllexnode->getSymbolId();
+        for ( int i = scopelist->count() - 1; i >= 0; i-- ) {
+            const finSyntaxLabelScope &scope = scopelist->at(i);
+            int labelidx = scope._labelIdxMap.value(lblid, -1);
+            if ( labelidx >= 0 ) {
+                synnode->setJumpTarget(scope._synNode, labelidx);
+                return;
+            }
+        }
+
+        finSyntaxError synerr;
+        synerr.setLevel(finSyntaxError::LV_ERROR);
+        synerr.setStage(finSyntaxError::ST_COMPILE);
+        synerr.setRow(lbllexnode->getRow());
+        synerr.setColumn(lbllexnode->getColumn());
+        synerr.setErrorString(QString("Cannot find the jumping target '%1'.").arg(lbllexnode->getString()));
+        errlist->append(synerr);
+        return;
+    }
+
+    bool isscope = (type == finSyntaxNode::TP_STATEMENT || type == finSyntaxNode::TP_PROGRAM);
+    if ( isscope ) {
+        finSyntaxLabelScope scope;
+        scope._synNode = synnode;
+        for ( int i = 0; i < synnode->getSubListCount(); i++ ) {
+            finSyntaxNode *subnode = synnode->getSubSyntaxNode(i);
+            finLexNode *sublexnode = subnode->getCommandLexNode();
+            if ( subnode->getType() != finSyntaxNode::TP_LABEL || sublexnode == nullptr )
+                continue;
+
+            // The first of several equal labels wins, as in finSyntaxNode::findLabelIdx().
+            int lblid = sublexnode->getSymbolId();
+            if ( lblid != finSymbolTable::SYM_NONE && !scope._labelIdxMap.contains(lblid) )
+                scope._labelIdxMap.insert(lblid, i);
+        }
+        scopelist->append(scope);
+    }
+
+    for ( int i = 0; i < synnode->getSubListCount(); i++ )
+        _resolveJumpTargets(synnode->getSubSyntaxNode(i), scopelist, errlist);
+
+    if ( isscope )
+        scopelist->removeLast();
+}
+
+int finSyntaxTree::resolveJumpTargets()
+{
+    QList<finSyntaxLabelScope> scopelist;
+    QList<finSyntaxError> errlist;
+
+    _resolveJumpTargets(&this->_rootNode, &scopelist, &errlist);
+    this->_errList.append(errlist);
+    return errlist.count();
+}
+
 void finSyntaxTree::setScriptCode(const QString &script)
 {
     this->_scriptCodes = script.split(QChar::LineSeparator, Qt::KeepEmptyParts);
@@ -21,6 +21,7 @@
 class finSyntaxTree : public finExceptionObject
 {
 protected:
+    finExecObjectArena _nodeArena;
     finSyntaxNode _rootNode;
     QStringList _scriptCodes;
     QList<finSyntaxError> _errList;
@@ -31,6 +32,7 @@ public:
 
     const finSyntaxNode *getRootNode() const;
     finSyntaxNode *getRootNode();
+    finExecObjectArena *getNodeArena();
     QString getScriptCode() const;
     QString getCodeLine(int line) const;
     int getErrorCount() const;
@@ -41,7 +43,10 @@ public:
     void prependSyntaxNode(const finSyntaxNode *synnode);
     void appendSyntaxNodeList(const QList<finSyntaxNode *> *list);
     void appendSyntaxNodeStack(const QList<finSyntaxNode *> *list);
+    void shareSyntaxNodeList(const QList<finSyntaxNode *> *list);
+    int detachSharedNodes();
     void clearSyntaxNodes();
+    int resolveJumpTargets();
 
     void setScriptCode(const QString &script);
 
@@ -8,28 +8,51 @@
 
 #include "finUiCommandLine.h"
 
+#include <QAtomicInt>
 #include <QDebug>
 #include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QPdfWriter>
 #include <QSvgGenerator>
 #include <QImage>
+#include <QThread>
+#include <QThreadPool>
 
 #include "finFigureContainer.h"
 #include "finExecMachine.h"
+#include "finExecCompileCache.h"
 #include "finExecEnvironment.h"
 #include "finGraphPanelWidget.h"
+#include "finUiRenderServer.h"
 
 
 finUiCommandLine::finUiCommandLine()
     : _inFileList()
 {
     this->_outType = QString("PDF");
+    this->_useCache = true;
+    this->_clearCache = false;
+    this->_cacheDir = QString();
+    this->_jobCount = 1;
+    this->_plotWorkerCount = 1;
+    this->_optimize = false;
+    this->_serveMode = false;
+    this->_serveSocket = QString();
 }
 
 finUiCommandLine::finUiCommandLine(int argc, char *argv[])
     : _inFileList()
 {
     this->_outType = QString("PDF");
+    this->_useCache = true;
+    this->_clearCache = false;
+    this->_cacheDir = QString();
+    this->_jobCount = 1;
+    this->_plotWorkerCount = 1;
+    this->_optimize = false;
+    this->_serveMode = false;
+    this->_serveSocket = QString();
     this->parseArgument(argc, argv);
 }
 
@@ -37,6 +60,14 @@ finUiCommandLine::finUiCommandLine(const QStringList &arglist)
     : _inFileList()
 {
     this->_outType = QString("PDF");
+    this->_useCache = true;
+    this->_clearCache = false;
+    this->_cacheDir = QString();
+    this->_jobCount = 1;
+    this->_plotWorkerCount = 1;
+    this->_optimize = false;
+    this->_serveMode = false;
+    this->_serveSocket = QString();
     this->parseArgument(arglist);
 }
 
@@ -44,6 +75,14 @@ finErrorCode finUiCommandLine::reset()
 {
     this->_inFileList.clear();
     this->_outType = QString("PDF");
+    this->_useCache = true;
+    this->_clearCache = false;
+    this->_cacheDir = QString();
+    this->_jobCount = 1;
+    this->_plotWorkerCount = 1;
+    this->_optimize = false;
+    this->_serveMode = false;
+    this->_serveSocket = QString();
     return finErrorKits::EC_SUCCESS;
 }
 
@@ -67,6 +106,24 @@ QString finUiCommandLine::parseArgumentCommand(const QString &argstr)
     } else if ( QString::compare(argstr, QString("-c")) == 0 ||
                 QString::compare(argstr, QString("--console")) == 0 ) {
         return QString("ignore");
+    } else if ( QString::compare(argstr, QString("-O")) == 0 ||
+                QString::compare(argstr, QString("--optimize")) == 0 ) {
+        return QString("optimize");
+    } else if ( QString::compare(argstr, QString("--no-cache")) == 0 ) {
+        return QString("nocache");
+    } else if ( QString::compare(argstr, QString("--clear-cache")) == 0 ) {
+        return QString("clearcache");
+    } else if ( QString::compare(argstr, QString("--cache-dir")) == 0 ) {
+        return QString("cachedir");
+    } else if ( QString::compare(argstr, QString("-j")) == 0 ||
+                QString::compare(argstr, QString("--jobs")) == 0 ) {
+        return QString("jobs");
+    } else if ( QString::compare(argstr, QString("--plot-workers")) == 0 ) {
+        return QString("plotworkers");
+    } else if ( QString::compare(argstr, QString("--serve")) == 0 ) {
+        return QString("serve");
+    } else if ( QString::compare(argstr, QString("--serve-socket")) == 0 ) {
+        return QString("servesocket");
     } else {
         return QString();
     }
@@ -93,6 +150,18 @@ finErrorCode finUiCommandLine::parseArgument(const QStringList &arglist)
                 this->_inFileList.append(curarg);
             } else if ( QString::compare(cmd, QString("ignore")) == 0 ) {
                 cmd = QString();
+            } else if ( QString::compare(cmd, QString("optimize")) == 0 ) {
+                this->_optimize = true;
+                cmd = QString();
+            } else if ( QString::compare(cmd, QString("nocache")) == 0 ) {
+                this->_useCache = false;
+                cmd = QString();
+            } else if ( QString::compare(cmd, QString("clearcache")) == 0 ) {
+                this->_clearCache = true;
+                cmd = QString();
+            } else if ( QString::compare(cmd, QString("serve")) == 0 ) {
+                this->_serveMode = true;
+                cmd = QString();
             } else {
                 cmdargidx = 0;
                 continue;
@@ -105,6 +174,38 @@ finErrorCode finUiCommandLine::parseArgument(const QStringList &arglist)
             if ( cmdargidx == 0 )
                 this->_outType = curarg;
             cmd = QString();
+        } else if ( QString::compare(cmd, QString("cachedir")) == 0 ) {
+            if ( cmdargidx == 0 )
+                this->_cacheDir = curarg;
+            cmd = QString();
+        } else if ( QString::compare(cmd, QString("jobs")) == 0 ) {
+            if ( cmdargidx == 0 ) {
+                bool isnum = false;
+                int jobcnt = curarg.toInt(&isnum);
+                if ( !isnum )
+                    qWarning() << "Invalid job count: " << curarg;
+                else if ( jobcnt <= 0 )
+                    this->_jobCount = QThread::idealThreadCount();
+                else
+                    this->_jobCount = jobcnt;
+            }
+            cmd = QString();
+        } else if ( QString::compare(cmd, QString("plotworkers")) == 0 ) {
+            if ( cmdargidx == 0 ) {
+                bool isnum = false;
+                int wkcnt = curarg.toInt(&isnum);
+                if ( !isnum )
+                    qWarning() << "Invalid plot worker count: " << curarg;
+                else
+                    this->_plotWorkerCount = wkcnt;
+            }
+            cmd = QString();
+        } else if ( QString::compare(cmd, QString("servesocket")) == 0 ) {
+            if ( cmdargidx == 0 ) {
+                this->_serveMode = true;
+                this->_serveSocket = curarg;
+            }
+            cmd = QString();
         }
         cmdargidx++;
     }
@@ -115,6 +216,24 @@ finErrorCode finUiCommandLine::work()
 {
     qInfo() << "Input file count: " << this->_inFileList.count();
     qInfo() << "Output type: " << this->_outType;
+    qInfo() << "Job count: " << this->_jobCount;
+    qInfo() << "Plot worker count: " << this->_plotWorkerCount;
+    qInfo() << "Optimize: " << this->_optimize;
+
+    if ( !this->_cacheDir.isEmpty() )
+        finExecCompileCache::setCacheDirectory(this->_cacheDir);
+    finExecCompileCache::setEnabled(this->_useCache);
+    if ( this->_clearCache )
+        finExecCompileCache::clearCache();
+
+    if ( this->_serveMode ) {
+        finUiRenderServer server;
+        server.setSocketName(this->_serveSocket);
+        server.setPlotWorkerCount(this->_plotWorkerCount);
+        if ( this->_optimize )
+            server.setOptimizeOption(finSyntaxOptimzer::getDefaultOption());
+        return server.serve();
+    }
 
     if ( this->_inFileList.count() <= 0 ) {
         qWarning() << "No file to handle!";
@@ -123,9 +242,9 @@ finErrorCode finUiCommandLine::work()
 
     int success = 0;
     if ( QString::compare(this->_outType, QString("PDF"), Qt::CaseInsensitive) == 0 ) {
-        success = this->figureToPDF();
+        success = this->runScripts(&finUiCommandLine::figureToPDF);
     } else if ( QString::compare(this->_outType, QString("SVG"), Qt::CaseInsensitive) == 0 ) {
-        success = this->figureToSVG();
+        success = this->runScripts(&finUiCommandLine::figureToSVG);
     } else if ( QString::compare(this->_outType, QString("PNG"), Qt::CaseInsensitive) == 0 ||
                 QString::compare(this->_outType, QString("JPG"), Qt::CaseInsensitive) == 0 ||
                 QString::compare(this->_outType, QString("JPEG"), Qt::CaseInsensitive) == 0 ||
@@ -134,7 +253,7 @@ finErrorCode finUiCommandLine::work()
                 QString::compare(this->_outType, QString("TIFF"), Qt::CaseInsensitive) == 0 ||
                 QString::compare(this->_outType, QString("XBM"), Qt::CaseInsensitive) == 0 ||
                 QString::compare(this->_outType, QString("XPM"), Qt::CaseInsensitive) == 0 ) {
-        success = this->figureToImage();
+        success = this->runScripts(&finUiCommandLine::figureToImage);
     } else {
         qWarning() << "The output type is not supported!";
         return finErrorKits::EC_NON_IMPLEMENT;
@@ -147,142 +266,221 @@ finErrorCode finUiCommandLine::work()
         return finErrorKits::EC_SUCCESS;
 }
 
-finErrorCode finUiCommandLine::compileAndRunScript(const QString &filename, finFigureContainer *outfig)
+finErrorCode
+finUiCommandLine::compileAndRunScript(const QString &filename, finFigureContainer *outfig, ScriptLog *log)
 {
     QFile infile(filename);
     bool openok = infile.open(QIODevice::ReadOnly);
     if ( !openok ) {
-        qWarning() << "Cannot open file: " << filename << Qt::endl;
+        log->append(qMakePair(QtWarningMsg, QString("Cannot open file: %1").arg(filename)));
         return finErrorKits::EC_FILE_NOT_OPEN;
     }
 
     QString scriptcode = infile.readAll();
     infile.close();
 
+    // Every script runs in a global scope of its own, above which the root is shared read-only.
     finErrorCode errcode;
     finExecMachine machine;
     machine.initEnvironmentFromRoot();
+    machine.setPlotWorkerCount(this->_plotWorkerCount);
+    if ( this->_optimize )
+        machine.setOptimizeOption(finSyntaxOptimzer::getDefaultOption());
     machine.setFigureContainer(outfig);
     machine.setScriptCode(scriptcode);
 
     errcode = machine.compile();
     if ( finErrorKits::isErrorResult(errcode) ) {
-        qWarning() << "Compile script failed: " << filename;
+        log->append(qMakePair(QtWarningMsg, QString("Compile script failed: %1").arg(filename)));
         return errcode;
     }
 
     errcode = machine.execute();
     if ( finErrorKits::isErrorResult(errcode) ) {
-        qWarning() << "Execute script failed: " << filename;
+        log->append(qMakePair(QtWarningMsg, QString("Execute script failed: %1").arg(filename)));
         return errcode;
     }
     return finErrorKits::EC_SUCCESS;
 }
 
-int finUiCommandLine::figureToPDF()
+bool finUiCommandLine::figureToPDF(const QString &filename, ScriptLog *log)
 {
-    int succ = 0;
-    QString filename;
-    foreach ( filename, this->_inFileList ) {
-        QString outfilename = filename + QString(".pdf");
-        finFigureContainer figcontainer;
-
-        finErrorCode errcode = this->compileAndRunScript(filename, &figcontainer);
-        if ( finErrorKits::isErrorResult(errcode) )
-            continue;
-
-        static const int _defResolution = 72;
-
-        finGraphConfig *graphcfg = figcontainer.getGraphConfig();
-        QPdfWriter pdfwrt(outfilename);
-
-        pdfwrt.setTitle(filename);
-        pdfwrt.setCreator(QString("FigureItNow 7"));
-        pdfwrt.setPageSize(QPageSize(graphcfg->getPanelPixelSize() / _defResolution, QPageSize::Inch));
-        pdfwrt.setPageMargins(QMarginsF(0.0, 0.0, 0.0, 0.0));
-        pdfwrt.setResolution(_defResolution);
-
-        finGraphPanelWidget graphpanel;
-        graphpanel.setWidget(&pdfwrt);
-        graphpanel.setFigureContainer(&figcontainer);
-
-        errcode = graphpanel.draw();
-        if ( finErrorKits::isErrorResult(errcode) ) {
-            qWarning() << "Draw on panel failed: " << filename;
-            continue;
-        }
+    QString outfilename = filename + QString(".pdf");
+    finFigureContainer figcontainer;
+
+    finErrorCode errcode = this->compileAndRunScript(filename, &figcontainer, log);
+    if ( finErrorKits::isErrorResult(errcode) )
+        return false;
+
+    static const int _defResolution = 72;
+
+    finGraphConfig *graphcfg = figcontainer.getGraphConfig();
+    QPdfWriter pdfwrt(outfilename);
+
+    pdfwrt.setTitle(filename);
+    pdfwrt.setCreator(QString("FigureItNow 7"));
+    pdfwrt.setPageSize(QPageSize(graphcfg->getPanelPixelSize() / _defResolution, QPageSize::Inch));
+    pdfwrt.setPageMargins(QMarginsF(0.0, 0.0, 0.0, 0.0));
+    pdfwrt.setResolution(_defResolution);
 
-        qInfo() << "Figour OK: " << outfilename;
-        succ++;
+    finGraphPanelWidget graphpanel;
+    graphpanel.setWidget(&pdfwrt);
+    graphpanel.setFigureContainer(&figcontainer);
+
+    errcode = graphpanel.draw();
+    if ( finErrorKits::isErrorResult(errcode) ) {
+        log->append(qMakePair(QtWarningMsg, QString("Draw on panel failed: %1").arg(filename)));
+        return false;
     }
-    return succ;
+
+    log->append(qMakePair(QtInfoMsg, QString("Figour OK: %1").arg(outfilename)));
+    return true;
 }
 
-int finUiCommandLine::figureToSVG()
+bool finUiCommandLine::figureToSVG(const QString &filename, ScriptLog *log)
 {
-    int succ = 0;
-    QString filename;
-    foreach ( filename, this->_inFileList ) {
-        QString outfilename = filename + QString(".svg");
-        finFigureContainer figcontainer;
-
-        finErrorCode errcode = this->compileAndRunScript(filename, &figcontainer);
-        if ( finErrorKits::isErrorResult(errcode) )
-            continue;
-
-        finGraphConfig *graphcfg = figcontainer.getGraphConfig();
-        QSvgGenerator svggen;
-        svggen.setFileName(outfilename);
-        svggen.setTitle(filename);
-        svggen.setDescription(QString("Generated by FigureItNow7."));
-        svggen.setSize(graphcfg->getPanelPixelSize().toSize());
-        svggen.setViewBox(graphcfg->getWholePanelPixelRect().toRect());
-
-        finGraphPanelWidget graphpanel;
-        graphpanel.setWidget(&svggen);
-        graphpanel.setFigureContainer(&figcontainer);
-
-        errcode = graphpanel.draw();
-        if ( finErrorKits::isErrorResult(errcode) ) {
-            qWarning() << "Draw on panel failed: " << filename;
-            continue;
-        }
+    QString outfilename = filename + QString(".svg");
+    finFigureContainer figcontainer;
+
+    finErrorCode errcode = this->compileAndRunScript(filename, &figcontainer, log);
+    if ( finErrorKits::isErrorResult(errcode) )
+        return false;
+
+    finGraphConfig *graphcfg = figcontainer.getGraphConfig();
+    QSvgGenerator svggen;
+    svggen.setFileName(outfilename);
+    svggen.setTitle(filename);
+    svggen.setDescription(QString("Generated by FigureItNow7."));
+    svggen.setSize(graphcfg->getPanelPixelSize().toSize());
+    svggen.setViewBox(graphcfg->getWholePanelPixelRect().toRect());
+
+    finGraphPanelWidget graphpanel;
+    graphpanel.setWidget(&svggen);
+    graphpanel.setFigureContainer(&figcontainer);
+
+    errcode = graphpanel.draw();
+    if ( finErrorKits::isErrorResult(errcode) ) {
+        log->append(qMakePair(QtWarningMsg, QString("Draw on panel failed: %1").arg(filename)));
+        return false;
+    }
+
+    log->append(qMakePair(QtInfoMsg, QString("Figour OK: %1").arg(outfilename)));
+    return true;
+}
+
+bool finUiCommandLine::figureToImage(const QString &filename, ScriptLog *log)
+{
+    QString outfilename = filename + QString(".") + this->_outType.toLower();
+    finFigureContainer figcontainer;
+
+    finErrorCode errcode = this->compileAndRunScript(filename, &figcontainer, log);
+    if ( finErrorKits::isErrorResult(errcode) )
+        return false;
 
-        qInfo() << "Figour OK: " << outfilename;
-        succ++;
+    finGraphConfig *graphcfg = figcontainer.getGraphConfig();
+    QImage img(graphcfg->getPanelPixelSize().toSize(), QImage::Format_ARGB32);
+    //outimg.fill(Qt::transparent);
+
+    finGraphPanelWidget graphpanel;
+    graphpanel.setWidget(&img);
+    graphpanel.setFigureContainer(&figcontainer);
+
+    errcode = graphpanel.draw();
+    if ( finErrorKits::isErrorResult(errcode) ) {
+        log->append(qMakePair(QtWarningMsg, QString("Draw on panel failed: %1").arg(filename)));
+        return false;
     }
+    img.save(outfilename);
+
+    log->append(qMakePair(QtInfoMsg, QString("Figour OK: %1").arg(outfilename)));
+    return true;
+}
+
+thread_local finUiCommandLine::ScriptLog *finUiCommandLine::_threadLog = nullptr;
+QtMessageHandler finUiCommandLine::_prevMsgHandler = nullptr;
+
+void finUiCommandLine::captureMessage(QtMsgType type, const QMessageLogContext &context, const QString &msg)
+{
+    // Messages of the interpreter, such as print() or finWarning, join the log of the script being run on
+    // this thread. Threads that run no script, including plot workers, log straight through.
+    if ( finUiCommandLine::_threadLog != nullptr && type != QtFatalMsg )
+        finUiCommandLine::_threadLog->append(qMakePair(type, msg));
+    else if ( finUiCommandLine::_prevMsgHandler != nullptr )
+        finUiCommandLine::_prevMsgHandler(type, context, msg);
+}
+
+bool finUiCommandLine::runOneScript(ScriptExporter exporter, const QString &filename, ScriptLog *log)
+{
+    finUiCommandLine::_threadLog = log;
+    bool succ = (this->*exporter)(filename, log);
+    finUiCommandLine::_threadLog = nullptr;
     return succ;
 }
 
-int finUiCommandLine::figureToImage()
+int finUiCommandLine::runScripts(ScriptExporter exporter)
 {
-    int succ = 0;
-    QString filename;
-    foreach ( filename, this->_inFileList ) {
-        QString outfilename = filename + QString(".") + this->_outType.toLower();
-        finFigureContainer figcontainer;
-
-        finErrorCode errcode = this->compileAndRunScript(filename, &figcontainer);
-        if ( finErrorKits::isErrorResult(errcode) )
-            continue;
-
-        finGraphConfig *graphcfg = figcontainer.getGraphConfig();
-        QImage img(graphcfg->getPanelPixelSize().toSize(), QImage::Format_ARGB32);
-        //outimg.fill(Qt::transparent);
-
-        finGraphPanelWidget graphpanel;
-        graphpanel.setWidget(&img);
-        graphpanel.setFigureContainer(&figcontainer);
-
-        errcode = graphpanel.draw();
-        if ( finErrorKits::isErrorResult(errcode) ) {
-            qWarning() << "Draw on panel failed: " << filename;
-            continue;
+    int filecnt = this->_inFileList.count();
+    int jobcnt = qBound(1, this->_jobCount, filecnt);
+
+    if ( jobcnt <= 1 ) {
+        int succ = 0;
+        QString filename;
+        foreach ( filename, this->_inFileList ) {
+            ScriptLog log;
+            if ( (this->*exporter)(filename, &log) )
+                succ++;
+            finUiCommandLine::flushScriptLog(log);
         }
-        img.save(outfilename);
+        return succ;
+    }
 
-        qInfo() << "Figour OK: " << outfilename;
-        succ++;
+    finUiCommandLine::_prevMsgHandler = qInstallMessageHandler(&finUiCommandLine::captureMessage);
+
+    QList<ScriptLog> loglist(filecnt);
+    QList<bool> donelist(filecnt, false);
+    QAtomicInt nextfile(0), succcnt(0);
+    QMutex flushmutex;
+    int nextflush = 0;
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(jobcnt);
+    for ( int w = 0; w < jobcnt; w++ ) {
+        pool.start([&]() {
+            int fileidx;
+            while ( (fileidx = nextfile.fetchAndAddRelaxed(1)) < filecnt ) {
+                ScriptLog log;
+                if ( this->runOneScript(exporter, this->_inFileList.at(fileidx), &log) )
+                    succcnt.fetchAndAddRelaxed(1);
+
+                // Diagnostics come out in input order, one script at a time: whoever completes the oldest
+                // pending script prints it together with every finished script queued up behind it.
+                QMutexLocker locker(&flushmutex);
+                loglist[fileidx] = log;
+                donelist[fileidx] = true;
+                while ( nextflush < filecnt && donelist.at(nextflush) ) {
+                    finUiCommandLine::flushScriptLog(loglist.at(nextflush));
+                    loglist[nextflush].clear();
+                    nextflush++;
+                }
+            }
+        });
+    }
+    pool.waitForDone();
+    qInstallMessageHandler(finUiCommandLine::_prevMsgHandler);
+    return succcnt.loadRelaxed();
+}
+
+void finUiCommandLine::flushScriptLog(const ScriptLog &log)
+{
+    for ( int i = 0; i < log.count(); i++ ) {
+        const QPair<QtMsgType, QString> &msg = log.at(i);
+        if ( msg.first == QtDebugMsg )
+            qDebug().noquote() << msg.second;
+        else if ( msg.first == QtInfoMsg )
+            qInfo().noquote() << msg.second;
+        else if ( msg.first == QtCriticalMsg )
+            qCritical().noquote() << msg.second;
+        else
+            qWarning().noquote() << msg.second;
     }
-    return succ;
 }
@@ -9,8 +9,12 @@
 #ifndef FINUICOMMANDLINE_H
 #define FINUICOMMANDLINE_H
 
+#include <QList>
+#include <QPair>
 #include <QString>
 #include <QStringList>
+#include <QtGlobal>
+#include <QtLogging>
 
 #include "finErrorCode.h"
 #include "finFigureContainer.h"
@@ -21,6 +25,17 @@ class finUiCommandLine
 protected:
     QStringList _inFileList;
     QString _outType;
+    bool _useCache;
+    bool _clearCache;
+    QString _cacheDir;
+    int _jobCount;
+    int _plotWorkerCount;
+    bool _optimize;
+    bool _serveMode;
+    QString _serveSocket;
+
+    typedef QList<QPair<QtMsgType, QString> > ScriptLog;
+    typedef bool (finUiCommandLine::*ScriptExporter)(const QString &filename, ScriptLog *log);
 
 public:
     finUiCommandLine();
@@ -38,10 +53,18 @@ private:
     QStringList parseStringList(int argc, char *argv[]);
     QString parseArgumentCommand(const QString &argstr);
 
-    finErrorCode compileAndRunScript(const QString &filename, finFigureContainer *outfig);
-    int figureToPDF();
-    int figureToSVG();
-    int figureToImage();
+    finErrorCode compileAndRunScript(const QString &filename, finFigureContainer *outfig, ScriptLog *log);
+    bool figureToPDF(const QString &filename, ScriptLog *log);
+    bool figureToSVG(const QString &filename, ScriptLog *log);
+    bool figureToImage(const QString &filename, ScriptLog *log);
+
+    int runScripts(ScriptExporter exporter);
+    bool runOneScript(ScriptExporter exporter, const QString &filename, ScriptLog *log);
+    static void flushScriptLog(const ScriptLog &log);
+
+    static thread_local ScriptLog *_threadLog;
+    static QtMessageHandler _prevMsgHandler;
+    static void captureMessage(QtMsgType type, const QMessageLogContext &context, const QString &msg);
 };
 
 #endif // FINUICOMMANDLINE_H
@@ -0,0 +1,391 @@
+/*-
+ * GNU GENERAL PUBLIC LICENSE, version 3
+ * See LICENSE file for detail.
+ *
+ * Author: Yulong Yu
+ * Copyright(c) 2015-2026 Yulong Yu. All rights reserved.
+ */
+
+/*! \file finUiRenderServer.cpp
+ *  \brief Implementations of the headless, long-running render server.
+ */
+
+#include "finUiRenderServer.h"
+
+#include <QBuffer>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <QJsonValue>
+#ifdef FIN_RENDER_SOCKET
+#include <QLocalServer>
+#include <QLocalSocket>
+#endif
+#include <QPdfWriter>
+#include <QSvgGenerator>
+
+#include "finGraphPanelWidget.h"
+#include "finSyntaxError.h"
+
+
+finUiRenderServer::finUiRenderServer()
+    : _socketName(), _machineList()
+{
+    this->_machineLimit = 16;
+    this->_plotWorkerCnt = 1;
+    this->_optOptions = QStringList();
+    this->_shutdown = false;
+}
+
+finUiRenderServer::~finUiRenderServer()
+{
+    for ( int i = 0; i < this->_machineList.count(); i++ )
+        delete this->_machineList.at(i).second;
+    this->_machineList.clear();
+}
+
+QString finUiRenderServer::getSocketName() const
+{
+    return this->_socketName;
+}
+
+void finUiRenderServer::setSocketName(const QString &name)
+{
+    this->_socketName = name;
+}
+
+int finUiRenderServer::getMachineLimit() const
+{
+    return this->_machineLimit;
+}
+
+void finUiRenderServer::setMachineLimit(int limit)
+{
+    this->_machineLimit = (limit > 0 ? limit : 1);
+}
+
+int finUiRenderServer::getPlotWorkerCount() const
+{
+    return this->_plotWorkerCnt;
+}
+
+void finUiRenderServer::setPlotWorkerCount(int cnt)
+{
+    this->_plotWorkerCnt = cnt;
+}
+
+QStringList finUiRenderServer::getOptimizeOption() const
+{
+    return this->_optOptions;
+}
+
+void finUiRenderServer::setOptimizeOption(const QStringList &options)
+{
+    this->_optOptions = options;
+}
+
+finErrorCode finUiRenderServer::serve()
+{
+    this->_shutdown = false;
+    if ( this->_socketName.isEmpty() )
+        return this->serveStdio();
+    else
+        return this->serveSocket();
+}
+
+finErrorCode finUiRenderServer::serveStdio()
+{
+    QFile infile, outfile;
+    if ( !infile.open(stdin, QIODevice::ReadOnly) || !outfile.open(stdout, QIODevice::WriteOnly) ) {
+        qWarning() << "Cannot open the standard input and output.";
+        return finErrorKits::EC_FILE_NOT_OPEN;
+    }
+
+    qInfo() << "Render server is reading jobs from the standard input.";
+    while ( !this->_shutdown ) {
+        QByteArray reqline = infile.readLine();
+        if ( reqline.isEmpty() && infile.atEnd() )
+            break;
+        if ( reqline.trimmed().isEmpty() )
+            continue;
+
+        outfile.write(this->handleRequest(reqline));
+        outfile.write("\n");
+        outfile.flush();
+    }
+    return finErrorKits::EC_SUCCESS;
+}
+
+finErrorCode finUiRenderServer::serveSocket()
+{
+#ifdef FIN_RENDER_SOCKET
+    QLocalServer server;
+
+    // A server that died without cleaning up leaves its socket file behind.
+    QLocalServer::removeServer(this->_socketName);
+    if ( !server.listen(this->_socketName) ) {
+        qWarning() << "Cannot listen on the socket: " << this->_socketName << ", " << server.errorString();
+        return finErrorKits::EC_FILE_NOT_OPEN;
+    }
+
+    qInfo() << "Render server is listening on: " << server.fullServerName();
+    while ( !this->_shutdown && server.waitForNewConnection(-1) ) {
+        QLocalSocket *socket = server.nextPendingConnection();
+        if ( socket == nullptr )
+            continue;
+
+        // Clients are served one at a time; each may send any number of jobs.
+        while ( !this->_shutdown && socket->state() == QLocalSocket::ConnectedState ) {
+            if ( !socket->canReadLine() && !socket->waitForReadyRead(-1) )
+                break;
+
+            while ( !this->_shutdown && socket->canReadLine() ) {
+                QByteArray reqline = socket->readLine();
+                if ( reqline.trimmed().isEmpty() )
+                    continue;
+
+                socket->write(this->handleRequest(reqline));
+                socket->write("\n");
+                socket->waitForBytesWritten(-1);
+            }
+        }
+
+        socket->disconnectFromServer();
+        delete socket;
+    }
+
+    server.close();
+    return finErrorKits::EC_SUCCESS;
+#else
+    qWarning() << "This build cannot listen on a socket: " << this->_socketName;
+    return finErrorKits::EC_NON_IMPLEMENT;
+#endif
+}
+
+QByteArray finUiRenderServer::handleRequest(const QByteArray &reqline)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QJsonObject reply;
+    QJsonParseError parseerr;
+    QJsonDocument reqdoc = QJsonDocument::fromJson(reqline, &parseerr);
+    if ( parseerr.error != QJsonParseError::NoError || !reqdoc.isObject() ) {
+        reply.insert(QString("ok"), false);
+        reply.insert(QString("error"), QString("Cannot parse the request: %1").arg(parseerr.errorString()));
+        return QJsonDocument(reply).toJson(QJsonDocument::Compact);
+    }
+
+    QJsonObject job = reqdoc.object();
+    if ( job.contains(QString("id")) )
+        reply.insert(QString("id"), job.value(QString("id")));
+
+    if ( job.value(QString("command")).toString() == QString("shutdown") ) {
+        this->_shutdown = true;
+        reply.insert(QString("ok"), true);
+        return QJsonDocument(reply).toJson(QJsonDocument::Compact);
+    }
+
+    finErrorCode errcode = this->renderJob(job, &reply);
+    reply.insert(QString("ok"), !finErrorKits::isErrorResult(errcode));
+    reply.insert(QString("elapsed"), static_cast<double>(timer.elapsed()));
+    return QJsonDocument(reply).toJson(QJsonDocument::Compact);
+}
+
+finExecMachine *finUiRenderServer::takeMachine(const QString &key)
+{
+    finExecMachine *machine = nullptr;
+    for ( int i = 0; i < this->_machineList.count(); i++ ) {
+        if ( this->_machineList.at(i).first == key ) {
+            machine = this->_machineList.takeAt(i).second;
+            break;
+        }
+    }
+
+    if ( machine == nullptr ) {
+        machine = new finExecMachine(key);
+        if ( machine == nullptr )
+            return nullptr;
+
+        machine->initEnvironmentFromRoot();
+        while ( this->_machineList.count() >= this->_machineLimit )
+            delete this->_machineList.takeFirst().second;
+    } else {
+        machine->resetEnvironment();
+    }
+    machine->setPlotWorkerCount(this->_plotWorkerCnt);
+    machine->setOptimizeOption(this->_optOptions);
+    this->_machineList.append(qMakePair(key, machine));
+    return machine;
+}
+
+static bool _isImageOutType(const QString &outtype)
+{
+    static const char *const imgtypes[] = { "PNG", "JPG", "JPEG", "BMP", "PPM", "TIFF", "XBM", "XPM", nullptr };
+
+    for ( int i = 0; imgtypes[i] != nullptr; i++ ) {
+        if ( QString::compare(outtype, QString(imgtypes[i]), Qt::CaseInsensitive) == 0 )
+            return true;
+    }
+    return false;
+}
+
+static bool _isSupportedOutType(const QString &outtype)
+{
+    return QString::compare(outtype, QString("PDF"), Qt::CaseInsensitive) == 0 ||
+           QString::compare(outtype, QString("SVG"), Qt::CaseInsensitive) == 0 ||
+           _isImageOutType(outtype);
+}
+
+finErrorCode finUiRenderServer::renderJob(const QJsonObject &job, QJsonObject *reply)
+{
+    QString scriptpath = job.value(QString("script")).toString();
+    QString scriptcode, key;
+    if ( !scriptpath.isEmpty() ) {
+        QFile infile(scriptpath);
+        if ( !infile.open(QIODevice::ReadOnly) ) {
+            reply->insert(QString("error"), QString("Cannot open file: %1").arg(scriptpath));
+            return finErrorKits::EC_FILE_NOT_OPEN;
+        }
+        scriptcode = infile.readAll();
+        infile.close();
+        key = QString("file:") + scriptpath;
+    } else if ( job.contains(QString("code")) ) {
+        scriptcode = job.value(QString("code")).toString();
+        key = QString("code:") + scriptcode;
+    } else {
+        reply->insert(QString("error"), QString("The job has neither a script nor code."));
+        return finErrorKits::EC_INVALID_PARAM;
+    }
+
+    QString outtype = job.value(QString("type")).toString(QString("PNG"));
+    if ( !_isSupportedOutType(outtype) ) {
+        reply->insert(QString("error"), QString("Unsupported output type: %1").arg(outtype));
+        return finErrorKits::EC_INVALID_PARAM;
+    }
+    QString outpath = job.value(QString("output")).toString();
+    bool tobytes = job.value(QString("bytes")).toBool(false);
+    if ( outpath.isEmpty() && !tobytes ) {
+        if ( scriptpath.isEmpty() )
+            tobytes = true;
+        else
+            outpath = scriptpath + QString(".") + outtype.toLower();
+    }
+
+    finExecMachine *machine = this->takeMachine(key);
+    if ( machine == nullptr ) {
+        reply->insert(QString("error"), QString("Cannot build an execution machine."));
+        return finErrorKits::EC_OUT_OF_MEMORY;
+    }
+
+    // A script file may have changed since its last job; then only the changed statements are re-read.
+    finErrorCode errcode;
+    if ( !machine->isCompiled() || machine->getCompiledScriptCode() != scriptcode ) {
+        machine->setScriptCode(scriptcode);
+        errcode = machine->compile();
+        if ( finErrorKits::isErrorResult(errcode) ) {
+            reply->insert(QString("error"), QString("Compile script failed (%1).").arg(static_cast<int>(errcode)));
+            return errcode;
+        }
+    }
+
+    // The requested size is only a starting point; the script may still set its own.
+    finFigureContainer figcontainer;
+    finGraphConfig *graphcfg = figcontainer.getGraphConfig();
+    if ( job.contains(QString("width")) )
+        graphcfg->setPanelPixelWidth(job.value(QString("width")).toDouble());
+    if ( job.contains(QString("height")) )
+        graphcfg->setPanelPixelHeight(job.value(QString("height")).toDouble());
+
+    machine->setFigureContainer(&figcontainer);
+    errcode = machine->execute();
+    machine->setFigureContainer(nullptr);
+
+    QJsonArray diaglist;
+    for ( int i = 0; i < machine->getExecuteErrorCount(); i++ )
+        diaglist.append(machine->getExecuteErrorAt(i).makeErrorInfoString());
+    if ( !diaglist.isEmpty() )
+        reply->insert(QString("diagnostics"), diaglist);
+
+    if ( finErrorKits::isErrorResult(errcode) ) {
+        reply->insert(QString("error"), QString("Execute script failed (%1).").arg(static_cast<int>(errcode)));
+        return errcode;
+    }
+
+    QString title = (scriptpath.isEmpty() ? QString("FigureItNow 7") : scriptpath);
+    if ( tobytes ) {
+        QBuffer outbuf;
+        outbuf.open(QIODevice::WriteOnly);
+        errcode = finUiRenderServer::exportFigure(&figcontainer, outtype, &outbuf, title);
+        outbuf.close();
+        if ( !finErrorKits::isErrorResult(errcode) )
+            reply->insert(QString("data"), QString::fromLatin1(outbuf.data().toBase64()));
+    } else {
+        QFile outfile(outpath);
+        if ( !outfile.open(QIODevice::WriteOnly | QIODevice::Truncate) ) {
+            reply->insert(QString("error"), QString("Cannot open output file: %1").arg(outpath));
+            return finErrorKits::EC_FILE_NOT_OPEN;
+        }
+        errcode = finUiRenderServer::exportFigure(&figcontainer, outtype, &outfile, title);
+        outfile.close();
+        if ( !finErrorKits::isErrorResult(errcode) )
+            reply->insert(QString("output"), outpath);
+    }
+
+    if ( finErrorKits::isErrorResult(errcode) )
+        reply->insert(QString("error"), QString("Export figure as %1 failed (%2).").arg(outtype).arg(static_cast<int>(errcode)));
+    return errcode;
+}
+
+finErrorCode finUiRenderServer::exportFigure(finFigureContainer *figcontainer, const QString &outtype,
+                                             QIODevice *outdev, const QString &title)
+{
+    if ( figcontainer == nullptr || outdev == nullptr )
+        return finErrorKits::EC_NULL_POINTER;
+
+    finGraphConfig *graphcfg = figcontainer->getGraphConfig();
+    finGraphPanelWidget graphpanel;
+    graphpanel.setFigureContainer(figcontainer);
+
+    if ( QString::compare(outtype, QString("PDF"), Qt::CaseInsensitive) == 0 ) {
+        static const int _defResolution = 72;
+
+        QPdfWriter pdfwrt(outdev);
+        pdfwrt.setTitle(title);
+        pdfwrt.setCreator(QString("FigureItNow 7"));
+        pdfwrt.setPageSize(QPageSize(graphcfg->getPanelPixelSize() / _defResolution, QPageSize::Inch));
+        pdfwrt.setPageMargins(QMarginsF(0.0, 0.0, 0.0, 0.0));
+        pdfwrt.setResolution(_defResolution);
+
+        graphpanel.setWidget(&pdfwrt);
+        return graphpanel.draw();
+    } else if ( QString::compare(outtype, QString("SVG"), Qt::CaseInsensitive) == 0 ) {
+        QSvgGenerator svggen;
+        svggen.setOutputDevice(outdev);
+        svggen.setTitle(title);
+        svggen.setDescription(QString("Generated by FigureItNow7."));
+        svggen.setSize(graphcfg->getPanelPixelSize().toSize());
+        svggen.setViewBox(graphcfg->getWholePanelPixelRect().toRect());
+
+        graphpanel.setWidget(&svggen);
+        return graphpanel.draw();
+    } else if ( _isImageOutType(outtype) ) {
+        QImage img(graphcfg->getPanelPixelSize().toSize(), QImage::Format_ARGB32);
+        img.fill(Qt::transparent);
+
+        graphpanel.setWidget(&img);
+        finErrorCode errcode = graphpanel.draw();
+        if ( finErrorKits::isErrorResult(errcode) )
+            return errcode;
+
+        if ( !img.save(outdev, outtype.toUpper().toLatin1().constData()) )
+            return finErrorKits::EC_STATE_ERROR;
+        return finErrorKits::EC_SUCCESS;
+    } else {
+        return finErrorKits::EC_NON_IMPLEMENT;
+    }
+}
@@ -0,0 +1,103 @@
+/*-
+ * GNU GENERAL PUBLIC LICENSE, version 3
+ * See LICENSE file for detail.
+ *
+ * Author: Yulong Yu
+ * Copyright(c) 2015-2026 Yulong Yu. All rights reserved.
+ */
+
+/*! \file finUiRenderServer.h
+ *  \brief Declarations of the headless, long-running render server.
+ *
+ *  This header defines finUiRenderServer, which reads render jobs line by line from stdin or from a
+ *  local socket and answers each with one JSON line, keeping compiled scripts warm between jobs.
+ */
+
+#ifndef FINUIRENDERSERVER_H
+#define FINUIRENDERSERVER_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QJsonObject>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+
+#include "finErrorCode.h"
+#include "finExecMachine.h"
+#include "finFigureContainer.h"
+
+
+/*! \class finUiRenderServer
+ *  \brief Serves render jobs from one process, so each figure skips the start-up work.
+ *
+ *  Every request is one line holding a JSON object:
+ *  - \c "script": path of a script file, or \c "code": the script text itself;
+ *  - \c "type": output type, \c "PNG" by default; PDF, SVG and the image formats of the command line;
+ *  - \c "width" and \c "height": optional panel size in pixels, set before the script runs, which may still change it;
+ *  - \c "output": optional output file path. Without it a \c "script" job writes next to the script, like
+ *    the command line, while a \c "code" job returns the figure inline;
+ *  - \c "bytes": if \c true, return the figure inline even for a \c "script" job;
+ *  - \c "id": any value, echoed in the reply.
+ *
+ *  The reply is one line holding a JSON object with \c "id", \c "ok", and either \c "output" (the written
+ *  path) or \c "data" (the base64-encoded figure), plus \c "error" on failure, \c "diagnostics" with the
+ *  execution errors of the script, and \c "elapsed" in milliseconds. The request
+ *  <tt>{"command": "shutdown"}</tt> stops the server.
+ *
+ *  The read-only root environment is built once per process. The server also keeps the compiled machines
+ *  of the most recently used scripts, so a script rendered again is neither re-read nor re-parsed; its
+ *  machine only gets a fresh global scope.
+ *
+ *  \see finUiCommandLine
+ *  \see finExecMachine
+ */
+class finUiRenderServer
+{
+protected:
+    QString _socketName;                              //!< Local socket to listen on; empty for stdin / stdout.
+    int _machineLimit;                                //!< Number of compiled machines kept warm.
+    int _plotWorkerCnt;                               //!< Plot worker count given to every machine.
+    QStringList _optOptions;                          //!< Optimizer passes given to every machine.
+    QList<QPair<QString, finExecMachine *> > _machineList;  //!< Warm machines by script key, most recent last.
+    bool _shutdown;                                   //!< Set by a shutdown request.
+
+public:
+    finUiRenderServer();
+    ~finUiRenderServer();
+
+    QString getSocketName() const;
+    void setSocketName(const QString &name);
+    int getMachineLimit() const;
+    void setMachineLimit(int limit);
+    int getPlotWorkerCount() const;
+    void setPlotWorkerCount(int cnt);
+    QStringList getOptimizeOption() const;
+    void setOptimizeOption(const QStringList &options);
+
+    /*!
+     *  \brief Serves jobs until the input ends or a shutdown request arrives.
+     */
+    finErrorCode serve();
+
+    /*!
+     *  \brief Runs the job in one request line, and returns the reply line without its line break.
+     */
+    QByteArray handleRequest(const QByteArray &reqline);
+
+    /*!
+     *  \brief Draws \a figcontainer as \a outtype into \a outdev, which must be open for writing.
+     */
+    static finErrorCode exportFigure(finFigureContainer *figcontainer, const QString &outtype,
+                                     QIODevice *outdev, const QString &title);
+
+private:
+    finErrorCode serveStdio();
+    finErrorCode serveSocket();
+
+    finErrorCode renderJob(const QJsonObject &job, QJsonObject *reply);
+    finExecMachine *takeMachine(const QString &key);
+};
+
+#endif // FINUIRENDERSERVER_H
@@ -15,10 +15,21 @@
 #include "finUiScriptEditor.h"
 
 
+static bool _isServerStartUp(int argc, char *argv[]) {
+    for ( int i = 1; i < argc; i++ ) {
+        if ( qstrcmp(argv[i], "--serve") == 0 ||
+             qstrcmp(argv[i], "--serve-socket") == 0 )
+            return true;
+    }
+    return false;
+}
+
 static bool _isGUIStartUp(int argc, char *argv[]) {
     for ( int i = 1; i < argc; i++ ) {
         if ( qstrcmp(argv[i], "-c") == 0 ||
-             qstrcmp(argv[i], "--console") == 0 )
+             qstrcmp(argv[i], "--console") == 0 ||
+             qstrcmp(argv[i], "--serve") == 0 ||
+             qstrcmp(argv[i], "--serve-socket") == 0 )
             return false;
     }
     return true;
@@ -50,6 +61,10 @@ static int _guiMain(int argc, char *argv[])
 
 static int _consoleMain(int argc, char *argv[])
 {
+    // A render server never shows a window, so it must not need a display either.
+    if ( _isServerStartUp(argc, argv) && !qEnvironmentVariableIsSet("QT_QPA_PLATFORM") )
+        qputenv("QT_QPA_PLATFORM", QByteArray("offscreen"));
+
     QApplication a(argc, argv);
 
     finUiCommandLine cmdline(argc, argv);
@@ -61,6 +76,10 @@ static int _consoleMain(int argc, char *argv[])
 
 int main(int argc, char *argv[])
 {
+    // e.g. FIN_TRACE="warn,lex=debug" keeps warnings everywhere and full tracing in the lexer.
+    if ( qEnvironmentVariableIsSet("FIN_TRACE") )
+        finTraceKits::setupFromString(qEnvironmentVariable("FIN_TRACE"));
+
     bool isgui = _isGUIStartUp(argc, argv);
 
     if ( isgui )
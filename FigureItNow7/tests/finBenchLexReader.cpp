@@ -0,0 +1,76 @@
+/*-
+ * GNU GENERAL PUBLIC LICENSE, version 3
+ * See LICENSE file for detail.
+ *
+ * Author: Yulong Yu
+ * Copyright(c) 2015-2026 Yulong Yu. All rights reserved.
+ */
+
+/*! \file finBenchLexReader.cpp
+ *  \brief Measures the token throughput of finLexReader on a large generated script.
+ *
+ *  The script imitates the generated data scripts: long runs of array literals and assignments, with
+ *  strings, comments and a few control statements mixed in. The first argument gives its size in MiB
+ *  (4 by default), the second the number of timed runs (5 by default); the best run is reported.
+ */
+
+#include "finLexReader.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <QElapsedTimer>
+#include <QString>
+
+static QString _buildScript(int mibsize)
+{
+    QString script;
+    qsizetype limit = (qsizetype)mibsize * 1024 * 1024;
+    script.reserve(limit + 256);
+
+    for ( int i = 0; script.length() < limit; i++ ) {
+        script.append(QString("// data block %1\n").arg(i));
+        script.append(QString("var xary%1 = [").arg(i));
+        for ( int j = 0; j < 32; j++ )
+            script.append(QString("%1%2").arg(j > 0 ? ", " : "").arg((i * 32 + j) * 0.125 - 3.5e2));
+        script.append(QString("];\n"));
+        script.append(QString("name%1 = \"point \\\"%1\\\"\";\n").arg(i));
+        script.append(QString("if ( xary%1[3] >= 1.5e-3 && i != %1 ) { s = s + xary%1[3] * 2; }\n").arg(i));
+    }
+    return script;
+}
+
+int main(int argc, char *argv[])
+{
+    int mibsize = (argc > 1 ? atoi(argv[1]) : 4);
+    int runcnt = (argc > 2 ? atoi(argv[2]) : 5);
+    if ( mibsize <= 0 )
+        mibsize = 4;
+    if ( runcnt <= 0 )
+        runcnt = 5;
+
+    QString script = _buildScript(mibsize);
+    finLexReader reader(script);
+    finLexNode lexnode;
+    qint64 bestns = -1;
+    long tokencnt = 0;
+
+    for ( int r = 0; r < runcnt; r++ ) {
+        reader.resetPosition();
+        tokencnt = 0;
+
+        QElapsedTimer timer;
+        timer.start();
+        while ( reader.getNextLexNode(&lexnode) )
+            tokencnt++;
+        qint64 elapsedns = timer.nsecsElapsed();
+        if ( bestns < 0 || elapsedns < bestns )
+            bestns = elapsedns;
+    }
+
+    double secs = (bestns > 0 ? bestns : 1) / 1.0e9;
+    printf("Script: %lld chars, %ld tokens\n", (long long)script.length(), tokencnt);
+    printf("Best of %d runs: %.3f ms, %.1f Mtokens/s, %.1f MiB/s\n", runcnt, secs * 1.0e3,
+           tokencnt / secs / 1.0e6, script.length() * sizeof (QChar) / secs / (1024.0 * 1024.0));
+    return 0;
+}
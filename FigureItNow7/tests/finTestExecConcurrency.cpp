@@ -0,0 +1,122 @@
+/*-
+ * GNU GENERAL PUBLIC LICENSE, version 3
+ * See LICENSE file for detail.
+ *
+ * Author: Yulong Yu
+ * Copyright(c) 2015-2026 Yulong Yu. All rights reserved.
+ */
+
+/*! \file finTestExecConcurrency.cpp
+ *  \brief Stress check for machines and plot workers sharing the read-only root environment.
+ *
+ *  Several threads each run a series of machines at once, and every machine plots with several workers,
+ *  so system functions and system variables are resolved from many threads at the same time. Every run
+ *  compiles its own script, must succeed, and must draw the same figure point for point. Configure with
+ *  -DFIN_ENABLE_TSAN=ON to have ThreadSanitizer report the races this cannot see.
+ */
+
+#include <stdio.h>
+
+#include <QApplication>
+#include <QAtomicInt>
+#include <QList>
+#include <QPainterPath>
+#include <QPointF>
+#include <QThreadPool>
+
+#include "finErrorCode.h"
+#include "finExecCompileCache.h"
+#include "finExecMachine.h"
+#include "finFigureContainer.h"
+#include "finFigurePath.h"
+
+static const char *_scriptCode =
+        "wave(x, k) {\n"
+        "    return sin(k * x) * PI + E;\n"
+        "}\n"
+        "ring(x, y, r) {\n"
+        "    return x * x + y * y - r * r;\n"
+        "}\n"
+        "clear_fig();\n"
+        "plot_function(-10, 10, \"wave\", 3);\n"
+        "plot_equation(-3, 3, -3, 3, \"ring\", 2);\n";
+
+/* Runs the script on a machine of its own and returns every point of the figure drawn, object by object. */
+static finErrorCode _runScript(int *objcnt, QList<QPointF> *ptlist)
+{
+    finFigureContainer figcontainer;
+    finExecMachine machine;
+    machine.initEnvironmentFromRoot();
+    machine.setPlotWorkerCount(4);
+    machine.setFigureContainer(&figcontainer);
+    machine.setScriptCode(QString(_scriptCode));
+
+    finErrorCode errcode = machine.compile();
+    if ( finErrorKits::isErrorResult(errcode) )
+        return errcode;
+
+    errcode = machine.execute();
+    if ( finErrorKits::isErrorResult(errcode) )
+        return errcode;
+    if ( machine.getExecuteErrorCount() > 0 )
+        return finErrorKits::EC_STATE_ERROR;
+
+    *objcnt = figcontainer.getFigureObjectCount();
+    ptlist->clear();
+    for ( int i = 0; i < *objcnt; i++ ) {
+        QList<finFigurePath> pathlist;
+        errcode = figcontainer.getPixelFigurePathAt(i, &pathlist, figcontainer.getGraphConfig());
+        if ( finErrorKits::isErrorResult(errcode) )
+            return errcode;
+
+        foreach ( const finFigurePath &figpath, pathlist ) {
+            const QPainterPath &path = figpath.getPath();
+            for ( int j = 0; j < path.elementCount(); j++ )
+                ptlist->append(QPointF(path.elementAt(j).x, path.elementAt(j).y));
+        }
+    }
+    return finErrorKits::EC_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+    if ( !qEnvironmentVariableIsSet("QT_QPA_PLATFORM") )
+        qputenv("QT_QPA_PLATFORM", QByteArray("offscreen"));
+    QApplication app(argc, argv);
+
+    // Every run has to compile for itself, and nothing may land in the user's cache directory.
+    finExecCompileCache::setEnabled(false);
+
+    int refobjcnt = 0;
+    QList<QPointF> refptlist;
+    if ( finErrorKits::isErrorResult(_runScript(&refobjcnt, &refptlist)) || refobjcnt <= 0 ||
+         refptlist.isEmpty() ) {
+        fprintf(stderr, "FAIL: the reference run did not draw.\n");
+        return 1;
+    }
+
+    const int threadcnt = 4, runcnt = 8;
+    QAtomicInt failcnt(0);
+    QThreadPool pool;
+    pool.setMaxThreadCount(threadcnt);
+    for ( int t = 0; t < threadcnt; t++ ) {
+        pool.start([&]() {
+            for ( int i = 0; i < runcnt; i++ ) {
+                int objcnt = 0;
+                QList<QPointF> ptlist;
+                if ( finErrorKits::isErrorResult(_runScript(&objcnt, &ptlist)) || objcnt != refobjcnt ||
+                     ptlist != refptlist )
+                    failcnt.fetchAndAddRelaxed(1);
+            }
+        });
+    }
+    pool.waitForDone();
+
+    if ( failcnt.loadRelaxed() > 0 ) {
+        fprintf(stderr, "%d of %d concurrent runs failed or drew a different figure.\n",
+                failcnt.loadRelaxed(), threadcnt * runcnt);
+        return 1;
+    }
+    printf("All %d concurrent runs drew the reference figure.\n", threadcnt * runcnt);
+    return 0;
+}
@@ -0,0 +1,174 @@
+/*-
+ * GNU GENERAL PUBLIC LICENSE, version 3
+ * See LICENSE file for detail.
+ *
+ * Author: Yulong Yu
+ * Copyright(c) 2015-2026 Yulong Yu. All rights reserved.
+ */
+
+/*! \file finTestExecIncrementalCompile.cpp
+ *  \brief Check that an incremental compile builds the same tree as a full compile.
+ *
+ *  One compiler follows a series of edits and reuses what each edit left intact, while a fresh compiler
+ *  reads every version from scratch. The two trees must agree node for node, source positions included,
+ *  and the statements behind an edit must be the very nodes of the previous tree rather than copies.
+ */
+
+#include <stdio.h>
+
+#include <QString>
+
+#include "finExecCompiler.h"
+#include "finLexNode.h"
+#include "finSyntaxNode.h"
+#include "finSyntaxTree.h"
+
+static const char *_scriptBase =
+        "wave(x, k) {\n"
+        "    return sin(k * x) * 2.5 + 1;\n"
+        "}\n"
+        "a = 1;\n"
+        "b = \"text\";\n"
+        "if ( a > 0 ) {\n"
+        "    b = b + \"more\";\n"
+        "}\n"
+        "for ( i = 0; i < 4; i++ ) {\n"
+        "    a = a + wave(i, 2);\n"
+        "}\n"
+        "plot_function(-10, 10, \"wave\", 3);\n";
+
+/* Returns why the two lex nodes differ, or an empty string if they do not. */
+static QString _diffLexNode(const finLexNode *lexnode, const finLexNode *reflexnode)
+{
+    if ( lexnode == nullptr || reflexnode == nullptr )
+        return (lexnode == reflexnode ? QString() : QString("head presence"));
+
+    if ( lexnode->getType() != reflexnode->getType() )
+        return QString("head type");
+    if ( lexnode->getString() != reflexnode->getString() )
+        return QString("head text '%1' vs '%2'").arg(lexnode->getString(), reflexnode->getString());
+    if ( lexnode->getType() == finLexNode::TP_DECIMAL && lexnode->getFloatValue() != reflexnode->getFloatValue() )
+        return QString("decimal value");
+    if ( lexnode->getType() == finLexNode::TP_STRING && lexnode->getStringValue() != reflexnode->getStringValue() )
+        return QString("string value");
+    if ( lexnode->getType() == finLexNode::TP_OPERATOR && lexnode->getOperator() != reflexnode->getOperator() )
+        return QString("operator");
+    if ( lexnode->getRow() != reflexnode->getRow() || lexnode->getColumn() != reflexnode->getColumn() )
+        return QString("position %1:%2 vs %3:%4").arg(lexnode->getRow()).arg(lexnode->getColumn())
+                                                 .arg(reflexnode->getRow()).arg(reflexnode->getColumn());
+    if ( lexnode->getSpanPosition() != reflexnode->getSpanPosition() ||
+         lexnode->getSpanLength() != reflexnode->getSpanLength() )
+        return QString("span");
+    return QString();
+}
+
+/* Returns why the two sub-trees differ, or an empty string if they do not. */
+static QString _diffSyntaxNode(const finSyntaxNode *synnode, const finSyntaxNode *refsynnode)
+{
+    if ( synnode->getType() != refsynnode->getType() )
+        return QString("node type");
+
+    QString lexdiff = _diffLexNode(synnode->getCommandLexNode(), refsynnode->getCommandLexNode());
+    if ( !lexdiff.isEmpty() )
+        return lexdiff;
+
+    if ( synnode->getSubListCount() != refsynnode->getSubListCount() )
+        return QString("child count %1 vs %2").arg(synnode->getSubListCount()).arg(refsynnode->getSubListCount());
+    for ( int i = 0; i < synnode->getSubListCount(); i++ ) {
+        QString subdiff = _diffSyntaxNode(synnode->getSubSyntaxNode(i), refsynnode->getSubSyntaxNode(i));
+        if ( !subdiff.isEmpty() )
+            return QString("child %1: %2").arg(i).arg(subdiff);
+    }
+    return QString();
+}
+
+static bool _checkScript(finExecCompiler *inccompiler, const QString &script, const QString &stepname)
+{
+    inccompiler->setScriptCode(script);
+    finSyntaxTree *inctree = inccompiler->compile();
+
+    finExecCompiler refcompiler;
+    refcompiler.setScriptCode(script);
+    finSyntaxTree *reftree = refcompiler.compile();
+
+    bool passed = false;
+    if ( inctree == nullptr || reftree == nullptr ) {
+        fprintf(stderr, "FAIL %s: no tree was built.\n", qPrintable(stepname));
+    } else if ( inctree->getErrorCount() != reftree->getErrorCount() ) {
+        fprintf(stderr, "FAIL %s: %d syntax errors, a full compile finds %d.\n", qPrintable(stepname),
+                inctree->getErrorCount(), reftree->getErrorCount());
+    } else {
+        QString diff = _diffSyntaxNode(inctree->getRootNode(), reftree->getRootNode());
+        if ( diff.isEmpty() )
+            passed = true;
+        else
+            fprintf(stderr, "FAIL %s: the trees differ at %s.\n", qPrintable(stepname), qPrintable(diff));
+    }
+
+    // Each tree goes before its compiler, whose arena holds the shared statements.
+    if ( reftree != nullptr )
+        delete reftree;
+    if ( inctree != nullptr )
+        delete inctree;
+    return passed;
+}
+
+int main(int argc, char *argv[])
+{
+    Q_UNUSED(argc);
+    Q_UNUSED(argv);
+
+    const QString base = QString(_scriptBase);
+    struct {
+        const char *_name;
+        QString _script;
+    } steplist[] = {
+        { "full read",           base },
+        { "unchanged",           base },
+        { "edit first line",     QString(base).replace("sin(k * x)", "cos(k * x + 1)") },
+        { "insert statement",    QString(base).replace("a = 1;\n", "a = 1;\nc = a * 3;\n") },
+        { "change column",       QString(base).replace("a = 1;", "a = 12345;") },
+        { "delete statement",    QString(base).replace("b = \"text\";\n", "") },
+        { "join lines",          QString(base).replace("a = 1;\nb", "a = 1; b") },
+        { "break syntax",        QString(base).replace("a > 0", "a > ") },
+        { "repair syntax",       base },
+        { "append statement",    base + QString("clear_fig();\n") },
+        { "edit last statement", base + QString("clear_fig(1);\n") },
+        { "empty script",        QString() },
+        { "reread",              base },
+    };
+
+    finExecCompiler inccompiler;
+    int failcnt = 0;
+    for ( const auto &step : steplist ) {
+        if ( !_checkScript(&inccompiler, step._script, QString(step._name)) )
+            failcnt++;
+    }
+
+    // An edit to the first statement must leave the others to the previous pass. The nodes are compared by
+    // address, so the older tree is kept alive here to keep its statements from being freed and recycled.
+    inccompiler.setScriptCode(base);
+    finSyntaxTree *oldtree = inccompiler.compile();
+    inccompiler.setScriptCode(QString(base).replace("2.5", "3.5"));
+    finSyntaxTree *newtree = inccompiler.compile();
+    int topcnt = oldtree->getRootNode()->getSubListCount();
+    int reusecnt = 0;
+    for ( int i = 1; i < topcnt && i < newtree->getRootNode()->getSubListCount(); i++ ) {
+        if ( oldtree->getRootNode()->getSubSyntaxNode(i) == newtree->getRootNode()->getSubSyntaxNode(i) )
+            reusecnt++;
+    }
+    if ( reusecnt != topcnt - 1 ) {
+        fprintf(stderr, "FAIL reuse: %d of %d unchanged statements were shared.\n", reusecnt, topcnt - 1);
+        failcnt++;
+    }
+    delete newtree;
+    delete oldtree;
+
+    if ( failcnt > 0 ) {
+        fprintf(stderr, "%d incremental compile checks failed.\n", failcnt);
+        return 1;
+    }
+    printf("Incremental compiles matched full compiles over %d edits.\n",
+           static_cast<int>(sizeof (steplist) / sizeof (steplist[0])));
+    return 0;
+}